@@ -0,0 +1,197 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * command_table_test
+ *     check the firmware API command table of acamera_command_api.c, built
+ *     from the same acamera_command_table.h. acamera_command looks commands up
+ *     with a binary search, so the (type, command) keys must be strictly
+ *     ascending, and every command the firmware API handled before the table
+ *     must be in it, otherwise it returns NOT_EXISTS for that command.
+ *     Returns 0 when the table is sorted and complete.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "acamera_command_api.h"
+// the INFO command id, not used here, logs.h has its own INFO
+#undef INFO
+#include "logs.h"
+
+#define CMD_KEY( type, cmd ) ( (uint16_t)( ( ( type ) << 8 ) | ( cmd ) ) )
+
+// only the key of an entry, the flags and the handler are not looked at
+#define CMD_ENTRY( type, cmd, flags, fn ) CMD_KEY( type, cmd )
+#define CMD_RANGE( type, cmd, flags, min, max, fn ) CMD_KEY( type, cmd )
+
+static const uint16_t command_table[] = {
+#include "acamera_command_table.h"
+};
+
+// every (type, command) the firmware API handled before the table
+static const uint16_t command_required[] = {
+    CMD_KEY( TGENERAL, CONTEXT_NUMBER ),
+    CMD_KEY( TGENERAL, ACTIVE_CONTEXT ),
+    CMD_KEY( TGENERAL, STALE_CONFIG_FRAMES ),
+    CMD_KEY( TSELFTEST, FW_REVISION ),
+    CMD_KEY( TSENSOR, SENSOR_STREAMING ),
+    CMD_KEY( TSENSOR, SENSOR_SUPPORTED_PRESETS ),
+    CMD_KEY( TSENSOR, SENSOR_PRESET ),
+    CMD_KEY( TSENSOR, SENSOR_SWITCH_TIME ),
+    CMD_KEY( TSENSOR, SENSOR_WDR_MODE ),
+    CMD_KEY( TSENSOR, SENSOR_FPS ),
+    CMD_KEY( TSENSOR, SENSOR_TESTPATTERN ),
+    CMD_KEY( TSENSOR, SENSOR_NAME ),
+    CMD_KEY( TSENSOR, SENSOR_WIDTH ),
+    CMD_KEY( TSENSOR, SENSOR_HEIGHT ),
+    CMD_KEY( TSENSOR, SENSOR_EXPOSURES ),
+    CMD_KEY( TSENSOR, SENSOR_INFO_PRESET ),
+    CMD_KEY( TSENSOR, SENSOR_INFO_WDR_MODE ),
+    CMD_KEY( TSENSOR, SENSOR_INFO_FPS ),
+    CMD_KEY( TSENSOR, SENSOR_INFO_WIDTH ),
+    CMD_KEY( TSENSOR, SENSOR_INFO_HEIGHT ),
+    CMD_KEY( TSENSOR, SENSOR_INFO_EXPOSURES ),
+    CMD_KEY( TSENSOR, SENSOR_IR_CUT ),
+    CMD_KEY( TSYSTEM, SYSTEM_LOGGER_LEVEL ),
+    CMD_KEY( TSYSTEM, SYSTEM_LOGGER_MASK ),
+    CMD_KEY( TSYSTEM, BUFFER_DATA_TYPE ),
+    CMD_KEY( TSYSTEM, TEST_PATTERN_ENABLE_ID ),
+    CMD_KEY( TSYSTEM, TEST_PATTERN_MODE_ID ),
+    CMD_KEY( TSYSTEM, TEMPER_MODE_ID ),
+    CMD_KEY( TSYSTEM, SYSTEM_FREEZE_FIRMWARE ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_EXPOSURE ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_EXPOSURE_RATIO ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_INTEGRATION_TIME ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_MAX_INTEGRATION_TIME ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_SENSOR_ANALOG_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_SENSOR_DIGITAL_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_ISP_DIGITAL_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_AWB ),
+    CMD_KEY( TSYSTEM, SYSTEM_MANUAL_SATURATION ),
+    CMD_KEY( TSYSTEM, SYSTEM_EXPOSURE ),
+    CMD_KEY( TSYSTEM, SYSTEM_EXPOSURE_RATIO ),
+    CMD_KEY( TSYSTEM, SYSTEM_MAX_EXPOSURE_RATIO ),
+    CMD_KEY( TSYSTEM, SYSTEM_INTEGRATION_TIME ),
+    CMD_KEY( TSYSTEM, SYSTEM_LONG_INTEGRATION_TIME ),
+    CMD_KEY( TSYSTEM, SYSTEM_SHORT_INTEGRATION_TIME ),
+    CMD_KEY( TSYSTEM, SYSTEM_MAX_INTEGRATION_TIME ),
+    CMD_KEY( TSYSTEM, SYSTEM_SENSOR_ANALOG_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_MAX_SENSOR_ANALOG_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_SENSOR_DIGITAL_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_MAX_SENSOR_DIGITAL_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_ISP_DIGITAL_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_MAX_ISP_DIGITAL_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_AWB_RED_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_AWB_BLUE_GAIN ),
+    CMD_KEY( TSYSTEM, SYSTEM_SATURATION_TARGET ),
+    CMD_KEY( TSYSTEM, SYSTEM_ANTIFLICKER_ENABLE ),
+    CMD_KEY( TSYSTEM, SYSTEM_ANTI_FLICKER_FREQUENCY ),
+    CMD_KEY( TSYSTEM, CALIBRATION_UPDATE ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_IRIDIX ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_SINTER ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_TEMPER ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_AUTO_LEVEL ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_FRAME_STITCH ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_RAW_FRONTEND ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_BLACK_LEVEL ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_SHADING ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_DEMOSAIC ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_CNR ),
+    CMD_KEY( TISP_MODULES, ISP_MODULES_MANUAL_SHARPEN ),
+    CMD_KEY( TSTATUS, STATUS_INFO_EXPOSURE_LOG2_ID ),
+    CMD_KEY( TSTATUS, STATUS_INFO_GAIN_ONES_ID ),
+    CMD_KEY( TSTATUS, STATUS_INFO_GAIN_LOG2_ID ),
+    CMD_KEY( TSTATUS, STATUS_INFO_AWB_MIX_LIGHT_CONTRAST ),
+    CMD_KEY( TSTATUS, STATUS_INFO_AF_LENS_POS ),
+    CMD_KEY( TSTATUS, STATUS_INFO_AF_FOCUS_VALUE ),
+    CMD_KEY( TIMAGE, DMA_READER_OUTPUT_ID ),
+    CMD_KEY( TIMAGE, FR_FORMAT_BASE_PLANE_ID ),
+    CMD_KEY( TIMAGE, DS1_FORMAT_BASE_PLANE_ID ),
+    CMD_KEY( TIMAGE, ORIENTATION_VFLIP_ID ),
+    CMD_KEY( TIMAGE, ORIENTATION_HFLIP_ID ),
+    CMD_KEY( TIMAGE, IMAGE_RESIZE_TYPE_ID ),
+    CMD_KEY( TIMAGE, IMAGE_RESIZE_ENABLE_ID ),
+    CMD_KEY( TIMAGE, IMAGE_RESIZE_WIDTH_ID ),
+    CMD_KEY( TIMAGE, IMAGE_RESIZE_HEIGHT_ID ),
+    CMD_KEY( TIMAGE, IMAGE_CROP_XOFFSET_ID ),
+    CMD_KEY( TIMAGE, IMAGE_CROP_YOFFSET_ID ),
+    CMD_KEY( TALGORITHMS, AF_LENS_STATUS ),
+    CMD_KEY( TALGORITHMS, AF_MODE_ID ),
+    CMD_KEY( TALGORITHMS, AF_RANGE_LOW_ID ),
+    CMD_KEY( TALGORITHMS, AF_RANGE_HIGH_ID ),
+    CMD_KEY( TALGORITHMS, AF_ROI_ID ),
+    CMD_KEY( TALGORITHMS, AF_MANUAL_CONTROL_ID ),
+    CMD_KEY( TALGORITHMS, AE_MODE_ID ),
+    CMD_KEY( TALGORITHMS, AE_SPLIT_PRESET_ID ),
+    CMD_KEY( TALGORITHMS, AE_GAIN_ID ),
+    CMD_KEY( TALGORITHMS, AE_EXPOSURE_ID ),
+    CMD_KEY( TALGORITHMS, AE_ROI_ID ),
+    CMD_KEY( TALGORITHMS, AE_COMPENSATION_ID ),
+    CMD_KEY( TALGORITHMS, AWB_MODE_ID ),
+    CMD_KEY( TALGORITHMS, AWB_TEMPERATURE_ID ),
+    CMD_KEY( TALGORITHMS, ANTIFLICKER_MODE_ID ),
+    CMD_KEY( TALGORITHMS, AE_ZONE_WEIGHT ),
+    CMD_KEY( TALGORITHMS, AWB_ZONE_WEIGHT ),
+    CMD_KEY( TSCENE_MODES, COLOR_MODE_ID ),
+    CMD_KEY( TSCENE_MODES, BRIGHTNESS_STRENGTH_ID ),
+    CMD_KEY( TSCENE_MODES, CONTRAST_STRENGTH_ID ),
+    CMD_KEY( TSCENE_MODES, SATURATION_STRENGTH_ID ),
+    CMD_KEY( TSCENE_MODES, SHARPENING_STRENGTH_ID ),
+    CMD_KEY( TREGISTERS, REGISTERS_ADDRESS_ID ),
+    CMD_KEY( TREGISTERS, REGISTERS_SIZE_ID ),
+    CMD_KEY( TREGISTERS, REGISTERS_SOURCE_ID ),
+    CMD_KEY( TREGISTERS, REGISTERS_VALUE_ID ),
+#if ISP_HAS_DS2
+    CMD_KEY( TAML_SCALER, SCALER_WIDTH ),
+    CMD_KEY( TAML_SCALER, SCALER_HEIGHT ),
+    CMD_KEY( TAML_SCALER, SCALER_SRC_WIDTH ),
+    CMD_KEY( TAML_SCALER, SCALER_SRC_HEIGHT ),
+    CMD_KEY( TAML_SCALER, SCALER_OUTPUT_MODE ),
+    CMD_KEY( TAML_SCALER, SCALER_STREAMING_ON ),
+    CMD_KEY( TAML_SCALER, SCALER_STREAMING_OFF ),
+#endif
+};
+
+#define ARRAY_SIZE( a ) ( sizeof( a ) / sizeof( ( a )[0] ) )
+
+int main(void)
+{
+    uint32_t errors = 0;
+    uint32_t i, j;
+
+    for (i = 1; i < ARRAY_SIZE(command_table); i++) {
+        if (command_table[i - 1] >= command_table[i]) {
+            ERR("entry %u: type %u, cmd %u after type %u, cmd %u\n", i,
+                command_table[i] >> 8, command_table[i] & 0xff,
+                command_table[i - 1] >> 8, command_table[i - 1] & 0xff);
+            errors++;
+        }
+    }
+
+    for (i = 0; i < ARRAY_SIZE(command_required); i++) {
+        for (j = 0; j < ARRAY_SIZE(command_table); j++)
+            if (command_table[j] == command_required[i])
+                break;
+        if (j == ARRAY_SIZE(command_table)) {
+            ERR("missing type %u, cmd %u\n", command_required[i] >> 8, command_required[i] & 0xff);
+            errors++;
+        }
+    }
+
+    MSG("command table: %zu entries, %zu required commands, %u errors\n",
+        ARRAY_SIZE(command_table), ARRAY_SIZE(command_required), errors);
+
+    return errors ? 1 : 0;
+}
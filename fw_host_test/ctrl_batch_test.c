@@ -0,0 +1,418 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * ctrl_batch_test [frames]
+ *     run the control batch bookkeeping of acamera_ctrl_batch.h the way
+ *     acamera.c does, against a model of the frame start and end interrupts,
+ *     the firmware thread and the cmos exposure history, for sensor exposure
+ *     delays of 1 to 3 frames and AE latencies of 0 to 2 frames, [frames]
+ *     frames each with randomly queued batches:
+ *     - the commands the batch controls of fw-interface.c queue can all be
+ *       SET in the real command table (acamera_command_table.h), a read only
+ *       one can not,
+ *     - a batch is applied at the frame start of its target frame, or of the
+ *       next frame when the target has started, and a batch with an earlier
+ *       target does not wait behind the ones queued before it,
+ *     - the reported frame is the first one whose exposure was computed after
+ *       the batch, or the frame after the one it was applied at when the
+ *       exposure did not change within ACAMERA_CTRL_BATCH_REPORT_FRAMES,
+ *     - a batch queued for frame 105 at frame 100 is applied at 105,
+ *     - a fifth queued batch is refused.
+ *     Frame ids are the buffer metadata ones, the hardware frame ids of the
+ *     exposure history are offset from them. Returns 0 when every check passes.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acamera_firmware_api.h"
+// the INFO command id, not used here, logs.h has its own INFO
+#undef INFO
+#include "logs.h"
+#include "acamera_ctrl_batch.h"
+
+#define CMD_KEY( type, cmd ) ( (uint16_t)( ( ( type ) << 8 ) | ( cmd ) ) )
+#define CMD_RO CMD_FLAG_GET
+#define CMD_WO CMD_FLAG_SET
+#define CMD_RW ( CMD_FLAG_GET | CMD_FLAG_SET )
+#define CMD_ENTRY( type, cmd, flags, fn ) { CMD_KEY( type, cmd ), ( flags ) }
+#define CMD_RANGE( type, cmd, flags, min, max, fn ) { CMD_KEY( type, cmd ), ( flags ) }
+
+static const struct {
+    uint16_t key;
+    uint8_t flags;
+} command_table[] = {
+#include "acamera_command_table.h"
+};
+
+#define ARRAY_SIZE( a ) ( sizeof( a ) / sizeof( ( a )[0] ) )
+
+#define HIST_SIZE 8   // CMOS_EXPOSURE_HIST_SIZE
+#define HW_START 1000 // hardware frame id before the first frame start
+#define MAX_FRAMES 100000
+#define MAX_BATCHES 8192
+#define OUTSTANDING 3 // queued and unreported batches, below the report slots
+
+// what the batch controls of fw-interface.c queue
+static const uint8_t batch_cmds[] = {
+    SYSTEM_MANUAL_INTEGRATION_TIME, SYSTEM_MANUAL_SENSOR_ANALOG_GAIN, SYSTEM_MANUAL_SENSOR_DIGITAL_GAIN,
+    SYSTEM_MANUAL_ISP_DIGITAL_GAIN, SYSTEM_INTEGRATION_TIME, SYSTEM_SENSOR_ANALOG_GAIN,
+    SYSTEM_SENSOR_DIGITAL_GAIN, SYSTEM_ISP_DIGITAL_GAIN,
+};
+
+typedef struct {
+    uint32_t seq;
+    uint32_t frame_id;
+    uint32_t updates;
+} slot_t;
+
+typedef struct {
+    uint32_t due;        // frame it has to be applied at
+    uint32_t applied;    // frame it was applied at, 0 before
+    uint32_t applied_hw;
+    uint32_t updates;    // exposure updates before it was applied
+    uint32_t reported;   // frame reported, 0 before
+    int no_exposure;     // changes nothing the cmos looks at
+} model_batch_t;
+
+/* the sensor and the firmware around the bookkeeping */
+static struct {
+    uint32_t delay;        // integration_time_apply_delay
+    uint32_t ae_latency;   // firmware passes from a batch to the exposure update
+    uint32_t hw;           // hardware frame id of the current frame
+    uint32_t frame;        // isp_frame_counter
+    uint32_t offset;       // isp_frame_hw_offset
+    slot_t hist[HIST_SIZE];
+    uint32_t update_count; // cmos exposure updates
+    uint32_t update_pass;  // pass the pending exposure update is due at, 0 for none
+    uint32_t pass;
+    uint32_t updates_of[MAX_FRAMES]; // update count of the exposure of each hardware frame
+    int woken;
+
+    uint32_t queue_frame;
+    acamera_ctrl_batch_list_t queued;
+    uint32_t report_num;
+    acamera_ctrl_batch_report_t report[ACAMERA_CTRL_BATCH_QUEUE_SIZE];
+
+    model_batch_t batch[MAX_BATCHES];
+    uint32_t batch_num;
+    uint32_t outstanding;
+} m;
+
+static uint64_t rnd_state = 0x9e3779b97f4a7c15ULL;
+static uint32_t checks, failures, timeouts, reports;
+
+static uint64_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 7;
+    rnd_state ^= rnd_state << 17;
+    return rnd_state;
+}
+
+static void fail(const char *what, uint32_t id, uint32_t got, uint32_t want)
+{
+    if (failures++ < 16)
+        ERR("delay %u, AE latency %u, batch %u: %s %u, expected %u\n",
+            m.delay, m.ae_latency, id, what, got, want);
+}
+
+static int command_can_set(uint8_t type, uint8_t cmd)
+{
+    uint32_t i;
+
+    for (i = 0; i < ARRAY_SIZE(command_table); i++)
+        if (command_table[i].key == CMD_KEY(type, cmd))
+            return (command_table[i].flags & CMD_FLAG_SET) != 0;
+
+    return 0;
+}
+
+/* FSM_PARAM_GET_FRAME_EXPOSURE_SET_BY_ID */
+static int32_t get_exposure(void *priv, uint32_t frame_hw, uint32_t *p_updates)
+{
+    const slot_t *slot = &m.hist[frame_hw % HIST_SIZE];
+
+    (void)priv;
+    if (slot->seq == 0 || slot->frame_id != frame_hw)
+        return -1;
+
+    *p_updates = slot->updates;
+    return 0;
+}
+
+static void write_slot(uint32_t frame_hw)
+{
+    slot_t *slot = &m.hist[frame_hw % HIST_SIZE];
+
+    slot->seq += 2;
+    slot->frame_id = frame_hw;
+    slot->updates = m.update_count;
+    m.updates_of[frame_hw - HW_START] = m.update_count;
+}
+
+/* acamera_queue_ctrl_batch */
+static int32_t queue_batch(uint32_t target, int no_exposure)
+{
+    acamera_ctrl_batch_t batch;
+    model_batch_t *b = &m.batch[m.batch_num];
+    uint32_t i;
+
+    memset(&batch, 0, sizeof(batch));
+    for (i = 0; i < ARRAY_SIZE(batch_cmds); i++) {
+        batch.cmd[i].command_type = TSYSTEM;
+        batch.cmd[i].command = batch_cmds[i];
+        batch.cmd[i].value = i;
+        checks++;
+        if (!command_can_set(TSYSTEM, batch_cmds[i]))
+            fail("command can not be set, cmd", m.batch_num, batch_cmds[i], 0);
+    }
+    batch.cmd_num = no_exposure ? 1 : ARRAY_SIZE(batch_cmds);
+    batch.id = m.batch_num;
+    batch.target_frame = target;
+
+    if (acamera_ctrl_batch_insert(&m.queued, &batch, acamera_ctrl_batch_due_frame(target, m.queue_frame)))
+        return -1;
+
+    memset(b, 0, sizeof(*b));
+    b->due = (target == 0 || (int32_t)(target - m.queue_frame) <= 0) ? m.queue_frame + 1 : target;
+    b->no_exposure = no_exposure;
+    m.batch_num++;
+    m.outstanding++;
+
+    return 0;
+}
+
+/* cmos_move_exposure_history and acamera_ctrl_batch_frame_start */
+static void frame_start(void)
+{
+    uint32_t updates;
+    uint32_t i;
+
+    m.hw++;
+    for (i = 0; i < m.delay; i++)
+        if (get_exposure(NULL, m.hw + i, &updates) != 0)
+            write_slot(m.hw + i);
+    write_slot(m.hw + m.delay);
+
+    m.queue_frame = m.frame + 1;
+    if (acamera_ctrl_batch_head_is_due(&m.queued, m.queue_frame))
+        m.woken = 1;
+}
+
+static void frame_end(void)
+{
+    m.frame++;
+    m.offset = m.frame - m.hw;
+}
+
+/* acamera_ctrl_batch_report_done with the callback */
+static void report_done(uint32_t idx, uint32_t frame_hw)
+{
+    acamera_ctrl_batch_report_t *p_report = &m.report[idx];
+    model_batch_t *b = &m.batch[p_report->batch.id];
+    uint32_t want = b->applied_hw + 1;
+    uint32_t h;
+
+    // the first exposure the cmos computed after the batch, if it came in time
+    for (h = b->applied_hw + 1; h <= b->applied_hw + ACAMERA_CTRL_BATCH_REPORT_FRAMES + m.delay; h++) {
+        if (m.updates_of[h - HW_START] > b->updates) {
+            want = h;
+            break;
+        }
+    }
+    if (want == b->applied_hw + 1 && m.updates_of[want - HW_START] <= b->updates)
+        timeouts++;
+
+    checks++;
+    reports++;
+    b->reported = frame_hw + m.offset;
+    if (b->reported != want + m.offset)
+        fail("reported at frame", p_report->batch.id, b->reported, want + m.offset);
+    m.outstanding--;
+
+    m.report_num--;
+    for (; idx < m.report_num; idx++)
+        m.report[idx] = m.report[idx + 1];
+}
+
+/* acamera_ctrl_batch_process */
+static void process(void)
+{
+    acamera_ctrl_batch_report_t *p_report;
+    acamera_ctrl_batch_t batch;
+    model_batch_t *b;
+
+    while (acamera_ctrl_batch_take(&m.queued, m.queue_frame, &batch)) {
+        if (m.report_num == ACAMERA_CTRL_BATCH_QUEUE_SIZE)
+            report_done(0, m.report[0].applied_hw + 1);
+        p_report = &m.report[m.report_num];
+        p_report->batch = batch;
+        p_report->applied_hw = m.hw;
+        p_report->next_hw = m.hw + 1;
+        p_report->exposure_updates = m.update_count;
+        p_report->result = 0;
+        m.report_num++;
+
+        b = &m.batch[batch.id];
+        b->applied = m.queue_frame;
+        b->applied_hw = m.hw;
+        b->updates = m.update_count;
+        checks++;
+        if (b->applied != b->due)
+            fail("applied at frame", batch.id, b->applied, b->due);
+
+        if (!b->no_exposure && !m.update_pass)
+            m.update_pass = m.pass + m.ae_latency;
+    }
+}
+
+/* acamera_ctrl_batch_report */
+static void report(void)
+{
+    uint32_t frame_hw;
+    uint32_t idx = 0;
+
+    while (idx < m.report_num) {
+        if (acamera_ctrl_batch_exposure_frame(&m.report[idx], m.hw, get_exposure, NULL, &frame_hw))
+            report_done(idx, frame_hw);
+        else
+            idx++;
+    }
+}
+
+/* acamera_process: batches, reports, then the FSMs */
+static void firmware_pass(void)
+{
+    m.pass++;
+    if (m.woken) {
+        m.woken = 0;
+        process();
+    }
+    report();
+
+    if (m.update_pass && (int32_t)(m.pass - m.update_pass) >= 0) {
+        m.update_pass = 0;
+        m.update_count++;
+    }
+}
+
+static void run(uint32_t delay, uint32_t ae_latency, uint32_t frames)
+{
+    uint32_t first = MAX_BATCHES;
+    uint32_t f, i;
+
+    memset(&m, 0, sizeof(m));
+    m.delay = delay;
+    m.ae_latency = ae_latency;
+    m.hw = HW_START;
+    // the exposure computed at sensor_ready
+    m.update_count = 1;
+
+    for (f = 0; f < frames; f++) {
+        frame_start();
+        firmware_pass();
+
+        if (m.frame == 100) {
+            // the batch of the V4L2 controls, for a frame five ahead
+            first = m.batch_num;
+            if (queue_batch(105, 0))
+                fail("batch for frame 105 refused, queued", 0, m.queued.count, 0);
+        } else if (m.frame > 100 && f + 64 < frames && m.outstanding < OUTSTANDING && rnd() % 3 == 0) {
+            // behind, now, just ahead, or ahead of the queued ones
+            uint32_t target = m.queue_frame - 2 + rnd() % 14;
+
+            if (rnd() % 8 == 0)
+                target = 0;
+            if (queue_batch(target, rnd() % 5 == 0))
+                fail("batch refused, queued", m.batch_num, m.queued.count, 0);
+        }
+
+        frame_end();
+    }
+
+    for (i = 0; i < m.batch_num; i++) {
+        checks++;
+        if (!m.batch[i].applied || !m.batch[i].reported)
+            fail("not applied or reported, applied at", i, m.batch[i].applied, m.batch[i].due);
+    }
+    checks++;
+    if (first >= m.batch_num || m.batch[first].applied != 105)
+        fail("applied at frame", first, first < m.batch_num ? m.batch[first].applied : 0, 105);
+}
+
+/* the list itself: sorted by due frame, stable, full at ACAMERA_CTRL_BATCH_QUEUE_SIZE */
+static void check_list(void)
+{
+    static const uint32_t due[] = {112, 108, 112, 109};
+    static const uint32_t order[] = {1, 3, 0, 2};
+    acamera_ctrl_batch_list_t list;
+    acamera_ctrl_batch_t batch;
+    uint32_t i;
+
+    memset(&list, 0, sizeof(list));
+    memset(&batch, 0, sizeof(batch));
+    for (i = 0; i < ARRAY_SIZE(due); i++) {
+        batch.id = i;
+        checks++;
+        if (acamera_ctrl_batch_insert(&list, &batch, due[i]))
+            fail("list insert failed, count", i, list.count, 0);
+    }
+    checks++;
+    if (acamera_ctrl_batch_insert(&list, &batch, 100) == 0)
+        fail("fifth batch queued, count", 4, list.count, ACAMERA_CTRL_BATCH_QUEUE_SIZE);
+
+    checks++;
+    if (acamera_ctrl_batch_take(&list, 107, &batch))
+        fail("taken before its frame, batch", batch.id, 107, 108);
+    for (i = 0; i < ARRAY_SIZE(order); i++) {
+        checks++;
+        if (!acamera_ctrl_batch_take(&list, 112, &batch) || batch.id != order[i])
+            fail("taken out of order, got", i, batch.id, order[i]);
+    }
+
+    // a read only command is refused at queue time
+    checks++;
+    if (command_can_set(TSYSTEM, SYSTEM_LONG_INTEGRATION_TIME))
+        fail("read only command can be set, cmd", 0, SYSTEM_LONG_INTEGRATION_TIME, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t frames = argc > 1 ? strtoul(argv[1], NULL, 0) : 4000;
+    uint32_t delay, ae_latency;
+    uint32_t batches = 0;
+
+    if (frames < 200 || frames > MAX_FRAMES - HIST_SIZE) {
+        ERR("usage: %s [frames], 200 to %u\n", argv[0], MAX_FRAMES - HIST_SIZE);
+        return 1;
+    }
+
+    check_list();
+
+    for (delay = 1; delay <= 3; delay++) {
+        for (ae_latency = 0; ae_latency <= 2; ae_latency++) {
+            run(delay, ae_latency, frames);
+            batches += m.batch_num;
+        }
+    }
+
+    MSG("control batches: %u, reported without an exposure change: %u, checks: %u, failed: %u\n",
+        batches, timeouts, checks, failures);
+
+    return failures ? 1 : 0;
+}
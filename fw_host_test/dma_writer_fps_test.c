@@ -0,0 +1,116 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * dma_writer_fps_test [max_fps]
+ *     run the dma writer decimation accumulator for every integer sensor and
+ *     target rate pair up to max_fps (120 by default) and check that:
+ *     - the first frame after the rate is set is written,
+ *     - over n sensor frames exactly t_fps * n / c_fps frames are written,
+ *     - every c_fps consecutive sensor frames hold exactly t_fps written ones,
+ *     - written frames are floor(c/t) or ceil(c/t) sensor frames apart.
+ *     Returns 0 when every pair passes.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "logs.h"
+#include "dma_writer_fps.h"
+
+#define CYCLES 8 // sensor frames run per pair, in units of c_fps
+
+static int check_pair(uint32_t c_fps, uint32_t t_fps)
+{
+    uint32_t frames = c_fps * CYCLES;
+    uint32_t acc = dma_writer_fps_acc_init(c_fps, t_fps);
+    uint32_t gap_min = c_fps / t_fps;
+    uint32_t gap_max = (c_fps + t_fps - 1) / t_fps;
+    uint32_t delivered = 0, window = 0, last = 0;
+    uint8_t *written;
+    uint32_t i;
+    int err = 0;
+
+    written = calloc(frames, 1);
+    if (!written) {
+        ERR("out of memory\n");
+        exit(1);
+    }
+
+    for (i = 0; i < frames; i++) {
+        written[i] = dma_writer_fps_acc_step(&acc, c_fps, t_fps);
+        if (!written[i])
+            continue;
+
+        if (delivered && (i - last < gap_min || i - last > gap_max)) {
+            ERR("%u/%u: frames %u and %u are %u apart, expected %u..%u\n",
+                t_fps, c_fps, last, i, i - last, gap_min, gap_max);
+            err = 1;
+        }
+        last = i;
+        delivered++;
+    }
+
+    if (!written[0]) {
+        ERR("%u/%u: the first frame is not written\n", t_fps, c_fps);
+        err = 1;
+    }
+
+    if ((uint64_t)delivered * c_fps != (uint64_t)t_fps * frames) {
+        ERR("%u/%u: %u frames written out of %u, expected %u\n",
+            t_fps, c_fps, delivered, frames, t_fps * CYCLES);
+        err = 1;
+    }
+
+    for (i = 0; i < frames; i++) {
+        window += written[i];
+        if (i >= c_fps)
+            window -= written[i - c_fps];
+        if (i + 1 >= c_fps && window != t_fps) {
+            ERR("%u/%u: %u frames written in the %u frames up to %u\n",
+                t_fps, c_fps, window, c_fps, i);
+            err = 1;
+            break;
+        }
+    }
+
+    free(written);
+
+    return err;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t max_fps = argc > 1 ? strtoul(argv[1], NULL, 0) : 120;
+    uint32_t c_fps, t_fps;
+    uint32_t pairs = 0, failed = 0;
+
+    if (!max_fps) {
+        ERR("usage: %s [max_fps]\n", argv[0]);
+        return 1;
+    }
+
+    for (c_fps = 1; c_fps <= max_fps; c_fps++) {
+        for (t_fps = 1; t_fps <= c_fps; t_fps++) {
+            pairs++;
+            failed += check_pair(c_fps, t_fps);
+        }
+    }
+
+    MSG("sensor/target pairs up to %u fps: %u, %u frames each in units of the sensor rate, failed: %u\n",
+        max_fps, pairs, CYCLES, failed);
+
+    return failed ? 1 : 0;
+}
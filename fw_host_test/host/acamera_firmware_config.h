@@ -0,0 +1,33 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#ifndef __ACAMERA_FIRMWARE_CONFIG_H__
+#define __ACAMERA_FIRMWARE_CONFIG_H__
+/*
+ * Stands in for inc/acamera_firmware_config.h in the host builds, only what
+ * the firmware files built here look at. FW_FAST_MATH and ISP_HAS_DS2 follow
+ * the firmware config unless the Makefile overrides them.
+ */
+
+#define KERNEL_MODULE 0
+
+#ifndef FW_FAST_MATH
+#define FW_FAST_MATH 1
+#endif
+
+#ifndef ISP_HAS_DS2
+#define ISP_HAS_DS2 1
+#endif
+
+#endif // __ACAMERA_FIRMWARE_CONFIG_H__
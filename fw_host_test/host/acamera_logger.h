@@ -0,0 +1,32 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#ifndef ACAMERA_LOGGER_H
+#define ACAMERA_LOGGER_H
+/*
+ * Stands in for the firmware logger in the host builds, messages go to stderr.
+ */
+
+#include <stdio.h>
+
+#define LOG_CRIT 1
+#define LOG_ERR 2
+#define LOG_WARNING 3
+#define LOG_NOTICE 4
+#define LOG_INFO 5
+#define LOG_DEBUG 6
+
+#define LOG( level, fmt, ... ) fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+
+#endif // ACAMERA_LOGGER_H
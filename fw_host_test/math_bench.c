@@ -0,0 +1,499 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * math_bench [samples]
+ *     time the firmware fixed-point primitives of acamera_math.c and compare
+ *     them against reference results computed in double precision:
+ *     ns/op, max and mean absolute error and a checksum of all outputs.
+ *     Errors are in output LSBs, for acamera_math_exp2 in ppm of the result.
+ *     16 bit arguments are run exhaustively, wider ones with [samples]
+ *     log-uniform values. math_bench is built with FW_FAST_MATH=1 and
+ *     math_bench_generic with FW_FAST_MATH=0, the checksums of both must
+ *     match. Returns 1 if a square root or a division is not exact.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "logs.h"
+#include "acamera_math.h"
+
+#define LOG2_SHIFT 18 // LOG2_GAIN_SHIFT of the firmware
+#define REPEAT 8
+#define ALL16 65536
+
+#define EXP2_SHIFT_OUT 8
+#define DIV_FRACTION 8
+#define BENCH_MAX 32
+
+typedef struct _bench_result_t {
+    const char *name;
+    const char *unit;
+    double ns_per_op;
+    double max_err;
+    double mean_err;
+    uint64_t checksum;
+    int exact; // any error fails the run
+} bench_result_t;
+
+// calibration style tables: increasing x, the u16 ones with a duplicate x
+static modulation_entry_t mod16[32];
+static modulation_entry_32_t mod32[32];
+// equidistant tables over the 16 bit range, rising for the inverse lookup
+static uint16_t eq16[33];
+static uint32_t eq32[65];
+
+static volatile uint64_t sink;
+
+static uint64_t rnd_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 7;
+    rnd_state ^= rnd_state << 17;
+    return rnd_state;
+}
+
+// log-uniform over the bit lengths so small arguments are covered as well as large ones
+static uint64_t rnd_bits(uint32_t max_bits)
+{
+    uint32_t bits = rnd() % max_bits + 1;
+
+    return rnd() >> (64 - bits);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t ref_isqrt64(uint64_t x)
+{
+    uint64_t r = (uint64_t)sqrt((double)x);
+
+    while (r && (unsigned __int128)r * r > x)
+        r--;
+    while ((unsigned __int128)(r + 1) * (r + 1) <= x)
+        r++;
+
+    return (uint32_t)r;
+}
+
+static void err_add(bench_result_t *res, double err, uint32_t n)
+{
+    err = fabs(err);
+    if (err > res->max_err)
+        res->max_err = err;
+    res->mean_err += err / n;
+}
+
+static void show(const bench_result_t *res)
+{
+    MSG("%-50s %8.2f %10.3f %10.4f %4s   %016llx\n", res->name, res->ns_per_op,
+        res->max_err, res->mean_err, res->unit, (unsigned long long)res->checksum);
+}
+
+#define TIME_LOOP(res, n, expr)                                         \
+    do {                                                                \
+        uint64_t _t0, _acc = 0;                                         \
+        uint32_t _r, i;                                                 \
+        _t0 = now_ns();                                                 \
+        for (_r = 0; _r < REPEAT; _r++)                                 \
+            for (i = 0; i < (n); i++)                                   \
+                _acc += (expr);                                         \
+        (res)->ns_per_op = (double)(now_ns() - _t0) / ((double)(n) * REPEAT); \
+        sink += _acc;                                                   \
+    } while (0)
+
+static void bench_sqrt16(bench_result_t *res)
+{
+    uint32_t i;
+
+    res->name = "acamera_sqrt16 (all)";
+    TIME_LOOP(res, 65536, acamera_sqrt16((uint16_t)i));
+    for (i = 0; i < 65536; i++) {
+        uint8_t v = acamera_sqrt16((uint16_t)i);
+
+        err_add(res, (double)v - ref_isqrt64(i), 65536);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_sqrt32(bench_result_t *res, const uint64_t *in, uint32_t n)
+{
+    uint32_t i;
+
+    res->name = "acamera_sqrt32";
+    TIME_LOOP(res, n, acamera_sqrt32((uint32_t)in[i]));
+    for (i = 0; i < n; i++) {
+        uint16_t v = acamera_sqrt32((uint32_t)in[i]);
+
+        err_add(res, (double)v - ref_isqrt64((uint32_t)in[i]), n);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_sqrt64(bench_result_t *res, const uint64_t *in, uint32_t n)
+{
+    uint32_t i;
+
+    res->name = "acamera_sqrt64";
+    TIME_LOOP(res, n, acamera_sqrt64(in[i]));
+    for (i = 0; i < n; i++) {
+        uint32_t v = acamera_sqrt64(in[i]);
+
+        err_add(res, (double)v - ref_isqrt64(in[i]), n);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_log2_32(bench_result_t *res, const uint64_t *in, uint32_t n)
+{
+    uint32_t i;
+
+    res->name = "acamera_log2_fixed_to_fixed";
+    TIME_LOOP(res, n, acamera_log2_fixed_to_fixed((uint32_t)in[i] | 1, 0, LOG2_SHIFT));
+    for (i = 0; i < n; i++) {
+        uint32_t x = (uint32_t)in[i] | 1;
+        uint32_t v = acamera_log2_fixed_to_fixed(x, 0, LOG2_SHIFT);
+
+        err_add(res, (double)v - log2((double)x) * (1 << LOG2_SHIFT), n);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_log2_64(bench_result_t *res, const uint64_t *in, uint32_t n)
+{
+    uint32_t i;
+
+    res->name = "acamera_log2_fixed_to_fixed_64";
+    TIME_LOOP(res, n, (uint32_t)acamera_log2_fixed_to_fixed_64(in[i] | 1, 0, LOG2_SHIFT));
+    for (i = 0; i < n; i++) {
+        uint64_t x = in[i] | 1;
+        int32_t v = acamera_log2_fixed_to_fixed_64(x, 0, LOG2_SHIFT);
+
+        err_add(res, (double)v - log2((double)x) * (1 << LOG2_SHIFT), n);
+        res->checksum = res->checksum * 31 + (uint32_t)v;
+    }
+}
+
+static void bench_log2_int(bench_result_t *res, const uint64_t *in, uint32_t n)
+{
+    uint32_t i;
+
+    res->name = "acamera_log2_int_to_fixed";
+    TIME_LOOP(res, n, acamera_log2_int_to_fixed((uint32_t)in[i] | 1, 8, 0));
+    for (i = 0; i < n; i++) {
+        uint32_t x = (uint32_t)in[i] | 1;
+        uint32_t v = acamera_log2_int_to_fixed(x, 8, 0);
+
+        err_add(res, (double)v - log2((double)x) * 256, n);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+// every exponent whose result fits, integral part up to 30 - shift_out
+static void bench_exp2(bench_result_t *res, const uint64_t *in, uint32_t n)
+{
+    const uint32_t range = (31 - EXP2_SHIFT_OUT) << LOG2_SHIFT;
+    uint32_t i;
+
+    res->name = "acamera_math_exp2";
+    res->unit = "ppm";
+    TIME_LOOP(res, n, acamera_math_exp2((uint32_t)in[i] % range, LOG2_SHIFT, EXP2_SHIFT_OUT));
+    for (i = 0; i < n; i++) {
+        uint32_t x = (uint32_t)in[i] % range;
+        uint32_t v = acamera_math_exp2(x, LOG2_SHIFT, EXP2_SHIFT_OUT);
+        double ref = exp2((double)x / (1 << LOG2_SHIFT) + EXP2_SHIFT_OUT);
+
+        err_add(res, ((double)v - ref) / ref * 1e6, n);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_div_fixed(bench_result_t *res, const uint64_t *in32, const uint64_t *in64, uint32_t n)
+{
+    uint32_t i;
+
+    res->name = "acamera_div_fixed";
+    res->exact = 1;
+    TIME_LOOP(res, n, acamera_div_fixed((uint32_t)in32[i], (uint32_t)in64[i] | 1, DIV_FRACTION));
+    for (i = 0; i < n; i++) {
+        uint32_t a = (uint32_t)in32[i];
+        uint32_t b = (uint32_t)in64[i] | 1;
+        uint32_t v = acamera_div_fixed(a, b, DIV_FRACTION);
+
+        // the quotient is truncated to 32 bits by contract
+        err_add(res, (double)v - (uint32_t)(((uint64_t)a << DIV_FRACTION) / b), n);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+// linear interpolation of a calibration table, clamped at both ends
+static double ref_modulation(double x, const double *tx, const double *ty, int len)
+{
+    int i;
+
+    if (x <= tx[0])
+        return ty[0];
+    if (x >= tx[len - 1])
+        return ty[len - 1];
+    for (i = 1; x >= tx[i]; i++)
+        ;
+
+    return ty[i - 1] + (ty[i] - ty[i - 1]) * (x - tx[i - 1]) / (tx[i] - tx[i - 1]);
+}
+
+static void bench_modulation_u16(bench_result_t *res, int len)
+{
+    double tx[32], ty[32];
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        tx[i] = mod16[i].x;
+        ty[i] = mod16[i].y;
+    }
+
+    res->name = len == 4 ? "acamera_calc_modulation_u16 (all, 4 rows)" : "acamera_calc_modulation_u16 (all, 32 rows)";
+    TIME_LOOP(res, ALL16, acamera_calc_modulation_u16((uint16_t)i, mod16, len));
+    for (i = 0; i < ALL16; i++) {
+        uint16_t v = acamera_calc_modulation_u16((uint16_t)i, mod16, len);
+
+        err_add(res, (double)v - ref_modulation(i, tx, ty, len), ALL16);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_modulation_u32(bench_result_t *res, const uint64_t *in, uint32_t n)
+{
+    double tx[32], ty[32];
+    uint32_t i, len = 32;
+
+    for (i = 0; i < len; i++) {
+        tx[i] = mod32[i].x;
+        ty[i] = mod32[i].y;
+    }
+
+    res->name = "acamera_calc_modulation_u32 (32 rows)";
+    TIME_LOOP(res, n, acamera_calc_modulation_u32((uint32_t)in[i], mod32, len));
+    for (i = 0; i < n; i++) {
+        uint32_t v = acamera_calc_modulation_u32((uint32_t)in[i], mod32, len);
+
+        err_add(res, (double)v - ref_modulation((uint32_t)in[i], tx, ty, len), n);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+// table entry k sits at k * 65536 / (len - 1)
+static double ref_equidistant(double x, const double *t, int len)
+{
+    double pos = x * (len - 1) / 65536;
+    int k = (int)pos;
+
+    if (k >= len - 1)
+        return t[len - 1];
+
+    return t[k] + (t[k + 1] - t[k]) * (pos - k);
+}
+
+static double ref_inv_equidistant(double x, const double *t, int len)
+{
+    int i;
+
+    if (x <= t[0])
+        return 0;
+    if (x >= t[len - 1])
+        return 65535;
+    for (i = 1; x >= t[i]; i++)
+        ;
+
+    return (i - 1 + (x - t[i - 1]) / (t[i] - t[i - 1])) * 65536 / (len - 1);
+}
+
+static void bench_equidistant_u16(bench_result_t *res)
+{
+    const int len = sizeof(eq16) / sizeof(eq16[0]);
+    double t[sizeof(eq16) / sizeof(eq16[0])];
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        t[i] = eq16[i];
+
+    res->name = "acamera_calc_equidistant_modulation_u16 (all)";
+    TIME_LOOP(res, ALL16, acamera_calc_equidistant_modulation_u16((uint16_t)i, eq16, len));
+    for (i = 0; i < ALL16; i++) {
+        uint16_t v = acamera_calc_equidistant_modulation_u16((uint16_t)i, eq16, len);
+
+        // the last input is pinned to the last entry
+        err_add(res, (double)v - (i == ALL16 - 1 ? t[len - 1] : ref_equidistant(i, t, len)), ALL16);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_equidistant_u32(bench_result_t *res)
+{
+    const int len = sizeof(eq32) / sizeof(eq32[0]);
+    double t[sizeof(eq32) / sizeof(eq32[0])];
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        t[i] = eq32[i];
+
+    res->name = "acamera_calc_equidistant_modulation_u32 (all)";
+    TIME_LOOP(res, ALL16, acamera_calc_equidistant_modulation_u32(i, eq32, len));
+    for (i = 0; i < ALL16; i++) {
+        uint32_t v = acamera_calc_equidistant_modulation_u32(i, eq32, len);
+
+        err_add(res, (double)v - (i == ALL16 - 1 ? t[len - 1] : ref_equidistant(i, t, len)), ALL16);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_inv_equidistant_u16(bench_result_t *res)
+{
+    const int len = sizeof(eq16) / sizeof(eq16[0]);
+    double t[sizeof(eq16) / sizeof(eq16[0])];
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        t[i] = eq16[i];
+
+    res->name = "acamera_calc_inv_equidistant_modulation_u16 (all)";
+    TIME_LOOP(res, ALL16, acamera_calc_inv_equidistant_modulation_u16((uint16_t)i, eq16, len));
+    for (i = 0; i < ALL16; i++) {
+        uint16_t v = acamera_calc_inv_equidistant_modulation_u16((uint16_t)i, eq16, len);
+
+        err_add(res, (double)v - ref_inv_equidistant(i, t, len), ALL16);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void bench_inv_equidistant_u32(bench_result_t *res)
+{
+    const int len = sizeof(eq32) / sizeof(eq32[0]);
+    double t[sizeof(eq32) / sizeof(eq32[0])];
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        t[i] = eq32[i];
+
+    res->name = "acamera_calc_inv_equidistant_modulation_u32 (all)";
+    TIME_LOOP(res, ALL16, acamera_calc_inv_equidistant_modulation_u32(i, eq32, len));
+    for (i = 0; i < ALL16; i++) {
+        uint32_t v = acamera_calc_inv_equidistant_modulation_u32(i, eq32, len);
+
+        err_add(res, (double)v - ref_inv_equidistant(i, t, len), ALL16);
+        res->checksum = res->checksum * 31 + v;
+    }
+}
+
+static void tables_init(void)
+{
+    uint32_t i, x16 = 64, x32 = 1024;
+
+    for (i = 0; i < 32; i++) {
+        mod16[i].x = x16;
+        mod16[i].y = rnd() & 0xffff;
+        // x stays below 65535 - 64, row 10 repeats the x of row 9
+        if (i != 9)
+            x16 += 256 + rnd() % 1792;
+
+        mod32[i].x = x32;
+        mod32[i].y = rnd() & 0xfffff;
+        x32 += 4096 + rnd() % (1 << 19);
+    }
+
+    // gamma like curves
+    for (i = 0; i < 33; i++)
+        eq16[i] = (uint16_t)(pow(i / 32.0, 0.45) * 65535);
+    for (i = 0; i < 65; i++)
+        eq32[i] = (uint32_t)(pow(i / 64.0, 0.45) * 65535) + i;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t n = argc > 1 ? strtoul(argv[1], NULL, 0) : 1 << 20;
+    bench_result_t res[BENCH_MAX] = {{0}};
+    uint64_t *in32, *in64;
+    uint32_t i, k;
+    int rc = 0;
+
+    if (n < 64) {
+        ERR("usage: %s [samples >= 64]\n", argv[0]);
+        return 1;
+    }
+
+    in32 = malloc(n * sizeof(*in32));
+    in64 = malloc(n * sizeof(*in64));
+    if (!in32 || !in64) {
+        ERR("out of memory\n");
+        return 1;
+    }
+
+    // powers of two and their neighbours first, the rest log-uniform
+    for (i = 0, k = 0; k < 32; k++) {
+        in32[i] = (1ULL << k) - 1;
+        in64[i++] = (1ULL << (k * 2)) - 1;
+        in32[i] = 1ULL << k;
+        in64[i++] = 1ULL << (k * 2 + 1);
+    }
+    in64[0] = UINT64_MAX;
+    for (; i < n; i++) {
+        in32[i] = rnd_bits(32);
+        in64[i] = rnd_bits(64);
+    }
+
+    tables_init();
+
+    // square roots are floor(sqrt(x)) by contract
+    res[0].exact = res[1].exact = res[2].exact = 1;
+    bench_sqrt16(&res[0]);
+    bench_sqrt32(&res[1], in32, n);
+    bench_sqrt64(&res[2], in64, n);
+    bench_log2_32(&res[3], in32, n);
+    bench_log2_64(&res[4], in64, n);
+    bench_log2_int(&res[5], in32, n);
+    bench_exp2(&res[6], in64, n);
+    bench_div_fixed(&res[7], in32, in64, n);
+    bench_modulation_u16(&res[8], 4);
+    bench_modulation_u16(&res[9], 32);
+    bench_modulation_u32(&res[10], in32, n);
+    bench_equidistant_u16(&res[11]);
+    bench_equidistant_u32(&res[12]);
+    bench_inv_equidistant_u16(&res[13]);
+    bench_inv_equidistant_u32(&res[14]);
+
+    MSG("FW_FAST_MATH=%d, %u samples\n", FW_FAST_MATH, n);
+    MSG("%-50s %8s %10s %10s %4s   %s\n", "function", "ns/op", "max err", "mean err", "unit", "checksum");
+    for (i = 0; i < BENCH_MAX && res[i].name; i++) {
+        if (!res[i].unit)
+            res[i].unit = "lsb";
+        show(&res[i]);
+        if (res[i].exact && res[i].max_err != 0)
+            rc = 1;
+    }
+
+    free(in32);
+    free(in64);
+
+    return rc;
+}
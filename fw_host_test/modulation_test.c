@@ -0,0 +1,252 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * modulation_test [tables]
+ *     check the modulation table segment search of acamera_math.c against
+ *     the linear scan it replaced. For [tables] random calibration tables of
+ *     every length from 2 to 40 rows, with duplicate x values and tables
+ *     touching 0 and the top of the x range:
+ *     - u16: every x strictly between the first and the last row,
+ *     - u32: every row x, its neighbours, the segment midpoints and random x,
+ *     searched without a hint, with the right hint, with stale and out of
+ *     range hints and with a hint carried over from the previous x.
+ *     The segment and the updated hint must match the linear scan, and the
+ *     interpolated values with and without a hint must be equal.
+ *     Returns 0 when every lookup matches.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "logs.h"
+
+// the segment search is static, build it into the test
+#include "acamera_math.c"
+
+#define MAX_LEN 40
+#define U32_RANDOM_X 4096
+
+static uint64_t rnd_state = 0x2545f4914f6cdd1dULL;
+static uint32_t checks, failures;
+
+static uint64_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 7;
+    rnd_state ^= rnd_state << 17;
+    return rnd_state;
+}
+
+// the lookup before the bisection, the first i with x < p_table[i].x
+#define LINEAR_SEGMENT(val, p_table, table_len) ({ \
+        int _i;                                     \
+        for (_i = 1; _i < (table_len); ++_i)        \
+            if ((val) < (p_table)[_i].x)            \
+                break;                              \
+        _i;                                         \
+    })
+
+static void fail(const char *type, int len, uint32_t x, uint32_t hint, int got, int want)
+{
+    if (failures++ < 16)
+        ERR("%s table of %d rows, x %u, hint %u: segment %d, linear scan %d\n",
+            type, len, x, hint, got, want);
+}
+
+static void fail_value(const char *type, int len, uint32_t x, uint32_t with_hint, uint32_t without)
+{
+    if (failures++ < 16)
+        ERR("%s table of %d rows, x %u: %u with a hint, %u without\n",
+            type, len, x, with_hint, without);
+}
+
+/* stale hints around the right segment and outside the table */
+static uint16_t stale_hint(int k, int want, int len)
+{
+    static const int offsets[] = {-2, -1, 1, 2};
+
+    switch (k) {
+    case 0:
+        return 0;
+    case 1:
+        return len;
+    case 2:
+        return 0xffff;
+    default:
+        return (uint16_t)(want + offsets[(k - 3) % 4]);
+    }
+}
+
+#define STALE_HINTS 7
+
+#define CHECK_X(type, find, val, p_table, len, carry)                          \
+    do {                                                                       \
+        int _want = LINEAR_SEGMENT(val, p_table, len);                           \
+        uint16_t _hint;                                                        \
+        int _got, _k;                                                          \
+                                                                               \
+        checks++;                                                              \
+        _got = find(val, p_table, len, NULL);                                    \
+        if (_got != _want)                                                     \
+            fail(type, len, val, 0xffffffff, _got, _want);                       \
+                                                                               \
+        _hint = _want;                                                         \
+        _got = find(val, p_table, len, &_hint);                                  \
+        if (_got != _want || _hint != _want)                                   \
+            fail(type, len, val, _want, _got, _want);                            \
+                                                                               \
+        for (_k = 0; _k < STALE_HINTS; _k++) {                                 \
+            uint16_t _stale = stale_hint(_k, _want, len);                      \
+            _hint = _stale;                                                    \
+            _got = find(val, p_table, len, &_hint);                              \
+            if (_got != _want || _hint != _want)                               \
+                fail(type, len, val, _stale, _got, _want);                       \
+        }                                                                      \
+                                                                               \
+        _hint = *(carry);                                                      \
+        _got = find(val, p_table, len, carry);                                   \
+        if (_got != _want || *(carry) != _want)                                \
+            fail(type, len, val, _hint, _got, _want);                            \
+    } while (0)
+
+/* x rises by 0..span, a quarter of the rows repeat the x before them */
+static void fill_u16(modulation_entry_t *t, int len, uint32_t first, uint32_t span)
+{
+    uint32_t x = first;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        t[i].x = (uint16_t)x;
+        t[i].y = rnd() & 0xffff;
+        if (rnd() % 4)
+            x += 1 + rnd() % span;
+        if (x > 0xffff)
+            x = 0xffff;
+    }
+}
+
+static void check_u16(const modulation_entry_t *t, int len)
+{
+    uint16_t carry = 0, hint = 0;
+    uint32_t x;
+
+    for (x = t[0].x + 1; x < t[len - 1].x; x++)
+        CHECK_X("u16", modulation_find_segment_u16, (uint16_t)x, t, len, &carry);
+
+    // downwards, the carried hint goes stale at every row crossed
+    for (x = t[len - 1].x; x > (uint32_t)t[0].x + 1; x--)
+        CHECK_X("u16", modulation_find_segment_u16, (uint16_t)(x - 1), t, len, &carry);
+
+    // the hint only changes where the segment is found, not the result
+    for (x = 0; x <= 0xffff; x++) {
+        uint16_t with_hint = acamera_calc_modulation_u16_hint((uint16_t)x, t, len, &hint);
+        uint16_t without = acamera_calc_modulation_u16((uint16_t)x, t, len);
+
+        checks++;
+        if (with_hint != without)
+            fail_value("u16", len, x, with_hint, without);
+    }
+}
+
+static void fill_u32(modulation_entry_32_t *t, int len, uint64_t first, uint64_t span)
+{
+    uint64_t x = first;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        t[i].x = (uint32_t)x;
+        t[i].y = rnd() & 0xfffff;
+        if (rnd() % 4)
+            x += 1 + rnd() % span;
+        if (x > UINT32_MAX)
+            x = UINT32_MAX;
+    }
+}
+
+static void check_u32_x(const modulation_entry_32_t *t, int len, uint32_t x, uint16_t *carry, uint16_t *hint)
+{
+    uint32_t with_hint, without;
+
+    if (x <= t[0].x || x >= t[len - 1].x)
+        return;
+
+    CHECK_X("u32", modulation_find_segment_u32, x, t, len, carry);
+
+    with_hint = acamera_calc_modulation_u32_hint(x, t, len, hint);
+    without = acamera_calc_modulation_u32(x, t, len);
+
+    checks++;
+    if (with_hint != without)
+        fail_value("u32", len, x, with_hint, without);
+}
+
+static void check_u32(const modulation_entry_32_t *t, int len)
+{
+    uint16_t carry = 0, hint = 0;
+    uint32_t k;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        check_u32_x(t, len, t[i].x - 1, &carry, &hint);
+        check_u32_x(t, len, t[i].x, &carry, &hint);
+        check_u32_x(t, len, t[i].x + 1, &carry, &hint);
+        if (i)
+            check_u32_x(t, len, t[i - 1].x + (t[i].x - t[i - 1].x) / 2, &carry, &hint);
+    }
+
+    for (k = 0; k < U32_RANDOM_X; k++)
+        check_u32_x(t, len, t[0].x + (uint32_t)(rnd() % ((uint64_t)t[len - 1].x - t[0].x + 1)), &carry, &hint);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t tables = argc > 1 ? strtoul(argv[1], NULL, 0) : 8;
+    modulation_entry_t t16[MAX_LEN];
+    modulation_entry_32_t t32[MAX_LEN];
+    uint32_t n;
+    int len;
+
+    if (!tables) {
+        ERR("usage: %s [tables]\n", argv[0]);
+        return 1;
+    }
+
+    for (n = 0; n < tables; n++) {
+        for (len = 2; len <= MAX_LEN; len++) {
+            // spread over the range, from 0, up to the top, and dense
+            fill_u16(t16, len, 1 + rnd() % 1024, 0xffff / len);
+            check_u16(t16, len);
+            fill_u16(t16, len, 0, 0xffff / (len - 1) + 1);
+            t16[len - 1].x = 0xffff;
+            check_u16(t16, len);
+            fill_u16(t16, len, rnd() % 0x8000, 4);
+            check_u16(t16, len);
+
+            fill_u32(t32, len, 1 + rnd() % 0x100000, UINT32_MAX / len);
+            check_u32(t32, len);
+            fill_u32(t32, len, 0, (uint64_t)UINT32_MAX / (len - 1) + 1);
+            t32[len - 1].x = UINT32_MAX;
+            check_u32(t32, len);
+            fill_u32(t32, len, rnd() % 0x80000000, 4);
+            check_u32(t32, len);
+        }
+    }
+
+    MSG("modulation tables of 2 to %d rows: %u, lookups checked: %u, failed: %u\n",
+        MAX_LEN, tables * (MAX_LEN - 1) * 6, checks, failures);
+
+    return failures ? 1 : 0;
+}
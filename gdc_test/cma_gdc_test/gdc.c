@@ -29,9 +29,15 @@
 #include <errno.h>
 
 #include "gdc_api.h"
+#include "gdc_model.h"
 
 int gdc_create_ctx(struct gdc_usr_ctx_s *ctx)
 {
+    if (ctx->use_model) {
+        ctx->gdc_client = -1;
+        return 0;
+    }
+
     ctx->gdc_client = open("/dev/gdc", O_RDWR | O_SYNC);
 
     if (ctx->gdc_client < 0)
@@ -86,6 +92,33 @@ int gdc_alloc_dma_buffer (struct gdc_usr_ctx_s *ctx,
 	buf_cfg.type = type;
 	buf_cfg.len = len;
 
+	if (ctx->use_model) {
+		void *p = gdc_model_alloc(len);
+
+		if (p == NULL) {
+			printf("%s: model alloc failed\n", __func__);
+			return -1;
+		}
+		switch (type) {
+		case INPUT_BUFF_TYPE:
+			ctx->i_len = len;
+			ctx->i_buff = p;
+			return 0;
+		case OUTPUT_BUFF_TYPE:
+			ctx->o_len = len;
+			ctx->o_buff = p;
+			return 0;
+		case CONFIG_BUFF_TYPE:
+			ctx->c_len = len;
+			ctx->c_buff = p;
+			return 0;
+		default:
+			munmap(p, len);
+			printf("Error no such buff type\n");
+			return -1;
+		}
+	}
+
 	ret = ioctl(ctx->gdc_client, GDC_REQUEST_BUFF, &buf_cfg);
     if (ret < 0) {
         printf("%s failed: %s\n", __func__, strerror(ret));
@@ -137,6 +170,9 @@ int gdc_process(struct gdc_usr_ctx_s *ctx)
 	int ret = 0;
     struct gdc_settings *gs = &ctx->gs;
 
+    if (ctx->use_model)
+        return gdc_model_run(ctx);
+
     ret = ioctl(ctx->gdc_client, GDC_RUN, gs);
     if (ret < 0) {
         printf("GDC_RUN ioctl failed\n");
@@ -145,3 +181,173 @@ int gdc_process(struct gdc_usr_ctx_s *ctx)
 
     return 0;
 }
+
+int get_file_size(char *f_name)
+{
+    int f_size = -1;
+    FILE *fp = NULL;
+
+    if (f_name == NULL) {
+        printf("Error file name\n");
+        return f_size;
+    }
+
+    fp = fopen(f_name, "rb");
+    if (fp == NULL) {
+        printf("Error open file %s\n", f_name);
+        return f_size;
+    }
+
+    fseek(fp, 0, SEEK_END);
+
+    f_size = ftell(fp);
+
+    fclose(fp);
+
+    printf("%s: size %d\n", f_name, f_size);
+
+    return f_size;
+}
+
+int gdc_set_config_param(struct gdc_usr_ctx_s *ctx,
+                                    char *f_name, int len)
+{
+    FILE *fp = NULL;
+    int r_size = -1;
+
+    if (f_name == NULL || ctx == NULL || ctx->c_buff == NULL) {
+        printf("Error input param\n");
+        return r_size;
+    }
+
+    fp = fopen(f_name, "rb");
+    if (fp == NULL) {
+        printf("Error open file %s\n", f_name);
+        return -1;
+    }
+
+    r_size = fread(ctx->c_buff, len, 1, fp);
+    if (r_size <= 0) {
+        printf("Failed to read file %s\n", f_name);
+    }
+
+    fclose(fp);
+
+    return r_size;
+}
+
+int gdc_fill_config(gdc_config_t *cfg, struct gdc_param *tparm)
+{
+    uint32_t format = tparm->format;
+    uint32_t i_c_stride = 0;
+    uint32_t o_c_stride = 0;
+
+    if (format == NV12 || format == YUV444_P || format == RGB444_P) {
+        i_c_stride = AXI_WORD_ALIGN(tparm->i_width);
+        o_c_stride = AXI_WORD_ALIGN(tparm->o_width);
+    } else if (format == YV12) {
+        i_c_stride = AXI_WORD_ALIGN(tparm->i_width) / 2;
+        o_c_stride = AXI_WORD_ALIGN(tparm->o_width) / 2;
+    } else if (format == Y_GREY) {
+        i_c_stride = 0;
+        o_c_stride = 0;
+    } else {
+        printf("Error unknow format\n");
+        return -1;
+    }
+
+    cfg->input_width = tparm->i_width;
+    cfg->input_height = tparm->i_height;
+    cfg->input_y_stride = AXI_WORD_ALIGN(tparm->i_width);
+    cfg->input_c_stride = i_c_stride;
+    cfg->output_width = tparm->o_width;
+    cfg->output_height = tparm->o_height;
+    cfg->output_y_stride = AXI_WORD_ALIGN(tparm->o_width);
+    cfg->output_c_stride = o_c_stride;
+    cfg->format = format;
+
+    return 0;
+}
+
+unsigned long gdc_input_len(gdc_config_t *cfg)
+{
+    if (cfg->format == RGB444_P || cfg->format == YUV444_P)
+        return (unsigned long)cfg->input_y_stride * cfg->input_height * 3;
+
+    return (unsigned long)cfg->input_y_stride * cfg->input_height * 2;
+}
+
+unsigned long gdc_output_len(gdc_config_t *cfg)
+{
+    if (cfg->format == RGB444_P || cfg->format == YUV444_P)
+        return (unsigned long)cfg->output_y_stride * cfg->output_height * 3;
+    else if (cfg->format == NV12 || cfg->format == YV12)
+        return (unsigned long)cfg->output_y_stride * cfg->output_height * 3 / 2;
+
+    return (unsigned long)cfg->output_y_stride * cfg->output_height;
+}
+
+int gdc_init_cfg(struct gdc_usr_ctx_s *ctx, struct gdc_param *tparm, char *f_name)
+{
+    struct gdc_settings *gdc_gs = NULL;
+    int ret = -1;
+    uint32_t c_len = 0;
+
+    if (ctx == NULL || tparm == NULL || f_name == NULL) {
+        printf("Error invalid input param\n");
+        return ret;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->use_model = tparm->use_model;
+    ctx->model_us = tparm->model_us;
+
+    gdc_gs = &ctx->gs;
+
+    gdc_gs->base_gdc = 0;
+
+    if (gdc_fill_config(&gdc_gs->gdc_config, tparm) < 0)
+        return ret;
+    gdc_gs->magic = sizeof(*gdc_gs);
+
+    gdc_create_ctx(ctx);
+
+    c_len = get_file_size(f_name);
+    if (c_len <= 0) {
+        gdc_destroy_ctx(ctx);
+        printf("Error gdc config file size\n");
+        return ret;
+    }
+
+    ret = gdc_alloc_dma_buffer(ctx, CONFIG_BUFF_TYPE, c_len);
+    if (ret < 0) {
+        gdc_destroy_ctx(ctx);
+        printf("Error alloc gdc cfg buff\n");
+        return ret;
+    }
+
+    ret = gdc_set_config_param(ctx, f_name, c_len);
+    if (ret < 0) {
+        gdc_destroy_ctx(ctx);
+        printf("Error cfg gdc param buff\n");
+        return ret;
+    }
+
+    gdc_gs->gdc_config.config_size = c_len / 4;
+
+    ret = gdc_alloc_dma_buffer(ctx, INPUT_BUFF_TYPE, gdc_input_len(&gdc_gs->gdc_config));
+    if (ret < 0) {
+        gdc_destroy_ctx(ctx);
+        printf("Error alloc gdc input buff\n");
+        return ret;
+    }
+
+    ret = gdc_alloc_dma_buffer(ctx, OUTPUT_BUFF_TYPE, gdc_output_len(&gdc_gs->gdc_config));
+    if (ret < 0) {
+        gdc_destroy_ctx(ctx);
+        printf("Error alloc gdc input buff\n");
+        return ret;
+    }
+
+    return ret;
+}
@@ -92,8 +92,12 @@ struct gdc_buf_cfg {
 	unsigned long len;
 };
 
+/*
+ * One context per open of /dev/gdc, each with its own config, input and
+ * output buffer. Several contexts can be open at once, jobs of different
+ * contexts are serialised by the job queue (gdc_job.h).
+ */
 struct gdc_usr_ctx_s {
-    //TODO  currently donot support multi-context
     int gdc_client;
     int ion_client;
     struct gdc_settings gs;
@@ -103,6 +107,18 @@ struct gdc_usr_ctx_s {
 	unsigned long i_len;
 	unsigned long o_len;
 	unsigned long c_len;
+	int use_model;		//run jobs on the cpu model (gdc_model.c), no /dev/gdc
+	unsigned int model_us;	//minimum time of a model job, to mimic the hardware
+};
+
+struct gdc_param {
+    uint32_t i_width;
+    uint32_t i_height;
+    uint32_t o_width;
+    uint32_t o_height;
+    uint32_t format;
+    uint32_t use_model;
+    uint32_t model_us;
 };
 
 /**
@@ -161,4 +177,34 @@ int gdc_destroy_ctx(struct gdc_usr_ctx_s *ctx);
 int gdc_alloc_dma_buffer (struct gdc_usr_ctx_s *ctx,
 			uint32_t type, size_t len);
 
+/**
+ *   This function sets up a context from gdc_param: opens the device,
+ *   loads the config file and allocates the config, input and output
+ *   buffers.
+ *
+ *   @param  ctx - context to init, cleared first.
+ *   @param  tparm - resolution, format and backend.
+ *   @param  f_name - gdc config file.
+ *
+ *   @return 0 - success
+ *           <0 - fail, ctx is destroyed.
+ */
+int gdc_init_cfg(struct gdc_usr_ctx_s *ctx, struct gdc_param *tparm, char *f_name);
+
+/**
+ *   This function fills the resolution, strides and format of a config from
+ *   gdc_param, the strides are AXI word aligned.
+ *
+ *   @return 0 - success
+ *           -1 - unknown format
+ */
+int gdc_fill_config(gdc_config_t *cfg, struct gdc_param *tparm);
+
+/* input and output buffer sizes needed by a config */
+unsigned long gdc_input_len(gdc_config_t *cfg);
+unsigned long gdc_output_len(gdc_config_t *cfg);
+
+int get_file_size(char *f_name);
+int gdc_set_config_param(struct gdc_usr_ctx_s *ctx, char *f_name, int len);
+
 #endif
@@ -0,0 +1,340 @@
+/*
+ *   Copyright 2018 Amlogic, Inc
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Throughput of blocking gdc_process() against the job queue with N frames
+ * in flight. Every frame costs some cpu work (-p) before it is handed to the
+ * gdc: the blocking loop pays cpu + gdc per frame, the queue overlaps them.
+ *
+ * ./cma_gdc_bench -c gdc/frame_1080p_s_3954/frame_1080p_s.bin -w 1920x1080-1920x1080 -f 1 -d 3 -p 5000
+ * add -m 8000 to run on the cpu model with 8ms per gdc job.
+ *
+ * -s cfg2 also times switching between two dewarp profiles, reloading the
+ * config file each time against the config cache (gdc_cfg_cache.h).
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "gdc_api.h"
+#include "gdc_cfg_cache.h"
+#include "gdc_job.h"
+
+struct bench_stat {
+    unsigned long long total_us;
+    unsigned long long latency_us;
+    unsigned long long run_us;
+    unsigned int frames;
+    unsigned int errors;
+};
+
+// stands in for whatever produces the gdc input: capture, copy, colour fix
+static void bench_cpu_work(struct gdc_usr_ctx_s *ctx, unsigned int frame, unsigned int prep_us)
+{
+    unsigned long long end = gdc_job_now_us() + prep_us;
+
+    ctx->i_buff[0] = (char)frame;
+    ctx->i_buff[ctx->i_len - 1] = (char)frame;
+
+    while (gdc_job_now_us() < end)
+        ;
+}
+
+static void bench_account(struct bench_stat *st, struct gdc_job *job)
+{
+    st->frames++;
+    if (job->status < 0)
+        st->errors++;
+    st->latency_us += job->done_us - job->submit_us;
+    st->run_us += job->done_us - job->start_us;
+}
+
+static int bench_blocking(struct gdc_usr_ctx_s *ctx, unsigned int frames,
+                unsigned int prep_us, struct bench_stat *st)
+{
+    unsigned long long start = gdc_job_now_us();
+    unsigned int i;
+
+    memset(st, 0, sizeof(*st));
+
+    for (i = 0; i < frames; i++) {
+        unsigned long long t;
+
+        bench_cpu_work(ctx, i, prep_us);
+        t = gdc_job_now_us();
+        if (gdc_process(ctx) < 0)
+            st->errors++;
+        st->run_us += gdc_job_now_us() - t;
+        st->latency_us += gdc_job_now_us() - t;
+        st->frames++;
+    }
+
+    st->total_us = gdc_job_now_us() - start;
+    return 0;
+}
+
+static int bench_queue(struct gdc_usr_ctx_s *ctx, int depth, unsigned int frames,
+                unsigned int prep_us, struct bench_stat *st)
+{
+    struct gdc_job_queue q;
+    struct gdc_job jobs[GDC_JOB_QUEUE_DEPTH];
+    struct gdc_job *done[GDC_JOB_QUEUE_DEPTH];
+    int busy[GDC_JOB_QUEUE_DEPTH];
+    unsigned long long start;
+    unsigned int i;
+    int ret, n, k;
+
+    memset(st, 0, sizeof(*st));
+    memset(jobs, 0, sizeof(jobs));
+    memset(busy, 0, sizeof(busy));
+
+    ret = gdc_job_queue_init(&q, NULL, NULL);
+    if (ret < 0)
+        return ret;
+
+    for (k = 0; k < depth; k++) {
+        jobs[k].ctx = &ctx[k];
+        jobs[k].priv = &busy[k];
+    }
+
+    start = gdc_job_now_us();
+
+    for (i = 0; i < frames; i++) {
+        k = i % depth;
+
+        // the context of this frame is reused once its last job is back
+        while (busy[k]) {
+            gdc_job_wait(&q, -1);
+            n = gdc_job_reap(&q, done, GDC_JOB_QUEUE_DEPTH);
+            while (n-- > 0) {
+                *(int *)done[n]->priv = 0;
+                bench_account(st, done[n]);
+            }
+        }
+
+        bench_cpu_work(&ctx[k], i, prep_us);
+
+        ret = gdc_job_submit(&q, &jobs[k]);
+        if (ret < 0) {
+            printf("submit failed: %d\n", ret);
+            break;
+        }
+        busy[k] = 1;
+    }
+
+    while (st->frames < i) {
+        gdc_job_wait(&q, -1);
+        n = gdc_job_reap(&q, done, GDC_JOB_QUEUE_DEPTH);
+        while (n-- > 0) {
+            *(int *)done[n]->priv = 0;
+            bench_account(st, done[n]);
+        }
+    }
+
+    st->total_us = gdc_job_now_us() - start;
+    gdc_job_queue_destroy(&q);
+
+    return 0;
+}
+
+// what starting a stream with another profile used to cost
+static int bench_reload_cfg(struct gdc_usr_ctx_s *ctx, char *f_name)
+{
+    int c_len = get_file_size(f_name);
+
+    if (c_len <= 0)
+        return -1;
+
+    if (ctx->c_buff != NULL) {
+        munmap(ctx->c_buff, ctx->c_len);
+        ctx->c_buff = NULL;
+        ctx->c_len = 0;
+    }
+
+    if (gdc_alloc_dma_buffer(ctx, CONFIG_BUFF_TYPE, c_len) < 0)
+        return -1;
+    if (gdc_set_config_param(ctx, f_name, c_len) <= 0)
+        return -1;
+
+    ctx->gs.gdc_config.config_size = c_len / 4;
+
+    return 0;
+}
+
+static int bench_switch(struct gdc_usr_ctx_s *ctx, struct gdc_param *param,
+                char *cfg[2], unsigned int switches)
+{
+    struct gdc_cfg_cache cache;
+    struct gdc_cfg_key key;
+    struct gdc_cfg_entry *entry;
+    unsigned long long start, reload_us, cached_us;
+    unsigned int i;
+    int ret = 0;
+
+    start = gdc_job_now_us();
+    for (i = 0; i < switches && ret == 0; i++)
+        ret = bench_reload_cfg(ctx, cfg[i & 1]);
+    reload_us = gdc_job_now_us() - start;
+    if (ret < 0) {
+        printf("Error reload gdc cfg\n");
+        return ret;
+    }
+
+    memset(&key, 0, sizeof(key));
+    key.format = param->format;
+    key.i_width = param->i_width;
+    key.i_height = param->i_height;
+    key.o_width = param->o_width;
+    key.o_height = param->o_height;
+
+    gdc_cfg_cache_init(&cache, ctx);
+
+    start = gdc_job_now_us();
+    for (i = 0; i < switches; i++) {
+        key.profile = i & 1;
+        entry = gdc_cfg_cache_get(&cache, &key, cfg[i & 1]);
+        if (gdc_cfg_cache_use(&cache, entry) < 0) {
+            ret = -1;
+            break;
+        }
+    }
+    cached_us = gdc_job_now_us() - start;
+
+    // GDC_RUN runs the sequence in the config buffer of the fd
+    if (ret == 0 && memcmp(ctx->c_buff, entry->seq, entry->seq_len)) {
+        printf("Error gdc config buffer doesn't hold the active profile\n");
+        ret = -1;
+    }
+
+    if (ret == 0)
+        printf("profile switch: reload %.2f us, cached %.2f us\n",
+                (double)reload_us / switches, (double)cached_us / switches);
+    gdc_cfg_cache_dump_stats(&cache);
+    gdc_cfg_cache_release(&cache);
+
+    return ret;
+}
+
+static void bench_print(const char *name, struct bench_stat *st)
+{
+    if (st->frames == 0 || st->total_us == 0)
+        return;
+
+    printf("%-10s %u frames, %.1f fps, gdc %llu us, latency %llu us, errors %u\n",
+            name, st->frames, st->frames * 1000000.0 / st->total_us,
+            st->run_us / st->frames, st->latency_us / st->frames, st->errors);
+}
+
+int main(int argc, char* argv[]) {
+    struct gdc_usr_ctx_s ctx[GDC_JOB_QUEUE_DEPTH];
+    struct gdc_param g_param;
+    struct bench_stat st;
+    char *config_file = "config.bin";
+    char *switch_file = NULL;
+    uint32_t format = NV12;
+    uint32_t in_width = 1920, in_height = 1080;
+    uint32_t out_width = 1920, out_height = 1080;
+    unsigned int frames = 300;
+    unsigned int prep_us = 5000;
+    int model_us = -1;
+    int depth = 3;
+    int ret = 0;
+    int c, k;
+
+    while ((c = getopt(argc, argv, "c:d:f:m:n:p:s:w:")) != -1) {
+        switch (c) {
+        case 'c':
+            config_file = optarg;
+            break;
+        case 'd':
+            depth = atoi(optarg);
+            break;
+        case 'f':
+            format = atol(optarg);
+            break;
+        case 'm':
+            model_us = atoi(optarg);
+            break;
+        case 'n':
+            frames = atoi(optarg);
+            break;
+        case 'p':
+            prep_us = atoi(optarg);
+            break;
+        case 's':
+            switch_file = optarg;
+            break;
+        case 'w':
+            sscanf(optarg, "%dx%d-%dx%d",
+                    &in_width, &in_height, &out_width, &out_height);
+            break;
+        default:
+            printf("usage: %s -c cfg -w iwxih-owxoh -f fmt [-d depth] [-n frames] [-p cpu_us] [-m model_us] [-s cfg2]\n",
+                    argv[0]);
+            return -1;
+        }
+    }
+
+    if (depth < 1 || depth > GDC_JOB_QUEUE_DEPTH) {
+        printf("Error depth must be 1..%d\n", GDC_JOB_QUEUE_DEPTH);
+        return -1;
+    }
+
+    memset(&g_param, 0, sizeof(g_param));
+    g_param.i_width = in_width;
+    g_param.i_height = in_height;
+    g_param.o_width = out_width;
+    g_param.o_height = out_height;
+    g_param.format = format;
+    g_param.use_model = (model_us >= 0);
+    g_param.model_us = (model_us >= 0) ? model_us : 0;
+
+    // one context per frame in flight, each with its own config buffer
+    memset(ctx, 0, sizeof(ctx));
+    for (k = 0; k < depth; k++) {
+        ret = gdc_init_cfg(&ctx[k], &g_param, config_file);
+        if (ret < 0) {
+            printf("Error gdc init ctx %d\n", k);
+            goto out;
+        }
+    }
+
+    printf("%s, %u frames, cpu %u us per frame, depth %d\n",
+            g_param.use_model ? "cpu model" : "/dev/gdc", frames, prep_us, depth);
+
+    bench_blocking(&ctx[0], frames, prep_us, &st);
+    bench_print("blocking", &st);
+
+    bench_queue(ctx, depth, frames, prep_us, &st);
+    bench_print("queued", &st);
+
+    if (switch_file != NULL) {
+        char *cfg[2] = { config_file, switch_file };
+
+        bench_switch(&ctx[0], &g_param, cfg, frames);
+    }
+
+out:
+    while (k-- > 0)
+        gdc_destroy_ctx(&ctx[k]);
+
+    return ret;
+}
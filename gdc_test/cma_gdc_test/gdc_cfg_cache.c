@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "gdc_cfg_cache.h"
+
+int gdc_cfg_cache_init(struct gdc_cfg_cache *cache, struct gdc_usr_ctx_s *ctx)
+{
+    if (cache == NULL || ctx == NULL) {
+        printf("%s: Error input param\n", __func__);
+        return -1;
+    }
+
+    memset(cache, 0, sizeof(*cache));
+
+    // switching overwrites the config buffer, keep what it holds now
+    if (ctx->c_buff != NULL && ctx->c_len) {
+        cache->own_seq = malloc(ctx->c_len);
+        if (cache->own_seq == NULL) {
+            printf("%s: Error alloc %lu bytes\n", __func__, ctx->c_len);
+            return -1;
+        }
+        memcpy(cache->own_seq, ctx->c_buff, ctx->c_len);
+        cache->own_len = ctx->c_len;
+    }
+
+    cache->ctx = ctx;
+    cache->own_config = ctx->gs.gdc_config;
+
+    return 0;
+}
+
+static void gdc_cfg_entry_free(struct gdc_cfg_entry *entry)
+{
+    free(entry->seq);
+    memset(entry, 0, sizeof(*entry));
+}
+
+void gdc_cfg_cache_release(struct gdc_cfg_cache *cache)
+{
+    struct gdc_usr_ctx_s *ctx = cache->ctx;
+    int i;
+
+    if (ctx == NULL)
+        return;
+
+    // the config buffer only grows, the own sequence still fits
+    if (cache->own_seq != NULL && ctx->c_buff != NULL)
+        memcpy(ctx->c_buff, cache->own_seq, cache->own_len);
+    ctx->gs.gdc_config = cache->own_config;
+    free(cache->own_seq);
+    cache->own_seq = NULL;
+
+    for (i = 0; i < GDC_CFG_CACHE_SIZE; i++)
+        gdc_cfg_entry_free(&cache->entries[i]);
+
+    cache->active = NULL;
+    cache->ctx = NULL;
+}
+
+static int gdc_cfg_key_equal(struct gdc_cfg_key *a, struct gdc_cfg_key *b)
+{
+    return a->format == b->format && a->profile == b->profile &&
+        a->i_width == b->i_width && a->i_height == b->i_height &&
+        a->o_width == b->o_width && a->o_height == b->o_height;
+}
+
+static int gdc_cfg_validate(gdc_config_t *cfg, long f_size)
+{
+    // the sequence is counted in 32bit words by config_size
+    if (f_size <= 0 || (f_size & 3)) {
+        printf("Error gdc config size %ld\n", f_size);
+        return -1;
+    }
+
+    if (cfg->input_width == 0 || cfg->input_height == 0 ||
+        cfg->output_width == 0 || cfg->output_height == 0) {
+        printf("Error gdc config resolution\n");
+        return -1;
+    }
+
+    if (cfg->input_y_stride < cfg->input_width ||
+        cfg->output_y_stride < cfg->output_width ||
+        cfg->input_y_stride != AXI_WORD_ALIGN(cfg->input_y_stride) ||
+        cfg->output_y_stride != AXI_WORD_ALIGN(cfg->output_y_stride)) {
+        printf("Error gdc y stride %u/%u for %ux%u-%ux%u\n",
+                cfg->input_y_stride, cfg->output_y_stride,
+                cfg->input_width, cfg->input_height,
+                cfg->output_width, cfg->output_height);
+        return -1;
+    }
+
+    if (cfg->format != Y_GREY &&
+        (cfg->input_c_stride == 0 || cfg->output_c_stride == 0 ||
+         cfg->input_c_stride > cfg->input_y_stride ||
+         cfg->output_c_stride > cfg->output_y_stride)) {
+        printf("Error gdc c stride %u/%u\n",
+                cfg->input_c_stride, cfg->output_c_stride);
+        return -1;
+    }
+
+    return 0;
+}
+
+static struct gdc_cfg_entry *gdc_cfg_cache_slot(struct gdc_cfg_cache *cache)
+{
+    struct gdc_cfg_entry *victim = NULL;
+    int i;
+
+    for (i = 0; i < GDC_CFG_CACHE_SIZE; i++) {
+        struct gdc_cfg_entry *entry = &cache->entries[i];
+
+        if (!entry->valid)
+            return entry;
+        if (entry == cache->active)
+            continue;
+        if (victim == NULL || entry->last_use < victim->last_use)
+            victim = entry;
+    }
+
+    if (victim != NULL) {
+        gdc_cfg_entry_free(victim);
+        cache->evictions++;
+    }
+
+    return victim;
+}
+
+static int gdc_cfg_read(struct gdc_cfg_entry *entry, char *f_name, long f_size)
+{
+    FILE *fp;
+    size_t r_size;
+
+    entry->seq_len = AXI_WORD_ALIGN(f_size);
+    entry->seq = calloc(1, entry->seq_len);
+    if (entry->seq == NULL)
+        return -1;
+
+    fp = fopen(f_name, "rb");
+    if (fp == NULL)
+        return -1;
+    r_size = fread(entry->seq, f_size, 1, fp);
+    fclose(fp);
+
+    return (r_size == 1) ? 0 : -1;
+}
+
+static int gdc_cfg_cache_load(struct gdc_cfg_cache *cache,
+                struct gdc_cfg_entry *entry, struct gdc_cfg_key *key, char *f_name)
+{
+    struct gdc_param param;
+    long f_size;
+
+    memset(&param, 0, sizeof(param));
+    param.format = key->format;
+    param.i_width = key->i_width;
+    param.i_height = key->i_height;
+    param.o_width = key->o_width;
+    param.o_height = key->o_height;
+
+    if (gdc_fill_config(&entry->config, &param) < 0)
+        return -1;
+
+    f_size = get_file_size(f_name);
+    if (gdc_cfg_validate(&entry->config, f_size) < 0)
+        return -1;
+
+    if (gdc_cfg_read(entry, f_name, f_size) < 0) {
+        printf("Error load gdc cfg %s\n", f_name);
+        return -1;
+    }
+
+    entry->config.config_size = f_size / 4;
+    entry->key = *key;
+    entry->valid = 1;
+
+    return 0;
+}
+
+struct gdc_cfg_entry *gdc_cfg_cache_get(struct gdc_cfg_cache *cache,
+                struct gdc_cfg_key *key, char *f_name)
+{
+    struct gdc_cfg_entry *entry;
+    int i;
+
+    for (i = 0; i < GDC_CFG_CACHE_SIZE; i++) {
+        entry = &cache->entries[i];
+        if (entry->valid && gdc_cfg_key_equal(&entry->key, key)) {
+            entry->last_use = ++cache->tick;
+            cache->hits++;
+            return entry;
+        }
+    }
+
+    cache->misses++;
+
+    entry = gdc_cfg_cache_slot(cache);
+    if (entry == NULL)
+        return NULL;
+
+    if (gdc_cfg_cache_load(cache, entry, key, f_name) < 0) {
+        gdc_cfg_entry_free(entry);
+        cache->rejects++;
+        return NULL;
+    }
+
+    entry->last_use = ++cache->tick;
+
+    return entry;
+}
+
+int gdc_cfg_cache_use(struct gdc_cfg_cache *cache, struct gdc_cfg_entry *entry)
+{
+    struct gdc_usr_ctx_s *ctx = cache->ctx;
+
+    if (entry == NULL || !entry->valid)
+        return -1;
+
+    if (gdc_input_len(&entry->config) > ctx->i_len ||
+        gdc_output_len(&entry->config) > ctx->o_len) {
+        printf("Error gdc buffers too small for %ux%u-%ux%u\n",
+                entry->key.i_width, entry->key.i_height,
+                entry->key.o_width, entry->key.o_height);
+        return -1;
+    }
+
+    // one config buffer per fd: GDC_RUN runs whatever sequence is in it
+    if (entry->seq_len > ctx->c_len) {
+        if (ctx->c_buff != NULL)
+            munmap(ctx->c_buff, ctx->c_len);
+        ctx->c_buff = NULL;
+        ctx->c_len = 0;
+        if (gdc_alloc_dma_buffer(ctx, CONFIG_BUFF_TYPE, entry->seq_len) < 0 ||
+            ctx->c_buff == NULL) {
+            printf("Error alloc gdc config buffer of %lu bytes\n", entry->seq_len);
+            return -1;
+        }
+    }
+
+    memcpy(ctx->c_buff, entry->seq, entry->seq_len);
+    ctx->gs.gdc_config = entry->config;
+    cache->active = entry;
+
+    return 0;
+}
+
+void gdc_cfg_cache_dump_stats(struct gdc_cfg_cache *cache)
+{
+    printf("gdc cfg cache: %lu hits, %lu misses, %lu evictions, %lu rejected\n",
+            cache->hits, cache->misses, cache->evictions, cache->rejects);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __GDC_CFG_CACHE_H__
+#define __GDC_CFG_CACHE_H__
+
+#include "gdc_api.h"
+
+/*
+ * Cache of gdc config sequences.
+ *
+ * Each config binary is read once into memory and checked against the
+ * resolution and format it is used for. The driver keeps one config buffer
+ * per open of /dev/gdc, and GDC_RUN always runs the sequence in it, so
+ * switching the context to a cached profile copies the entry into that
+ * buffer: no file access, and no buffer allocation unless the sequence is
+ * larger than any before it. Switch only while no job of the context is in
+ * flight.
+ */
+
+#define GDC_CFG_CACHE_SIZE 8
+
+struct gdc_cfg_key {
+    uint32_t format;
+    uint32_t i_width;
+    uint32_t i_height;
+    uint32_t o_width;
+    uint32_t o_height;
+    uint32_t profile;       //lens / dewarp profile id, chosen by the caller
+};
+
+struct gdc_cfg_entry {
+    struct gdc_cfg_key key;
+    gdc_config_t config;
+    char *seq;              //config sequence, zero padded to the AXI word
+    unsigned long seq_len;
+    unsigned long last_use;
+    int valid;
+};
+
+struct gdc_cfg_cache {
+    struct gdc_usr_ctx_s *ctx;
+    char *own_seq;          //config sequence of the context before the cache
+    unsigned long own_len;
+    gdc_config_t own_config;
+    struct gdc_cfg_entry *active;
+    struct gdc_cfg_entry entries[GDC_CFG_CACHE_SIZE];
+    unsigned long tick;
+
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    unsigned long rejects;  //config files failing validation
+};
+
+/**
+ *   This function attaches a cache to a context created by gdc_init_cfg().
+ *
+ *   @return 0 - success
+ *           -1 - fail
+ */
+int gdc_cfg_cache_init(struct gdc_cfg_cache *cache, struct gdc_usr_ctx_s *ctx);
+
+/**
+ *   This function gives the context its own config back and frees the
+ *   cached config sequences.
+ */
+void gdc_cfg_cache_release(struct gdc_cfg_cache *cache);
+
+/**
+ *   This function looks a config up, loading f_name on a miss. The least
+ *   recently used entry is dropped when the cache is full.
+ *
+ *   @return entry - success
+ *           NULL - file missing or not valid for key
+ */
+struct gdc_cfg_entry *gdc_cfg_cache_get(struct gdc_cfg_cache *cache,
+                struct gdc_cfg_key *key, char *f_name);
+
+/**
+ *   This function switches the context to a cached config by copying it
+ *   into the config buffer of the context, which is reallocated when it is
+ *   too small. The input and output buffers must be large enough for the
+ *   entry's resolution.
+ *
+ *   @return 0 - success
+ *           -1 - the context buffers don't fit or the config buffer
+ *                can't be reallocated
+ */
+int gdc_cfg_cache_use(struct gdc_cfg_cache *cache, struct gdc_cfg_entry *entry);
+
+void gdc_cfg_cache_dump_stats(struct gdc_cfg_cache *cache);
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gdc_job.h"
+
+unsigned long long gdc_job_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void *gdc_job_worker(void *arg)
+{
+    struct gdc_job_queue *q = arg;
+    struct gdc_job *job;
+    uint64_t one = 1;
+
+    for (;;) {
+        pthread_mutex_lock(&q->lock);
+        while (!q->stop && q->pending_head == q->pending_tail)
+            pthread_cond_wait(&q->cond, &q->lock);
+        if (q->pending_head == q->pending_tail) {
+            pthread_mutex_unlock(&q->lock);
+            break;
+        }
+        job = q->pending[q->pending_head % GDC_JOB_QUEUE_DEPTH];
+        q->pending_head++;
+        pthread_mutex_unlock(&q->lock);
+
+        job->start_us = gdc_job_now_us();
+        job->status = gdc_process(job->ctx);
+        job->done_us = gdc_job_now_us();
+
+        if (q->cb) {
+            q->cb(job, q->cb_arg);
+            pthread_mutex_lock(&q->lock);
+            q->inflight--;
+            pthread_mutex_unlock(&q->lock);
+            continue;
+        }
+
+        pthread_mutex_lock(&q->lock);
+        q->done[q->done_tail % GDC_JOB_QUEUE_DEPTH] = job;
+        q->done_tail++;
+        if (write(q->event_fd, &one, sizeof(one)) != sizeof(one))
+            printf("%s: failed to signal completion: %s\n", __func__, strerror(errno));
+        pthread_mutex_unlock(&q->lock);
+    }
+
+    return NULL;
+}
+
+int gdc_job_queue_init(struct gdc_job_queue *q, gdc_job_cb cb, void *arg)
+{
+    int ret;
+
+    memset(q, 0, sizeof(*q));
+    q->cb = cb;
+    q->cb_arg = arg;
+
+    q->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (q->event_fd < 0) {
+        printf("%s: eventfd failed: %s\n", __func__, strerror(errno));
+        return -errno;
+    }
+
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+
+    ret = pthread_create(&q->worker, NULL, gdc_job_worker, q);
+    if (ret != 0) {
+        printf("%s: failed to start worker: %s\n", __func__, strerror(ret));
+        pthread_cond_destroy(&q->cond);
+        pthread_mutex_destroy(&q->lock);
+        close(q->event_fd);
+        q->event_fd = -1;
+        return -ret;
+    }
+
+    return 0;
+}
+
+void gdc_job_queue_destroy(struct gdc_job_queue *q)
+{
+    if (q->event_fd < 0)
+        return;
+
+    pthread_mutex_lock(&q->lock);
+    q->stop = 1;
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+
+    pthread_join(q->worker, NULL);
+
+    pthread_cond_destroy(&q->cond);
+    pthread_mutex_destroy(&q->lock);
+    close(q->event_fd);
+    q->event_fd = -1;
+}
+
+int gdc_job_submit(struct gdc_job_queue *q, struct gdc_job *job)
+{
+    if (job == NULL || job->ctx == NULL)
+        return -EINVAL;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->stop || q->inflight >= GDC_JOB_QUEUE_DEPTH) {
+        pthread_mutex_unlock(&q->lock);
+        return -EAGAIN;
+    }
+
+    job->status = -EINPROGRESS;
+    job->submit_us = gdc_job_now_us();
+    job->start_us = 0;
+    job->done_us = 0;
+
+    q->pending[q->pending_tail % GDC_JOB_QUEUE_DEPTH] = job;
+    q->pending_tail++;
+    q->inflight++;
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+
+    return 0;
+}
+
+int gdc_job_poll_fd(struct gdc_job_queue *q)
+{
+    return q->event_fd;
+}
+
+int gdc_job_reap(struct gdc_job_queue *q, struct gdc_job **jobs, int max)
+{
+    uint64_t cnt;
+    int n = 0;
+
+    pthread_mutex_lock(&q->lock);
+    while (n < max && q->done_head != q->done_tail) {
+        jobs[n++] = q->done[q->done_head % GDC_JOB_QUEUE_DEPTH];
+        q->done_head++;
+    }
+    q->inflight -= n;
+
+    // drop the fd back to non readable once everything is reaped
+    if (q->done_head == q->done_tail)
+        while (read(q->event_fd, &cnt, sizeof(cnt)) == sizeof(cnt))
+            ;
+    pthread_mutex_unlock(&q->lock);
+
+    return n;
+}
+
+int gdc_job_wait(struct gdc_job_queue *q, int timeout_ms)
+{
+    struct pollfd pfd;
+    int ret;
+
+    pfd.fd = q->event_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    do {
+        ret = poll(&pfd, 1, timeout_ms);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0)
+        return -errno;
+
+    return ret > 0 ? 1 : 0;
+}
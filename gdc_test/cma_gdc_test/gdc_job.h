@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __GDC_JOB_H__
+#define __GDC_JOB_H__
+
+#include <pthread.h>
+
+#include "gdc_api.h"
+
+/*
+ * Asynchronous gdc jobs.
+ *
+ * gdc_job_submit() queues a job and returns at once, a worker thread runs
+ * the queued jobs one after the other on the device (GDC_RUN) or on the cpu
+ * model. A context has its own config, input and output buffer, so it holds
+ * at most one job; N frames are kept in flight by cycling over N contexts,
+ * filling the input of one while the others are queued or running.
+ *
+ * Completions are reported either through the callback given to
+ * gdc_job_queue_init(), called on the worker thread, or, without a callback,
+ * through gdc_job_reap() while the fd of gdc_job_poll_fd() is readable.
+ */
+
+#define GDC_JOB_QUEUE_DEPTH 16
+
+struct gdc_job {
+    struct gdc_usr_ctx_s *ctx;
+    void *priv;                     //caller's cookie
+    int status;                     //result of the run, valid on completion
+    unsigned long long submit_us;
+    unsigned long long start_us;
+    unsigned long long done_us;
+};
+
+typedef void (*gdc_job_cb)(struct gdc_job *job, void *arg);
+
+struct gdc_job_queue {
+    pthread_t worker;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int event_fd;
+    int stop;
+    gdc_job_cb cb;
+    void *cb_arg;
+
+    struct gdc_job *pending[GDC_JOB_QUEUE_DEPTH];
+    unsigned int pending_head;
+    unsigned int pending_tail;
+    struct gdc_job *done[GDC_JOB_QUEUE_DEPTH];
+    unsigned int done_head;
+    unsigned int done_tail;
+    unsigned int inflight;          //submitted and not yet reaped
+};
+
+/**
+ *   This function starts a job queue and its worker thread.
+ *
+ *   @param  q - queue to init.
+ *   @param  cb - completion callback, NULL to use gdc_job_reap().
+ *   @param  arg - passed to cb.
+ *
+ *   @return 0 - success
+ *           <0 - fail
+ */
+int gdc_job_queue_init(struct gdc_job_queue *q, gdc_job_cb cb, void *arg);
+
+/**
+ *   This function runs the jobs still queued and stops the worker.
+ *   Completions not yet reaped are dropped.
+ *
+ *   @param  q - queue.
+ */
+void gdc_job_queue_destroy(struct gdc_job_queue *q);
+
+/**
+ *   This function queues a job without waiting for it. The job and its
+ *   context belong to the queue until the job completes.
+ *
+ *   @param  q - queue.
+ *   @param  job - job with ctx set.
+ *
+ *   @return 0 - queued
+ *           -EAGAIN - GDC_JOB_QUEUE_DEPTH jobs in flight
+ *           -EINVAL - no context
+ */
+int gdc_job_submit(struct gdc_job_queue *q, struct gdc_job *job);
+
+/**
+ *   This function returns an fd which polls readable while completed jobs
+ *   wait in gdc_job_reap(). Not used when a callback is set.
+ */
+int gdc_job_poll_fd(struct gdc_job_queue *q);
+
+/**
+ *   This function takes completed jobs off the queue without blocking.
+ *
+ *   @param  q - queue.
+ *   @param  jobs - completed jobs, in completion order.
+ *   @param  max - size of jobs.
+ *
+ *   @return number of jobs returned
+ */
+int gdc_job_reap(struct gdc_job_queue *q, struct gdc_job **jobs, int max);
+
+/**
+ *   This function waits up to timeout_ms (-1 forever) for a completion.
+ *
+ *   @return 1 - completions to reap
+ *           0 - timeout
+ *           <0 - fail
+ */
+int gdc_job_wait(struct gdc_job_queue *q, int timeout_ms);
+
+unsigned long long gdc_job_now_us(void);
+
+#endif
@@ -0,0 +1,48 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gdc_api.h"
+#include "gdc_model.h"
+
+static unsigned long long gdc_model_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+int gdc_model_run(struct gdc_usr_ctx_s *ctx)
+{
+	gdc_config_t *cfg = &ctx->gs.gdc_config;
+	struct gdc_model_plane in[GDC_MODEL_MAX_PLANES];
+	struct gdc_model_plane out[GDC_MODEL_MAX_PLANES];
+	unsigned long long start = gdc_model_now_us();
+	unsigned long long spent;
+
+	gdc_model_split(cfg, 0, ctx->i_buff, ctx->i_len, in);
+	gdc_model_split(cfg, 1, ctx->o_buff, ctx->o_len, out);
+	if (gdc_model_process(cfg, in, out) < 0)
+		return -1;
+
+	spent = gdc_model_now_us() - start;
+	if (spent < ctx->model_us)
+		usleep(ctx->model_us - spent);
+
+	return 0;
+}
@@ -0,0 +1,33 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#ifndef __GDC_MODEL_H__
+#define __GDC_MODEL_H__
+
+/*
+ * CPU stand-in for /dev/gdc.
+ *
+ * It accepts the same settings as the driver and runs the job on the CPU
+ * model of gdc_model_core.h, so the library, the job queue and the
+ * benchmark run on any Linux host. Jobs are padded to ctx->model_us to
+ * stand in for the hardware time.
+ */
+
+#include "gdc_model_core.h"
+
+struct gdc_usr_ctx_s;
+
+int gdc_model_run(struct gdc_usr_ctx_s *ctx);
+
+#endif
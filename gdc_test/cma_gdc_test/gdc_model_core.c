@@ -0,0 +1,132 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "gdc_api.h"
+#include "gdc_model_core.h"
+
+void *gdc_model_alloc(unsigned long len)
+{
+	void *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	return (p == MAP_FAILED) ? NULL : p;
+}
+
+int gdc_model_planes(const struct gdc_config *cfg)
+{
+	switch (cfg->format) {
+	case NV12:
+		return 2;
+	case YV12:
+	case YUV444_P:
+	case RGB444_P:
+		return 3;
+	default:
+		return 1;
+	}
+}
+
+static uint32_t gdc_model_lines(const struct gdc_config *cfg, int plane, uint32_t height)
+{
+	if (plane && (cfg->format == NV12 || cfg->format == YV12))
+		return height / 2;
+	return height;
+}
+
+/* bytes copied per line of a plane, chroma of NV12 is interleaved */
+static uint32_t gdc_model_line(const struct gdc_config *cfg, int plane)
+{
+	uint32_t line = (cfg->input_width < cfg->output_width) ?
+				cfg->input_width : cfg->output_width;
+	uint32_t i_stride = plane ? cfg->input_c_stride : cfg->input_y_stride;
+	uint32_t o_stride = plane ? cfg->output_c_stride : cfg->output_y_stride;
+
+	if (plane && cfg->format == YV12)
+		line /= 2;
+	if (line > i_stride)
+		line = i_stride;
+	if (line > o_stride)
+		line = o_stride;
+
+	return line;
+}
+
+int gdc_model_split(const struct gdc_config *cfg, int output,
+		char *base, unsigned long len, struct gdc_model_plane *planes)
+{
+	uint32_t height = output ? cfg->output_height : cfg->input_height;
+	uint32_t y_stride = output ? cfg->output_y_stride : cfg->input_y_stride;
+	uint32_t c_stride = output ? cfg->output_c_stride : cfg->input_c_stride;
+	unsigned long offset = 0;
+	int n = gdc_model_planes(cfg);
+	int i;
+
+	for (i = 0; i < n; i++) {
+		int fits = base != NULL && offset <= len;
+
+		planes[i].base = fits ? base + offset : NULL;
+		planes[i].len = fits ? len - offset : 0;
+		offset += (unsigned long)(i ? c_stride : y_stride) *
+				gdc_model_lines(cfg, i, height);
+	}
+
+	return n;
+}
+
+/* the last line only needs to hold what is copied, not a whole stride */
+static int gdc_model_fits(const struct gdc_model_plane *plane,
+		uint32_t stride, uint32_t lines, uint32_t line)
+{
+	if (plane->base == NULL)
+		return 0;
+	if (lines == 0)
+		return 1;
+	return (unsigned long)stride * (lines - 1) + line <= plane->len;
+}
+
+int gdc_model_process(const struct gdc_config *cfg,
+		const struct gdc_model_plane *in, const struct gdc_model_plane *out)
+{
+	uint32_t height = (cfg->input_height < cfg->output_height) ?
+				cfg->input_height : cfg->output_height;
+	int n = gdc_model_planes(cfg);
+	int i;
+
+	for (i = 0; i < n; i++) {
+		uint32_t lines = gdc_model_lines(cfg, i, height);
+		uint32_t line = gdc_model_line(cfg, i);
+
+		if (!gdc_model_fits(&in[i], i ? cfg->input_c_stride : cfg->input_y_stride, lines, line) ||
+		    !gdc_model_fits(&out[i], i ? cfg->output_c_stride : cfg->output_y_stride, lines, line))
+			return -1;
+	}
+
+	for (i = 0; i < n; i++) {
+		uint32_t i_stride = i ? cfg->input_c_stride : cfg->input_y_stride;
+		uint32_t o_stride = i ? cfg->output_c_stride : cfg->output_y_stride;
+		uint32_t lines = gdc_model_lines(cfg, i, height);
+		uint32_t line = gdc_model_line(cfg, i);
+		uint32_t j;
+
+		for (j = 0; j < lines; j++)
+			memcpy(out[i].base + (unsigned long)j * o_stride,
+				in[i].base + (unsigned long)j * i_stride, line);
+	}
+
+	return 0;
+}
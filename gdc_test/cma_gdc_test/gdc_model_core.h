@@ -0,0 +1,56 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#ifndef __GDC_MODEL_CORE_H__
+#define __GDC_MODEL_CORE_H__
+
+/*
+ * CPU model of a GDC job, shared by cma_gdc_test and v4l2_testapp.
+ *
+ * The config sequence is not interpreted: the input planes are identity
+ * mapped into the output planes, honouring the strides of both sides.
+ * Every plane is checked against the bytes its buffer holds before it is
+ * read or written.
+ */
+
+#define GDC_MODEL_MAX_PLANES 3
+
+struct gdc_config;
+
+struct gdc_model_plane {
+	char *base;
+	unsigned long len;	//bytes which may be accessed from base
+};
+
+void *gdc_model_alloc(unsigned long len);
+
+/* y (or only) plane plus the chroma planes of cfg->format */
+int gdc_model_planes(const struct gdc_config *cfg);
+
+/*
+ * Point planes at the y and chroma planes packed in one buffer, as laid out
+ * by gdc_init_cfg. output selects the output strides and height.
+ * Returns the number of planes.
+ */
+int gdc_model_split(const struct gdc_config *cfg, int output,
+		char *base, unsigned long len, struct gdc_model_plane *planes);
+
+/*
+ * Run one job from in to out, both with gdc_model_planes() entries.
+ * Returns -1 when a plane is missing or smaller than the config needs.
+ */
+int gdc_model_process(const struct gdc_config *cfg,
+		const struct gdc_model_plane *in, const struct gdc_model_plane *out);
+
+#endif
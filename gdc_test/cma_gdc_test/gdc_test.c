@@ -35,69 +35,6 @@
 #include <sys/time.h>
 #endif
 
-struct gdc_param {
-    uint32_t i_width;
-    uint32_t i_height;
-    uint32_t o_width;
-    uint32_t o_height;
-    uint32_t format;
-};
-
-
-int get_file_size(char *f_name)
-{
-    int f_size = -1;
-    FILE *fp = NULL;
-
-    if (f_name == NULL) {
-        printf("Error file name\n");
-        return f_size;
-    }
-
-    fp = fopen(f_name, "rb");
-    if (fp == NULL) {
-        printf("Error open file %s\n", f_name);
-        return f_size;
-    }
-
-    fseek(fp, 0, SEEK_END);
-
-    f_size = ftell(fp);
-
-    fclose(fp);
-
-    printf("%s: size %d\n", f_name, f_size);
-
-    return f_size;
-}
-
-int gdc_set_config_param(struct gdc_usr_ctx_s *ctx,
-                                    char *f_name, int len)
-{
-    FILE *fp = NULL;
-    int r_size = -1;
-
-    if (f_name == NULL || ctx == NULL || ctx->c_buff == NULL) {
-        printf("Error input param\n");
-        return r_size;
-    }
-
-    fp = fopen(f_name, "rb");
-    if (fp == NULL) {
-        printf("Error open file %s\n", f_name);
-        return -1;
-    }
-
-    r_size = fread(ctx->c_buff, len, 1, fp);
-    if (r_size <= 0) {
-        printf("Failed to read file %s\n", f_name);
-    }
-
-    fclose(fp);
-
-    return r_size;
-}
-
 int gdc_set_input_image(struct gdc_usr_ctx_s *ctx,
                                     char *f_name, int len)
 {
@@ -150,123 +87,6 @@ void save_imgae(char *buff, unsigned long size, int flag, int count)
 }
 
 
-int gdc_init_cfg(struct gdc_usr_ctx_s *ctx, struct gdc_param *tparm, char *f_name)
-{
-    struct gdc_settings *gdc_gs = NULL;
-    int ret = -1;
-    uint32_t format = 0;
-    uint32_t i_width = 0;
-    uint32_t i_height = 0;
-    uint32_t o_width = 0;
-    uint32_t o_height = 0;
-    uint32_t i_y_stride = 0;
-    uint32_t i_c_stride = 0;
-    uint32_t o_y_stride = 0;
-    uint32_t o_c_stride = 0;
-    uint32_t i_len = 0;
-    uint32_t o_len = 0;
-    uint32_t c_len = 0;
-
-    if (ctx == NULL || tparm == NULL || f_name == NULL) {
-        printf("Error invalid input param\n");
-        return ret;
-    }
-
-    memset(ctx, 0, sizeof(*ctx));
-
-    i_width = tparm->i_width;
-    i_height = tparm->i_height;
-    o_width = tparm->o_width;
-    o_height = tparm->o_height;
-
-    format = tparm->format;
-
-    i_y_stride = AXI_WORD_ALIGN(i_width);
-    o_y_stride = AXI_WORD_ALIGN(o_width);
-
-    if (format == NV12 || format == YUV444_P || format == RGB444_P) {
-        i_c_stride = AXI_WORD_ALIGN(i_width);
-        o_c_stride = AXI_WORD_ALIGN(o_width);
-    } else if (format == YV12) {
-        i_c_stride = AXI_WORD_ALIGN(i_width) / 2;
-        o_c_stride = AXI_WORD_ALIGN(o_width) / 2;
-    } else if (format == Y_GREY) {
-        i_c_stride = 0;
-        o_c_stride = 0;
-    } else {
-        printf("Error unknow format\n");
-        return ret;
-    }
-
-    gdc_gs = &ctx->gs;
-
-    gdc_gs->base_gdc = 0;
-
-    gdc_gs->gdc_config.input_width = i_width;
-    gdc_gs->gdc_config.input_height = i_height;
-    gdc_gs->gdc_config.input_y_stride = i_y_stride;
-    gdc_gs->gdc_config.input_c_stride = i_c_stride;
-    gdc_gs->gdc_config.output_width = o_width;
-    gdc_gs->gdc_config.output_height = o_height;
-    gdc_gs->gdc_config.output_y_stride = o_y_stride;
-    gdc_gs->gdc_config.output_c_stride = o_c_stride;
-    gdc_gs->gdc_config.format = format;
-    gdc_gs->magic = sizeof(*gdc_gs);
-
-    gdc_create_ctx(ctx);
-
-    c_len = get_file_size(f_name);
-    if (c_len <= 0) {
-        gdc_destroy_ctx(ctx);
-        printf("Error gdc config file size\n");
-        return ret;
-    }
-
-    ret = gdc_alloc_dma_buffer(ctx, CONFIG_BUFF_TYPE, c_len);
-    if (ret < 0) {
-        gdc_destroy_ctx(ctx);
-        printf("Error alloc gdc cfg buff\n");
-        return ret;
-    }
-
-    ret = gdc_set_config_param(ctx, f_name, c_len);
-    if (ret < 0) {
-        gdc_destroy_ctx(ctx);
-        printf("Error cfg gdc param buff\n");
-        return ret;
-    }
-
-    gdc_gs->gdc_config.config_size = c_len / 4;
-
-    if (format == RGB444_P || format == YUV444_P)
-        i_len = i_y_stride * i_height * 3;
-    else
-        i_len = i_y_stride * i_height * 2;
-
-    ret = gdc_alloc_dma_buffer(ctx, INPUT_BUFF_TYPE, i_len);
-    if (ret < 0) {
-        gdc_destroy_ctx(ctx);
-        printf("Error alloc gdc input buff\n");
-        return ret;
-    }
-
-    if (format == RGB444_P || format == YUV444_P)
-        o_len = o_y_stride * o_height * 3;
-    else if (format == NV12 || format == YV12)
-        o_len = o_y_stride * o_height * 3 / 2;
-    else if (format == Y_GREY)
-         o_len = o_y_stride * o_height;
-
-    ret = gdc_alloc_dma_buffer(ctx, OUTPUT_BUFF_TYPE, o_len);
-    if (ret < 0) {
-        gdc_destroy_ctx(ctx);
-        printf("Error alloc gdc input buff\n");
-        return ret;
-    }
-
-    return ret;
-}
-
 int main(int argc, char* argv[]) {
     int c;
     int ret = 0;
@@ -281,6 +101,7 @@ int main(int argc, char* argv[]) {
     char *config_file = "config.bin";
     struct gdc_param g_param;
     int len = 0;
+    int model_us = -1;
 
     while (1) {
         static struct option opts[] = {
@@ -288,12 +109,13 @@ int main(int argc, char* argv[]) {
             {"format", required_argument, 0, 'f'},
             {"height", required_argument, 0, 'h'},
             {"input_file", required_argument, 0, 'i'},
+            {"model", required_argument, 0, 'm'},
             {"output_file", optional_argument, 0, 'o'},
             {"stride", optional_argument, 0, 's'},
             {"width", required_argument, 0, 'w'},
         };
         int i = 0;
-        c = getopt_long(argc, argv, "c:f:h:i:os:w:", opts, &i);
+        c = getopt_long(argc, argv, "c:f:h:i:m:os:w:", opts, &i);
         if (c == -1)
             break;
 
@@ -307,6 +129,9 @@ int main(int argc, char* argv[]) {
         case 'i':
             input_file = optarg;
             break;
+        case 'm':
+            model_us = atoi(optarg);
+            break;
         case 's':
             sscanf(optarg, "%dx%d-%dx%d",
                     &in_y_stride, &in_c_stride, &out_y_stride, &out_c_stride);
@@ -322,11 +147,14 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    memset(&g_param, 0, sizeof(g_param));
     g_param.i_width = in_width;
     g_param.i_height = in_height;
     g_param.o_width = out_width;
     g_param.o_height = out_height;
     g_param.format = format;
+    g_param.use_model = (model_us >= 0);
+    g_param.model_us = (model_us >= 0) ? model_us : 0;
 
     memset(&ctx, 0, sizeof(ctx));
 
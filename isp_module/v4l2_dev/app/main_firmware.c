@@ -91,6 +91,16 @@ void callback_ds2( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadat
 {
 }
 
+// Called when the firmware could not recover from an ISP error by itself
+void callback_error( uint32_t ctx_num, uint32_t irq_mask )
+{
+}
+
+// Called when the exposure of a frame carries a queued control batch
+void callback_ctrl_batch( uint32_t ctx_num, const acamera_ctrl_batch_t *batch, uint32_t frame_id, uint32_t result )
+{
+}
+
 #endif
 
 #if ISP_HAS_STREAM_CONNECTION && CONNECTION_IN_THREAD
@@ -149,7 +159,8 @@ static int isp_fw_process( void *data )
 // Please see the ACamera Porting Guide for details.
 static void interrupt_handler( void *data, uint32_t mask )
 {
-    acamera_interrupt_handler();
+    // the platform has already latched and cleared the status vector
+    acamera_interrupt_process( mask );
 }
 
 void isp_update_setting(void)
@@ -231,6 +242,8 @@ void isp_fw_exit( void )
 #endif
 
     if ( isp_fw_process_thread ) {
+        // the loop has no timeout any more, wake it for the stop
+        acamera_process_stop();
         kthread_stop( isp_fw_process_thread );
     }
 
@@ -35,9 +35,11 @@
 #include <linux/clk.h>
 #include "acamera_firmware_config.h"
 #include "acamera_logger.h"
+#include "acamera_firmware_api.h"
 #include "system_hw_io.h"
 #include "system_sw_io.h"
 #include "system_am_sc.h"
+#include "system_timeline.h"
 #include <linux/fs.h>
 #include <asm/uaccess.h>
 #include <asm/unaligned.h>
@@ -432,6 +434,108 @@ static ssize_t dump_frame_write(
 
 static DEVICE_ATTR(dump_frame, S_IRUGO | S_IWUSR, dump_frame_read, dump_frame_write);
 
+static ssize_t isp_error_read(
+    struct device *dev,
+    struct device_attribute *attr,
+    char *buf)
+{
+    acamera_isp_error_stats_t stats;
+    ssize_t len = 0;
+    int i;
+
+    if (acamera_get_isp_error_stats(&stats) != 0)
+        return sprintf(buf, "firmware not initialized\n");
+
+    len += sprintf(buf + len, "active: %u\n", stats.active);
+    len += sprintf(buf + len, "recoveries: %u\n", stats.recoveries);
+    len += sprintf(buf + len, "retries: %u\n", stats.retries);
+    len += sprintf(buf + len, "full_resets: %u\n", stats.full_resets);
+    len += sprintf(buf + len, "reported: %u\n", stats.reported);
+    len += sprintf(buf + len, "max_duration_ms: %u\n", stats.max_duration_ms);
+
+    for (i = 0; i < 32; i++) {
+        if (stats.irq_errors[i])
+            len += sprintf(buf + len, "irq_bit%d: %u\n", i, stats.irq_errors[i]);
+    }
+
+    for (i = 0; i < ACAMERA_ISP_RECOVERY_HIST_BINS; i++) {
+        if (i < ACAMERA_ISP_RECOVERY_HIST_BINS - 1)
+            len += sprintf(buf + len, "duration <%ums: %u\n", 1u << i, stats.duration_hist[i]);
+        else
+            len += sprintf(buf + len, "duration >=%ums: %u\n", 1u << (i - 1), stats.duration_hist[i]);
+    }
+
+    return len;
+}
+
+/* any write clears the counters */
+static ssize_t isp_error_write(
+    struct device *dev, struct device_attribute *attr,
+    char const *buf, size_t size)
+{
+    acamera_reset_isp_error_stats();
+    return size;
+}
+
+static DEVICE_ATTR(isp_error, S_IRUGO | S_IWUSR, isp_error_read, isp_error_write);
+
+/* commands that were called at least once: type cmd flags calls fails avg_ns max_ns */
+static ssize_t cmd_stats_read(
+    struct device *dev,
+    struct device_attribute *attr,
+    char *buf)
+{
+    acamera_command_info_t info;
+    ssize_t len = 0;
+    uint32_t idx;
+
+    for (idx = 0; acamera_command_get_info(idx, &info) == 0; idx++) {
+        if (!info.stats.calls)
+            continue;
+        len += scnprintf(buf + len, PAGE_SIZE - len, "%u %u 0x%x %u %u %llu %u\n",
+                         info.command_type, info.command, info.flags,
+                         info.stats.calls, info.stats.fails,
+                         div_u64(info.stats.time_ns, info.stats.calls),
+                         info.stats.max_time_ns);
+    }
+
+    return len;
+}
+
+/* any write clears the counters */
+static ssize_t cmd_stats_write(
+    struct device *dev, struct device_attribute *attr,
+    char const *buf, size_t size)
+{
+    acamera_command_reset_stats();
+    return size;
+}
+
+static DEVICE_ATTR(cmd_stats, S_IRUGO | S_IWUSR, cmd_stats_read, cmd_stats_write);
+
+/* one line per dma pipe: sensor_fps target_fps delivered skipped */
+static ssize_t dma_fps_read(
+    struct device *dev,
+    struct device_attribute *attr,
+    char *buf)
+{
+    static const char *const pipe_name[dma_max] = {"fr", "ds1", "ds2"};
+    uint32_t c_fps, t_fps, delivered, skipped;
+    ssize_t len = 0;
+    int type;
+
+    for (type = 0; type < dma_max; type++) {
+        if (acamera_api_get_fps(type, &c_fps, &t_fps, &delivered, &skipped) != SUCCESS)
+            continue;
+        len += scnprintf(buf + len, PAGE_SIZE - len, "%s %u %u %u %u\n",
+                         pipe_name[type], c_fps, t_fps, delivered, skipped);
+    }
+
+    return len;
+}
+
+static DEVICE_ATTR(dma_fps, S_IRUGO, dma_fps_read, NULL);
+
 uint32_t write_reg(uint32_t val, unsigned long addr)
 {
     void __iomem *io_addr;
@@ -638,6 +742,7 @@ static int32_t isp_platform_probe( struct platform_device *pdev )
 
     hw_reset(true);
 
+    system_timeline_init();
     system_interrupts_init();
 
     hw_reset(false);
@@ -681,6 +786,9 @@ static int32_t isp_platform_probe( struct platform_device *pdev )
 
     device_create_file(&pdev->dev, &dev_attr_reg);
     device_create_file(&pdev->dev, &dev_attr_dump_frame);
+    device_create_file(&pdev->dev, &dev_attr_isp_error);
+    device_create_file(&pdev->dev, &dev_attr_cmd_stats);
+    device_create_file(&pdev->dev, &dev_attr_dma_fps);
 
     LOG( LOG_ERR, "Init finished. async register notifier result %d. Waiting for subdevices", rc );
 #else
@@ -708,6 +816,9 @@ static int isp_platform_remove(struct platform_device *pdev)
 {
     device_remove_file(&pdev->dev, &dev_attr_reg);
     device_remove_file(&pdev->dev, &dev_attr_dump_frame);
+    device_remove_file(&pdev->dev, &dev_attr_isp_error);
+    device_remove_file(&pdev->dev, &dev_attr_cmd_stats);
+    device_remove_file(&pdev->dev, &dev_attr_dma_fps);
 
     if ( initialized == 1 ) {
         isp_v4l2_destroy_instance(isp_pdev);
@@ -723,6 +834,7 @@ static int isp_platform_remove(struct platform_device *pdev)
     hw_reset(true);
 
     system_interrupts_deinit();
+    system_timeline_deinit();
 
     if (dev_info.clk_mipi_0 != NULL) {
         clk_disable_unprepare(dev_info.clk_mipi_0);
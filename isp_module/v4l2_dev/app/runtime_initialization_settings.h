@@ -61,6 +61,8 @@ extern void callback_meta( uint32_t ctx_num,  const void *fw_metadata) ;
 extern void callback_fr( uint32_t ctx_num,  tframe_t * tframe, const metadata_t *metadata) ;
 extern void callback_ds1( uint32_t ctx_num,  tframe_t * tframe, const metadata_t *metadata) ;
 extern void callback_ds2( uint32_t ctx_num,  tframe_t * tframe, const metadata_t *metadata) ;
+extern void callback_error( uint32_t ctx_num, uint32_t irq_mask ) ;
+extern void callback_ctrl_batch( uint32_t ctx_num, const acamera_ctrl_batch_t *batch, uint32_t frame_id, uint32_t result ) ;
 
 static acamera_settings settings[ FIRMWARE_CONTEXT_NUMBER ] = {    {
         .sensor_init = sensor_init_v4l2,
@@ -82,5 +84,7 @@ static acamera_settings settings[ FIRMWARE_CONTEXT_NUMBER ] = {    {
         .ds2_frames = NULL,
         .ds2_frames_number = 0,
         .callback_ds2 = callback_ds2,
+        .callback_error = callback_error,
+        .callback_ctrl_batch = callback_ctrl_batch,
     }
 } ;
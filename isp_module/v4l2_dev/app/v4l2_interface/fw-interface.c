@@ -28,6 +28,7 @@
 
 #include "system_interrupts.h"
 #include "acamera_command_api.h"
+#include "acamera_firmware_api.h"
 #include "acamera_firmware_settings.h"
 #include "application_command_api.h"
 #include "acamera_logger.h"
@@ -740,6 +741,23 @@ static int fw_intf_set_ds1_fps(uint32_t fps)
     return 0;
 }
 
+static int fw_intf_set_ds2_fps(uint32_t fps)
+{
+    uint32_t cur_fps = 0;
+
+    acamera_command(TSENSOR, SENSOR_FPS, 0, COMMAND_GET, &cur_fps);
+    if (cur_fps == 0) {
+        LOG(LOG_ERR, "Error input param\n");
+        return -1;
+    }
+
+    cur_fps = cur_fps / 256;
+
+    acamera_api_set_fps(dma_ds2, cur_fps, fps);
+
+    return 0;
+}
+
 
 static int fw_intf_set_ae_zone_weight(unsigned long ctrl_val)
 {
@@ -1742,6 +1760,15 @@ int fw_intf_set_custom_ds1_fps(uint32_t ctrl_val)
     return rtn;
 }
 
+int fw_intf_set_custom_ds2_fps(uint32_t ctrl_val)
+{
+    int rtn = -1;
+
+    rtn = fw_intf_set_ds2_fps(ctrl_val);
+
+    return rtn;
+}
+
 int fw_intf_set_custom_sensor_testpattern(uint32_t ctrl_val)
 {
     int rtn = -1;
@@ -1894,3 +1921,78 @@ int fw_intf_set_customer_max_integration_time(uint32_t ctrl_val)
     }
     return isp_fw_do_set_max_integration_time(ctrl_val);
 }
+
+static int fw_intf_ctrl_batch_add( acamera_ctrl_batch_t *batch, uint8_t command, uint32_t value )
+{
+    if ( batch->cmd_num >= ACAMERA_CTRL_BATCH_MAX_CMDS )
+        return -EINVAL;
+
+    batch->cmd[batch->cmd_num].command_type = TSYSTEM;
+    batch->cmd[batch->cmd_num].command = command;
+    batch->cmd[batch->cmd_num].value = value;
+    batch->cmd_num++;
+
+    return 0;
+}
+
+int fw_intf_set_customer_ctrl_batch( int target_frame, const uint32_t *id, const int32_t *val, int num )
+{
+    static uint32_t batch_id = 0;
+    acamera_ctrl_batch_t batch;
+    int rtn = 0;
+    int i;
+
+    if ( !isp_started ) {
+        LOG( LOG_ERR, "ISP FW not inited yet" );
+        return -EBUSY;
+    }
+
+    memset( &batch, 0, sizeof( batch ) );
+    batch.target_frame = target_frame;
+
+    for ( i = 0; i < num && rtn == 0; i++ ) {
+        switch ( id[i] ) {
+        case ISP_V4L2_CID_CUSTOM_SET_MANUAL_EXPOSURE:
+            rtn = fw_intf_ctrl_batch_add( &batch, SYSTEM_MANUAL_INTEGRATION_TIME, val[i] );
+            if ( rtn == 0 )
+                rtn = fw_intf_ctrl_batch_add( &batch, SYSTEM_MANUAL_SENSOR_ANALOG_GAIN, val[i] );
+            if ( rtn == 0 )
+                rtn = fw_intf_ctrl_batch_add( &batch, SYSTEM_MANUAL_SENSOR_DIGITAL_GAIN, val[i] );
+            if ( rtn == 0 )
+                rtn = fw_intf_ctrl_batch_add( &batch, SYSTEM_MANUAL_ISP_DIGITAL_GAIN, val[i] );
+            break;
+        case ISP_V4L2_CID_CUSTOM_SET_SENSOR_INTEGRATION_TIME:
+            rtn = fw_intf_ctrl_batch_add( &batch, SYSTEM_INTEGRATION_TIME, val[i] );
+            break;
+        case ISP_V4L2_CID_CUSTOM_SET_SENSOR_ANALOG_GAIN:
+            rtn = fw_intf_ctrl_batch_add( &batch, SYSTEM_SENSOR_ANALOG_GAIN, val[i] );
+            break;
+        case ISP_V4L2_CID_CUSTOM_SET_ISP_DIGITAL_GAIN:
+            rtn = fw_intf_ctrl_batch_add( &batch, SYSTEM_ISP_DIGITAL_GAIN, val[i] );
+            break;
+        case ISP_V4L2_CID_CUSTOM_SET_SENSOR_DIGITAL_GAIN:
+            rtn = fw_intf_ctrl_batch_add( &batch, SYSTEM_SENSOR_DIGITAL_GAIN, val[i] );
+            break;
+        default:
+            LOG( LOG_ERR, "control 0x%x can not be batched", id[i] );
+            rtn = -EINVAL;
+            break;
+        }
+    }
+
+    if ( rtn != 0 || batch.cmd_num == 0 )
+        return rtn;
+
+    batch.id = ++batch_id;
+    LOG( LOG_INFO, "queue control batch %u with %u commands for frame %d", batch.id, batch.cmd_num, target_frame );
+
+    if ( acamera_queue_ctrl_batch( &batch ) != 0 )
+        return -EBUSY;
+
+    return 0;
+}
+
+int fw_intf_get_frame_count( void )
+{
+    return acamera_get_frame_count() & 0x7fffffff;
+}
@@ -79,6 +79,7 @@ int fw_intf_set_custom_sensor_wdr_mode( uint32_t ctrl_val );
 int fw_intf_set_custom_sensor_exposure( uint32_t ctrl_val );
 int fw_intf_set_custom_fr_fps(uint32_t ctrl_val);
 int fw_intf_set_custom_ds1_fps(uint32_t ctrl_val);
+int fw_intf_set_custom_ds2_fps(uint32_t ctrl_val);
 int fw_intf_set_custom_sensor_testpattern(uint32_t ctrl_val);
 int fw_intf_set_customer_sensor_ir_cut(uint32_t ctrl_val);
 int fw_intf_set_customer_ae_zone_weight(unsigned long ctrl_val);
@@ -93,6 +94,8 @@ int fw_intf_set_customer_sensor_digital_gain(uint32_t ctrl_val);
 int fw_intf_set_customer_awb_red_gain(uint32_t ctrl_val);
 int fw_intf_set_customer_awb_blue_gain(uint32_t ctrl_val);
 int fw_intf_set_customer_max_integration_time(uint32_t ctrl_val);
+int fw_intf_set_customer_ctrl_batch( int target_frame, const uint32_t *id, const int32_t *val, int num );
+int fw_intf_get_frame_count( void );
 
 
 #endif
@@ -66,10 +66,23 @@ typedef struct _isp_v4l2_sensor_info {
 #define ISP_V4L2_PIX_FMT_ARGB2101010 v4l2_fourcc( 'B', 'A', '3', '0' ) /* ARGB2101010 */
 #define ISP_V4L2_PIX_FMT_NULL v4l2_fourcc( 'N', 'U', 'L', 'L' )        /* format NULL to disable */
 
+/* mmap offset of the metadata ring on the video node, above any vb2 plane offset */
+#define ISP_V4L2_META_RING_MMAP_OFFSET ( 1UL << 30 )
+
 /* custom v4l2 events */
 #define V4L2_EVENT_ACAMERA_CLASS ( V4L2_EVENT_PRIVATE_START + 0xA * 1000 )
 #define V4L2_EVENT_ACAMERA_FRAME_READY ( V4L2_EVENT_ACAMERA_CLASS + 0x1 )
 #define V4L2_EVENT_ACAMERA_STREAM_OFF ( V4L2_EVENT_ACAMERA_CLASS + 0x2 )
+#define V4L2_EVENT_ACAMERA_ISP_ERROR ( V4L2_EVENT_ACAMERA_CLASS + 0x3 )
+#define V4L2_EVENT_ACAMERA_CTRL_BATCH_DONE ( V4L2_EVENT_ACAMERA_CLASS + 0x4 )
+
+/* payload of V4L2_EVENT_ACAMERA_CTRL_BATCH_DONE in v4l2_event.u.data */
+typedef struct _isp_v4l2_ctrl_batch_event {
+    uint32_t batch_id;     /* counts the batches queued on the device */
+    uint32_t target_frame; /* frame requested with ISP_V4L2_CID_CUSTOM_SET_CTRL_BATCH_FRAME */
+    uint32_t frame_id;     /* frame_id of the first buffer whose exposure carries the batch */
+    uint32_t result;       /* 0 or the status of the first failing firmware command */
+} isp_v4l2_ctrl_batch_event_t;
 
 /* custom v4l2 controls */
 #define ISP_V4L2_CID_ISP_V4L2_CLASS ( 0x00f00000 | 1 )
@@ -99,6 +112,9 @@ typedef struct _isp_v4l2_sensor_info {
 #define ISP_V4L2_CID_CUSTOM_SET_AWB_RED_GAIN ( ISP_V4L2_CID_BASE + 22 )
 #define ISP_V4L2_CID_CUSTOM_SET_AWB_BLUE_GAIN ( ISP_V4L2_CID_BASE + 23 )
 #define ISP_V4L2_CID_CUSTOM_SET_MAX_INTEGRATION_TIME (ISP_V4L2_CID_BASE + 24)
+#define ISP_V4L2_CID_CUSTOM_SET_CTRL_BATCH_FRAME ( ISP_V4L2_CID_BASE + 25 )
+#define ISP_V4L2_CID_CUSTOM_FRAME_COUNT ( ISP_V4L2_CID_BASE + 26 )
+#define ISP_V4L2_CID_CUSTOM_SET_DS2_FPS ( ISP_V4L2_CID_BASE + 27 )
 
 /* type of stream */
 typedef enum {
@@ -103,6 +103,62 @@ static int isp_v4l2_ctrl_s_ctrl_standard( struct v4l2_ctrl *ctrl )
     return ret;
 }
 
+static int isp_v4l2_ctrl_s_ctrl_custom( struct v4l2_ctrl *ctrl );
+
+/*
+ * The batch frame control is the master of the manual exposure cluster.
+ * With a frame set in the same VIDIOC_S_EXT_CTRLS call the new values are
+ * queued together and the firmware applies them at that frame start,
+ * otherwise each one is applied right away as before.
+ */
+static int isp_v4l2_ctrl_s_ctrl_batch( struct v4l2_ctrl *master )
+{
+    uint32_t id[ISP_V4L2_CTRL_BATCH_CLUSTER_SIZE];
+    int32_t val[ISP_V4L2_CTRL_BATCH_CLUSTER_SIZE];
+    struct v4l2_ctrl *ctrl;
+    int num = 0;
+    int ret = 0;
+    int i;
+
+    if ( !master->is_new || master->val < 0 ) {
+        for ( i = 1; i < master->ncontrols && ret == 0; i++ ) {
+            ctrl = master->cluster[i];
+            if ( ctrl != NULL && ctrl->is_new )
+                ret = isp_v4l2_ctrl_s_ctrl_custom( ctrl );
+        }
+        return ret;
+    }
+
+    for ( i = 1; i < master->ncontrols; i++ ) {
+        ctrl = master->cluster[i];
+        if ( ctrl == NULL || !ctrl->is_new || ctrl->val < 0 )
+            continue;
+
+        id[num] = ctrl->id;
+        val[num] = ctrl->val;
+        num++;
+        /* same value can be set again, like the controls do one at a time */
+        ctrl->val = -1;
+    }
+
+    LOG( LOG_INFO, "set control batch of %d for frame %d\n", num, master->val );
+    ret = fw_intf_set_customer_ctrl_batch( master->val, id, val, num );
+    master->val = -1;
+
+    return ret;
+}
+
+static int isp_v4l2_ctrl_g_ctrl_custom( struct v4l2_ctrl *ctrl )
+{
+    switch ( ctrl->id ) {
+    case ISP_V4L2_CID_CUSTOM_FRAME_COUNT:
+        ctrl->val = fw_intf_get_frame_count();
+        break;
+    }
+
+    return 0;
+}
+
 static int isp_v4l2_ctrl_s_ctrl_custom( struct v4l2_ctrl *ctrl )
 {
     int ret = 0;
@@ -208,6 +264,11 @@ static int isp_v4l2_ctrl_s_ctrl_custom( struct v4l2_ctrl *ctrl )
         ret = fw_intf_set_custom_ds1_fps(ctrl->val);
         *(ctrl->p_new.p_s32) = 0;
         break;
+    case ISP_V4L2_CID_CUSTOM_SET_DS2_FPS:
+        LOG( LOG_INFO, "set ds2 fps: 0x%x.\n", ctrl->val );
+        ret = fw_intf_set_custom_ds2_fps(ctrl->val);
+        *(ctrl->p_new.p_s32) = 0;
+        break;
     case ISP_V4L2_CID_AE_COMPENSATION:
         LOG( LOG_INFO, "new ae compensation: %d.\n", ctrl->val );
         ret = fw_intf_set_ae_compensation( ctrl->val );
@@ -229,6 +290,9 @@ static int isp_v4l2_ctrl_s_ctrl_custom( struct v4l2_ctrl *ctrl )
         LOG( LOG_INFO, "set_customer_max_integration_time = %d\n", ctrl->val );
         ret = fw_intf_set_customer_max_integration_time(ctrl->val);
         break;
+    case ISP_V4L2_CID_CUSTOM_SET_CTRL_BATCH_FRAME:
+        ret = isp_v4l2_ctrl_s_ctrl_batch( ctrl );
+        break;
     }
 
     return ret;
@@ -236,6 +300,7 @@ static int isp_v4l2_ctrl_s_ctrl_custom( struct v4l2_ctrl *ctrl )
 
 static const struct v4l2_ctrl_ops isp_v4l2_ctrl_ops_custom = {
     .s_ctrl = isp_v4l2_ctrl_s_ctrl_custom,
+    .g_volatile_ctrl = isp_v4l2_ctrl_g_ctrl_custom,
 };
 
 static const struct v4l2_ctrl_config isp_v4l2_ctrl_test_pattern = {
@@ -363,6 +428,17 @@ static const struct v4l2_ctrl_config isp_v4l2_ctrl_ds1_fps = {
     .def = 0,
 };
 
+static const struct v4l2_ctrl_config isp_v4l2_ctrl_ds2_fps = {
+    .ops = &isp_v4l2_ctrl_ops_custom,
+    .id = ISP_V4L2_CID_CUSTOM_SET_DS2_FPS,
+    .name = "ISP ds2 fps",
+    .type = V4L2_CTRL_TYPE_INTEGER,
+    .min = 0,
+    .max = 120,
+    .step = 1,
+    .def = 0,
+};
+
 static const struct v4l2_ctrl_config isp_v4l2_ctrl_sensor_testpattern = {
     .ops = &isp_v4l2_ctrl_ops_custom,
     .id = ISP_V4L2_CID_CUSTOM_SET_SENSOR_TESTPATTERN,
@@ -517,6 +593,29 @@ static const struct v4l2_ctrl_config isp_v4l2_ctrl_max_integration_time = {
     .def = -1,
 };
 
+static const struct v4l2_ctrl_config isp_v4l2_ctrl_ctrl_batch_frame = {
+    .ops = &isp_v4l2_ctrl_ops_custom,
+    .id = ISP_V4L2_CID_CUSTOM_SET_CTRL_BATCH_FRAME,
+    .name = "ctrl_batch_frame set",
+    .type = V4L2_CTRL_TYPE_INTEGER,
+    .min = -1,
+    .max = 0x7fffffff,
+    .step = 1,
+    .def = -1,
+};
+
+static const struct v4l2_ctrl_config isp_v4l2_ctrl_frame_count = {
+    .ops = &isp_v4l2_ctrl_ops_custom,
+    .flags = V4L2_CTRL_FLAG_VOLATILE | V4L2_CTRL_FLAG_READ_ONLY,
+    .id = ISP_V4L2_CID_CUSTOM_FRAME_COUNT,
+    .name = "frame_count get",
+    .type = V4L2_CTRL_TYPE_INTEGER,
+    .min = 0,
+    .max = 0x7fffffff,
+    .step = 1,
+    .def = 0,
+};
+
 static const struct v4l2_ctrl_ops isp_v4l2_ctrl_ops = {
     .s_ctrl = isp_v4l2_ctrl_s_ctrl_standard,
 };
@@ -634,6 +733,8 @@ int isp_v4l2_ctrl_init( isp_v4l2_ctrl_t *ctrl )
                   &isp_v4l2_ctrl_stop_sensor_update, NULL);
     ADD_CTRL_CST( ISP_V4L2_CID_CUSTOM_SET_DS1_FPS,
                   &isp_v4l2_ctrl_ds1_fps, NULL);
+    ADD_CTRL_CST( ISP_V4L2_CID_CUSTOM_SET_DS2_FPS,
+                  &isp_v4l2_ctrl_ds2_fps, NULL);
     ADD_CTRL_CST( ISP_V4L2_CID_AE_COMPENSATION,
                   &isp_v4l2_ctrl_ae_compensation, NULL);
     ADD_CTRL_CST( ISP_V4L2_CID_CUSTOM_SET_SENSOR_DIGITAL_GAIN,
@@ -644,6 +745,20 @@ int isp_v4l2_ctrl_init( isp_v4l2_ctrl_t *ctrl )
                   &isp_v4l2_ctrl_awb_blue_gain, NULL);
     ADD_CTRL_CST( ISP_V4L2_CID_CUSTOM_SET_MAX_INTEGRATION_TIME,
                   &isp_v4l2_ctrl_max_integration_time, NULL);
+    ADD_CTRL_CST( ISP_V4L2_CID_CUSTOM_SET_CTRL_BATCH_FRAME,
+                  &isp_v4l2_ctrl_ctrl_batch_frame, NULL);
+    ADD_CTRL_CST( ISP_V4L2_CID_CUSTOM_FRAME_COUNT,
+                  &isp_v4l2_ctrl_frame_count, NULL);
+
+    /* batch frame first, it is the cluster master */
+    ctrl->batch_cluster[0] = v4l2_ctrl_find( hdl_cst_ctrl, ISP_V4L2_CID_CUSTOM_SET_CTRL_BATCH_FRAME );
+    ctrl->batch_cluster[1] = v4l2_ctrl_find( hdl_cst_ctrl, ISP_V4L2_CID_CUSTOM_SET_MANUAL_EXPOSURE );
+    ctrl->batch_cluster[2] = v4l2_ctrl_find( hdl_cst_ctrl, ISP_V4L2_CID_CUSTOM_SET_SENSOR_INTEGRATION_TIME );
+    ctrl->batch_cluster[3] = v4l2_ctrl_find( hdl_cst_ctrl, ISP_V4L2_CID_CUSTOM_SET_SENSOR_ANALOG_GAIN );
+    ctrl->batch_cluster[4] = v4l2_ctrl_find( hdl_cst_ctrl, ISP_V4L2_CID_CUSTOM_SET_ISP_DIGITAL_GAIN );
+    ctrl->batch_cluster[5] = v4l2_ctrl_find( hdl_cst_ctrl, ISP_V4L2_CID_CUSTOM_SET_SENSOR_DIGITAL_GAIN );
+    if ( ctrl->batch_cluster[0] != NULL )
+        v4l2_ctrl_cluster( ISP_V4L2_CTRL_BATCH_CLUSTER_SIZE, ctrl->batch_cluster );
 
     /* Add control handler to v4l2 device */
     v4l2_ctrl_add_handler( hdl_std_ctrl, hdl_cst_ctrl, NULL );
@@ -23,6 +23,8 @@
 #include <media/v4l2-device.h>
 #include <media/v4l2-ctrls.h>
 
+#define ISP_V4L2_CTRL_BATCH_CLUSTER_SIZE 6
+
 typedef struct _isp_v4l2_ctrl {
     /* Fields need to be filled by owner */
     struct v4l2_device *v4l2_dev;
@@ -31,6 +33,9 @@ typedef struct _isp_v4l2_ctrl {
     /* Fields will be filled by isp_v4l2_ctrl module */
     struct v4l2_ctrl_handler ctrl_hdl_std_ctrl; /* STD ctrl */
     struct v4l2_ctrl_handler ctrl_hdl_cst_ctrl; /* CST ctrl */
+
+    /* manual exposure controls applied as one batch at a frame start */
+    struct v4l2_ctrl *batch_cluster[ISP_V4L2_CTRL_BATCH_CLUSTER_SIZE];
 } isp_v4l2_ctrl_t;
 
 /* external interface to isp-v4l2 module */
@@ -0,0 +1,133 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <linux/vmalloc.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/bug.h>
+
+#include "acamera_firmware_config.h"
+#include "acamera_logger.h"
+
+#include "isp-v4l2-meta-ring.h"
+
+#define ISP_META_RING_SIZE ( ISP_META_RING_HDR_SIZE + ISP_META_RING_SLOTS * ISP_META_RING_RECORD_SIZE )
+
+static struct {
+    void *vaddr;
+    isp_meta_ring_hdr_t *hdr;
+    isp_meta_ring_record_t *records;
+    /* serializes writers only, readers never take it */
+    spinlock_t wlock;
+} meta_ring;
+
+int isp_meta_ring_init( void )
+{
+    BUILD_BUG_ON( sizeof( isp_meta_ring_record_t ) != ISP_META_RING_RECORD_SIZE );
+    BUILD_BUG_ON( ISP_META_RING_SLOTS & ( ISP_META_RING_SLOTS - 1 ) );
+
+    /* zeroed and safe to hand to remap_vmalloc_range */
+    meta_ring.vaddr = vmalloc_user( ISP_META_RING_SIZE );
+    if ( !meta_ring.vaddr ) {
+        LOG( LOG_ERR, "failed to allocate metadata ring (%lu bytes)", (unsigned long)ISP_META_RING_SIZE );
+        return -ENOMEM;
+    }
+
+    spin_lock_init( &meta_ring.wlock );
+
+    meta_ring.hdr = meta_ring.vaddr;
+    meta_ring.records = meta_ring.vaddr + ISP_META_RING_HDR_SIZE;
+
+    meta_ring.hdr->magic = ISP_META_RING_MAGIC;
+    meta_ring.hdr->version = ISP_META_RING_VERSION;
+    meta_ring.hdr->num_slots = ISP_META_RING_SLOTS;
+    meta_ring.hdr->record_size = ISP_META_RING_RECORD_SIZE;
+    meta_ring.hdr->records_offset = ISP_META_RING_HDR_SIZE;
+    meta_ring.hdr->payload_size = 0;
+
+    return 0;
+}
+
+void isp_meta_ring_release( void )
+{
+    if ( meta_ring.vaddr ) {
+        vfree( meta_ring.vaddr );
+        meta_ring.vaddr = NULL;
+        meta_ring.hdr = NULL;
+        meta_ring.records = NULL;
+    }
+}
+
+void isp_meta_ring_write( uint32_t ctx_num, const void *fw_metadata, uint32_t size )
+{
+    isp_meta_ring_record_t *rec;
+    uint32_t frame_id;
+    unsigned long flags;
+
+    if ( !meta_ring.hdr || !fw_metadata )
+        return;
+
+    if ( size > sizeof( rec->payload ) ) {
+        LOG( LOG_ERR, "metadata (%u bytes) does not fit a ring record", size );
+        return;
+    }
+
+    /* the frame id is the first field of firmware_metadata_t */
+    frame_id = *(const uint32_t *)fw_metadata;
+    rec = &meta_ring.records[frame_id & ( ISP_META_RING_SLOTS - 1 )];
+
+    spin_lock_irqsave( &meta_ring.wlock, flags );
+
+    WRITE_ONCE( rec->seq, rec->seq + 1 );
+    smp_wmb();
+
+    rec->frame_id = frame_id;
+    rec->ctx_num = ctx_num;
+    memcpy( rec->payload, fw_metadata, size );
+
+    smp_wmb();
+    WRITE_ONCE( rec->seq, rec->seq + 1 );
+
+    meta_ring.hdr->payload_size = size;
+    WRITE_ONCE( meta_ring.hdr->last_frame_id, frame_id );
+    smp_wmb();
+    WRITE_ONCE( meta_ring.hdr->write_count, meta_ring.hdr->write_count + 1 );
+
+    spin_unlock_irqrestore( &meta_ring.wlock, flags );
+}
+
+int isp_meta_ring_mmap( struct vm_area_struct *vma )
+{
+    unsigned long size = vma->vm_end - vma->vm_start;
+
+    if ( !meta_ring.vaddr )
+        return -ENODEV;
+
+    if ( size > PAGE_ALIGN( ISP_META_RING_SIZE ) ) {
+        LOG( LOG_ERR, "metadata ring mmap too large (%lu bytes)", size );
+        return -EINVAL;
+    }
+
+    /* consumers only read, the firmware thread is the only writer */
+    if ( vma->vm_flags & VM_WRITE )
+        return -EPERM;
+    vma->vm_flags &= ~VM_MAYWRITE;
+
+    return remap_vmalloc_range( vma, meta_ring.vaddr, 0 );
+}
@@ -0,0 +1,72 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _ISP_V4L2_META_RING_H_
+#define _ISP_V4L2_META_RING_H_
+
+#include <linux/types.h>
+#include <linux/mm.h>
+
+/*
+ * Kernel-owned ring of per-frame metadata records.
+ *
+ * The ring is mapped read-only by any number of processes through mmap()
+ * on the video node at ISP_V4L2_META_RING_MMAP_OFFSET. Records are indexed
+ * by frame id modulo the number of slots; every record carries a sequence
+ * number which is odd while the firmware thread rewrites it, so readers copy
+ * the payload and retry when the sequence changed underneath them.
+ *
+ * The layout below is ABI, v4l2_testapp/isp_meta_ring.h mirrors it.
+ */
+
+#define ISP_META_RING_MAGIC 0x474E524D /* 'MRNG' */
+#define ISP_META_RING_VERSION 1
+#define ISP_META_RING_SLOTS 64 /* power of two */
+#define ISP_META_RING_RECORD_SIZE 512
+#define ISP_META_RING_HDR_SIZE PAGE_SIZE
+
+typedef struct _isp_meta_ring_hdr {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_slots;
+    uint32_t record_size;
+    uint32_t records_offset; /* from the start of the mapping */
+    uint32_t payload_size;   /* sizeof( firmware_metadata_t ) */
+    uint32_t write_count;    /* records published so far */
+    uint32_t last_frame_id;  /* frame id of the newest record */
+} isp_meta_ring_hdr_t;
+
+typedef struct _isp_meta_ring_record {
+    uint32_t seq; /* odd while being written, 0 if never written */
+    uint32_t frame_id;
+    uint32_t ctx_num;
+    uint32_t reserved;
+    uint8_t payload[ISP_META_RING_RECORD_SIZE - 4 * sizeof( uint32_t )];
+} isp_meta_ring_record_t;
+
+int isp_meta_ring_init( void );
+void isp_meta_ring_release( void );
+
+/* publish the metadata of one frame, called from the metadata callback */
+void isp_meta_ring_write( uint32_t ctx_num, const void *fw_metadata, uint32_t size );
+
+/* map the ring read-only into the caller */
+int isp_meta_ring_mmap( struct vm_area_struct *vma );
+
+#endif
@@ -41,12 +41,16 @@
 #endif
 
 #include "acamera_logger.h"
+#include "system_timeline.h"
 
 #include "isp-v4l2-common.h"
 #include "isp-v4l2.h"
 #include "fw-interface.h"
 
 #include "isp-v4l2-stream.h"
+#if ISP_HAS_META_CB
+#include "isp-v4l2-meta-ring.h"
+#endif
 
 #define CHECK_METADATA_ID 0
 
@@ -166,88 +170,135 @@ extern void cache_flush(uint32_t buf_start, uint32_t buf_size);
  * temporal frame sync before DDR access is available
  */
 #if V4L2_FRAME_ID_SYNC
-#define SYNC_FLAG_META ( 1 << 0 )
-#define SYNC_FLAG_RAW ( 1 << 1 )
-#define SYNC_FLAG_FR ( 1 << 2 )
-#define SYNC_FLAG_DS1 ( 1 << 3 )
-#define SYNC_FLAG_DS2 ( 1 << 4 )
+/*
+ * Not built by default: acamera_firmware_config.h sets V4L2_FRAME_ID_SYNC to
+ * 0, and each stream then delivers its frames without waiting for the others.
+ *
+ * Frames are matched across streams in a small table indexed by frame id.
+ * A set completes once every started stream has delivered its frame; a set
+ * still open after SYNC_TIMEOUT_MS is closed as incomplete and any stream
+ * arriving later for it is dropped as late.
+ */
+#define SYNC_TABLE_SIZE 8
+#define SYNC_TIMEOUT_MS 100
+
+#define SYNC_FLAG( type ) ( 1 << ( type ) )
+
+enum {
+    SYNC_ENTRY_OPEN = 0,
+    SYNC_ENTRY_COMPLETE,
+    SYNC_ENTRY_EXPIRED,
+};
+
+typedef struct _sync_entry_t {
+    uint32_t fid;
+    uint32_t mask;          /* streams that delivered this frame */
+    uint32_t state;
+    unsigned long deadline; /* jiffies */
+} sync_entry_t;
+
+typedef struct _sync_ctx_t {
+    sync_entry_t entry[SYNC_TABLE_SIZE];
+    uint32_t complete;
+    uint32_t incomplete;
+    uint32_t late;
+    uint32_t duplicate;
+} sync_ctx_t;
+
 static spinlock_t sync_slock;
 static uint32_t sync_started = 0;
-static uint32_t sync_flag = 0;
-static uint32_t sync_frame_id = 0;
-static uint32_t sync_highest_id = 0;
-static uint32_t sync_prev_ctx_id[V4L2_STREAM_TYPE_MAX] = {
-    0,
-};
-static uint32_t sync_done_meta_cnt = 0;
+static uint32_t sync_enabled = 0; /* streams currently on */
+static sync_ctx_t sync_ctx[FIRMWARE_CONTEXT_NUMBER];
 
-int sync_frame( int stream_type, uint32_t ctx_num, uint32_t fid, uint32_t flag )
+int sync_frame( int stream_type, uint32_t ctx_num, uint32_t fid )
 {
+    uint32_t flag = SYNC_FLAG( stream_type );
     unsigned long sflags;
-    int rc = -1;
+    sync_ctx_t *sc;
+    sync_entry_t *e;
+    int rc = 0;
+
+    if ( ctx_num >= FIRMWARE_CONTEXT_NUMBER )
+        return -EINVAL;
+
+    sc = &sync_ctx[ctx_num];
+    e = &sc->entry[fid % SYNC_TABLE_SIZE];
 
     spin_lock_irqsave( &sync_slock, sflags );
-    if ( sync_prev_ctx_id[stream_type] != ctx_num ) {
-        sync_highest_id = 0;
-        sync_prev_ctx_id[stream_type] = ctx_num;
+
+    if ( e->mask && e->fid != fid ) {
+        if ( (int32_t)( fid - e->fid ) < 0 ) {
+            /* the slot has already moved on to a newer frame */
+            sc->late++;
+            rc = -2;
+            goto out;
+        }
+        if ( e->state == SYNC_ENTRY_OPEN )
+            sc->incomplete++;
+        e->mask = 0;
     }
 
-    if ( sync_flag > 0 ) {
-        LOG( LOG_DEBUG, "[Stream#%d] Sync_flag on - sync_highest_id (%d), New fid (%d) / sync_frame_id (%d). sync flag: %x, flag: %x",
-             stream_type, sync_highest_id, fid, sync_frame_id, sync_flag, flag);
+    if ( !e->mask ) {
+        e->fid = fid;
+        e->state = SYNC_ENTRY_OPEN;
+        e->deadline = jiffies + msecs_to_jiffies( SYNC_TIMEOUT_MS );
+    } else if ( e->state == SYNC_ENTRY_OPEN && time_after( jiffies, e->deadline ) ) {
+        e->state = SYNC_ENTRY_EXPIRED;
+        sc->incomplete++;
+    }
 
-        if ( fid > sync_highest_id )
-            sync_highest_id = fid;
+    if ( e->mask & flag ) {
+        sc->duplicate++;
+        rc = -3;
+        goto out;
+    }
 
-        if ( fid != sync_frame_id || sync_flag & flag ) {
-            if (fid != sync_frame_id)
-                rc = -2;
-            else
-                rc = -3;
+    if ( e->state == SYNC_ENTRY_EXPIRED ) {
+        LOG( LOG_DEBUG, "[Stream#%d] fid %d arrived after its set expired (mask %x)", stream_type, fid, e->mask );
+        sc->late++;
+        rc = -2;
+        goto out;
+    }
 
-#if ISP_HAS_META_CB
-            if ( stream_type == V4L2_STREAM_TYPE_META && fid > sync_frame_id ) {
-                sync_flag &= ~flag;
-                /* FIXME: check if need reset the sync_done_meta_cnt*/
-                sync_done_meta_cnt = 0;
-                if (!sync_flag) {
-                    sync_flag |= flag;
-                    sync_highest_id = fid;
-                    sync_frame_id = fid;
-                    rc = 0;
-                }
-            }
-#endif
-            spin_unlock_irqrestore( &sync_slock, sflags );
-            return rc;
-        }
-        sync_flag |= flag;
-#if ISP_HAS_META_CB
-        if (sync_done_meta_cnt > 0) {
-            sync_flag &= ~SYNC_FLAG_META;
-            sync_done_meta_cnt--;
-        }
-        if (sync_flag & SYNC_FLAG_META) {
-            LOG( LOG_ERR, "[Stream#%d] Sync meta not done - sync_highest_id (%d), New fid (%d) / sync_frame_id (%d). sync flag: %x, flag: %x",
-                        stream_type, sync_highest_id, fid, sync_frame_id, sync_flag, flag);
-        }
+    e->mask |= flag;
+    if ( e->state == SYNC_ENTRY_OPEN && ( e->mask & sync_enabled ) == sync_enabled ) {
+        e->state = SYNC_ENTRY_COMPLETE;
+        sc->complete++;
+    }
+
+out:
+    spin_unlock_irqrestore( &sync_slock, sflags );
+
+    return rc;
+}
+
+static void sync_stream_enable( int stream_type, int enable )
+{
+    unsigned long sflags;
+    int i;
+
+#if ISP_HAS_DS2
+    /* callback_ds2 does not report its frames, a set would never complete */
+    if ( stream_type == V4L2_STREAM_TYPE_DS2 )
+        return;
 #endif
-    } else {
-        if ( fid > sync_highest_id ) {
-            LOG( LOG_DEBUG, "[Stream#%d] New synced frame started with fid %d", stream_type, fid );
-            sync_highest_id = fid;
-            sync_frame_id = fid;
-            sync_flag |= flag;
-        } else {
-            LOG( LOG_DEBUG, "[Stream#%d] returning since new fid is not the highest, (id = %d, highest = %d) ",
-                 stream_type, fid, sync_highest_id );
-            spin_unlock_irqrestore( &sync_slock, sflags );
-            return rc;
+
+    spin_lock_irqsave( &sync_slock, sflags );
+    if ( enable ) {
+        /* first stream on starts a fresh table for every context */
+        if ( !sync_enabled )
+            memset( sync_ctx, 0, sizeof( sync_ctx ) );
+        sync_enabled |= SYNC_FLAG( stream_type );
+    } else if ( sync_enabled & SYNC_FLAG( stream_type ) ) {
+        sync_enabled &= ~SYNC_FLAG( stream_type );
+        if ( !sync_enabled ) {
+            for ( i = 0; i < FIRMWARE_CONTEXT_NUMBER; i++ )
+                LOG( LOG_INFO, "ctx#%d sync: complete %u, incomplete %u, late %u, duplicate %u",
+                     i, sync_ctx[i].complete, sync_ctx[i].incomplete,
+                     sync_ctx[i].late, sync_ctx[i].duplicate );
         }
     }
     spin_unlock_irqrestore( &sync_slock, sflags );
-
-    return 0;
 }
 #endif
 
@@ -276,6 +327,9 @@ void callback_meta( uint32_t ctx_num, const void *fw_metadata )
         return;
     }
 
+    /* every frame goes to the shared ring, whether the META stream is on or not */
+    isp_meta_ring_write( ctx_num, fw_metadata, ISP_V4L2_METADATA_SIZE );
+
     /* find stream pointer */
     rc = isp_v4l2_find_stream( &pstream, ctx_num, V4L2_STREAM_TYPE_META );
     if ( rc < 0 ) {
@@ -301,7 +355,7 @@ void callback_meta( uint32_t ctx_num, const void *fw_metadata )
     LOG( LOG_INFO, "[Stream#%d] Meta Frame ID %d.", pstream->stream_id, frame_id );
 
 #if V4L2_FRAME_ID_SYNC
-    rc = sync_frame( pstream->stream_type, ctx_num, frame_id, SYNC_FLAG_META );
+    rc = sync_frame( pstream->stream_type, ctx_num, frame_id );
     if ( rc  < 0 ) {
         LOG( LOG_DEBUG, "sync_frame on ctx %d (errno = %d)", ctx_num, rc );
         return;
@@ -362,16 +416,6 @@ void callback_meta( uint32_t ctx_num, const void *fw_metadata )
     /* Put buffer back to vb2 queue */
     vb2_buffer_done( vb, VB2_BUF_STATE_DONE );
 
-#if V4L2_FRAME_ID_SYNC
-    {
-        unsigned long sflags;
-
-        spin_lock_irqsave( &sync_slock, sflags );
-        sync_done_meta_cnt++;
-        spin_unlock_irqrestore( &sync_slock, sflags );
-    }
-#endif
-
     /* Notify buffer ready */
     isp_v4l2_notify_event( pstream->stream_id, V4L2_EVENT_ACAMERA_FRAME_READY );
 
@@ -384,6 +428,42 @@ void callback_meta( uint32_t ctx_num, const void *fw_metadata )
 }
 #endif
 
+/* firmware gave up recovering from an ISP error, tell every open stream */
+void callback_error( uint32_t ctx_num, uint32_t irq_mask )
+{
+    isp_v4l2_stream_t *pstream = NULL;
+    int stream_type;
+
+    LOG( LOG_ERR, "isp error recovery failed on ctx %d, errors 0x%x", ctx_num, irq_mask );
+
+    for ( stream_type = 0; stream_type < V4L2_STREAM_TYPE_MAX; stream_type++ ) {
+        if ( isp_v4l2_find_stream( &pstream, ctx_num, stream_type ) < 0 )
+            continue;
+
+        isp_v4l2_notify_event( pstream->stream_id, V4L2_EVENT_ACAMERA_ISP_ERROR );
+    }
+}
+
+/* a control batch reached the exposure of frame_id, the buffer frame id, tell every open stream */
+void callback_ctrl_batch( uint32_t ctx_num, const acamera_ctrl_batch_t *batch, uint32_t frame_id, uint32_t result )
+{
+    isp_v4l2_stream_t *pstream = NULL;
+    isp_v4l2_ctrl_batch_event_t data;
+    int stream_type;
+
+    data.batch_id = batch->id;
+    data.target_frame = batch->target_frame;
+    data.frame_id = frame_id;
+    data.result = result;
+
+    for ( stream_type = 0; stream_type < V4L2_STREAM_TYPE_MAX; stream_type++ ) {
+        if ( isp_v4l2_find_stream( &pstream, ctx_num, stream_type ) < 0 )
+            continue;
+
+        isp_v4l2_notify_event_data( pstream->stream_id, V4L2_EVENT_ACAMERA_CTRL_BATCH_DONE, &data, sizeof( data ) );
+    }
+}
+
 #if ISP_HAS_RAW_CB
 void callback_raw( uint32_t ctx_num, aframe_t *aframe, const metadata_t *metadata, uint8_t exposures_num )
 {
@@ -422,7 +502,7 @@ void callback_raw( uint32_t ctx_num, aframe_t *aframe, const metadata_t *metadat
 #endif
 
 #if V4L2_FRAME_ID_SYNC
-    if ( sync_frame( pstream->stream_type, ctx_num, metadata->frame_id, SYNC_FLAG_RAW ) < 0 ) {
+    if ( sync_frame( pstream->stream_type, ctx_num, metadata->frame_id ) < 0 ) {
         LOG( LOG_CRIT, "[Stream#2] stream RAW sync_frame error" );
         return;
     }
@@ -502,7 +582,7 @@ void callback_fr( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadata
 #endif
 
 #if V4L2_FRAME_ID_SYNC
-    rc = sync_frame( pstream->stream_type, ctx_num, metadata->frame_id, SYNC_FLAG_FR );
+    rc = sync_frame( pstream->stream_type, ctx_num, metadata->frame_id );
     if ( rc  < 0 ) {
         LOG( LOG_DEBUG, "sync_frame on ctx %d (errno = %d)", ctx_num, rc );
         return;
@@ -521,6 +601,7 @@ void callback_fr( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadata
         frame_mgr->frame_buffer.meta = *metadata;
         frame_mgr->frame_buffer.state = ISP_FW_FRAME_BUF_VALID;
         frame_mgr->frame_buffer.tframe = *tframe;
+        frame_mgr->frame_buffer.ctx_num = ctx_num;
         /* lock buffer from firmware */
         tframe->primary.status = dma_buf_purge;
         tframe->secondary.status = dma_buf_purge;
@@ -531,8 +612,10 @@ void callback_fr( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadata
     spin_unlock_irqrestore( &frame_mgr->frame_slock, flags );
 
     /* wake up the kernel thread to copy the frame data  */
-    if ( wake_up )
+    if ( wake_up ) {
+        SYS_TIMELINE_MARK( ctx_num, metadata->frame_id, SYS_TIMELINE_CALLBACK + SYS_TIMELINE_OUT_FR );
         wake_up_interruptible( &frame_mgr->frame_wq );
+    }
 
     if ( metadata )
         LOG( LOG_DEBUG, "metadata: width: %u, height: %u, line_size: %u, frame_number: %u.",
@@ -576,7 +659,7 @@ void callback_ds1( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadat
 #endif
 
 #if V4L2_FRAME_ID_SYNC
-    rc = sync_frame( pstream->stream_type, ctx_num, metadata->frame_id, SYNC_FLAG_DS1 );
+    rc = sync_frame( pstream->stream_type, ctx_num, metadata->frame_id );
     if ( rc  < 0 ) {
         LOG( LOG_DEBUG, "sync_frame on ctx %d (errno = %d)", ctx_num, rc );
         return;
@@ -595,6 +678,7 @@ void callback_ds1( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadat
         frame_mgr->frame_buffer.meta = *metadata;
         frame_mgr->frame_buffer.state = ISP_FW_FRAME_BUF_VALID;
         frame_mgr->frame_buffer.tframe = *tframe;
+        frame_mgr->frame_buffer.ctx_num = ctx_num;
 
         /* lock buffer from firmware */
         tframe->primary.status = dma_buf_purge;
@@ -606,8 +690,10 @@ void callback_ds1( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadat
     spin_unlock_irqrestore( &frame_mgr->frame_slock, flags );
 
     /* wake up the kernel thread to copy the frame data  */
-    if ( wake_up )
+    if ( wake_up ) {
+        SYS_TIMELINE_MARK( ctx_num, metadata->frame_id, SYS_TIMELINE_CALLBACK + SYS_TIMELINE_OUT_DS1 );
         wake_up_interruptible( &frame_mgr->frame_wq );
+    }
 
     if ( metadata )
         LOG( LOG_DEBUG, "metadata: width: %u, height: %u, line_size: %u, frame_number: %u.",
@@ -653,7 +739,7 @@ void callback_ds2( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadat
 
 #if 0
 #if V4L2_FRAME_ID_SYNC
-		if ( sync_frame( pstream->stream_type, ctx_num, metadata->frame_id, SYNC_FLAG_DS2 ) < 0 ) {
+		if ( sync_frame( pstream->stream_type, ctx_num, metadata->frame_id ) < 0 ) {
 			LOG(LOG_ERR, "callback_ds2 sync frame failed");
 			return;
 		}
@@ -671,6 +757,7 @@ void callback_ds2( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadat
 			frame_mgr->frame_buffer.meta = *metadata;
 			frame_mgr->frame_buffer.state = ISP_FW_FRAME_BUF_VALID;
 			frame_mgr->frame_buffer.tframe = *tframe;
+			frame_mgr->frame_buffer.ctx_num = ctx_num;
 
 			/* lock buffer from firmware */
 			tframe->primary.status = dma_buf_purge;
@@ -682,8 +769,10 @@ void callback_ds2( uint32_t ctx_num, tframe_t *tframe, const metadata_t *metadat
 		spin_unlock_irqrestore( &frame_mgr->frame_slock, flags );
 
 		/* wake up the kernel thread to copy the frame data  */
-		if ( wake_up )
+		if ( wake_up ) {
+			SYS_TIMELINE_MARK( ctx_num, metadata->frame_id, SYS_TIMELINE_CALLBACK + SYS_TIMELINE_OUT_DS2 );
 			wake_up_interruptible( &frame_mgr->frame_wq );
+		}
 
 		if ( metadata )
 			LOG( LOG_INFO, "metadata: width: %u, height: %u, line_size: %u, frame_number: %u.",
@@ -910,6 +999,8 @@ static int isp_v4l2_stream_copy_thread( void *data )
     unsigned int buf_index;
     void *s_list = NULL;
     void *t_list = NULL;
+    uint32_t ctx_num = 0;
+    int tl_out = -1;
 
     if ( !pstream ) {
         LOG( LOG_ERR, "Null stream passed" );
@@ -918,6 +1009,14 @@ static int isp_v4l2_stream_copy_thread( void *data )
 
     LOG( LOG_INFO, "[Stream#%d] Enter HW thread.", pstream->stream_id );
 
+    /* output pipe of this stream in the frame timeline */
+    if ( pstream->stream_type == V4L2_STREAM_TYPE_FR )
+        tl_out = SYS_TIMELINE_OUT_FR;
+    else if ( pstream->stream_type == V4L2_STREAM_TYPE_DS1 )
+        tl_out = SYS_TIMELINE_OUT_DS1;
+    else if ( pstream->stream_type == V4L2_STREAM_TYPE_DS2 )
+        tl_out = SYS_TIMELINE_OUT_DS2;
+
     frame_mgr = &pstream->frame_mgr;
     set_freezable();
 
@@ -941,6 +1040,7 @@ static int isp_v4l2_stream_copy_thread( void *data )
         if ( ISP_FW_FRAME_BUF_VALID == frame_mgr->frame_buffer.state ) {
             meta = frame_mgr->frame_buffer.meta;
             tframe = frame_mgr->frame_buffer.tframe;
+            ctx_num = frame_mgr->frame_buffer.ctx_num;
             frame_mgr->frame_buffer.state = ISP_FW_FRAME_BUF_INVALID;
         } else {
             spin_unlock_irqrestore( &frame_mgr->frame_slock, flags );
@@ -948,6 +1048,9 @@ static int isp_v4l2_stream_copy_thread( void *data )
         }
         spin_unlock_irqrestore( &frame_mgr->frame_slock, flags );
 
+        if ( tl_out >= 0 )
+            SYS_TIMELINE_MARK( ctx_num, meta.frame_id, SYS_TIMELINE_COPY + tl_out );
+
         /* try to get an active buffer from vb2 queue  */
         pbuf = NULL;
         spin_lock( &pstream->slock );
@@ -967,43 +1070,6 @@ static int isp_v4l2_stream_copy_thread( void *data )
         if ((s_list != t_list) || (t_list == NULL) || (s_list == NULL)) {
             LOG(LOG_ERR, "[Stream#%d] Failed to find vb2 buffer on stream buffer list, s_list:%p, t_list:%p", pstream->stream_id, s_list, t_list);
             spin_unlock( &pstream->slock );
-#if V4L2_FRAME_ID_SYNC
-            {
-                unsigned long sflags;
-
-                spin_lock_irqsave( &sync_slock, sflags );
-#if ISP_HAS_RAW_CB
-                if ( pstream->stream_type == V4L2_STREAM_TYPE_RAW ) {
-                    LOG( LOG_DEBUG, "[Stream#%d] releasing RAW sync flag", pstream->stream_id );
-                    sync_flag &= ~SYNC_FLAG_RAW;
-                } else
-#endif
-#if ISP_HAS_DS1
-                if ( pstream->stream_type == V4L2_STREAM_TYPE_DS1 ) {
-                    LOG( LOG_DEBUG, "[Stream#%d] releasing DS1 sync flag", pstream->stream_id );
-                    sync_flag &= ~SYNC_FLAG_DS1;
-                } else
-#endif
-#if ISP_HAS_DS2
-                if ( pstream->stream_type == V4L2_STREAM_TYPE_DS2 ) {
-                    LOG( LOG_DEBUG, "[Stream#%d] releasing DS2 sync flag", pstream->stream_id );
-                    sync_flag &= ~SYNC_FLAG_DS2;
-                } else
-#endif
-#if ISP_HAS_META_CB
-                if (pstream->stream_type == V4L2_STREAM_TYPE_META) {
-                    LOG( LOG_DEBUG, "[Stream#%d] releasing Meta sync flag", pstream->stream_id );
-                    sync_flag &= ~SYNC_FLAG_META;
-                    sync_done_meta_cnt = 0;
-                } else
-#endif
-                if ( pstream->stream_type == V4L2_STREAM_TYPE_FR ) {
-                    LOG( LOG_DEBUG, "[Stream#%d] releasing FR  sync flag", pstream->stream_id );
-                    sync_flag &= ~SYNC_FLAG_FR;
-                }
-                spin_unlock_irqrestore( &sync_slock, sflags );
-            }
-#endif
             continue;
         }
         spin_unlock( &pstream->slock );
@@ -1025,51 +1091,14 @@ static int isp_v4l2_stream_copy_thread( void *data )
              pstream->stream_id, buf_index, idx_tmp );
 
         /* Put buffer back to vb2 queue */
+        if ( tl_out >= 0 )
+            SYS_TIMELINE_MARK( ctx_num, meta.frame_id, SYS_TIMELINE_BUFFER_DONE + tl_out );
         vb2_buffer_done( vb, VB2_BUF_STATE_DONE );
         LOG( LOG_INFO, "[Stream#%d] vid_cap buffer %d done frame_id:%d",
              pstream->stream_id, buf_index, meta.frame_id );
 
         /* Notify buffer ready */
         isp_v4l2_notify_event( pstream->stream_id, V4L2_EVENT_ACAMERA_FRAME_READY );
-
-#if V4L2_FRAME_ID_SYNC
-        {
-            unsigned long sflags;
-
-            spin_lock_irqsave( &sync_slock, sflags );
-#if ISP_HAS_RAW_CB
-            if ( pstream->stream_type == V4L2_STREAM_TYPE_RAW ) {
-                LOG( LOG_DEBUG, "[Stream#%d] releasing RAW sync flag", pstream->stream_id );
-                sync_flag &= ~SYNC_FLAG_RAW;
-            } else
-#endif
-#if ISP_HAS_DS1
-            if ( pstream->stream_type == V4L2_STREAM_TYPE_DS1 ) {
-                LOG( LOG_DEBUG, "[Stream#%d] releasing DS1 sync flag", pstream->stream_id );
-                sync_flag &= ~SYNC_FLAG_DS1;
-            } else
-#endif
-#if ISP_HAS_DS2
-            if ( pstream->stream_type == V4L2_STREAM_TYPE_DS2 ) {
-                LOG( LOG_DEBUG, "[Stream#%d] releasing DS2 sync flag", pstream->stream_id );
-                sync_flag &= ~SYNC_FLAG_DS2;
-            } else
-#endif
-#if ISP_HAS_META_CB
-            if (pstream->stream_type == V4L2_STREAM_TYPE_META) {
-                LOG( LOG_DEBUG, "[Stream#%d] releasing Meta sync flag", pstream->stream_id );
-                sync_flag &= ~SYNC_FLAG_META;
-                sync_done_meta_cnt = 0;
-            } else
-#endif
-            if ( pstream->stream_type == V4L2_STREAM_TYPE_FR ) {
-                LOG( LOG_DEBUG, "[Stream#%d] releasing FR  sync flag", pstream->stream_id );
-                sync_flag &= ~SYNC_FLAG_FR;
-            }
-            spin_unlock_irqrestore( &sync_slock, sflags );
-        }
-#endif
-
     }
 
     /* Notify stream off */
@@ -1090,41 +1119,7 @@ int isp_v4l2_stream_on( isp_v4l2_stream_t *pstream )
     LOG( LOG_DEBUG, "[Stream#%d] called", pstream->stream_id );
 
 #if V4L2_FRAME_ID_SYNC
-    {
-        unsigned long sflags;
-
-        spin_lock_irqsave( &sync_slock, sflags );
-#if ISP_HAS_RAW_CB
-        if ( pstream->stream_type == V4L2_STREAM_TYPE_RAW ) {
-            LOG( LOG_DEBUG, "[Stream#%d] releasing RAW sync flag", pstream->stream_id );
-            sync_flag &= ~SYNC_FLAG_RAW;
-        } else
-#endif
-#if ISP_HAS_DS1
-        if (pstream->stream_type == V4L2_STREAM_TYPE_DS1) {
-            LOG( LOG_DEBUG, "[Stream#%d] releasing DS1 sync flag", pstream->stream_id );
-            sync_flag &= ~SYNC_FLAG_DS1;
-        } else
-#endif
-#if ISP_HAS_DS2
-        if (pstream->stream_type == V4L2_STREAM_TYPE_DS2) {
-            LOG( LOG_DEBUG, "[Stream#%d] releasing DS2 sync flag", pstream->stream_id );
-            sync_flag &= ~SYNC_FLAG_DS2;
-        } else
-#endif
-#if ISP_HAS_META_CB
-        if (pstream->stream_type == V4L2_STREAM_TYPE_META) {
-            LOG( LOG_DEBUG, "[Stream#%d] releasing Meta sync flag", pstream->stream_id );
-            sync_flag &= ~SYNC_FLAG_META;
-            sync_done_meta_cnt = 0;
-        } else
-#endif
-        if (pstream->stream_type == V4L2_STREAM_TYPE_FR) {
-            LOG( LOG_DEBUG, "[Stream#%d] releasing FR  sync flag", pstream->stream_id );
-            sync_flag &= ~SYNC_FLAG_FR;
-        }
-        spin_unlock_irqrestore( &sync_slock, sflags );
-    }
+    sync_stream_enable( pstream->stream_type, 1 );
 #endif
 
 /* for now, we need memcpy */
@@ -1217,6 +1212,10 @@ void isp_v4l2_stream_off( isp_v4l2_stream_t *pstream )
     }
     spin_unlock( &pstream->slock );
 
+#if V4L2_FRAME_ID_SYNC
+    sync_stream_enable( pstream->stream_type, 0 );
+#endif
+
     // control fields update
 
     pstream->stream_started = 0;
@@ -62,6 +62,7 @@ typedef struct isp_fw_frame {
     uint32_t addr[VIDEO_MAX_PLANES]; //multiplanar addresses
     metadata_t meta;
     tframe_t tframe;
+    uint32_t ctx_num;
 } isp_v4l2_frame_t;
 
 /**
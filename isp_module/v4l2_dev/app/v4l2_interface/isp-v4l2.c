@@ -35,12 +35,16 @@
 #include "isp-v4l2-stream.h"
 #include "isp-vb2.h"
 #include "fw-interface.h"
+#if ISP_HAS_META_CB
+#include "isp-v4l2-meta-ring.h"
+#endif
 #include <linux/dma-mapping.h>
 #include <linux/of_reserved_mem.h>
 #include <linux/dma-contiguous.h>
 #include "system_am_sc.h"
 
 #define ISP_V4L2_NUM_INPUTS 1
+#define ISP_V4L2_EVENT_QUEUE_DEPTH 8
 
 
 /* isp_v4l2_dev_t to destroy video device */
@@ -49,6 +53,7 @@ void *isp_kaddr = NULL;
 resource_size_t isp_paddr = 0;
 #define SIZE_1M (1024 * 1024UL)
 #define DEFAULT_TEMPER_BUFFER_SIZE 16
+#define DEFAULT_CMA_POOL_SIZE 64
 
 
 /* ----------------------------------------------------------------
@@ -269,6 +274,11 @@ static int isp_v4l2_fop_mmap( struct file *file, struct vm_area_struct *vma )
     struct isp_v4l2_fh *sp = fh_to_private( file->private_data );
     int rc = 0;
 
+#if ISP_HAS_META_CB
+    if ( vma->vm_pgoff == ( ISP_V4L2_META_RING_MMAP_OFFSET >> PAGE_SHIFT ) )
+        return isp_meta_ring_mmap( vma );
+#endif
+
     rc = vb2_mmap( &sp->vb2_q, vma );
 
     return rc;
@@ -599,6 +609,19 @@ static int isp_v4l2_expbuf(struct file *file, void *priv, struct v4l2_exportbuff
     return vb2_expbuf(&sp->vb2_q, ex_buf);
 }
 
+static int isp_v4l2_subscribe_event( struct v4l2_fh *fh, const struct v4l2_event_subscription *sub )
+{
+    switch ( sub->type ) {
+    case V4L2_EVENT_ACAMERA_FRAME_READY:
+    case V4L2_EVENT_ACAMERA_STREAM_OFF:
+    case V4L2_EVENT_ACAMERA_ISP_ERROR:
+    case V4L2_EVENT_ACAMERA_CTRL_BATCH_DONE:
+        return v4l2_event_subscribe( fh, sub, ISP_V4L2_EVENT_QUEUE_DEPTH, NULL );
+    default:
+        return v4l2_ctrl_subscribe_event( fh, sub );
+    }
+}
+
 static const struct v4l2_ioctl_ops isp_v4l2_ioctl_ops = {
     .vidioc_querycap = isp_v4l2_querycap,
 
@@ -627,7 +650,7 @@ static const struct v4l2_ioctl_ops isp_v4l2_ioctl_ops = {
 
     /* v4l2 event ioctls */
     .vidioc_log_status = v4l2_ctrl_log_status,
-    .vidioc_subscribe_event = v4l2_ctrl_subscribe_event,
+    .vidioc_subscribe_event = isp_v4l2_subscribe_event,
     .vidioc_unsubscribe_event = v4l2_event_unsubscribe,
 
     /* crop ioctls */
@@ -706,6 +729,12 @@ int isp_v4l2_create_instance( struct v4l2_device *v4l2_dev, struct platform_devi
         dev->temper_buf_size = DEFAULT_TEMPER_BUFFER_SIZE;
     }
 
+    /* get the amount of freed vb2 CMA kept for reuse from dts */
+    rc = of_property_read_u32(pdev->dev.of_node, "cma-pool-size",
+                        &(dev->cma_pool_size));
+    if (rc != 0)
+        dev->cma_pool_size = DEFAULT_CMA_POOL_SIZE;
+
     /* register v4l2_device */
 
     dev->v4l2_dev = v4l2_dev;
@@ -743,10 +772,21 @@ int isp_v4l2_create_instance( struct v4l2_device *v4l2_dev, struct platform_devi
 	if (rc < 0)
         goto deinit_ctrl;
 
+    rc = vb2_cmalloc_pool_init(&pdev->dev, (dev->cma_pool_size) * SIZE_1M);
+    if ( rc < 0 )
+        goto free_cma;
+
+#if ISP_HAS_META_CB
+    /* metadata must have somewhere to go before the firmware starts */
+    rc = isp_meta_ring_init();
+    if ( rc < 0 )
+        goto free_pool;
+#endif
+
     /* initialize isp */
     rc = fw_intf_isp_init();
     if ( rc < 0 )
-        goto free_cma;
+        goto free_meta_ring;
 
     /* initialize isp */
     rc = isp_v4l2_stream_init_static_resources(pdev);
@@ -784,6 +824,14 @@ int isp_v4l2_create_instance( struct v4l2_device *v4l2_dev, struct platform_devi
 deinit_fw_intf:
     fw_intf_isp_deinit();
 
+free_meta_ring:
+#if ISP_HAS_META_CB
+    isp_meta_ring_release();
+#endif
+
+free_pool:
+    vb2_cmalloc_pool_release();
+
 free_cma:
     isp_cma_free(pdev, isp_kaddr, (dev->temper_buf_size) * SIZE_1M);
 
@@ -815,6 +863,12 @@ void isp_v4l2_destroy_instance( struct platform_device *pdev )
         /* unregister video device */
         video_unregister_device( &g_isp_v4l2_dev->video_dev );
 
+        vb2_cmalloc_pool_release();
+
+#if ISP_HAS_META_CB
+        isp_meta_ring_release();
+#endif
+
         isp_v4l2_ctrl_deinit( &g_isp_v4l2_dev->isp_v4l2_ctrl );
 
         kfree( g_isp_v4l2_dev );
@@ -855,6 +909,11 @@ int isp_v4l2_find_stream( isp_v4l2_stream_t **ppstream,
  * event notifier utility function
  */
 int isp_v4l2_notify_event( int stream_id, uint32_t event_type )
+{
+    return isp_v4l2_notify_event_data( stream_id, event_type, NULL, 0 );
+}
+
+int isp_v4l2_notify_event_data( int stream_id, uint32_t event_type, const void *data, size_t size )
 {
     struct v4l2_event event;
 
@@ -862,6 +921,10 @@ int isp_v4l2_notify_event( int stream_id, uint32_t event_type )
         return -EBUSY;
     }
 
+    if ( size > sizeof( event.u.data ) ) {
+        return -EINVAL;
+    }
+
     if ( mutex_lock_interruptible( &g_isp_v4l2_dev->notify_lock ) )
         LOG( LOG_CRIT, "mutex_lock_interruptible failed.\n" );
     if ( g_isp_v4l2_dev->fh_ptr[stream_id] == NULL ) {
@@ -872,6 +935,8 @@ int isp_v4l2_notify_event( int stream_id, uint32_t event_type )
 
     memset( &event, 0, sizeof( event ) );
     event.type = event_type;
+    if ( data != NULL )
+        memcpy( event.u.data, data, size );
 
     v4l2_event_queue_fh( g_isp_v4l2_dev->fh_ptr[stream_id], &event );
     mutex_unlock( &g_isp_v4l2_dev->notify_lock );
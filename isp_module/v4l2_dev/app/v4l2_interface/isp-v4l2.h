@@ -56,6 +56,7 @@ typedef struct _isp_v4l2_dev {
     atomic_t opened;
     unsigned int stream_mask;
     unsigned int temper_buf_size;
+    unsigned int cma_pool_size;
 } isp_v4l2_dev_t;
 
 
@@ -70,4 +71,7 @@ int isp_v4l2_find_stream( isp_v4l2_stream_t **ppstream,
 /* Frame ready event */
 int isp_v4l2_notify_event( int stream_id, uint32_t event_type );
 
+/* Event carrying a payload of up to 64 bytes in v4l2_event.u.data */
+int isp_v4l2_notify_event_data( int stream_id, uint32_t event_type, const void *data, size_t size );
+
 #endif
@@ -18,24 +18,376 @@
 #include <linux/vmalloc.h>
 #include <linux/dma-mapping.h>
 #include <linux/dma-contiguous.h>
+#include <linux/dma-buf.h>
+#include <linux/scatterlist.h>
+#include <linux/shrinker.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
 
 #include "isp-vb2-cmalloc.h"
 
+/*
+ * Freed CMA regions are parked in a per-device pool and handed back to the
+ * next allocation of the same page-rounded size, so stream off/on and
+ * format switches do not go through dma_alloc_from_contiguous() again.
+ * The pool keeps at most high_water bytes, the least recently parked
+ * regions are returned to CMA first, also by the shrinker on memory
+ * pressure.
+ */
+#define CMALLOC_LAT_BUCKETS 9
+
+struct vb2_cmalloc_pool_entry {
+	struct list_head	list;
+	struct page		*pages;
+	unsigned long		size;
+};
+
+struct vb2_cmalloc_pool {
+	struct device		*dev;
+	struct mutex		lock;
+	struct list_head	free_list;	/* most recently parked first */
+	unsigned long		bytes_held;
+	unsigned long		high_water;
+
+	u64			hits;
+	u64			misses;
+	u64			parked;
+	u64			released;
+	u64			alloc_fail;
+	/* allocation latency, [0] pool hits, [1] CMA allocations */
+	u64			lat_hist[2][CMALLOC_LAT_BUCKETS];
+
+	struct shrinker		shrinker;
+	struct dentry		*debugfs;
+};
+
+/* guards cmalloc_pool and keeps it alive while cma_alloc/cma_free use it */
+static DEFINE_MUTEX(cmalloc_pool_lock);
+static struct vb2_cmalloc_pool *cmalloc_pool;
+
+static const char * const cmalloc_lat_names[CMALLOC_LAT_BUCKETS] = {
+	"<16us", "<64us", "<256us", "<1ms", "<4ms",
+	"<16ms", "<64ms", "<256ms", ">=256ms",
+};
+
+static void cma_pool_account_latency(struct vb2_cmalloc_pool *pool,
+				     int miss, ktime_t start)
+{
+	s64 us = ktime_us_delta(ktime_get(), start);
+	s64 limit = 16;
+	int b = 0;
+
+	while (us >= limit && b < CMALLOC_LAT_BUCKETS - 1) {
+		limit <<= 2;
+		b++;
+	}
+
+	mutex_lock(&pool->lock);
+	pool->lat_hist[miss][b]++;
+	mutex_unlock(&pool->lock);
+}
+
+static void cma_pool_release_entry(struct vb2_cmalloc_pool *pool,
+				   struct vb2_cmalloc_pool_entry *entry)
+{
+	list_del(&entry->list);
+	pool->bytes_held -= entry->size;
+	pool->released++;
+
+	if (!dma_release_from_contiguous(pool->dev, entry->pages,
+					 entry->size >> PAGE_SHIFT))
+		pr_err("Failed to release pooled cma buffer\n");
+
+	kfree(entry);
+}
+
+/* pool->lock held */
+static unsigned long cma_pool_trim(struct vb2_cmalloc_pool *pool,
+				   unsigned long limit)
+{
+	struct vb2_cmalloc_pool_entry *entry;
+	unsigned long freed = 0;
+
+	while (pool->bytes_held > limit && !list_empty(&pool->free_list)) {
+		entry = list_last_entry(&pool->free_list,
+					struct vb2_cmalloc_pool_entry, list);
+		freed += entry->size;
+		cma_pool_release_entry(pool, entry);
+	}
+
+	return freed;
+}
+
+static struct page *cma_pool_get(struct vb2_cmalloc_pool *pool,
+				 unsigned long size)
+{
+	struct vb2_cmalloc_pool_entry *entry;
+	struct page *pages = NULL;
+
+	mutex_lock(&pool->lock);
+	list_for_each_entry(entry, &pool->free_list, list) {
+		if (entry->size == size) {
+			pages = entry->pages;
+			list_del(&entry->list);
+			pool->bytes_held -= size;
+			kfree(entry);
+			break;
+		}
+	}
+	if (pages)
+		pool->hits++;
+	else
+		pool->misses++;
+	mutex_unlock(&pool->lock);
+
+	return pages;
+}
+
+static int cma_pool_put(struct vb2_cmalloc_pool *pool,
+			struct page *pages, unsigned long size)
+{
+	struct vb2_cmalloc_pool_entry *entry;
+
+	if (size > pool->high_water)
+		return -1;
+
+	entry = kmalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry)
+		return -1;
+
+	entry->pages = pages;
+	entry->size = size;
+
+	mutex_lock(&pool->lock);
+	list_add(&entry->list, &pool->free_list);
+	pool->bytes_held += size;
+	pool->parked++;
+	cma_pool_trim(pool, pool->high_water);
+	mutex_unlock(&pool->lock);
+
+	return 0;
+}
+
+static unsigned long cma_pool_shrink_count(struct shrinker *shrink,
+					   struct shrink_control *sc)
+{
+	struct vb2_cmalloc_pool *pool =
+		container_of(shrink, struct vb2_cmalloc_pool, shrinker);
+
+	return pool->bytes_held >> PAGE_SHIFT;
+}
+
+static unsigned long cma_pool_shrink_scan(struct shrinker *shrink,
+					  struct shrink_control *sc)
+{
+	struct vb2_cmalloc_pool *pool =
+		container_of(shrink, struct vb2_cmalloc_pool, shrinker);
+	unsigned long want = sc->nr_to_scan << PAGE_SHIFT;
+	unsigned long freed;
+
+	if (!mutex_trylock(&pool->lock))
+		return SHRINK_STOP;
+
+	if (want >= pool->bytes_held)
+		freed = cma_pool_trim(pool, 0);
+	else
+		freed = cma_pool_trim(pool, pool->bytes_held - want);
+	mutex_unlock(&pool->lock);
+
+	return freed >> PAGE_SHIFT;
+}
+
+static int cma_pool_stats_show(struct seq_file *m, void *v)
+{
+	struct vb2_cmalloc_pool *pool = m->private;
+	struct vb2_cmalloc_pool_entry *entry;
+	int i;
+
+	mutex_lock(&pool->lock);
+	seq_printf(m, "hits:        %llu\n", pool->hits);
+	seq_printf(m, "misses:      %llu\n", pool->misses);
+	seq_printf(m, "alloc_fail:  %llu\n", pool->alloc_fail);
+	seq_printf(m, "parked:      %llu\n", pool->parked);
+	seq_printf(m, "released:    %llu\n", pool->released);
+	seq_printf(m, "bytes_held:  %lu\n", pool->bytes_held);
+	seq_printf(m, "high_water:  %lu\n", pool->high_water);
+
+	seq_puts(m, "held:");
+	list_for_each_entry(entry, &pool->free_list, list)
+		seq_printf(m, " %lu", entry->size);
+	seq_puts(m, "\n");
+
+	seq_printf(m, "%-10s %12s %12s\n", "latency", "hit", "miss");
+	for (i = 0; i < CMALLOC_LAT_BUCKETS; i++)
+		seq_printf(m, "%-10s %12llu %12llu\n", cmalloc_lat_names[i],
+			   pool->lat_hist[0][i], pool->lat_hist[1][i]);
+	mutex_unlock(&pool->lock);
+
+	return 0;
+}
+
+static int cma_pool_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, cma_pool_stats_show, inode->i_private);
+}
+
+static const struct file_operations cma_pool_stats_fops = {
+	.owner		= THIS_MODULE,
+	.open		= cma_pool_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int cma_pool_high_water_get(void *data, u64 *val)
+{
+	struct vb2_cmalloc_pool *pool = data;
+
+	*val = pool->high_water;
+	return 0;
+}
+
+static int cma_pool_high_water_set(void *data, u64 val)
+{
+	struct vb2_cmalloc_pool *pool = data;
+
+	mutex_lock(&pool->lock);
+	pool->high_water = val;
+	cma_pool_trim(pool, pool->high_water);
+	mutex_unlock(&pool->lock);
+
+	return 0;
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(cma_pool_high_water_fops, cma_pool_high_water_get,
+			cma_pool_high_water_set, "%llu\n");
+
+int vb2_cmalloc_pool_init(struct device *dev, unsigned long high_water)
+{
+	struct vb2_cmalloc_pool *pool;
+	int rc;
+
+	mutex_lock(&cmalloc_pool_lock);
+	if (cmalloc_pool) {
+		rc = -EBUSY;
+		goto out;
+	}
+
+	pool = kzalloc(sizeof(*pool), GFP_KERNEL);
+	if (!pool) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	pool->dev = dev;
+	pool->high_water = high_water;
+	mutex_init(&pool->lock);
+	INIT_LIST_HEAD(&pool->free_list);
+
+	pool->shrinker.count_objects = cma_pool_shrink_count;
+	pool->shrinker.scan_objects = cma_pool_shrink_scan;
+	pool->shrinker.seeks = DEFAULT_SEEKS;
+	rc = register_shrinker(&pool->shrinker);
+	if (rc) {
+		kfree(pool);
+		goto out;
+	}
+
+	/* statistics are optional, the pool works without debugfs */
+	pool->debugfs = debugfs_create_dir("isp_cma_pool", NULL);
+	if (!IS_ERR_OR_NULL(pool->debugfs)) {
+		debugfs_create_file("stats", 0444, pool->debugfs,
+				    pool, &cma_pool_stats_fops);
+		debugfs_create_file("high_water", 0644, pool->debugfs,
+				    pool, &cma_pool_high_water_fops);
+	}
+
+	cmalloc_pool = pool;
+
+out:
+	mutex_unlock(&cmalloc_pool_lock);
+
+	return rc;
+}
+
+void vb2_cmalloc_pool_release(void)
+{
+	struct vb2_cmalloc_pool *pool;
+
+	/* held until the pool is gone, cma_alloc/cma_free may be using it */
+	mutex_lock(&cmalloc_pool_lock);
+	pool = cmalloc_pool;
+	if (!pool) {
+		mutex_unlock(&cmalloc_pool_lock);
+		return;
+	}
+
+	/* buffers still owned by vb2 go straight back to CMA from now on */
+	cmalloc_pool = NULL;
+
+	debugfs_remove_recursive(pool->debugfs);
+	unregister_shrinker(&pool->shrinker);
+
+	mutex_lock(&pool->lock);
+	cma_pool_trim(pool, 0);
+	mutex_unlock(&pool->lock);
+
+	kfree(pool);
+	mutex_unlock(&cmalloc_pool_lock);
+}
+
 static void *cma_alloc(struct device *dev, unsigned long size)
 {
+    struct vb2_cmalloc_pool *pool;
     struct page *cma_pages = NULL;
     dma_addr_t paddr = 0;
     void *vaddr = NULL;
+    ktime_t start = ktime_get();
+
+    mutex_lock(&cmalloc_pool_lock);
+    pool = cmalloc_pool;
+    if (pool && pool->dev != dev)
+        pool = NULL;
+
+    if (pool) {
+        cma_pages = cma_pool_get(pool, size);
+        if (cma_pages) {
+            cma_pool_account_latency(pool, 0, start);
+            mutex_unlock(&cmalloc_pool_lock);
+            return phys_to_virt(page_to_phys(cma_pages));
+        }
+    }
 
     cma_pages = dma_alloc_from_contiguous(dev,
             size >> PAGE_SHIFT, 0);
+    if (!cma_pages && pool && pool->bytes_held) {
+        /* parked regions of other sizes may be what fragments CMA */
+        mutex_lock(&pool->lock);
+        cma_pool_trim(pool, 0);
+        mutex_unlock(&pool->lock);
+        cma_pages = dma_alloc_from_contiguous(dev,
+                size >> PAGE_SHIFT, 0);
+    }
+
     if (cma_pages) {
         paddr = page_to_phys(cma_pages);
     } else {
+        if (pool) {
+            mutex_lock(&pool->lock);
+            pool->alloc_fail++;
+            mutex_unlock(&pool->lock);
+        }
+        mutex_unlock(&cmalloc_pool_lock);
         pr_err("Failed to alloc cma pages.\n");
         return NULL;
     }
 
+    if (pool)
+        cma_pool_account_latency(pool, 1, start);
+    mutex_unlock(&cmalloc_pool_lock);
+
     vaddr = phys_to_virt(paddr);
 
     return vaddr;
@@ -44,6 +396,7 @@ static void *cma_alloc(struct device *dev, unsigned long size)
 static void cma_free(void *buf_priv)
 {
     struct vb2_cmalloc_buf *buf = buf_priv;
+    struct vb2_cmalloc_pool *pool;
     struct page *cma_pages = NULL;
     struct device *dev = NULL;
     bool rc = -1;
@@ -52,6 +405,16 @@ static void cma_free(void *buf_priv)
 
     cma_pages = virt_to_page(buf->vaddr);
 
+    mutex_lock(&cmalloc_pool_lock);
+    pool = cmalloc_pool;
+    if (pool && pool->dev == dev &&
+        cma_pool_put(pool, cma_pages, buf->size) == 0) {
+        mutex_unlock(&cmalloc_pool_lock);
+        buf->vaddr = NULL;
+        return;
+    }
+    mutex_unlock(&cmalloc_pool_lock);
+
     rc = dma_release_from_contiguous(dev, cma_pages,
                 buf->size >> PAGE_SHIFT);
     if (rc == false) {
@@ -97,6 +460,8 @@ static void *vb2_cmalloc_alloc(struct device *dev, unsigned long attrs,
 		return ERR_PTR(-ENOMEM);
 	}
 
+	buf->dma_addr = virt_to_phys(buf->vaddr);
+
 	atomic_inc(&buf->refcount);
 	return buf;
 }
@@ -181,6 +546,9 @@ static void *vb2_cmalloc_vaddr(void *buf_priv)
 {
 	struct vb2_cmalloc_buf *buf = buf_priv;
 
+	if (!buf->vaddr && buf->db_attach)
+		buf->vaddr = dma_buf_vmap(buf->db_attach->dmabuf);
+
 	if (!buf->vaddr) {
 		pr_err("Address of an unallocated plane requested "
 		       "or cannot map user pointer\n");
@@ -190,6 +558,13 @@ static void *vb2_cmalloc_vaddr(void *buf_priv)
 	return buf->vaddr;
 }
 
+static void *vb2_cmalloc_cookie(void *buf_priv)
+{
+	struct vb2_cmalloc_buf *buf = buf_priv;
+
+	return &buf->dma_addr;
+}
+
 static unsigned int vb2_cmalloc_num_users(void *buf_priv)
 {
 	struct vb2_cmalloc_buf *buf = buf_priv;
@@ -403,6 +778,145 @@ static struct dma_buf *vb2_cmalloc_get_dmabuf(void *buf_priv, unsigned long flag
 	return dbuf;
 }
 
+static unsigned long vb2_cmalloc_contiguous_size(struct sg_table *sgt)
+{
+	struct scatterlist *s;
+	dma_addr_t expected = sg_dma_address(sgt->sgl);
+	unsigned int i;
+	unsigned long size = 0;
+
+	for_each_sg(sgt->sgl, s, sgt->nents, i) {
+		if (sg_dma_address(s) != expected)
+			break;
+		expected = sg_dma_address(s) + sg_dma_len(s);
+		size += sg_dma_len(s);
+	}
+
+	return size;
+}
+
+/*
+ * The attachment is mapped once, on the first QBUF, and stays mapped until
+ * vb2 detaches it (different fd queued, REQBUFS or close). QBUF/DQBUF of
+ * the same dmabuf only hand the cache lines back and forth.
+ */
+static int vb2_cmalloc_map_dmabuf(void *mem_priv)
+{
+	struct vb2_cmalloc_buf *buf = mem_priv;
+	struct sg_table *sgt;
+	unsigned long contig_size;
+
+	if (WARN_ON(!buf->db_attach)) {
+		pr_err("trying to pin a non attached buffer\n");
+		return -EINVAL;
+	}
+
+	if (buf->dma_sgt) {
+		dma_sync_sg_for_device(buf->dev, buf->dma_sgt->sgl,
+				       buf->dma_sgt->orig_nents, buf->dma_dir);
+		return 0;
+	}
+
+	sgt = dma_buf_map_attachment(buf->db_attach, buf->dma_dir);
+	if (IS_ERR(sgt)) {
+		pr_err("Error getting dmabuf scatterlist\n");
+		return -EINVAL;
+	}
+
+	/* the ISP DMA writer only takes a single base address per plane */
+	contig_size = vb2_cmalloc_contiguous_size(sgt);
+	if (contig_size < buf->size) {
+		pr_err("dmabuf is not contiguous: %lu of %lu bytes, "
+		       "import from a CMA backed exporter\n",
+		       contig_size, buf->size);
+		dma_buf_unmap_attachment(buf->db_attach, sgt, buf->dma_dir);
+		return -EFAULT;
+	}
+
+	buf->dma_addr = sg_dma_address(sgt->sgl);
+	buf->dma_sgt = sgt;
+	buf->vaddr = NULL;
+
+	return 0;
+}
+
+static void vb2_cmalloc_unmap_dmabuf(void *mem_priv)
+{
+	struct vb2_cmalloc_buf *buf = mem_priv;
+
+	if (WARN_ON(!buf->db_attach)) {
+		pr_err("trying to unpin a not attached buffer\n");
+		return;
+	}
+
+	if (!buf->dma_sgt)
+		return;
+
+	/* keep the mapping, see vb2_cmalloc_map_dmabuf() */
+	dma_sync_sg_for_cpu(buf->dev, buf->dma_sgt->sgl,
+			    buf->dma_sgt->orig_nents, buf->dma_dir);
+}
+
+static void vb2_cmalloc_release_dmabuf_map(struct vb2_cmalloc_buf *buf)
+{
+	struct dma_buf *dbuf = buf->db_attach->dmabuf;
+
+	if (!buf->dma_sgt)
+		return;
+
+	if (buf->vaddr) {
+		dma_buf_vunmap(dbuf, buf->vaddr);
+		buf->vaddr = NULL;
+	}
+
+	dma_buf_unmap_attachment(buf->db_attach, buf->dma_sgt, buf->dma_dir);
+	buf->dma_sgt = NULL;
+	buf->dma_addr = 0;
+}
+
+static void vb2_cmalloc_detach_dmabuf(void *mem_priv)
+{
+	struct vb2_cmalloc_buf *buf = mem_priv;
+
+	vb2_cmalloc_release_dmabuf_map(buf);
+
+	dma_buf_detach(buf->db_attach->dmabuf, buf->db_attach);
+	kfree(buf);
+}
+
+static void *vb2_cmalloc_attach_dmabuf(struct device *dev, struct dma_buf *dbuf,
+	unsigned long size, enum dma_data_direction dma_dir)
+{
+	struct vb2_cmalloc_buf *buf;
+	struct dma_buf_attachment *dba;
+
+	if (WARN_ON(!dev))
+		return ERR_PTR(-EINVAL);
+
+	if (dbuf->size < size) {
+		pr_err("dmabuf too small (%zu < %lu)\n", dbuf->size, size);
+		return ERR_PTR(-EFAULT);
+	}
+
+	buf = kzalloc(sizeof(*buf), GFP_KERNEL);
+	if (!buf)
+		return ERR_PTR(-ENOMEM);
+
+	buf->dev = dev;
+	dba = dma_buf_attach(dbuf, dev);
+	if (IS_ERR(dba)) {
+		pr_err("failed to attach dmabuf\n");
+		kfree(buf);
+		return dba;
+	}
+
+	buf->dma_dir = dma_dir;
+	buf->size = size;
+	buf->db_attach = dba;
+
+	return buf;
+}
+
 const struct vb2_mem_ops vb2_cmalloc_memops = {
 	.alloc		= vb2_cmalloc_alloc,
 	.put		= vb2_cmalloc_put,
@@ -411,11 +925,12 @@ const struct vb2_mem_ops vb2_cmalloc_memops = {
 #ifdef CONFIG_HAS_DMA
 	.get_dmabuf	= vb2_cmalloc_get_dmabuf,
 #endif
-	.map_dmabuf	= NULL,
-	.unmap_dmabuf	= NULL,
-	.attach_dmabuf	= NULL,
-	.detach_dmabuf	= NULL,
+	.map_dmabuf	= vb2_cmalloc_map_dmabuf,
+	.unmap_dmabuf	= vb2_cmalloc_unmap_dmabuf,
+	.attach_dmabuf	= vb2_cmalloc_attach_dmabuf,
+	.detach_dmabuf	= vb2_cmalloc_detach_dmabuf,
 	.vaddr		= vb2_cmalloc_vaddr,
+	.cookie		= vb2_cmalloc_cookie,
 	.mmap		= vb2_cmalloc_mmap,
 	.num_users	= vb2_cmalloc_num_users,
 };
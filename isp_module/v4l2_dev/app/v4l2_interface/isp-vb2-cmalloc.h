@@ -18,6 +18,10 @@
 
 extern const struct vb2_mem_ops vb2_cmalloc_memops;
 
+/* reuse pool for freed CMA regions of the given device */
+int vb2_cmalloc_pool_init(struct device *dev, unsigned long high_water);
+void vb2_cmalloc_pool_release(void);
+
 struct vb2_cmalloc_buf {
 	void				*vaddr;
 	struct frame_vector		*vec;
@@ -26,7 +30,23 @@ struct vb2_cmalloc_buf {
 	atomic_t			refcount;
 	struct vb2_vmarea_handler	handler;
 	struct dma_buf			*dbuf;
+
+	/* bus address programmed into the ISP DMA writer */
+	dma_addr_t			dma_addr;
+
+	/* imported dmabuf: attachment and its cached mapping */
+	struct device			*dev;
+	struct dma_buf_attachment	*db_attach;
+	struct sg_table			*dma_sgt;
 };
 
+static inline dma_addr_t
+vb2_cmalloc_plane_paddr(struct vb2_buffer *vb, unsigned int plane_no)
+{
+	dma_addr_t *addr = vb2_plane_cookie(vb, plane_no);
+
+	return addr ? *addr : 0;
+}
+
 
 #endif
@@ -137,8 +137,9 @@ static int isp_vb2_buf_prepare( struct vb2_buffer *vb )
 
 static int isp_vb_to_tframe(tframe_t *frame, isp_v4l2_buffer_t *buf)
 {
-    void *p_mem = NULL;
-    void *s_mem = NULL;
+    struct vb2_buffer *vb = NULL;
+    dma_addr_t p_addr = 0;
+    dma_addr_t s_addr = 0;
     unsigned int p_size = 0;
     unsigned int s_size = 0;
 
@@ -147,15 +148,25 @@ static int isp_vb_to_tframe(tframe_t *frame, isp_v4l2_buffer_t *buf)
         return -1;
     }
 
-    p_mem = vb2_plane_vaddr(&buf->vvb.vb2_buf, 0);
-    p_size = PAGE_ALIGN(buf->vvb.vb2_buf.planes[0].length);
+    vb = &buf->vvb.vb2_buf;
 
-    s_mem = vb2_plane_vaddr(&buf->vvb.vb2_buf, 1);
-    s_size = PAGE_ALIGN(buf->vvb.vb2_buf.planes[1].length);
+    /* same for MMAP and imported DMABUF planes */
+    p_addr = vb2_cmalloc_plane_paddr(vb, 0);
+    p_size = PAGE_ALIGN(vb->planes[0].length);
 
-    frame->primary.address = virt_to_phys(p_mem);
+    if (vb->num_planes > 1) {
+        s_addr = vb2_cmalloc_plane_paddr(vb, 1);
+        s_size = PAGE_ALIGN(vb->planes[1].length);
+    }
+
+    if (p_addr == 0) {
+        LOG(LOG_ERR, "buffer %u has no physical address (memory %u)", vb->index, vb->memory);
+        return -1;
+    }
+
+    frame->primary.address = p_addr;
     frame->primary.size = p_size;
-    frame->secondary.address = virt_to_phys(s_mem);
+    frame->secondary.address = s_addr;
     frame->secondary.size = s_size;
     frame->list = (void *)&buf->list;
 
@@ -274,7 +285,7 @@ int isp_vb2_queue_init( struct vb2_queue *q, struct mutex *mlock, isp_v4l2_strea
         q->mem_ops = &vb2_vmalloc_memops;
     }
 
-    q->io_modes = VB2_MMAP | VB2_READ;
+    q->io_modes = VB2_MMAP | VB2_READ | VB2_DMABUF;
     q->drv_priv = pstream;
     q->buf_struct_size = sizeof( isp_v4l2_buffer_t );
 
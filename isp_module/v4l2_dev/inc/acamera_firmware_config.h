@@ -59,6 +59,7 @@
 #define FW_DO_INITIALIZATION 1
 #define FW_DS1_OUTPUT_FORMAT_PIPE PIPE_OUT_RGB
 #define FW_EVT_QUEUE_TIMEOUT_MS 100
+#define FW_FAST_MATH 1
 #define FW_FR_OUTPUT_FORMAT_PIPE PIPE_OUT_RGB
 #define FW_HAS_CONTROL_CHANNEL 1
 #define FW_INPUT_FORMAT DMA_FORMAT_RAW16
@@ -84,6 +85,7 @@
 #define ISP_DISPLAY_MODE 1080
 #define ISP_DMA_RAW_BANKS 0
 #define ISP_DMA_RAW_CAPTURE 0
+#define ISP_FRAME_TIMELINE 1
 #define ISP_FULL_HISTOGRAM_SIZE 1024
 #define ISP_FW_BUILD 1
 #define ISP_GAMMA_LUT_SIZE 129
@@ -322,6 +322,8 @@
 #define SCALER_SRC_HEIGHT                                 0x00000077
 #define AE_ZONE_WEIGHT                                    0x00000078
 #define AWB_ZONE_WEIGHT                                   0x00000079
+#define SENSOR_SWITCH_TIME                                0x0000007A
+#define STALE_CONFIG_FRAMES                               0x0000007B
 // ------------------------------------------------------------------------------ //
 //		VALUE LIST
 // ------------------------------------------------------------------------------ //
@@ -415,6 +417,31 @@
 #define API_VERSION                                       0x00000064
 
 
+// ------------------------------------------------------------------------------ //
+//		COMMAND TABLE FLAGS
+// ------------------------------------------------------------------------------ //
+#define CMD_FLAG_GET                                      0x00000001
+#define CMD_FLAG_SET                                      0x00000002
+#define CMD_FLAG_ATOMIC                                   0x00000004 // handler neither sleeps nor talks to the sensor
+#define CMD_FLAG_RANGE                                    0x00000008 // SET value checked against min/max
+
+typedef struct _acamera_command_stats_t {
+	uint32_t calls;
+	uint32_t fails;
+	uint64_t time_ns;
+	uint32_t max_time_ns;
+} acamera_command_stats_t;
+
+typedef struct _acamera_command_info_t {
+	uint8_t command_type;
+	uint8_t command;
+	uint8_t flags;
+	uint32_t min;
+	uint32_t max;
+	acamera_command_stats_t stats;
+} acamera_command_info_t;
+
+
 // ------------------------------------------------------------------------------ //
 //		SET/GET FUNCTION
 // ------------------------------------------------------------------------------ //
@@ -424,12 +451,21 @@
 //The main api function to control and change the firmware state
 uint8_t acamera_command( uint8_t command_type, uint8_t command, uint32_t value, uint8_t direction, uint32_t *ret_value);
 
+//Look a command up without calling it, returns SUCCESS, NOT_EXISTS or NOT_PERMITTED for the direction.
+uint8_t acamera_command_check( uint8_t command_type, uint8_t command, uint8_t direction);
+
+//Walk the command table, idx from 0 until it returns -1.
+int32_t acamera_command_get_info( uint32_t idx, acamera_command_info_t *info);
+void acamera_command_reset_stats( void );
+
 //The function to change firmware internal calibrations.
 uint8_t acamera_api_calibration( uint8_t type, uint8_t id, uint8_t direction, void* data, uint32_t data_size, uint32_t* ret_value);
 
 uint8_t acamera_api_dma_buffer( uint8_t type, void* data, uint32_t data_size, uint32_t* ret_value);
 void acamera_api_dma_buff_queue_reset(uint8_t type);
 uint8_t acamera_api_set_fps(uint8_t type, uint32_t c_fps, uint32_t t_fps);
+//Rates of a dma pipe and the frames it wrote or skipped since the rate was set.
+uint8_t acamera_api_get_fps(uint8_t type, uint32_t *c_fps, uint32_t *t_fps, uint32_t *delivered, uint32_t *skipped);
 void acamera_api_dma_buff_get_next(uint8_t type);
 
 #endif//_ACAMERA_COMMAND_API_H_
@@ -80,4 +80,91 @@ int32_t acamera_process( void );
 int32_t acamera_interrupt_handler( void );
 
 
+/**
+ *   Process an already latched interrupt vector
+ *
+ *   Same as acamera_interrupt_handler but the ISP interrupt status vector has been read and cleared by the caller,
+ *   which allows the platform to do that in the hard interrupt and run the processing from a thread.
+ *
+ *   @param  irq_mask - ISP interrupt status vector
+ *
+ *   @return 0 - success
+ *          -1 - fail.
+ */
+int32_t acamera_interrupt_process( uint32_t irq_mask );
+
+
+#define ACAMERA_ISP_RECOVERY_HIST_BINS 8
+
+typedef struct _acamera_isp_error_stats_t {
+    uint32_t irq_errors[32];                                // error interrupts per ISP_INTERRUPT_EVENT_* bit
+    uint32_t recoveries;                                    // recoveries started
+    uint32_t retries;                                       // safe stops requested again after a stop timeout
+    uint32_t full_resets;                                   // recoveries escalated to a full reset
+    uint32_t reported;                                      // recoveries reported to the application
+    uint32_t duration_hist[ACAMERA_ISP_RECOVERY_HIST_BINS]; // bin n counts recoveries shorter than 2^n ms, the last one all longer
+    uint32_t max_duration_ms;
+    uint32_t active; // a recovery is in progress
+} acamera_isp_error_stats_t;
+
+
+/**
+ *   Read the ISP error recovery statistics
+ *
+ *   @param  p_stats - filled with the counters collected since init or the last reset
+ *
+ *   @return 0 - success
+ *          -1 - fail.
+ */
+int32_t acamera_get_isp_error_stats( acamera_isp_error_stats_t *p_stats );
+
+
+/**
+ *   Clear the ISP error recovery statistics
+ */
+void acamera_reset_isp_error_stats( void );
+
+
+#define ACAMERA_CTRL_BATCH_MAX_CMDS 8
+#define ACAMERA_CTRL_BATCH_QUEUE_SIZE 4
+
+typedef struct _acamera_ctrl_batch_cmd_t {
+    uint8_t command_type;
+    uint8_t command;
+    uint32_t value;
+} acamera_ctrl_batch_cmd_t;
+
+typedef struct _acamera_ctrl_batch_t {
+    uint32_t id;           // chosen by the caller, handed back to callback_ctrl_batch
+    uint32_t target_frame; // metadata frame_id of the frame to apply at, 0 for the next frame start
+    uint32_t cmd_num;
+    acamera_ctrl_batch_cmd_t cmd[ACAMERA_CTRL_BATCH_MAX_CMDS];
+} acamera_ctrl_batch_t;
+
+
+/**
+ *   Queue SET commands to be applied together at a frame start
+ *
+ *   Frames are counted in the frame_id of the buffer metadata. The firmware thread runs all commands of
+ *   the batch back to back once the frame target_frame has started, before any FSM processing of that
+ *   frame. Batches are applied in the order of their target frames, a target frame that has already
+ *   started applies at the next frame start. settings.callback_ctrl_batch is called with the first frame
+ *   whose sensor exposure was computed after the batch, which is later than the frame it was applied at
+ *   by the AE and sensor latency, or with the frame after it for batches which do not change the exposure.
+ *
+ *   @param  p_batch - commands to apply, copied by the call
+ *
+ *   @return 0 - success
+ *          -1 - fail, the firmware is not running, the batch is malformed, holds a command which can not
+ *               be set or the queue is full.
+ */
+int32_t acamera_queue_ctrl_batch( const acamera_ctrl_batch_t *p_batch );
+
+
+/**
+ *   Metadata frame_id of the frame which has started last
+ */
+uint32_t acamera_get_frame_count( void );
+
+
 #endif // __ACAMERA_FIRMWARE_API_H__
@@ -24,6 +24,8 @@
 #include "acamera_sensor_api.h"
 #include "acamera_lens_api.h"
 
+struct _acamera_ctrl_batch_t;
+
 // formats which are supported on output of ISP
 // they can be used to set a desired output format
 // in acamera_settings structure
@@ -143,6 +145,8 @@ typedef struct _acamera_settings {
     tframe_t* ds2_frames ;                                              // frames to be used for the ds2 dma writer
     uint32_t  ds2_frames_number ;                                       // number of frames for ds2 pipe
     void (*callback_ds2)( uint32_t ctx_num, tframe_t * tframe, const metadata_t *metadata ) ; // callback on every DS2 output frame. can be null if there is no ds2 output
+    void (*callback_error)( uint32_t ctx_num, uint32_t irq_mask ) ;  // called from the firmware thread when ISP error recovery gave up. can be null
+    void (*callback_ctrl_batch)( uint32_t ctx_num, const struct _acamera_ctrl_batch_t *batch, uint32_t frame_id, uint32_t result ) ;  // called from the firmware thread after a queued command batch was applied. can be null
 } acamera_settings ;
 
 #endif
@@ -45,6 +45,8 @@ void system_interrupts_init( void );
  *   Set an interrupt handler
  *
  *   This function is used by application to set an interrupt handler for all ISP related interrupt events.
+ *   The handler runs in the interrupt thread and gets the ISP status vector latched and cleared by the
+ *   hard interrupt as mask.
  *
  *   @param
  *          handler - a callback to handle interrupts
@@ -68,5 +68,28 @@ void system_spinlock_unlock( sys_spinlock lock, unsigned long flags );
  */
 void system_spinlock_destroy( sys_spinlock lock );
 
+
+/**
+ *   Write memory barrier
+ *
+ *   Orders the stores issued before the call against the stores
+ *   issued after it, as seen from other CPUs. Used by lock-free
+ *   publishers together with a sequence counter.
+ *
+ *   @return  void
+ */
+void system_smp_wmb( void );
+
+
+/**
+ *   Read memory barrier
+ *
+ *   Orders the loads issued before the call against the loads
+ *   issued after it. Pairs with system_smp_wmb on the writer side.
+ *
+ *   @return  void
+ */
+void system_smp_rmb( void );
+
 //-----------------------------------------------------------------------------
 #endif //__SYSTEM_SPINLOCK_H__
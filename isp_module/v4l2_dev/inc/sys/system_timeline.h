@@ -0,0 +1,115 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_TIMELINE_H__
+#define __SYSTEM_TIMELINE_H__
+
+#include "acamera_types.h"
+#include "acamera_firmware_config.h"
+
+// frames kept per context, must be a power of two
+#define SYS_TIMELINE_DEPTH 64
+
+// output pipes with their own stages, in the order of the stage groups below
+#define SYS_TIMELINE_OUT_FR 0
+#define SYS_TIMELINE_OUT_DS1 1
+#define SYS_TIMELINE_OUT_DS2 2
+#define SYS_TIMELINE_OUT_MAX 3
+
+typedef enum {
+    SYS_TIMELINE_FRAME_START = 0, // frame start in the interrupt thread
+    SYS_TIMELINE_CONFIG_DMA,      // config and metering dma completed
+    SYS_TIMELINE_FSM_FRAME,       // frame end handled by the firmware thread
+    SYS_TIMELINE_CONFIG_COMMIT,   // software config committed for the next frame
+    SYS_TIMELINE_WRITER,          // dma writer done, one stage per output
+    SYS_TIMELINE_CALLBACK = SYS_TIMELINE_WRITER + SYS_TIMELINE_OUT_MAX,      // frame handed to v4l2
+    SYS_TIMELINE_COPY = SYS_TIMELINE_CALLBACK + SYS_TIMELINE_OUT_MAX,        // copy thread picked the frame up
+    SYS_TIMELINE_BUFFER_DONE = SYS_TIMELINE_COPY + SYS_TIMELINE_OUT_MAX,     // vb2 buffer returned, ready to DQBUF
+    SYS_TIMELINE_STAGE_MAX = SYS_TIMELINE_BUFFER_DONE + SYS_TIMELINE_OUT_MAX
+} system_timeline_stage_t;
+
+
+#if ISP_FRAME_TIMELINE
+
+/**
+ *   Initialize the frame timeline
+ *
+ *   Clears the per context rings and creates the isp_timeline debugfs directory
+ *   with the raw "records" and the percentile "summary" files.
+ *
+ *   @return none
+ */
+void system_timeline_init( void );
+
+
+/**
+ *   Release the frame timeline debugfs entries
+ *
+ *   @return none
+ */
+void system_timeline_deinit( void );
+
+
+/**
+ *   Start a frame record
+ *
+ *   Resets the ring slot of the frame and stamps SYS_TIMELINE_FRAME_START, so a
+ *   frame start that is repeated for the same frame id restarts its record.
+ *   Callable from any context.
+ *
+ *   @param   ctx_id - firmware context
+ *            frame_id - frame id as reported later in metadata_t.frame_id
+ *
+ *   @return none
+ */
+void system_timeline_frame_start( uint32_t ctx_id, uint32_t frame_id );
+
+
+/**
+ *   Stamp a stage of a frame
+ *
+ *   Only the first stamp of a stage is kept. Stamps for frames that already
+ *   left the ring are dropped. Callable from any context.
+ *
+ *   @param   ctx_id - firmware context
+ *            frame_id - frame id as reported later in metadata_t.frame_id
+ *            stage - one of system_timeline_stage_t
+ *
+ *   @return none
+ */
+void system_timeline_mark( uint32_t ctx_id, uint32_t frame_id, uint32_t stage );
+
+#define SYS_TIMELINE_FRAME_START_MARK( ctx_id, frame_id ) system_timeline_frame_start( ctx_id, frame_id )
+#define SYS_TIMELINE_MARK( ctx_id, frame_id, stage ) system_timeline_mark( ctx_id, frame_id, stage )
+
+#else
+
+static inline void system_timeline_init( void ) {}
+static inline void system_timeline_deinit( void ) {}
+
+#define SYS_TIMELINE_FRAME_START_MARK( ctx_id, frame_id ) \
+    do {                                                  \
+    } while ( 0 )
+#define SYS_TIMELINE_MARK( ctx_id, frame_id, stage ) \
+    do {                                             \
+    } while ( 0 )
+
+#endif // ISP_FRAME_TIMELINE
+
+#endif /* __SYSTEM_TIMELINE_H__ */
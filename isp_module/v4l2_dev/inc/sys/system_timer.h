@@ -45,6 +45,17 @@ void system_timer_init( void );
 uint32_t system_timer_timestamp( void );
 
 
+/**
+ *   Return a monotonic timestamp in nanoseconds
+ *
+ *   Unlike system_timer_timestamp this one has sub-tick resolution and is
+ *   meant for measuring short intervals. It must be callable from any context.
+ *
+ *   @return  current time in ns
+ */
+uint64_t system_timer_timestamp_ns( void );
+
+
 /**
  *   Return the system timer frequency
  *
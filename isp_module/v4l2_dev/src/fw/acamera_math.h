@@ -107,6 +107,10 @@ uint16_t acamera_line_offset( uint16_t line_len, uint8_t bytes_per_pixel );
 uint16_t acamera_calc_modulation_u16( uint16_t x, const modulation_entry_t *p_table, int table_len );
 uint32_t acamera_calc_modulation_u32( uint32_t x, const modulation_entry_32_t *p_table, int table_len );
 
+// Same as above, p_hint caches the last table segment for the call site
+uint16_t acamera_calc_modulation_u16_hint( uint16_t x, const modulation_entry_t *p_table, int table_len, uint16_t *p_hint );
+uint32_t acamera_calc_modulation_u32_hint( uint32_t x, const modulation_entry_32_t *p_table, int table_len, uint16_t *p_hint );
+
 uint16_t acamera_calc_scaled_modulation_u16( uint16_t x, uint16_t target_min_y, uint16_t target_max_y, const modulation_entry_t *p_table, int table_len );
 
 uint16_t acamera_calc_equidistant_modulation_u16( uint16_t x, const uint16_t *p_table, uint16_t table_len );
@@ -27,6 +27,7 @@
 #include "acamera_isp_core_nomem_settings.h"
 #include "system_stdlib.h"
 #include "system_dma.h"
+#include "system_timeline.h"
 #include "acamera_metering_stats_mem_config.h"
 #include "acamera_aexp_hist_stats_mem_config.h"
 #include "acamera_decompander0_mem_config.h"
@@ -84,6 +85,11 @@ int32_t acamera_get_context_number( void )
     return result;
 }
 
+uint32_t acamera_get_stale_config_count( void )
+{
+    return g_firmware.stale_config_count;
+}
+
 
 void *acamera_get_api_ctx_ptr( void )
 {
@@ -99,9 +105,258 @@ uintptr_t acamera_get_isp_sw_setting_base( void )
         return 0;
 }
 
-void acamera_notify_evt_data_avail( void )
+void acamera_notify_evt_data_avail( uint32_t ctx_id )
+{
+    acamera_wake( ACAMERA_WAKE_CTX( ctx_id ) );
+}
+
+void acamera_wake( uint32_t source )
+{
+    unsigned long flags;
+    uint32_t pending;
+    int bit;
+
+    flags = system_spinlock_lock( g_firmware.wake_lock );
+    pending = g_firmware.wake_mask;
+    g_firmware.wake_mask |= source;
+    for ( bit = 0; bit < ACAMERA_WAKE_SOURCES; bit++ ) {
+        if ( source & ( 1u << bit ) )
+            g_firmware.wake_count[bit]++;
+    }
+    system_spinlock_unlock( g_firmware.wake_lock, flags );
+
+    // the loop only goes to sleep after it has seen an empty mask
+    if ( !pending )
+        system_semaphore_raise( g_firmware.sem_evt_avail );
+}
+
+static uint32_t acamera_take_wake_mask( void )
+{
+    unsigned long flags;
+    uint32_t mask;
+
+    flags = system_spinlock_lock( g_firmware.wake_lock );
+    mask = g_firmware.wake_mask;
+    // stop stays pending until the thread is gone
+    g_firmware.wake_mask &= ACAMERA_WAKE_STOP;
+    system_spinlock_unlock( g_firmware.wake_lock, flags );
+
+    return mask;
+}
+
+static void acamera_wake_init( void )
+{
+    system_spinlock_init( &g_firmware.wake_lock );
+    system_memset( g_firmware.wake_count, 0, sizeof( g_firmware.wake_count ) );
+    // first pass services everything
+    g_firmware.wake_mask = ~ACAMERA_WAKE_STOP;
+}
+
+uint32_t acamera_get_wake_count( uint32_t bit )
+{
+    return bit < ACAMERA_WAKE_SOURCES ? g_firmware.wake_count[bit] : 0;
+}
+
+// wakeups of a single ACAMERA_WAKE_* source
+static uint32_t acamera_wake_count_of( uint32_t source )
+{
+    return source ? g_firmware.wake_count[__builtin_ctz( source )] : 0;
+}
+
+void acamera_process_stop( void )
+{
+    acamera_wake( ACAMERA_WAKE_STOP );
+}
+
+int32_t acamera_get_isp_error_stats( acamera_isp_error_stats_t *p_stats )
+{
+    unsigned long flags;
+
+    if ( p_stats == NULL || g_firmware.initialized != 1 )
+        return -1;
+
+    flags = system_spinlock_lock( g_firmware.recovery.lock );
+    system_memcpy( p_stats, &g_firmware.recovery.stats, sizeof( *p_stats ) );
+    system_spinlock_unlock( g_firmware.recovery.lock, flags );
+
+    return 0;
+}
+
+void acamera_reset_isp_error_stats( void )
+{
+    unsigned long flags;
+    uint32_t active;
+
+    if ( g_firmware.initialized != 1 )
+        return;
+
+    flags = system_spinlock_lock( g_firmware.recovery.lock );
+    active = g_firmware.recovery.stats.active;
+    system_memset( &g_firmware.recovery.stats, 0, sizeof( g_firmware.recovery.stats ) );
+    g_firmware.recovery.stats.active = active;
+    system_spinlock_unlock( g_firmware.recovery.lock, flags );
+}
+
+uint32_t acamera_get_frame_count( void )
+{
+    return g_firmware.ctrl_batch.frame;
+}
+
+static void acamera_ctrl_batch_init( void )
 {
-    system_semaphore_raise( g_firmware.sem_evt_avail );
+    system_spinlock_init( &g_firmware.ctrl_batch.lock );
+    g_firmware.ctrl_batch.frame = 0;
+    g_firmware.ctrl_batch.queued.count = 0;
+    g_firmware.ctrl_batch.report_num = 0;
+}
+
+int32_t acamera_queue_ctrl_batch( const acamera_ctrl_batch_t *p_batch )
+{
+    acamera_ctrl_batch_queue_t *p_queue = &g_firmware.ctrl_batch;
+    unsigned long flags;
+    uint32_t slot;
+    int32_t result;
+
+    if ( p_batch == NULL || p_batch->cmd_num == 0 || p_batch->cmd_num > ACAMERA_CTRL_BATCH_MAX_CMDS || g_firmware.initialized != 1 )
+        return -1;
+
+    // refuse the whole batch now rather than applying a part of it at the frame start
+    for ( slot = 0; slot < p_batch->cmd_num; slot++ ) {
+        if ( acamera_command_check( p_batch->cmd[slot].command_type, p_batch->cmd[slot].command, COMMAND_SET ) != SUCCESS ) {
+            LOG( LOG_ERR, "Control batch %u: command %d/%d can not be set", p_batch->id, p_batch->cmd[slot].command_type, p_batch->cmd[slot].command );
+            return -1;
+        }
+    }
+
+    flags = system_spinlock_lock( p_queue->lock );
+    result = acamera_ctrl_batch_insert( &p_queue->queued, p_batch, acamera_ctrl_batch_due_frame( p_batch->target_frame, p_queue->frame ) );
+    system_spinlock_unlock( p_queue->lock, flags );
+
+    if ( result != 0 )
+        LOG( LOG_ERR, "Control batch %u dropped, %d batches already queued", p_batch->id, ACAMERA_CTRL_BATCH_QUEUE_SIZE );
+
+    return result;
+}
+
+// called at frame start with the frame id the frame will carry, the batches themselves are applied by the firmware thread
+static void acamera_ctrl_batch_frame_start( uint32_t frame )
+{
+    acamera_ctrl_batch_queue_t *p_queue = &g_firmware.ctrl_batch;
+    unsigned long flags;
+    int due;
+
+    flags = system_spinlock_lock( p_queue->lock );
+    p_queue->frame = frame;
+    due = acamera_ctrl_batch_head_is_due( &p_queue->queued, frame );
+    system_spinlock_unlock( p_queue->lock, flags );
+
+    if ( due )
+        acamera_wake( ACAMERA_WAKE_CTRL_BATCH );
+}
+
+static int32_t acamera_ctrl_batch_get_exposure( void *priv, uint32_t frame_hw, uint32_t *p_updates )
+{
+    exposure_set_t exp_set;
+
+    if ( acamera_fsm_mgr_get_param( (acamera_fsm_mgr_t *)priv, FSM_PARAM_GET_FRAME_EXPOSURE_SET_BY_ID, &frame_hw, sizeof( frame_hw ), &exp_set, sizeof( exp_set ) ) != 0 )
+        return -1;
+
+    *p_updates = exp_set.data.update_count;
+
+    return 0;
+}
+
+static void acamera_ctrl_batch_report_done( acamera_context_ptr_t p_ctx, uint32_t idx, uint32_t frame_hw )
+{
+    acamera_ctrl_batch_queue_t *p_queue = &g_firmware.ctrl_batch;
+    acamera_ctrl_batch_report_t *p_report = &p_queue->report[idx];
+    uint32_t frame = frame_hw + p_ctx->isp_frame_hw_offset;
+
+    LOG( LOG_DEBUG, "Control batch %u in the exposure of frame %u, target %u", p_report->batch.id, frame, p_report->batch.target_frame );
+
+    if ( p_ctx->settings.callback_ctrl_batch != NULL ) {
+        p_ctx->settings.callback_ctrl_batch( p_ctx->context_id, &p_report->batch, frame, p_report->result );
+    }
+
+    p_queue->report_num--;
+    for ( ; idx < p_queue->report_num; idx++ )
+        p_queue->report[idx] = p_queue->report[idx + 1];
+}
+
+// tells the application about applied batches once their frame is known
+static void acamera_ctrl_batch_report( void )
+{
+    acamera_ctrl_batch_queue_t *p_queue = &g_firmware.ctrl_batch;
+    acamera_context_ptr_t p_ctx = (acamera_context_ptr_t)&g_firmware.fw_ctx[g_firmware.api_context];
+    uint32_t cur_hw;
+    uint32_t frame_hw;
+    uint32_t idx = 0;
+
+    if ( p_queue->report_num == 0 )
+        return;
+
+    cur_hw = acamera_isp_isp_global_dbg_frame_cnt_ctx0_read( p_ctx->settings.isp_base );
+    while ( idx < p_queue->report_num ) {
+        if ( acamera_ctrl_batch_exposure_frame( &p_queue->report[idx], cur_hw, acamera_ctrl_batch_get_exposure, &p_ctx->fsm_mgr, &frame_hw ) )
+            acamera_ctrl_batch_report_done( p_ctx, idx, frame_hw );
+        else
+            idx++;
+    }
+}
+
+static void acamera_ctrl_batch_process( void )
+{
+    acamera_ctrl_batch_queue_t *p_queue = &g_firmware.ctrl_batch;
+    acamera_context_ptr_t p_ctx = (acamera_context_ptr_t)&g_firmware.fw_ctx[g_firmware.api_context];
+    acamera_ctrl_batch_report_t *p_report;
+    acamera_ctrl_batch_t batch;
+    unsigned long flags;
+    uint32_t frame;
+    uint32_t idx;
+    uint32_t ret_value;
+    uint8_t status;
+    int32_t rc;
+    int taken;
+
+    for ( ;; ) {
+        flags = system_spinlock_lock( p_queue->lock );
+        frame = p_queue->frame;
+        taken = acamera_ctrl_batch_take( &p_queue->queued, frame, &batch );
+        system_spinlock_unlock( p_queue->lock, flags );
+
+        if ( !taken )
+            break;
+
+        // the oldest report goes out with what it has when the new batch needs its slot
+        if ( p_queue->report_num == ACAMERA_CTRL_BATCH_QUEUE_SIZE )
+            acamera_ctrl_batch_report_done( p_ctx, 0, p_queue->report[0].applied_hw + 1 );
+        p_report = &p_queue->report[p_queue->report_num];
+        system_memcpy( &p_report->batch, &batch, sizeof( batch ) );
+
+        p_report->applied_hw = acamera_isp_isp_global_dbg_frame_cnt_ctx0_read( p_ctx->settings.isp_base );
+        p_report->next_hw = p_report->applied_hw + 1;
+        rc = acamera_fsm_mgr_get_param( &p_ctx->fsm_mgr, FSM_PARAM_GET_CMOS_EXPOSURE_UPDATES, NULL, 0, &p_report->exposure_updates, sizeof( p_report->exposure_updates ) );
+
+        // the FSMs run on this thread too, so none of them sees a partly applied batch
+        p_report->result = SUCCESS;
+        for ( idx = 0; idx < p_report->batch.cmd_num; idx++ ) {
+            acamera_ctrl_batch_cmd_t *p_cmd = &p_report->batch.cmd[idx];
+
+            status = acamera_command( p_cmd->command_type, p_cmd->command, p_cmd->value, COMMAND_SET, &ret_value );
+            if ( status != SUCCESS ) {
+                LOG( LOG_ERR, "Control batch %u: command %d/%d failed with %d", p_report->batch.id, p_cmd->command_type, p_cmd->command, status );
+                if ( p_report->result == SUCCESS )
+                    p_report->result = status;
+            }
+        }
+
+        LOG( LOG_DEBUG, "Control batch %u applied at frame %u, target %u", p_report->batch.id, frame, p_report->batch.target_frame );
+        p_queue->report_num++;
+
+        // without a cmos exposure to look at the batch counts from the next frame
+        if ( rc != 0 )
+            acamera_ctrl_batch_report_done( p_ctx, p_queue->report_num - 1, p_report->applied_hw + 1 );
+    }
 }
 
 
@@ -138,8 +393,51 @@ static int32_t validate_settings( acamera_settings *settings, uint32_t ctx_num )
 
 
 #define ACAMERA_CONTEXT_SIZE ACAMERA_ISP1_BASE_ADDR + ACAMERA_ISP1_SIZE
+#define ACAMERA_CONFIG_SIZE ( ACAMERA_CONTEXT_SIZE - ACAMERA_DECOMPANDER0_MEM_BASE_ADDR )
+
+// isp_sw_metering_dma only holds the stats the metering dma collects, back to back
+#define SW_METERING_HIST_SIZE ( ACAMERA_AEXP_HIST_STATS_MEM_SIZE + ACAMERA_IHIST_STATS_MEM_SIZE )
+#define SW_METERING_STATS_OFFSET SW_METERING_HIST_SIZE
+#define SW_METERING_DMA_SIZE ( SW_METERING_HIST_SIZE + ACAMERA_METERING_STATS_MEM_SIZE )
 
-static int32_t dma_channel_addresses_setup( void *isp_chan, void *metering_chan, void *sw_context_map, uint32_t idx )
+// copy the part of the software context which is uploaded to ping/pong
+static void acamera_copy_sw_config( volatile uint8_t *dst, volatile uint8_t *src )
+{
+    system_memcpy( (void *)( (uintptr_t)dst + ACAMERA_DECOMPANDER0_MEM_BASE_ADDR ),
+                   (void *)( (uintptr_t)src + ACAMERA_DECOMPANDER0_MEM_BASE_ADDR ),
+                   ACAMERA_CONFIG_SIZE );
+}
+
+// The firmware thread writes the software context while the frame start
+// interrupt uploads the committed copy, so a frame always starts with the
+// last complete configuration even if events are still being processed.
+static void acamera_commit_sw_config( acamera_context_ptr_t p_ctx )
+{
+    if ( p_ctx->sw_reg_map.isp_sw_config_commit == NULL )
+        return;
+
+    acamera_fw_interrupts_disable( p_ctx );
+    // the config dma reads the committed copy, never change it under a transfer
+    if ( g_firmware.dma_flag_isp_config_completed ) {
+        acamera_copy_sw_config( p_ctx->sw_reg_map.isp_sw_config_commit, p_ctx->sw_reg_map.isp_sw_config_map );
+        g_firmware.config_commit_count++;
+        SYS_TIMELINE_MARK( p_ctx->context_id, p_ctx->isp_frame_counter, SYS_TIMELINE_CONFIG_COMMIT );
+    }
+    acamera_fw_interrupts_enable( p_ctx );
+}
+
+// copy the metering stats which the frame start interrupt collects into the software context
+static void acamera_copy_sw_metering( volatile uint8_t *dst, volatile uint8_t *src )
+{
+    system_memcpy( (void *)( (uintptr_t)dst + ACAMERA_AEXP_HIST_STATS_MEM_BASE_ADDR ),
+                   (void *)src,
+                   SW_METERING_HIST_SIZE );
+    system_memcpy( (void *)( (uintptr_t)dst + ACAMERA_METERING_STATS_MEM_BASE_ADDR ),
+                   (void *)( (uintptr_t)src + SW_METERING_STATS_OFFSET ),
+                   ACAMERA_METERING_STATS_MEM_SIZE );
+}
+
+static int32_t dma_channel_addresses_setup( void *isp_chan, void *metering_chan, void *sw_metering_map, void *sw_commit_map, uint32_t idx )
 {
     int32_t result = 0;
     //PING ISP
@@ -152,8 +450,8 @@ static int32_t dma_channel_addresses_setup( void *isp_chan, void *metering_chan,
             result = -1;
         }
         fwmem_addr_pair_t fwmem_add_pair[2] = {
-            {(void *)( (uintptr_t)sw_context_map + ACAMERA_DECOMPANDER0_MEM_BASE_ADDR ), ACAMERA_ISP1_BASE_ADDR - ACAMERA_DECOMPANDER0_MEM_BASE_ADDR},
-            {(void *)( (uintptr_t)sw_context_map + ACAMERA_ISP1_BASE_ADDR ), ACAMERA_ISP1_SIZE}};
+            {(void *)( (uintptr_t)sw_commit_map + ACAMERA_DECOMPANDER0_MEM_BASE_ADDR ), ACAMERA_ISP1_BASE_ADDR - ACAMERA_DECOMPANDER0_MEM_BASE_ADDR},
+            {(void *)( (uintptr_t)sw_commit_map + ACAMERA_ISP1_BASE_ADDR ), ACAMERA_ISP1_SIZE}};
         if ( system_dma_sg_fwmem_setup( isp_chan, ISP_CONFIG_PING, fwmem_add_pair, 2 ) ) {
             LOG( LOG_CRIT, "ISP memory channel address setup for PING ctx:%d failed", idx );
             result = -1;
@@ -170,8 +468,8 @@ static int32_t dma_channel_addresses_setup( void *isp_chan, void *metering_chan,
         }
 
         fwmem_addr_pair_t fwmem_add_pair[2] = {
-            {(void *)( (uintptr_t)sw_context_map + ACAMERA_DECOMPANDER0_MEM_BASE_ADDR ), ACAMERA_ISP1_BASE_ADDR - ACAMERA_DECOMPANDER0_MEM_BASE_ADDR},
-            {(void *)( (uintptr_t)sw_context_map + ACAMERA_ISP1_BASE_ADDR ), ACAMERA_ISP1_SIZE}};
+            {(void *)( (uintptr_t)sw_commit_map + ACAMERA_DECOMPANDER0_MEM_BASE_ADDR ), ACAMERA_ISP1_BASE_ADDR - ACAMERA_DECOMPANDER0_MEM_BASE_ADDR},
+            {(void *)( (uintptr_t)sw_commit_map + ACAMERA_ISP1_BASE_ADDR ), ACAMERA_ISP1_SIZE}};
         if ( system_dma_sg_fwmem_setup( isp_chan, ISP_CONFIG_PONG, fwmem_add_pair, 2 ) ) {
             LOG( LOG_CRIT, "ISP memory channel address setup for PONG ctx:%d failed", idx );
             result = -1;
@@ -188,8 +486,8 @@ static int32_t dma_channel_addresses_setup( void *isp_chan, void *metering_chan,
         }
 
         fwmem_addr_pair_t fwmem_add_pair[2] = {
-            {(void *)( (uintptr_t)sw_context_map + ACAMERA_AEXP_HIST_STATS_MEM_BASE_ADDR ), ACAMERA_AEXP_HIST_STATS_MEM_SIZE + ACAMERA_IHIST_STATS_MEM_SIZE},
-            {(void *)( (uintptr_t)sw_context_map + ACAMERA_METERING_STATS_MEM_BASE_ADDR ), ACAMERA_METERING_STATS_MEM_SIZE}};
+            {sw_metering_map, SW_METERING_HIST_SIZE},
+            {(void *)( (uintptr_t)sw_metering_map + SW_METERING_STATS_OFFSET ), ACAMERA_METERING_STATS_MEM_SIZE}};
         if ( system_dma_sg_fwmem_setup( metering_chan, ISP_CONFIG_PING, fwmem_add_pair, 2 ) ) {
             LOG( LOG_CRIT, "Metering memory channel address setup for PING ctx:%d failed", idx );
             result = -1;
@@ -206,8 +504,8 @@ static int32_t dma_channel_addresses_setup( void *isp_chan, void *metering_chan,
         }
 
         fwmem_addr_pair_t fwmem_add_pair[2] = {
-            {(void *)( (uintptr_t)sw_context_map + ACAMERA_AEXP_HIST_STATS_MEM_BASE_ADDR ), ACAMERA_AEXP_HIST_STATS_MEM_SIZE + ACAMERA_IHIST_STATS_MEM_SIZE},
-            {(void *)( (uintptr_t)sw_context_map + ACAMERA_METERING_STATS_MEM_BASE_ADDR ), ACAMERA_METERING_STATS_MEM_SIZE}};
+            {sw_metering_map, SW_METERING_HIST_SIZE},
+            {(void *)( (uintptr_t)sw_metering_map + SW_METERING_STATS_OFFSET ), ACAMERA_METERING_STATS_MEM_SIZE}};
         if ( system_dma_sg_fwmem_setup( metering_chan, ISP_CONFIG_PONG, fwmem_add_pair, 2 ) ) {
             LOG( LOG_CRIT, "Metering memory channel address setup for PONG  ctx:%d failed", idx );
             result = -1;
@@ -233,6 +531,9 @@ int32_t acamera_init( acamera_settings *settings, uint32_t ctx_num )
         g_firmware.api_context = 0;
 
         system_semaphore_init( &g_firmware.sem_evt_avail );
+        acamera_wake_init();
+        acamera_fw_error_init( &g_firmware.recovery );
+        acamera_ctrl_batch_init();
 
         if ( ctx_num <= FIRMWARE_CONTEXT_NUMBER ) {
             uint32_t idx = 0;
@@ -281,6 +582,10 @@ void acamera_reset_ping_pong_port(void)
 {
 }
 
+void acamera_latch_metering_stats( acamera_context_ptr_t p_ctx )
+{
+}
+
 #else /* #if USER_MODULE */
 
 int32_t acamera_init( acamera_settings *settings, uint32_t ctx_num )
@@ -316,6 +621,9 @@ int32_t acamera_init( acamera_settings *settings, uint32_t ctx_num )
             g_firmware.api_context = 0;
 
             system_semaphore_init( &g_firmware.sem_evt_avail );
+            acamera_wake_init();
+            acamera_fw_error_init( &g_firmware.recovery );
+            acamera_ctrl_batch_init();
 
             if ( ctx_num <= FIRMWARE_CONTEXT_NUMBER ) {
                 uint32_t idx = 0;
@@ -337,9 +645,11 @@ int32_t acamera_init( acamera_settings *settings, uint32_t ctx_num )
                         // dump hw default configuration to the current context
 
                         p_ctx->sw_reg_map.isp_sw_config_map = system_sw_alloc( ACAMERA_CONTEXT_SIZE );
+                        p_ctx->sw_reg_map.isp_sw_config_commit = system_sw_alloc( ACAMERA_CONTEXT_SIZE );
+                        p_ctx->sw_reg_map.isp_sw_metering_dma = system_sw_alloc( SW_METERING_DMA_SIZE );
 
-                        if ( p_ctx->sw_reg_map.isp_sw_config_map ) {
-                            result = dma_channel_addresses_setup( g_firmware.dma_chan_isp_config, g_firmware.dma_chan_isp_metering, (void *)p_ctx->sw_reg_map.isp_sw_config_map, idx );
+                        if ( p_ctx->sw_reg_map.isp_sw_config_map && p_ctx->sw_reg_map.isp_sw_config_commit && p_ctx->sw_reg_map.isp_sw_metering_dma ) {
+                            result = dma_channel_addresses_setup( g_firmware.dma_chan_isp_config, g_firmware.dma_chan_isp_metering, (void *)p_ctx->sw_reg_map.isp_sw_metering_dma, (void *)p_ctx->sw_reg_map.isp_sw_config_commit, idx );
                         } else {
                             LOG( LOG_CRIT, "Software Context %d failed to allocate", idx );
                             result = -1;
@@ -349,11 +659,13 @@ int32_t acamera_init( acamera_settings *settings, uint32_t ctx_num )
                             break;
 
                         system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PING, SYS_DMA_FROM_DEVICE, 0 );
+                        acamera_copy_sw_config( p_ctx->sw_reg_map.isp_sw_config_map, p_ctx->sw_reg_map.isp_sw_config_commit );
                         // init context
                         result = acamera_init_context( p_ctx, &settings[idx], &g_firmware );
                         if ( result == 0 ) {
                             // initialize ping
                             LOG( LOG_INFO, "DMA config from DDR to ping and pong of size %d", ACAMERA_ISP1_SIZE );
+                            acamera_copy_sw_config( p_ctx->sw_reg_map.isp_sw_config_commit, p_ctx->sw_reg_map.isp_sw_config_map );
                             // system_dma_copy current software context to the ping and pong
                             system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PING, SYS_DMA_TO_DEVICE, 0 );
                             system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PONG, SYS_DMA_TO_DEVICE, 0 );
@@ -409,6 +721,8 @@ int32_t acamera_init( acamera_settings *settings, uint32_t ctx_num )
 
 void acamera_update_cur_settings_to_isp( int port )
 {
+    acamera_commit_sw_config( (acamera_context_ptr_t)&g_firmware.fw_ctx[0] );
+
     if (port == 0xff) {
         system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PING, SYS_DMA_TO_DEVICE, NULL );
         system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PONG, SYS_DMA_TO_DEVICE, NULL );
@@ -424,6 +738,26 @@ void acamera_reset_ping_pong_port(void)
     acamera_isp_isp_global_mcu_ping_pong_config_select_write( 0, ISP_CONFIG_PING );
 }
 
+// The frame start interrupt collects the metering stats into a buffer of its
+// own, the FSMs read the copy in the software context. It is refreshed here
+// when a new_frame is processed, after the events of the previous frame.
+void acamera_latch_metering_stats( acamera_context_ptr_t p_ctx )
+{
+    if ( p_ctx->sw_reg_map.isp_sw_metering_dma == NULL )
+        return;
+
+    acamera_fw_interrupts_disable( p_ctx );
+    // a transfer in flight finishes with its own new_frame, keep the last stats until then
+    if ( g_firmware.metering_stats_pending && g_firmware.dma_flag_isp_metering_completed ) {
+        acamera_copy_sw_metering( p_ctx->sw_reg_map.isp_sw_config_map, p_ctx->sw_reg_map.isp_sw_metering_dma );
+        g_firmware.metering_stats_pending = 0;
+    } else {
+        g_firmware.metering_stale_count++;
+        LOG( LOG_DEBUG, "No new metering stats for this frame, stale stats %u", g_firmware.metering_stale_count );
+    }
+    acamera_fw_interrupts_enable( p_ctx );
+}
+
 #endif /* #if USER_MODULE */
 
 static void acamera_deinit( void )
@@ -447,6 +781,16 @@ static void acamera_deinit( void )
             system_sw_free( (void *)p_ctx->sw_reg_map.isp_sw_config_map );
             p_ctx->sw_reg_map.isp_sw_config_map = NULL;
         }
+
+        if ( p_ctx->sw_reg_map.isp_sw_config_commit != NULL ) {
+            system_sw_free( (void *)p_ctx->sw_reg_map.isp_sw_config_commit );
+            p_ctx->sw_reg_map.isp_sw_config_commit = NULL;
+        }
+
+        if ( p_ctx->sw_reg_map.isp_sw_metering_dma != NULL ) {
+            system_sw_free( (void *)p_ctx->sw_reg_map.isp_sw_metering_dma );
+            p_ctx->sw_reg_map.isp_sw_metering_dma = NULL;
+        }
     }
 }
 
@@ -454,7 +798,13 @@ int32_t acamera_terminate()
 {
     acamera_logger_empty(); //empty the logger buffer and print remaining logs
     acamera_deinit();
+    LOG( LOG_INFO, "wakeups: ctx0 %u, ctrl channel %u, sbuf %u, command %u",
+         acamera_wake_count_of( ACAMERA_WAKE_CTX( 0 ) ), acamera_wake_count_of( ACAMERA_WAKE_CTRL_CHANNEL ),
+         acamera_wake_count_of( ACAMERA_WAKE_SBUF ), acamera_wake_count_of( ACAMERA_WAKE_COMMAND ) );
     system_semaphore_destroy( g_firmware.sem_evt_avail );
+    system_spinlock_destroy( g_firmware.wake_lock );
+    acamera_fw_error_deinit( &g_firmware.recovery );
+    system_spinlock_destroy( g_firmware.ctrl_batch.lock );
 
     return 0;
 }
@@ -465,6 +815,11 @@ int32_t acamera_interrupt_handler()
 {
     return 0;
 }
+
+int32_t acamera_interrupt_process( uint32_t irq_mask )
+{
+    return 0;
+}
 #else
 // single context handler
 
@@ -472,17 +827,13 @@ static void start_processing_frame( void )
 {
     acamera_context_ptr_t p_ctx = (acamera_context_ptr_t)&g_firmware.fw_ctx[0];
 
+    // the frame end handling of this frame bumps isp_frame_counter to its id
+    SYS_TIMELINE_MARK( p_ctx->context_id, p_ctx->isp_frame_counter + 1, SYS_TIMELINE_CONFIG_DMA );
+
     // new_frame event to start reading metering memory and run 3A
     acamera_fw_raise_event( p_ctx, event_id_new_frame );
 }
 
-static void start_dropping_frame( void )
-{
-    acamera_context_ptr_t p_ctx = (acamera_context_ptr_t)&g_firmware.fw_ctx[0];
-
-    acamera_fw_raise_event( p_ctx, event_id_drop_frame );
-}
-
 static void dma_complete_context_func( void *arg )
 {
     LOG( LOG_INFO, "DMA COMPLETION FOR CONTEXT" );
@@ -502,6 +853,7 @@ static void dma_complete_metering_func( void *arg )
 {
     LOG( LOG_INFO, "DMA COMPLETION FOR METERING" );
 
+    g_firmware.metering_stats_pending = 1;
     g_firmware.dma_flag_isp_metering_completed = 1;
 
     if ( g_firmware.dma_flag_isp_config_completed && g_firmware.dma_flag_isp_metering_completed ) {
@@ -513,50 +865,39 @@ static void dma_complete_metering_func( void *arg )
     // after we finish transfer context and metering we can start processing the current data
 }
 
-static void dma_drop_context_func( void *arg )
+// single context handler
+int32_t acamera_interrupt_handler()
 {
-    g_firmware.dma_flag_isp_config_completed = 1;
+    // read the irq vector from isp
+    uint32_t irq_mask = acamera_isp_isp_global_interrupt_status_vector_read( 0 );
 
-    if ( g_firmware.dma_flag_isp_config_completed && g_firmware.dma_flag_isp_metering_completed ) {
-        LOG( LOG_INFO, "START DROPPING FROM CONTEXT CALLBACK" );
-        start_dropping_frame();
-    }
+    // clear irq vector
+    acamera_isp_isp_global_interrupt_clear_write( 0, 0 );
+    acamera_isp_isp_global_interrupt_clear_write( 0, 1 );
 
-    system_dma_unmap_sg( arg );
+    return acamera_interrupt_process( irq_mask );
 }
 
-// single context handler
-int32_t acamera_interrupt_handler()
+int32_t acamera_interrupt_process( uint32_t irq_mask )
 {
     int32_t result = 0;
     int32_t irq_bit = ISP_INTERRUPT_EVENT_NONES_COUNT - 1;
     int not_empty = 0;
-    LOG( LOG_INFO, "Interrupt handler called" );
 
     acamera_context_ptr_t p_ctx = (acamera_context_ptr_t)&g_firmware.fw_ctx[0];
 
-    // read the irq vector from isp
-    uint32_t irq_mask = acamera_isp_isp_global_interrupt_status_vector_read( 0 );
-
     LOG( LOG_INFO, "IRQ MASK is %d", irq_mask );
 
-    // clear irq vector
-    acamera_isp_isp_global_interrupt_clear_write( 0, 0 );
-    acamera_isp_isp_global_interrupt_clear_write( 0, 1 );
-
     if ( irq_mask > 0 ) {
 
-#if defined( ISP_INTERRUPT_EVENT_BROKEN_FRAME ) && defined( ISP_INTERRUPT_EVENT_MULTICTX_ERROR ) && defined( ISP_INTERRUPT_EVENT_DMA_ERROR ) && defined( ISP_INTERRUPT_EVENT_WATCHDOG_EXP ) && defined( ISP_INTERRUPT_EVENT_FRAME_COLLISION )
+#if defined( ISP_RECOVERY_ERROR_MASK )
         //check for errors in the interrupt
-        if ( ( irq_mask & 1 << ISP_INTERRUPT_EVENT_BROKEN_FRAME ) ||
-             ( irq_mask & 1 << ISP_INTERRUPT_EVENT_MULTICTX_ERROR ) ||
-             ( irq_mask & 1 << ISP_INTERRUPT_EVENT_DMA_ERROR ) ||
-             ( irq_mask & 1 << ISP_INTERRUPT_EVENT_WATCHDOG_EXP ) ||
-             ( irq_mask & 1 << ISP_INTERRUPT_EVENT_FRAME_COLLISION ) ) {
+        if ( irq_mask & ISP_RECOVERY_ERROR_MASK ) {
 
             LOG( LOG_CRIT, "Found error resetting ISP. MASK is 0x%x", irq_mask );
 
-            acamera_fw_error_routine( p_ctx, irq_mask );
+            // the firmware thread completes the recovery
+            acamera_fw_error_routine( p_ctx, irq_mask & ISP_RECOVERY_ERROR_MASK );
             return -1; //skip other interrupts in case of error
         }
 #endif
@@ -568,6 +909,7 @@ int32_t acamera_interrupt_handler()
                 // process interrupts
                 if ( irq_bit == ISP_INTERRUPT_EVENT_ISP_START_FRAME_START ) {
                     LOG( LOG_INFO, "FS interrupt" );
+                    SYS_TIMELINE_FRAME_START_MARK( p_ctx->context_id, p_ctx->isp_frame_counter + 1 );
 
 #if ISP_DMA_RAW_CAPTURE
                     dma_raw_capture_interrupt( &g_firmware, ACAMERA_IRQ_FRAME_END );
@@ -577,8 +919,15 @@ int32_t acamera_interrupt_handler()
                         LOG( LOG_CRIT, "DMA is not finished, cfg: %d, meter: %d, skip this frame.", g_firmware.dma_flag_isp_config_completed, g_firmware.dma_flag_isp_metering_completed );
                         return -2;
                     }
+                    // pending events only mean the committed config is a frame older,
+                    // the frame is still processed and its events roll over
                     not_empty = acamera_event_queue_not_empty( &p_ctx->fsm_mgr.event_queue );
-                    // we must finish all previous processing before scheduling new dma
+                    g_firmware.frame_start_count++;
+                    if ( not_empty ) {
+                        g_firmware.stale_config_count++;
+                        LOG( LOG_DEBUG, "Events pending at frame start, stale config %u/%u", g_firmware.stale_config_count, g_firmware.frame_start_count );
+                    }
+                    acamera_ctrl_batch_frame_start( p_ctx->isp_frame_counter + 1 );
                     {
                         // switch to ping/pong contexts for the next frame
                         // these flags are used for sync of callbacks
@@ -598,17 +947,12 @@ int32_t acamera_interrupt_handler()
                             //            |^^^^^^^^^|
                             // conf --->  |  PONG   |
                             //            |_________|
-                            if (!not_empty) {
-                                LOG( LOG_INFO, "DMA metering from pong to DDR of size %d", ACAMERA_METERING_STATS_MEM_SIZE );
-                                // dma all stat memory only to the software context
-                                system_dma_copy_sg( g_firmware.dma_chan_isp_metering, ISP_CONFIG_PING, SYS_DMA_FROM_DEVICE, dma_complete_metering_func );
+                            LOG( LOG_INFO, "DMA metering from pong to DDR of size %d", ACAMERA_METERING_STATS_MEM_SIZE );
+                            // dma all stat memory to the metering buffer, the FSMs take it at new_frame
+                            system_dma_copy_sg( g_firmware.dma_chan_isp_metering, ISP_CONFIG_PING, SYS_DMA_FROM_DEVICE, dma_complete_metering_func );
 
-                                LOG( LOG_INFO, "DMA config from pong to DDR of size %d", ACAMERA_ISP1_SIZE );
-                                system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PING, SYS_DMA_TO_DEVICE, dma_complete_context_func );
-                            } else {
-                                g_firmware.dma_flag_isp_metering_completed = 1;
-                                system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PING, SYS_DMA_TO_DEVICE, dma_drop_context_func );
-                            }
+                            LOG( LOG_INFO, "DMA config from pong to DDR of size %d", ACAMERA_ISP1_SIZE );
+                            system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PING, SYS_DMA_TO_DEVICE, dma_complete_context_func );
                         } else {
                             LOG( LOG_INFO, "Current config is ping" );
                             //            |^^^^^^^^^|
@@ -622,17 +966,12 @@ int32_t acamera_interrupt_handler()
                             // conf --->  |  PING   |
                             //            |_________|
 
-                            if (!not_empty) {
-                                LOG( LOG_INFO, "DMA metering from ping to DDR of size %d", ACAMERA_METERING_STATS_MEM_SIZE );
-                                // dma all stat memory only to the software context
-                                system_dma_copy_sg( g_firmware.dma_chan_isp_metering, ISP_CONFIG_PONG, SYS_DMA_FROM_DEVICE, dma_complete_metering_func );
+                            LOG( LOG_INFO, "DMA metering from ping to DDR of size %d", ACAMERA_METERING_STATS_MEM_SIZE );
+                            // dma all stat memory to the metering buffer, the FSMs take it at new_frame
+                            system_dma_copy_sg( g_firmware.dma_chan_isp_metering, ISP_CONFIG_PONG, SYS_DMA_FROM_DEVICE, dma_complete_metering_func );
 
-                                LOG( LOG_INFO, "DMA config from DDR to ping of size %d", ACAMERA_ISP1_SIZE );
-                                system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PONG, SYS_DMA_TO_DEVICE, dma_complete_context_func );
-                            } else {
-                                g_firmware.dma_flag_isp_metering_completed = 1;
-                                system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PONG, SYS_DMA_TO_DEVICE, dma_drop_context_func );
-                            }
+                            LOG( LOG_INFO, "DMA config from DDR to ping of size %d", ACAMERA_ISP1_SIZE );
+                            system_dma_copy_sg( g_firmware.dma_chan_isp_config, ISP_CONFIG_PONG, SYS_DMA_TO_DEVICE, dma_complete_context_func );
                         }
                     }
                 } else {
@@ -653,11 +992,29 @@ int32_t acamera_process( void )
 {
     int32_t result = 0;
     int32_t idx = 0;
+    uint32_t wake = acamera_take_wake_mask();
+    uint32_t recovery_ms = 0;
 
     if ( g_firmware.initialized == 1 ) {
+        recovery_ms = acamera_fw_error_process( &g_firmware.fw_ctx[0] );
+
+        // queued control batches go in before the FSMs look at the new frame
+        if ( wake & ACAMERA_WAKE_CTRL_BATCH )
+            acamera_ctrl_batch_process();
+        acamera_ctrl_batch_report();
+
         for ( idx = 0; idx < g_firmware.context_number; idx++ ) {
             acamera_context_ptr_t p_ctx = ( acamera_context_ptr_t ) & ( g_firmware.fw_ctx[idx] );
+
+            // leave contexts without new work alone
+            if ( !( wake & ACAMERA_WAKE_CTX( idx ) ) && !acamera_event_queue_not_empty( &p_ctx->fsm_mgr.event_queue ) )
+                continue;
+
             acamera_fw_process( p_ctx );
+
+            // all events handled, the software context is consistent again
+            if ( !acamera_event_queue_not_empty( &p_ctx->fsm_mgr.event_queue ) )
+                acamera_commit_sw_config( p_ctx );
         }
     } else {
         result = -1;
@@ -665,10 +1022,13 @@ int32_t acamera_process( void )
     }
 
 #if FW_HAS_CONTROL_CHANNEL
-    ctrl_channel_process();
+    if ( wake & ACAMERA_WAKE_CTRL_CHANNEL )
+        ctrl_channel_process();
 #endif
 
-    system_semaphore_wait( g_firmware.sem_evt_avail, FW_EVT_QUEUE_TIMEOUT_MS );
+    // sleep until the next wake source, only an error recovery in progress polls
+    if ( !( wake & ACAMERA_WAKE_STOP ) )
+        system_semaphore_wait( g_firmware.sem_evt_avail, recovery_ms );
 
     return result;
 }
@@ -38,4 +38,22 @@ void acamera_update_cur_settings_to_isp( int port );
 
 void acamera_reset_ping_pong_port(void);
 
+uint32_t acamera_get_stale_config_count( void );
+
+// sources waking the firmware processing loop, one bit each
+#define ACAMERA_WAKE_CTX( idx ) ( 1u << ( idx ) ) // event queue of a context
+#define ACAMERA_WAKE_CTRL_CHANNEL ( 1u << 16 )
+#define ACAMERA_WAKE_SBUF ( 1u << 17 )
+#define ACAMERA_WAKE_COMMAND ( 1u << 18 )
+#define ACAMERA_WAKE_RECOVERY ( 1u << 19 )
+#define ACAMERA_WAKE_CTRL_BATCH ( 1u << 20 )
+#define ACAMERA_WAKE_STOP ( 1u << 31 )
+#define ACAMERA_WAKE_SOURCES 32
+
+void acamera_wake( uint32_t source );
+
+uint32_t acamera_get_wake_count( uint32_t bit );
+
+void acamera_process_stop( void );
+
 #endif /* __ACAMERA_H__ */
@@ -93,6 +93,15 @@ modulation_entry_32_t *_GET_MOD_ENTRY32_PTR( void *p_ctx, uint32_t idx )
     return result;
 }
 
+uint16_t *_GET_MOD_HINT_PTR( void *p_ctx, uint32_t idx )
+{
+    uint16_t *result = NULL;
+    if ( idx < CALIBRATION_TOTAL_SIZE ) {
+        result = &( (acamera_context_ptr_t)p_ctx )->calibration_mod_hint[idx];
+    }
+    return result;
+}
+
 uint32_t _GET_ROWS( void *p_ctx, uint32_t idx )
 {
     uint32_t result = 0;
@@ -43,6 +43,8 @@ modulation_entry_t *_GET_MOD_ENTRY16_PTR( void *p_ctx, uint32_t idx );
 
 modulation_entry_32_t *_GET_MOD_ENTRY32_PTR( void *p_ctx, uint32_t idx );
 
+uint16_t *_GET_MOD_HINT_PTR( void *p_ctx, uint32_t idx );
+
 uint32_t _GET_ROWS( void *p_ctx, uint32_t idx );
 
 uint32_t _GET_COLS( void *p_ctx, uint32_t idx );
@@ -24,6 +24,8 @@
 #include "acamera.h"
 #include "acamera_firmware_api.h"
 #include "acamera_fw.h"
+#include "system_timer.h"
+#include "system_stdlib.h"
 
 #if FW_HAS_CONTROL_CHANNEL
 #include "acamera_ctrl_channel.h"
@@ -31,410 +33,96 @@
 
 extern void * acamera_get_api_ctx_ptr(void);
 
+#define CMD_RO CMD_FLAG_GET
+#define CMD_WO CMD_FLAG_SET
+#define CMD_RW ( CMD_FLAG_GET | CMD_FLAG_SET )
+
+#define CMD_KEY( type, cmd ) ( (uint16_t)( ( ( type ) << 8 ) | ( cmd ) ) )
+#define CMD_ENTRY( type, cmd, flags, fn ) { CMD_KEY( type, cmd ), ( flags ), 0, 0xFFFFFFFF, fn }
+#define CMD_RANGE( type, cmd, flags, min, max, fn ) { CMD_KEY( type, cmd ), ( flags ) | CMD_FLAG_RANGE, min, max, fn }
+
+typedef uint8_t (*acamera_command_fn_t)( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t direction, uint32_t *ret_value );
+
+typedef struct _acamera_command_entry_t {
+	uint16_t key;
+	uint8_t flags;
+	uint32_t min;
+	uint32_t max;
+	acamera_command_fn_t fn;
+} acamera_command_entry_t;
+
+#if ISP_HAS_DS2
+static uint8_t scaler_streaming_on_command( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t direction, uint32_t *ret_value ){
+	scaler_streaming_on();
+	return SUCCESS;
+}
+
+static uint8_t scaler_streaming_off_command( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t direction, uint32_t *ret_value ){
+	scaler_streaming_off();
+	return SUCCESS;
+}
+#endif
+
+// sorted by CMD_KEY, looked up with a binary search
+static const acamera_command_entry_t command_table[] = {
+#include "acamera_command_table.h"
+};
+
+#define COMMAND_TABLE_SIZE ( sizeof( command_table ) / sizeof( command_table[0] ) )
+
+// counters are not locked, concurrent callers may lose an update
+static acamera_command_stats_t command_stats[COMMAND_TABLE_SIZE];
+
+static int32_t acamera_command_find( uint8_t command_type, uint8_t command ){
+	uint16_t key = CMD_KEY( command_type, command );
+	int32_t lo = 0;
+	int32_t hi = COMMAND_TABLE_SIZE - 1;
+	while(lo <= hi){
+		int32_t mid = ( lo + hi ) >> 1;
+		if(command_table[mid].key == key)
+			return mid;
+		if(command_table[mid].key < key)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+	return -1;
+}
+
 uint8_t acamera_command( uint8_t command_type, uint8_t command, uint32_t value, uint8_t direction, uint32_t *ret_value){
 acamera_fsm_mgr_t *instance = &((acamera_context_ptr_t)acamera_get_api_ctx_ptr())->fsm_mgr;
 uint8_t ret = NOT_EXISTS;
-switch (command_type){
-case  TGENERAL:
-	switch (command){
-		case  CONTEXT_NUMBER:
-			ret = general_context_number(instance, value, direction, ret_value);
-			break;
-		case  ACTIVE_CONTEXT:
-			ret = general_active_context(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TSELFTEST:
-	switch (command){
-		case  FW_REVISION:
-			ret = selftest_fw_revision(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TSENSOR:
-	switch (command){
-		case  SENSOR_STREAMING:
-			ret = sensor_streaming(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_SUPPORTED_PRESETS:
-			ret = sensor_supported_presets(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_PRESET:
-			ret = sensor_preset(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_WDR_MODE:
-			ret = sensor_wdr_mode(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_FPS:
-			ret = sensor_fps(instance, value, direction, ret_value);
-			break;
-		case SENSOR_TESTPATTERN:
-			ret = sensor_test_pattern(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_NAME:
-			ret = sensor_name(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_WIDTH:
-			ret = sensor_width(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_HEIGHT:
-			ret = sensor_height(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_EXPOSURES:
-			ret = sensor_exposures(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_INFO_PRESET:
-			ret = sensor_info_preset(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_INFO_WDR_MODE:
-			ret = sensor_info_wdr_mode(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_INFO_FPS:
-			ret = sensor_info_fps(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_INFO_WIDTH:
-			ret = sensor_info_width(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_INFO_HEIGHT:
-			ret = sensor_info_height(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_INFO_EXPOSURES:
-			ret = sensor_info_exposures(instance, value, direction, ret_value);
-			break;
-		case  SENSOR_IR_CUT:
-			ret = sensor_ir_cut_set(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TSYSTEM:
-	switch (command){
-		case  SYSTEM_LOGGER_LEVEL:
-			ret = system_logger_level(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_LOGGER_MASK:
-			ret = system_logger_mask(instance, value, direction, ret_value);
-			break;
-		case  BUFFER_DATA_TYPE:
-			ret = buffer_data_type(instance, value, direction, ret_value);
-			break;
-		case  TEST_PATTERN_ENABLE_ID:
-			ret = test_pattern_enable(instance, value, direction, ret_value);
-			break;
-		case  TEST_PATTERN_MODE_ID:
-			ret = test_pattern(instance, value, direction, ret_value);
-			break;
-		case  TEMPER_MODE_ID:
-			ret = temper_mode(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_FREEZE_FIRMWARE:
-			ret = system_freeze_firmware(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_EXPOSURE:
-			ret = system_manual_exposure(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_EXPOSURE_RATIO:
-			ret = system_manual_exposure_ratio(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_INTEGRATION_TIME:
-			ret = system_manual_integration_time(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_MAX_INTEGRATION_TIME:
-			ret = system_manual_max_integration_time(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_SENSOR_ANALOG_GAIN:
-			ret = system_manual_sensor_analog_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_SENSOR_DIGITAL_GAIN:
-			ret = system_manual_sensor_digital_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_ISP_DIGITAL_GAIN:
-			ret = system_manual_isp_digital_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_AWB:
-			ret = system_manual_awb(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MANUAL_SATURATION:
-			ret = system_manual_saturation(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_EXPOSURE:
-			ret = system_exposure(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_EXPOSURE_RATIO:
-			ret = system_exposure_ratio(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MAX_EXPOSURE_RATIO:
-			ret = system_max_exposure_ratio(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_INTEGRATION_TIME:
-			ret = system_integration_time(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_LONG_INTEGRATION_TIME:
-			ret = system_long_integration_time(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_SHORT_INTEGRATION_TIME:
-			ret = system_short_integration_time(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MAX_INTEGRATION_TIME:
-			ret = system_max_integration_time(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_SENSOR_ANALOG_GAIN:
-			ret = system_sensor_analog_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MAX_SENSOR_ANALOG_GAIN:
-			ret = system_max_sensor_analog_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_SENSOR_DIGITAL_GAIN:
-			ret = system_sensor_digital_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MAX_SENSOR_DIGITAL_GAIN:
-			ret = system_max_sensor_digital_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_ISP_DIGITAL_GAIN:
-			ret = system_isp_digital_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_MAX_ISP_DIGITAL_GAIN:
-			ret = system_max_isp_digital_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_AWB_RED_GAIN:
-			ret = system_awb_red_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_AWB_BLUE_GAIN:
-			ret = system_awb_blue_gain(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_SATURATION_TARGET:
-			ret = system_saturation_target(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_ANTIFLICKER_ENABLE:
-			ret = system_antiflicker_enable(instance, value, direction, ret_value);
-			break;
-		case  SYSTEM_ANTI_FLICKER_FREQUENCY:
-			ret = system_anti_flicker_frequency(instance, value, direction, ret_value);
-			break;
-		case  CALIBRATION_UPDATE:
-			ret = calibration_update(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TISP_MODULES:
-	switch (command){
-		case  ISP_MODULES_MANUAL_IRIDIX:
-			ret = isp_modules_manual_iridix(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_SINTER:
-			ret = isp_modules_manual_sinter(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_TEMPER:
-			ret = isp_modules_manual_temper(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_AUTO_LEVEL:
-			ret = isp_modules_manual_auto_level(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_FRAME_STITCH:
-			ret = isp_modules_manual_frame_stitch(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_RAW_FRONTEND:
-			ret = isp_modules_manual_raw_frontend(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_BLACK_LEVEL:
-			ret = isp_modules_manual_black_level(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_SHADING:
-			ret = isp_modules_manual_shading(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_DEMOSAIC:
-			ret = isp_modules_manual_demosaic(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_CNR:
-			ret = isp_modules_manual_cnr(instance, value, direction, ret_value);
-			break;
-		case  ISP_MODULES_MANUAL_SHARPEN:
-			ret = isp_modules_manual_sharpen(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TSTATUS:
-	switch (command){
-		case  STATUS_INFO_EXPOSURE_LOG2_ID:
-			ret = status_info_exposure_log2(instance, value, direction, ret_value);
-			break;
-		case  STATUS_INFO_GAIN_ONES_ID:
-			ret = status_info_gain_ones(instance, value, direction, ret_value);
-			break;
-		case  STATUS_INFO_GAIN_LOG2_ID:
-			ret = status_info_gain_log2(instance, value, direction, ret_value);
-			break;
-		case  STATUS_INFO_AWB_MIX_LIGHT_CONTRAST:
-			ret = status_info_awb_mix_light_contrast(instance, value, direction, ret_value);
-			break;
-		case  STATUS_INFO_AF_LENS_POS:
-			ret = status_info_af_lens_pos(instance, value, direction, ret_value);
-			break;
-		case  STATUS_INFO_AF_FOCUS_VALUE:
-			ret = status_info_af_focus_value(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TIMAGE:
-	switch (command){
-		case  DMA_READER_OUTPUT_ID:
-			ret = dma_reader_output(instance, value, direction, ret_value);
-			break;
-		case  FR_FORMAT_BASE_PLANE_ID:
-			ret = fr_format_base_plane(instance, value, direction, ret_value);
-			break;
-		case  DS1_FORMAT_BASE_PLANE_ID:
-			ret = ds1_format_base_plane(instance, value, direction, ret_value);
-			break;
-		case  ORIENTATION_VFLIP_ID:
-			ret = orientation_vflip(instance, value, direction, ret_value);
-			break;
-		case  ORIENTATION_HFLIP_ID:
-			ret = orientation_hflip(instance, value, direction, ret_value);
-			break;
-		case  IMAGE_RESIZE_TYPE_ID:
-			ret = image_resize_type(instance, value, direction, ret_value);
-			break;
-		case  IMAGE_RESIZE_ENABLE_ID:
-			ret = image_resize_enable(instance, value, direction, ret_value);
-			break;
-		case  IMAGE_RESIZE_WIDTH_ID:
-			ret = image_resize_width(instance, value, direction, ret_value);
-			break;
-		case  IMAGE_RESIZE_HEIGHT_ID:
-			ret = image_resize_height(instance, value, direction, ret_value);
-			break;
-		case  IMAGE_CROP_XOFFSET_ID:
-			ret = image_crop_xoffset(instance, value, direction, ret_value);
-			break;
-		case  IMAGE_CROP_YOFFSET_ID:
-			ret = image_crop_yoffset(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TALGORITHMS:
-	switch (command){
-		case  AF_LENS_STATUS:
-			ret = af_lens_status(instance, value, direction, ret_value);
-			break;
-		case  AF_MODE_ID:
-			ret = af_mode(instance, value, direction, ret_value);
-			break;
-		case  AF_RANGE_LOW_ID:
-			ret = af_range_low(instance, value, direction, ret_value);
-			break;
-		case  AF_RANGE_HIGH_ID:
-			ret = af_range_high(instance, value, direction, ret_value);
-			break;
-		case  AF_ROI_ID:
-			ret = af_roi(instance, value, direction, ret_value);
-			break;
-		case  AF_MANUAL_CONTROL_ID:
-			ret = af_manual_control(instance, value, direction, ret_value);
-			break;
-		case  AE_MODE_ID:
-			ret = ae_mode(instance, value, direction, ret_value);
-			break;
-		case  AE_SPLIT_PRESET_ID:
-			ret = ae_split_preset(instance, value, direction, ret_value);
-			break;
-		case  AE_GAIN_ID:
-			ret = ae_gain(instance, value, direction, ret_value);
-			break;
-		case  AE_EXPOSURE_ID:
-			ret = ae_exposure(instance, value, direction, ret_value);
-			break;
-		case  AE_ROI_ID:
-			ret = ae_roi(instance, value, direction, ret_value);
-			break;
-		case  AE_COMPENSATION_ID:
-			ret = ae_compensation(instance, value, direction, ret_value);
-			break;
-		case  AWB_MODE_ID:
-			ret = awb_mode(instance, value, direction, ret_value);
-			break;
-		case  AWB_TEMPERATURE_ID:
-			ret = awb_temperature(instance, value, direction, ret_value);
-			break;
-		case  ANTIFLICKER_MODE_ID:
-			ret = antiflicker_mode(instance, value, direction, ret_value);
-			break;
-		case AE_ZONE_WEIGHT:
-			ret = ae_zone_weight(instance, value, direction, ret_value);
-			break;
-		case AWB_ZONE_WEIGHT:
-			ret = awb_zone_weight(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TSCENE_MODES:
-	switch (command){
-		case  COLOR_MODE_ID:
-			ret = color_mode(instance, value, direction, ret_value);
-			break;
-		case  BRIGHTNESS_STRENGTH_ID:
-			ret = brightness_strength(instance, value, direction, ret_value);
-			break;
-		case  CONTRAST_STRENGTH_ID:
-			ret = contrast_strength(instance, value, direction, ret_value);
-			break;
-		case  SATURATION_STRENGTH_ID:
-			ret = saturation_strength(instance, value, direction, ret_value);
-			break;
-		case  SHARPENING_STRENGTH_ID:
-			ret = sharpening_strength(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-case  TREGISTERS:
-	switch (command){
-		case  REGISTERS_ADDRESS_ID:
-			ret = register_address(instance, value, direction, ret_value);
-			break;
-		case  REGISTERS_SIZE_ID:
-			ret = register_size(instance, value, direction, ret_value);
-			break;
-		case  REGISTERS_SOURCE_ID:
-			ret = register_source(instance, value, direction, ret_value);
-			break;
-		case  REGISTERS_VALUE_ID:
-			ret = register_value(instance, value, direction, ret_value);
-			break;
-	}//switch (command)
-	break;
-#if ISP_HAS_DS2
-case TAML_SCALER:
-	switch (command) {
-		case SCALER_WIDTH:
-			ret = scaler_width(instance, value, direction, ret_value);
-			break;
-		case SCALER_HEIGHT:
-			ret = scaler_height(instance, value, direction, ret_value);
-			break;
-		case SCALER_SRC_WIDTH:
-			ret = scaler_src_width(instance, value, direction, ret_value);
-			break;
-		case SCALER_SRC_HEIGHT:
-			ret = scaler_src_height(instance, value, direction, ret_value);
-			break;
-		case SCALER_OUTPUT_MODE:
-			ret = scaler_output_mode(instance, value, direction, ret_value);
-			break;
-		case SCALER_STREAMING_ON:
-			scaler_streaming_on();
-			break;
-		case SCALER_STREAMING_OFF:
-			scaler_streaming_off();
-			break;
-	}//switch (command)
-	break;
-#endif
-}//switch (command_type)
+int32_t idx = acamera_command_find( command_type, command );
+if(idx >= 0){
+	const acamera_command_entry_t *entry = &command_table[idx];
+	acamera_command_stats_t *stats = &command_stats[idx];
+	uint8_t access = ( direction == COMMAND_SET ) ? CMD_FLAG_SET : CMD_FLAG_GET;
+	if(!( entry->flags & access )){
+		ret = NOT_PERMITTED;
+	}else if(direction == COMMAND_SET && ( entry->flags & CMD_FLAG_RANGE ) && ( value < entry->min || value > entry->max )){
+		ret = NOT_SUPPORTED;
+	}else{
+		uint64_t start = system_timer_timestamp_ns();
+		uint32_t elapsed;
+		ret = entry->fn(instance, value, direction, ret_value);
+		elapsed = (uint32_t)( system_timer_timestamp_ns() - start );
+		stats->time_ns += elapsed;
+		if(elapsed > stats->max_time_ns)
+			stats->max_time_ns = elapsed;
+	}
+	stats->calls++;
+	if(ret != SUCCESS)
+		stats->fails++;
+}
 
 #if FW_HAS_CONTROL_CHANNEL
 	ctrl_channel_handle_command( command_type, command, value, direction );
 #endif
 
+// let the firmware loop pick up the new setting now
+if(ret==SUCCESS && direction==COMMAND_SET)
+	acamera_wake( ACAMERA_WAKE_COMMAND | ACAMERA_WAKE_CTX( instance->ctx_id ) );
+
 if(ret!=SUCCESS)
 {
 	LOG(LOG_WARNING,"API COMMAND FAILED: type %d, cmd %d, value %lu, direction %d, ret_value %lu, result %d",command_type, command, (unsigned long)value, direction, (unsigned long)*ret_value, ret);
@@ -445,3 +133,29 @@ else
 }
 	return ret;
 }
+
+uint8_t acamera_command_check( uint8_t command_type, uint8_t command, uint8_t direction ){
+	int32_t idx = acamera_command_find( command_type, command );
+	uint8_t access = ( direction == COMMAND_SET ) ? CMD_FLAG_SET : CMD_FLAG_GET;
+	if(idx < 0)
+		return NOT_EXISTS;
+	if(!( command_table[idx].flags & access ))
+		return NOT_PERMITTED;
+	return SUCCESS;
+}
+
+int32_t acamera_command_get_info( uint32_t idx, acamera_command_info_t *info){
+	if(idx >= COMMAND_TABLE_SIZE || info == NULL)
+		return -1;
+	info->command_type = command_table[idx].key >> 8;
+	info->command = command_table[idx].key & 0xFF;
+	info->flags = command_table[idx].flags;
+	info->min = command_table[idx].min;
+	info->max = command_table[idx].max;
+	info->stats = command_stats[idx];
+	return 0;
+}
+
+void acamera_command_reset_stats( void ){
+	system_memset(command_stats, 0, sizeof(command_stats));
+}
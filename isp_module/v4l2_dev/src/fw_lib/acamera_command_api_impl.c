@@ -159,6 +159,20 @@ uint8_t general_active_context( acamera_fsm_mgr_t *instance, uint32_t value, uin
 #endif
 
 
+#ifdef STALE_CONFIG_FRAMES
+uint8_t general_stale_config_frames( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t direction, uint32_t *ret_value )
+{
+    uint32_t result = NOT_SUPPORTED;
+    *ret_value = 0;
+    if ( direction == COMMAND_GET ) {
+        *ret_value = acamera_get_stale_config_count();
+        result = SUCCESS;
+    }
+    return result;
+}
+#endif
+
+
 #ifdef DMA_WRITER_SINGLE_FRAME_MODE
 uint8_t dma_writer_single_frame( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t direction, uint32_t *ret_value )
 {
@@ -303,11 +317,16 @@ uint8_t sensor_preset( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t dire
         result = SUCCESS;
     } else {
         if ( value < param->modes_num ) {
-            acamera_fsm_mgr_set_param( instance, FSM_PARAM_SET_SENSOR_PRESET_MODE, &value, sizeof( value ) );
+            fsm_param_sensor_switch_info_t switch_info;
 
-            isp_safe_stop( ACAMERA_MGR2CTX_PTR( instance )->settings.isp_base );
+            acamera_fsm_mgr_set_param( instance, FSM_PARAM_SET_SENSOR_PRESET_MODE, &value, sizeof( value ) );
+            acamera_fsm_mgr_get_param( instance, FSM_PARAM_GET_SENSOR_SWITCH_INFO, NULL, 0, &switch_info, sizeof( switch_info ) );
 
-            acamera_fsm_mgr_raise_event( instance, event_id_acamera_reset_sensor_hw );
+            // the sensor FSM already stopped and reconfigured the ISP for a
+            // cold switch, only the FSMs following the sensor mode are left
+            if ( switch_info.diff & SENSOR_PRESET_DIFF_COLD_MASK ) {
+                acamera_fsm_mgr_raise_event( instance, event_id_acamera_reset_sensor_hw );
+            }
 
             result = SUCCESS;
         } else {
@@ -319,6 +338,24 @@ uint8_t sensor_preset( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t dire
 #endif
 
 
+#ifdef SENSOR_SWITCH_TIME
+uint8_t sensor_switch_time( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t direction, uint32_t *ret_value )
+{
+    uint32_t result = SUCCESS;
+    *ret_value = 0;
+    if ( direction == COMMAND_GET ) {
+        fsm_param_sensor_switch_info_t switch_info;
+        acamera_fsm_mgr_get_param( instance, FSM_PARAM_GET_SENSOR_SWITCH_INFO, NULL, 0, &switch_info, sizeof( switch_info ) );
+
+        *ret_value = switch_info.switch_time_ms;
+    } else {
+        result = NOT_SUPPORTED;
+    }
+    return result;
+}
+#endif
+
+
 #ifdef SENSOR_WDR_MODE
 uint8_t sensor_wdr_mode( acamera_fsm_mgr_t *instance, uint32_t value, uint8_t direction, uint32_t *ret_value )
 {
@@ -4593,6 +4630,33 @@ uint8_t acamera_api_set_fps(uint8_t type, uint32_t c_fps, uint32_t t_fps)
     return SUCCESS;
 }
 
+uint8_t acamera_api_get_fps(uint8_t type, uint32_t *c_fps, uint32_t *t_fps, uint32_t *delivered, uint32_t *skipped)
+{
+    acamera_context_t *p_ctx = (acamera_context_t *)acamera_get_api_ctx_ptr();
+    acamera_fsm_mgr_t *instance = NULL;
+    fsm_param_path_fps_t pipe_fps;
+    dma_type d_type = type;
+
+    if (type >= dma_max || !c_fps || !t_fps || !delivered || !skipped)
+        return NOT_SUPPORTED;
+
+    // may be read from outside the firmware before the FSMs exist
+    if (!p_ctx->initialized)
+        return FAIL;
+
+    instance = &p_ctx->fsm_mgr;
+
+    if (acamera_fsm_mgr_get_param(instance, FSM_PARAM_GET_PATH_FPS, &d_type, sizeof(d_type), &pipe_fps, sizeof(pipe_fps)))
+        return FAIL;
+
+    *c_fps = pipe_fps.c_fps;
+    *t_fps = pipe_fps.t_fps;
+    *delivered = pipe_fps.delivered;
+    *skipped = pipe_fps.skipped;
+
+    return SUCCESS;
+}
+
 void acamera_api_dma_buff_queue_reset(uint8_t type)
 {
     uint8_t d_type = 0xff;
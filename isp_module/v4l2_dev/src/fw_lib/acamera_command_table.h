@@ -0,0 +1,144 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+// The firmware API commands, one CMD_ENTRY or CMD_RANGE per (type, command),
+// sorted by type and then command for the binary search in acamera_command_api.c.
+// Included in the middle of an initializer, no include guard on purpose:
+// fw_host_test/command_table_test.c includes it too and checks the order.
+
+	CMD_ENTRY( TGENERAL, CONTEXT_NUMBER, CMD_RO | CMD_FLAG_ATOMIC, general_context_number ),
+	CMD_ENTRY( TGENERAL, ACTIVE_CONTEXT, CMD_RW, general_active_context ),
+	CMD_ENTRY( TGENERAL, STALE_CONFIG_FRAMES, CMD_RO | CMD_FLAG_ATOMIC, general_stale_config_frames ),
+	CMD_ENTRY( TSELFTEST, FW_REVISION, CMD_RO | CMD_FLAG_ATOMIC, selftest_fw_revision ),
+	CMD_ENTRY( TSENSOR, SENSOR_STREAMING, CMD_RW, sensor_streaming ),
+	CMD_ENTRY( TSENSOR, SENSOR_SUPPORTED_PRESETS, CMD_RO, sensor_supported_presets ),
+	CMD_ENTRY( TSENSOR, SENSOR_PRESET, CMD_RW, sensor_preset ),
+	CMD_ENTRY( TSENSOR, SENSOR_WDR_MODE, CMD_RO, sensor_wdr_mode ),
+	CMD_ENTRY( TSENSOR, SENSOR_FPS, CMD_RO, sensor_fps ),
+	CMD_ENTRY( TSENSOR, SENSOR_WIDTH, CMD_RO, sensor_width ),
+	CMD_ENTRY( TSENSOR, SENSOR_HEIGHT, CMD_RO, sensor_height ),
+	CMD_ENTRY( TSENSOR, SENSOR_EXPOSURES, CMD_RO, sensor_exposures ),
+	CMD_ENTRY( TSENSOR, SENSOR_INFO_PRESET, CMD_RW, sensor_info_preset ),
+	CMD_ENTRY( TSENSOR, SENSOR_INFO_WDR_MODE, CMD_RO, sensor_info_wdr_mode ),
+	CMD_ENTRY( TSENSOR, SENSOR_INFO_FPS, CMD_RO, sensor_info_fps ),
+	CMD_ENTRY( TSENSOR, SENSOR_INFO_WIDTH, CMD_RO, sensor_info_width ),
+	CMD_ENTRY( TSENSOR, SENSOR_INFO_HEIGHT, CMD_RO, sensor_info_height ),
+	CMD_ENTRY( TSENSOR, SENSOR_INFO_EXPOSURES, CMD_RO, sensor_info_exposures ),
+	CMD_ENTRY( TSENSOR, SENSOR_NAME, CMD_RO, sensor_name ),
+	CMD_ENTRY( TSENSOR, SENSOR_TESTPATTERN, CMD_WO, sensor_test_pattern ),
+	CMD_ENTRY( TSENSOR, SENSOR_IR_CUT, CMD_WO, sensor_ir_cut_set ),
+	CMD_ENTRY( TSENSOR, SENSOR_SWITCH_TIME, CMD_RO, sensor_switch_time ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_LOGGER_LEVEL, CMD_RW | CMD_FLAG_ATOMIC, system_logger_level ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_LOGGER_MASK, CMD_RW | CMD_FLAG_ATOMIC, system_logger_mask ),
+	CMD_ENTRY( TSYSTEM, BUFFER_DATA_TYPE, CMD_RO, buffer_data_type ),
+	CMD_ENTRY( TSYSTEM, TEST_PATTERN_ENABLE_ID, CMD_RW | CMD_FLAG_ATOMIC, test_pattern_enable ),
+	CMD_ENTRY( TSYSTEM, TEST_PATTERN_MODE_ID, CMD_RW | CMD_FLAG_ATOMIC, test_pattern ),
+	CMD_ENTRY( TSYSTEM, TEMPER_MODE_ID, CMD_RW | CMD_FLAG_ATOMIC, temper_mode ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_FREEZE_FIRMWARE, CMD_RW | CMD_FLAG_ATOMIC, system_freeze_firmware ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_EXPOSURE, CMD_RW | CMD_FLAG_ATOMIC, system_manual_exposure ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_EXPOSURE_RATIO, CMD_RW | CMD_FLAG_ATOMIC, system_manual_exposure_ratio ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_INTEGRATION_TIME, CMD_RW | CMD_FLAG_ATOMIC, system_manual_integration_time ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_MAX_INTEGRATION_TIME, CMD_RW | CMD_FLAG_ATOMIC, system_manual_max_integration_time ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_SENSOR_ANALOG_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_manual_sensor_analog_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_SENSOR_DIGITAL_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_manual_sensor_digital_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_ISP_DIGITAL_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_manual_isp_digital_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_AWB, CMD_RW | CMD_FLAG_ATOMIC, system_manual_awb ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MANUAL_SATURATION, CMD_RW | CMD_FLAG_ATOMIC, system_manual_saturation ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_EXPOSURE, CMD_RW | CMD_FLAG_ATOMIC, system_exposure ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_EXPOSURE_RATIO, CMD_RW | CMD_FLAG_ATOMIC, system_exposure_ratio ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MAX_EXPOSURE_RATIO, CMD_RW | CMD_FLAG_ATOMIC, system_max_exposure_ratio ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_INTEGRATION_TIME, CMD_RW, system_integration_time ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_LONG_INTEGRATION_TIME, CMD_RO | CMD_FLAG_ATOMIC, system_long_integration_time ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_SHORT_INTEGRATION_TIME, CMD_RO | CMD_FLAG_ATOMIC, system_short_integration_time ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MAX_INTEGRATION_TIME, CMD_RW, system_max_integration_time ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_SENSOR_ANALOG_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_sensor_analog_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MAX_SENSOR_ANALOG_GAIN, CMD_RW, system_max_sensor_analog_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_SENSOR_DIGITAL_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_sensor_digital_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MAX_SENSOR_DIGITAL_GAIN, CMD_RW, system_max_sensor_digital_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_ISP_DIGITAL_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_isp_digital_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_MAX_ISP_DIGITAL_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_max_isp_digital_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_AWB_RED_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_awb_red_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_AWB_BLUE_GAIN, CMD_RW | CMD_FLAG_ATOMIC, system_awb_blue_gain ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_SATURATION_TARGET, CMD_RW | CMD_FLAG_ATOMIC, system_saturation_target ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_ANTIFLICKER_ENABLE, CMD_RW | CMD_FLAG_ATOMIC, system_antiflicker_enable ),
+	CMD_ENTRY( TSYSTEM, SYSTEM_ANTI_FLICKER_FREQUENCY, CMD_RW | CMD_FLAG_ATOMIC, system_anti_flicker_frequency ),
+	CMD_ENTRY( TSYSTEM, CALIBRATION_UPDATE, CMD_RW, calibration_update ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_IRIDIX, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_iridix ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_SINTER, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_sinter ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_TEMPER, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_temper ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_AUTO_LEVEL, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_auto_level ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_FRAME_STITCH, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_frame_stitch ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_RAW_FRONTEND, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_raw_frontend ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_BLACK_LEVEL, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_black_level ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_SHADING, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_shading ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_DEMOSAIC, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_demosaic ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_CNR, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_cnr ),
+	CMD_ENTRY( TISP_MODULES, ISP_MODULES_MANUAL_SHARPEN, CMD_RW | CMD_FLAG_ATOMIC, isp_modules_manual_sharpen ),
+	CMD_ENTRY( TSTATUS, STATUS_INFO_EXPOSURE_LOG2_ID, CMD_RO | CMD_FLAG_ATOMIC, status_info_exposure_log2 ),
+	CMD_ENTRY( TSTATUS, STATUS_INFO_GAIN_ONES_ID, CMD_RO | CMD_FLAG_ATOMIC, status_info_gain_ones ),
+	CMD_ENTRY( TSTATUS, STATUS_INFO_GAIN_LOG2_ID, CMD_RO | CMD_FLAG_ATOMIC, status_info_gain_log2 ),
+	CMD_ENTRY( TSTATUS, STATUS_INFO_AWB_MIX_LIGHT_CONTRAST, CMD_RO | CMD_FLAG_ATOMIC, status_info_awb_mix_light_contrast ),
+	CMD_ENTRY( TSTATUS, STATUS_INFO_AF_LENS_POS, CMD_RO | CMD_FLAG_ATOMIC, status_info_af_lens_pos ),
+	CMD_ENTRY( TSTATUS, STATUS_INFO_AF_FOCUS_VALUE, CMD_RO | CMD_FLAG_ATOMIC, status_info_af_focus_value ),
+	CMD_ENTRY( TIMAGE, DMA_READER_OUTPUT_ID, CMD_RW, dma_reader_output ),
+	CMD_ENTRY( TIMAGE, FR_FORMAT_BASE_PLANE_ID, CMD_RW, fr_format_base_plane ),
+	CMD_ENTRY( TIMAGE, DS1_FORMAT_BASE_PLANE_ID, CMD_RW, ds1_format_base_plane ),
+	CMD_ENTRY( TIMAGE, ORIENTATION_VFLIP_ID, CMD_RW, orientation_vflip ),
+	CMD_ENTRY( TIMAGE, ORIENTATION_HFLIP_ID, CMD_RW, orientation_hflip ),
+	CMD_ENTRY( TIMAGE, IMAGE_RESIZE_TYPE_ID, CMD_RW, image_resize_type ),
+	CMD_ENTRY( TIMAGE, IMAGE_RESIZE_ENABLE_ID, CMD_RW, image_resize_enable ),
+	CMD_ENTRY( TIMAGE, IMAGE_RESIZE_WIDTH_ID, CMD_RW, image_resize_width ),
+	CMD_ENTRY( TIMAGE, IMAGE_RESIZE_HEIGHT_ID, CMD_RW, image_resize_height ),
+	CMD_ENTRY( TIMAGE, IMAGE_CROP_XOFFSET_ID, CMD_RW, image_crop_xoffset ),
+	CMD_ENTRY( TIMAGE, IMAGE_CROP_YOFFSET_ID, CMD_RW, image_crop_yoffset ),
+	CMD_ENTRY( TALGORITHMS, AF_LENS_STATUS, CMD_RO, af_lens_status ),
+	CMD_ENTRY( TALGORITHMS, AF_MODE_ID, CMD_RW, af_mode ),
+	CMD_ENTRY( TALGORITHMS, AF_RANGE_LOW_ID, CMD_RW, af_range_low ),
+	CMD_ENTRY( TALGORITHMS, AF_RANGE_HIGH_ID, CMD_RW, af_range_high ),
+	CMD_ENTRY( TALGORITHMS, AF_ROI_ID, CMD_RW, af_roi ),
+	CMD_ENTRY( TALGORITHMS, AF_MANUAL_CONTROL_ID, CMD_RW, af_manual_control ),
+	CMD_ENTRY( TALGORITHMS, AE_MODE_ID, CMD_RW, ae_mode ),
+	CMD_ENTRY( TALGORITHMS, AE_SPLIT_PRESET_ID, CMD_RW, ae_split_preset ),
+	CMD_ENTRY( TALGORITHMS, AE_GAIN_ID, CMD_RW, ae_gain ),
+	CMD_ENTRY( TALGORITHMS, AE_EXPOSURE_ID, CMD_RW, ae_exposure ),
+	CMD_ENTRY( TALGORITHMS, AE_ROI_ID, CMD_RW, ae_roi ),
+	CMD_RANGE( TALGORITHMS, AE_COMPENSATION_ID, CMD_RW | CMD_FLAG_ATOMIC, 0, 255, ae_compensation ),
+	CMD_ENTRY( TALGORITHMS, AWB_MODE_ID, CMD_RW, awb_mode ),
+	CMD_ENTRY( TALGORITHMS, AWB_TEMPERATURE_ID, CMD_RW, awb_temperature ),
+	CMD_ENTRY( TALGORITHMS, ANTIFLICKER_MODE_ID, CMD_RW | CMD_FLAG_ATOMIC, antiflicker_mode ),
+	CMD_ENTRY( TALGORITHMS, AE_ZONE_WEIGHT, CMD_WO, ae_zone_weight ),
+	CMD_ENTRY( TALGORITHMS, AWB_ZONE_WEIGHT, CMD_WO, awb_zone_weight ),
+	CMD_ENTRY( TSCENE_MODES, COLOR_MODE_ID, CMD_RW, color_mode ),
+	CMD_RANGE( TSCENE_MODES, BRIGHTNESS_STRENGTH_ID, CMD_RW, 0, 255, brightness_strength ),
+	CMD_RANGE( TSCENE_MODES, CONTRAST_STRENGTH_ID, CMD_RW, 0, 255, contrast_strength ),
+	CMD_ENTRY( TSCENE_MODES, SATURATION_STRENGTH_ID, CMD_RW, saturation_strength ),
+	CMD_RANGE( TSCENE_MODES, SHARPENING_STRENGTH_ID, CMD_RW, 0, 255, sharpening_strength ),
+	CMD_ENTRY( TREGISTERS, REGISTERS_ADDRESS_ID, CMD_RW, register_address ),
+	CMD_ENTRY( TREGISTERS, REGISTERS_SIZE_ID, CMD_RW, register_size ),
+	CMD_ENTRY( TREGISTERS, REGISTERS_SOURCE_ID, CMD_RW, register_source ),
+	CMD_ENTRY( TREGISTERS, REGISTERS_VALUE_ID, CMD_RW, register_value ),
+#if ISP_HAS_DS2
+	CMD_ENTRY( TAML_SCALER, SCALER_WIDTH, CMD_RW, scaler_width ),
+	CMD_ENTRY( TAML_SCALER, SCALER_HEIGHT, CMD_RW, scaler_height ),
+	CMD_ENTRY( TAML_SCALER, SCALER_OUTPUT_MODE, CMD_WO, scaler_output_mode ),
+	CMD_ENTRY( TAML_SCALER, SCALER_STREAMING_ON, CMD_WO, scaler_streaming_on_command ),
+	CMD_ENTRY( TAML_SCALER, SCALER_STREAMING_OFF, CMD_WO, scaler_streaming_off_command ),
+	CMD_ENTRY( TAML_SCALER, SCALER_SRC_WIDTH, CMD_RW, scaler_src_width ),
+	CMD_ENTRY( TAML_SCALER, SCALER_SRC_HEIGHT, CMD_RW, scaler_src_height ),
+#endif
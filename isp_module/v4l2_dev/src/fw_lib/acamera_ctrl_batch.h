@@ -0,0 +1,162 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_CTRL_BATCH_H__
+#define __ACAMERA_CTRL_BATCH_H__
+
+/*
+ * Control batch bookkeeping of acamera.c, without the locking and the
+ * firmware calls so the host test can run it as is, include it after
+ * acamera_firmware_api.h.
+ *
+ * Frames are counted in the frame_id of the buffer metadata (isp_frame_counter).
+ * Queued batches are kept sorted by the frame they are due at. An applied batch
+ * is reported at the first frame whose exposure, looked up by hardware frame id
+ * in the cmos exposure history, was computed after the batch went in.
+ */
+
+// frames an applied batch waits for an exposure update before it is reported without one
+#define ACAMERA_CTRL_BATCH_REPORT_FRAMES 8
+
+typedef struct _acamera_ctrl_batch_list_t {
+    uint32_t count;                                    // batches waiting, earliest due frame first
+    uint32_t due_frame[ACAMERA_CTRL_BATCH_QUEUE_SIZE]; // frame each batch waits for
+    acamera_ctrl_batch_t batch[ACAMERA_CTRL_BATCH_QUEUE_SIZE];
+} acamera_ctrl_batch_list_t;
+
+typedef struct _acamera_ctrl_batch_report_t {
+    acamera_ctrl_batch_t batch;
+    uint32_t result;
+    uint32_t exposure_updates; // cmos exposure updates before the batch was applied
+    uint32_t applied_hw;       // hardware frame id the batch was applied in
+    uint32_t next_hw;          // next hardware frame id to look up
+} acamera_ctrl_batch_report_t;
+
+// the update count stamped into the exposure of a hardware frame, non zero when it is not in the history
+typedef int32_t ( *acamera_ctrl_batch_exposure_fn_t )( void *priv, uint32_t frame_hw, uint32_t *p_updates );
+
+// frame counts wrap, a frame up to half the range behind counts as reached
+static inline int acamera_ctrl_batch_is_due( uint32_t due_frame, uint32_t frame )
+{
+    return (int32_t)( frame - due_frame ) >= 0;
+}
+
+// a frame which has already started can only be caught at the next one
+static inline uint32_t acamera_ctrl_batch_due_frame( uint32_t target_frame, uint32_t frame )
+{
+    if ( target_frame == 0 || acamera_ctrl_batch_is_due( target_frame, frame ) )
+        return frame + 1;
+
+    return target_frame;
+}
+
+// queued behind the batches due at the same frame or earlier, -1 when the list is full
+static inline int32_t acamera_ctrl_batch_insert( acamera_ctrl_batch_list_t *p_list, const acamera_ctrl_batch_t *p_batch, uint32_t due_frame )
+{
+    uint32_t pos = p_list->count;
+
+    if ( pos >= ACAMERA_CTRL_BATCH_QUEUE_SIZE )
+        return -1;
+
+    while ( pos > 0 && !acamera_ctrl_batch_is_due( p_list->due_frame[pos - 1], due_frame ) ) {
+        p_list->due_frame[pos] = p_list->due_frame[pos - 1];
+        p_list->batch[pos] = p_list->batch[pos - 1];
+        pos--;
+    }
+
+    p_list->due_frame[pos] = due_frame;
+    p_list->batch[pos] = *p_batch;
+    p_list->count++;
+
+    return 0;
+}
+
+static inline int acamera_ctrl_batch_head_is_due( const acamera_ctrl_batch_list_t *p_list, uint32_t frame )
+{
+    return p_list->count > 0 && acamera_ctrl_batch_is_due( p_list->due_frame[0], frame );
+}
+
+// takes the first batch when it is due at frame, returns 0 when none is
+static inline int acamera_ctrl_batch_take( acamera_ctrl_batch_list_t *p_list, uint32_t frame, acamera_ctrl_batch_t *p_batch )
+{
+    uint32_t idx;
+
+    if ( !acamera_ctrl_batch_head_is_due( p_list, frame ) )
+        return 0;
+
+    *p_batch = p_list->batch[0];
+    p_list->count--;
+    for ( idx = 0; idx < p_list->count; idx++ ) {
+        p_list->due_frame[idx] = p_list->due_frame[idx + 1];
+        p_list->batch[idx] = p_list->batch[idx + 1];
+    }
+
+    return 1;
+}
+
+/*
+ * Looks for the hardware frame whose exposure first carries the batch, from
+ * next_hw up to the frames the cmos has scheduled by hardware frame cur_hw.
+ * Returns 1 with *p_frame_hw set when it is found. A batch which has not
+ * changed the exposure within ACAMERA_CTRL_BATCH_REPORT_FRAMES frames is
+ * reported at the frame after the one it was applied in. Returns 0 while
+ * the frame is not scheduled yet.
+ */
+static inline int acamera_ctrl_batch_exposure_frame( acamera_ctrl_batch_report_t *p_report, uint32_t cur_hw,
+                                                     acamera_ctrl_batch_exposure_fn_t get_exposure, void *priv, uint32_t *p_frame_hw )
+{
+    uint32_t updates;
+
+    // the hardware frame counter starts again with the stream
+    if ( (int32_t)( cur_hw - p_report->applied_hw ) < 0 ) {
+        *p_frame_hw = cur_hw;
+        return 1;
+    }
+
+    // the history only holds a few frames, older ones can not be looked at any more
+    if ( (int32_t)( cur_hw - p_report->next_hw ) > ACAMERA_CTRL_BATCH_REPORT_FRAMES )
+        p_report->next_hw = cur_hw - ACAMERA_CTRL_BATCH_REPORT_FRAMES;
+
+    for ( ;; ) {
+        if ( get_exposure( priv, p_report->next_hw, &updates ) != 0 ) {
+            // not scheduled yet
+            if ( (int32_t)( p_report->next_hw - cur_hw ) >= 0 )
+                break;
+            // a frame start the cmos has missed or overwritten already
+            p_report->next_hw++;
+            continue;
+        }
+
+        if ( (int32_t)( updates - p_report->exposure_updates ) > 0 ) {
+            *p_frame_hw = p_report->next_hw;
+            return 1;
+        }
+
+        p_report->next_hw++;
+    }
+
+    if ( (int32_t)( cur_hw - p_report->applied_hw ) >= ACAMERA_CTRL_BATCH_REPORT_FRAMES ) {
+        *p_frame_hw = p_report->applied_hw + 1;
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif /* __ACAMERA_CTRL_BATCH_H__ */
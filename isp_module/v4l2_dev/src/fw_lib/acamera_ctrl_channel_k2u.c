@@ -29,6 +29,7 @@
 #include "system_stdlib.h"
 #include "acamera_command_api.h"
 #include "acamera_ctrl_channel.h"
+#include "acamera.h"
 
 #define CTRL_CHANNEL_FIFO_INPUT_SIZE ( 4 * 1024 )
 #define CTRL_CHANNEL_FIFO_OUTPUT_SIZE ( 8 * 1024 )
@@ -141,6 +142,7 @@ static ssize_t ctrl_channel_fops_write( struct file *file, const char __user *bu
     mutex_unlock( &p_ctx->fops_lock );
 
     LOG( LOG_DEBUG, "wake up reader." );
+    acamera_wake( ACAMERA_WAKE_CTRL_CHANNEL );
 
     return rc ? rc : copied;
 }
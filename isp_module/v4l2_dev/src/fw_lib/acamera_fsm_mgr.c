@@ -24,6 +24,7 @@
 #endif
 #include "acamera_logger.h"
 #include "system_semaphore.h"
+#include "system_timeline.h"
 
 extern fsm_common_t * sensor_get_fsm_common(uint8_t ctx_id);
 extern fsm_common_t * cmos_get_fsm_common(uint8_t ctx_id);
@@ -183,6 +184,12 @@ void acamera_fsm_mgr_process_events(acamera_fsm_mgr_t *p_fsm_mgr,int n_max_event
                 }
             }
 
+            // the frame end as the FSMs see it, not when the interrupt raised it
+            if(event_id==event_id_frame_end)
+            {
+                SYS_TIMELINE_MARK(p_fsm_mgr->ctx_id,p_fsm_mgr->p_ctx->isp_frame_counter,SYS_TIMELINE_FSM_FRAME);
+            }
+
             if(b_event_processed)
             {
                 ++n_event;
@@ -18,6 +18,7 @@
 */
 
 #include "acamera_fw.h"
+#include "acamera.h"
 #if ACAMERA_ISP_PROFILING
 #include "acamera_profiler.h"
 #endif
@@ -27,6 +28,7 @@
 #include "acamera_isp_core_nomem_settings.h"
 #include "acamera_metering_stats_mem_config.h"
 #include "system_timer.h"
+#include "system_timeline.h"
 #include "acamera_logger.h"
 #include "acamera_sbus_api.h"
 #include "sensor_init.h"
@@ -46,7 +48,7 @@
 
 static const acam_reg_t **p_isp_data = SENSOR_ISP_SEQUENCE_DEFAULT;
 
-extern void acamera_notify_evt_data_avail( void );
+extern void acamera_notify_evt_data_avail( uint32_t ctx_id );
 
 void acamera_load_isp_sequence( uintptr_t isp_base, const acam_reg_t **sequence, uint8_t num )
 {
@@ -102,36 +104,239 @@ void acamera_fw_deinit( acamera_context_t *p_ctx )
     acamera_fsm_mgr_deinit( &p_ctx->fsm_mgr );
 }
 
+/* error recovery is stepped by the firmware thread, nothing here waits for the hardware */
+#define ISP_RECOVERY_POLL_MS 2
+#define ISP_RECOVERY_STOP_TIMEOUT_MS 20
+#define ISP_RECOVERY_RESET_TIMEOUT_MS 50
+#define ISP_RECOVERY_RETRY_MAX 2
+#define ISP_RECOVERY_STORM_MS 1000 // an error this soon after a recovery escalates the next one
+
+static uint32_t recovery_elapsed_ms( uint32_t since )
+{
+    uint32_t freq = system_timer_frequency();
+    uint32_t ticks = system_timer_timestamp() - since;
+
+    if ( !freq )
+        return 0;
+
+    return ( ticks / freq ) * 1000 + ( ( ticks % freq ) * 1000 ) / freq;
+}
+
+static int recovery_isp_stopped( acamera_context_t *p_ctx )
+{
+    return acamera_isp_input_port_mode_status_read( p_ctx->settings.isp_base ) == ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_STOP &&
+           !acamera_isp_isp_global_monitor_fr_pipeline_busy_read( p_ctx->settings.isp_base );
+}
+
+static void recovery_request_stop( acamera_context_t *p_ctx, acamera_isp_recovery_t *p_rec )
+{
+    acamera_isp_input_port_mode_request_write( p_ctx->settings.isp_base, ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_STOP );
+    p_rec->state = ISP_RECOVERY_STOPPING;
+    p_rec->step_time = system_timer_timestamp();
+}
+
+static void recovery_fsm_reset( acamera_context_t *p_ctx )
+{
+    acamera_isp_isp_global_global_fsm_reset_write( p_ctx->settings.isp_base, 1 );
+    acamera_isp_isp_global_global_fsm_reset_write( p_ctx->settings.isp_base, 0 );
+}
+
+static void recovery_full_reset( acamera_context_t *p_ctx, acamera_isp_recovery_t *p_rec )
+{
+    p_rec->stats.full_resets++;
+
+    acamera_isp_input_port_mode_request_write( p_ctx->settings.isp_base, ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_STOP );
+    recovery_fsm_reset( p_ctx );
+
+    // a transfer cut by the error never completes, do not let frame start wait for it
+    p_ctx->p_gfw->dma_flag_isp_config_completed = 1;
+    p_ctx->p_gfw->dma_flag_isp_metering_completed = 1;
+
+    p_rec->state = ISP_RECOVERY_RESETTING;
+    p_rec->step_time = system_timer_timestamp();
+    // the config upload goes through dma, the firmware thread does it before the restart
+    p_rec->reload = 1;
+    if ( p_rec->level == ISP_RECOVERY_LEVEL_REPORT )
+        p_rec->report = 1;
+}
+
+static void recovery_finish( acamera_context_t *p_ctx, acamera_isp_recovery_t *p_rec )
+{
+    uint32_t duration = recovery_elapsed_ms( p_rec->start_time );
+    uint32_t bin = 0;
+
+    //return the interrupts
+    acamera_isp_isp_global_interrupt_mask_vector_write( 0, ISP_IRQ_MASK_VECTOR );
+    acamera_isp_input_port_mode_request_write( p_ctx->settings.isp_base, ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_START );
+
+    while ( bin < ACAMERA_ISP_RECOVERY_HIST_BINS - 1 && duration >= ( 1u << bin ) )
+        bin++;
+    p_rec->stats.duration_hist[bin]++;
+    if ( duration > p_rec->stats.max_duration_ms )
+        p_rec->stats.max_duration_ms = duration;
+
+    p_rec->state = ISP_RECOVERY_IDLE;
+    p_rec->end_time = system_timer_timestamp();
+    p_rec->finished++;
+    p_rec->stats.active = 0;
+
+    LOG( LOG_CRIT, "starting isp from error 0x%x after %u ms, level %u", p_rec->irq_mask, duration, p_rec->level );
+}
+
+static void recovery_report( acamera_context_t *p_ctx, uint32_t irq_mask )
+{
+    LOG( LOG_CRIT, "isp error recovery escalated to the application, errors 0x%x", irq_mask );
+
+    if ( p_ctx->settings.callback_error != NULL ) {
+        p_ctx->settings.callback_error( p_ctx->context_id, irq_mask );
+    }
+}
+
+void acamera_fw_error_init( acamera_isp_recovery_t *p_rec )
+{
+    system_spinlock_init( &p_rec->lock );
+    p_rec->state = ISP_RECOVERY_IDLE;
+    p_rec->level = ISP_RECOVERY_LEVEL_RETRY;
+    p_rec->attempt = 0;
+    p_rec->irq_mask = 0;
+    p_rec->reload = 0;
+    p_rec->report = 0;
+    p_rec->end_time = 0;
+    p_rec->finished = 0;
+    system_memset( &p_rec->stats, 0, sizeof( p_rec->stats ) );
+}
+
+void acamera_fw_error_deinit( acamera_isp_recovery_t *p_rec )
+{
+    system_spinlock_destroy( p_rec->lock );
+}
+
+// called from the interrupt path, only masks the interrupts and requests the stop
 void acamera_fw_error_routine( acamera_context_t *p_ctx, uint32_t irq_mask )
 {
+    acamera_isp_recovery_t *p_rec = &p_ctx->p_gfw->recovery;
+    unsigned long flags;
+    int bit;
+
+    flags = system_spinlock_lock( p_rec->lock );
+
+    for ( bit = 0; bit < 32; bit++ ) {
+        if ( irq_mask & ( 1u << bit ) )
+            p_rec->stats.irq_errors[bit]++;
+    }
+
+    if ( p_rec->state != ISP_RECOVERY_IDLE ) {
+        p_rec->irq_mask |= irq_mask;
+        system_spinlock_unlock( p_rec->lock, flags );
+        return;
+    }
+
     //masked all interrupts
     acamera_isp_isp_global_interrupt_mask_vector_write( 0, ISP_IRQ_DISABLE_ALL_IRQ );
-    //safe stop
-    acamera_isp_input_port_mode_request_write( p_ctx->settings.isp_base, ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_STOP );
 
-    // check whether the HW is stopped or not.
-    uint32_t count = 0;
-    while ( acamera_isp_input_port_mode_status_read( p_ctx->settings.isp_base ) != ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_STOP || acamera_isp_isp_global_monitor_fr_pipeline_busy_read( p_ctx->settings.isp_base ) ) {
-        //cannot sleep use this delay
-        do {
-            count++;
-        } while ( count % 32 != 0 );
-
-        if ( ( count >> 5 ) > 50 ) {
-            LOG( LOG_CRIT, "stopping isp failed, timeout: %u.", (unsigned int)count * 1000 );
-            break;
+    if ( p_rec->finished && recovery_elapsed_ms( p_rec->end_time ) < ISP_RECOVERY_STORM_MS ) {
+        if ( p_rec->level < ISP_RECOVERY_LEVEL_REPORT )
+            p_rec->level++;
+    } else {
+        p_rec->level = ISP_RECOVERY_LEVEL_RETRY;
+    }
+
+    p_rec->irq_mask = irq_mask;
+    p_rec->attempt = 0;
+    p_rec->start_time = system_timer_timestamp();
+    p_rec->stats.recoveries++;
+    p_rec->stats.active = 1;
+
+    if ( p_rec->level == ISP_RECOVERY_LEVEL_RETRY ) {
+        recovery_request_stop( p_ctx, p_rec );
+    } else {
+        recovery_full_reset( p_ctx, p_rec );
+    }
+
+    system_spinlock_unlock( p_rec->lock, flags );
+
+    acamera_wake( ACAMERA_WAKE_RECOVERY );
+}
+
+// advance the recovery, returns the time in ms until it wants to be called again or 0 when idle
+uint32_t acamera_fw_error_process( acamera_context_t *p_ctx )
+{
+    acamera_isp_recovery_t *p_rec = &p_ctx->p_gfw->recovery;
+    unsigned long flags;
+    uint32_t restart = 0;
+    uint32_t reload;
+    uint32_t report;
+    uint32_t irq_mask;
+    uint32_t state;
+
+    flags = system_spinlock_lock( p_rec->lock );
+
+    switch ( p_rec->state ) {
+    case ISP_RECOVERY_STOPPING:
+        if ( recovery_isp_stopped( p_ctx ) ) {
+            recovery_fsm_reset( p_ctx );
+            recovery_finish( p_ctx, p_rec );
+        } else if ( recovery_elapsed_ms( p_rec->step_time ) > ISP_RECOVERY_STOP_TIMEOUT_MS ) {
+            if ( p_rec->attempt < ISP_RECOVERY_RETRY_MAX ) {
+                p_rec->attempt++;
+                p_rec->stats.retries++;
+                LOG( LOG_ERR, "stopping isp timed out, retry %u", (unsigned int)p_rec->attempt );
+                recovery_request_stop( p_ctx, p_rec );
+            } else {
+                LOG( LOG_ERR, "stopping isp failed, full reset" );
+                p_rec->level = ISP_RECOVERY_LEVEL_FULL_RESET;
+                recovery_full_reset( p_ctx, p_rec );
+            }
+        }
+        break;
+
+    case ISP_RECOVERY_RESETTING:
+        // the restart waits for the config reload below, the dma can not run under the lock
+        if ( !acamera_isp_isp_global_monitor_fr_pipeline_busy_read( p_ctx->settings.isp_base ) ) {
+            restart = 1;
+        } else if ( recovery_elapsed_ms( p_rec->step_time ) > ISP_RECOVERY_RESET_TIMEOUT_MS ) {
+            // restart anyway, the application decides whether to tear the stream down
+            p_rec->level = ISP_RECOVERY_LEVEL_REPORT;
+            p_rec->report = 1;
+            restart = 1;
         }
+        break;
+
+    default:
+        break;
     }
 
-    acamera_isp_isp_global_global_fsm_reset_write( p_ctx->settings.isp_base, 1 );
-    acamera_isp_isp_global_global_fsm_reset_write( p_ctx->settings.isp_base, 0 );
+    reload = restart && p_rec->reload;
+    report = p_rec->report;
+    if ( restart )
+        p_rec->reload = 0;
+    p_rec->report = 0;
+    if ( report )
+        p_rec->stats.reported++;
+    irq_mask = p_rec->irq_mask;
+    state = p_rec->state;
+
+    system_spinlock_unlock( p_rec->lock, flags );
+
+    if ( reload ) {
+        acamera_reset_ping_pong_port();
+        acamera_update_cur_settings_to_isp( 0xff );
+    }
 
-    //return the interrupts
-    acamera_isp_isp_global_interrupt_mask_vector_write( 0, ISP_IRQ_MASK_VECTOR );
+    if ( restart ) {
+        // interrupts are still masked, so nothing moved the state while unlocked
+        flags = system_spinlock_lock( p_rec->lock );
+        if ( p_rec->state == ISP_RECOVERY_RESETTING )
+            recovery_finish( p_ctx, p_rec );
+        state = p_rec->state;
+        system_spinlock_unlock( p_rec->lock, flags );
+    }
 
-    acamera_isp_input_port_mode_request_write( p_ctx->settings.isp_base, ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_START );
+    if ( report ) {
+        recovery_report( p_ctx, irq_mask );
+    }
 
-    LOG( LOG_CRIT, "starting isp from error" );
+    return state != ISP_RECOVERY_IDLE ? ISP_RECOVERY_POLL_MS : 0;
 }
 
 
@@ -172,7 +377,7 @@ void acamera_fw_raise_event( acamera_context_t *p_ctx, event_id_t event_id )
          ) {
         acamera_event_queue_push( &p_ctx->fsm_mgr.event_queue, (int)( event_id ) );
 
-        acamera_notify_evt_data_avail();
+        acamera_notify_evt_data_avail( p_ctx->context_id );
     }
 }
 
@@ -188,7 +393,7 @@ void acamera_fsm_mgr_raise_event( acamera_fsm_mgr_t *p_fsm_mgr, event_id_t event
          ) {
         acamera_event_queue_push( &( p_fsm_mgr->event_queue ), (int)( event_id ) );
 
-        acamera_notify_evt_data_avail();
+        acamera_notify_evt_data_avail( p_fsm_mgr->ctx_id );
     }
 }
 
@@ -324,6 +529,8 @@ static void internal_callback_fr( void *ctx, tframe_t *tframe, const metadata_t
 {
     acamera_context_ptr_t p_ctx = (acamera_context_ptr_t)ctx;
 
+    if ( metadata )
+        SYS_TIMELINE_MARK( p_ctx->context_id, metadata->frame_id, SYS_TIMELINE_WRITER + SYS_TIMELINE_OUT_FR );
     if ( p_ctx->settings.callback_fr != NULL ) {
         p_ctx->settings.callback_fr( p_ctx->context_id, tframe, metadata );
     }
@@ -336,6 +543,8 @@ static void internal_callback_ds1( void *ctx, tframe_t *tframe, const metadata_t
 {
 
     acamera_context_ptr_t p_ctx = (acamera_context_ptr_t)ctx;
+    if ( metadata )
+        SYS_TIMELINE_MARK( p_ctx->context_id, metadata->frame_id, SYS_TIMELINE_WRITER + SYS_TIMELINE_OUT_DS1 );
     if ( p_ctx->settings.callback_ds1 != NULL ) {
         p_ctx->settings.callback_ds1( p_ctx->context_id, tframe, metadata );
     }
@@ -348,6 +557,8 @@ static void external_callback_ds2( void *ctx, tframe_t *tframe, const metadata_t
 {
 
     acamera_context_ptr_t p_ctx = (acamera_context_ptr_t)ctx;
+    if ( metadata )
+        SYS_TIMELINE_MARK( p_ctx->context_id, metadata->frame_id, SYS_TIMELINE_WRITER + SYS_TIMELINE_OUT_DS2 );
     if ( p_ctx->settings.callback_ds2 != NULL ) {
         p_ctx->settings.callback_ds2( p_ctx->context_id, tframe, metadata );
     }
@@ -496,6 +707,7 @@ int32_t acamera_init_context( acamera_context_t *p_ctx, acamera_settings *settin
     // reset frame counters
     p_ctx->isp_frame_counter_raw = 0;
     p_ctx->isp_frame_counter = 0;
+    p_ctx->isp_frame_hw_offset = 0;
 
     acamera_fw_init( p_ctx );
 
@@ -542,6 +754,7 @@ int32_t acamera_init_context( acamera_context_t *p_ctx, acamera_settings *settin
         // reset frame counters
         p_ctx->isp_frame_counter_raw = 0;
         p_ctx->isp_frame_counter = 0;
+        p_ctx->isp_frame_hw_offset = 0;
 
         acamera_fw_init( p_ctx );
 
@@ -606,6 +819,8 @@ void acamera_general_interrupt_hanlder( acamera_context_ptr_t p_ctx, uint8_t eve
             p_ctx->isp_frame_counter = p_ctx->isp_frame_counter_raw;
         }
 #endif
+        // maps the hardware frame ids of the exposure history to the buffer frame ids
+        p_ctx->isp_frame_hw_offset = p_ctx->isp_frame_counter - acamera_isp_isp_global_dbg_frame_cnt_ctx0_read( p_ctx->settings.isp_base );
 
         acamera_fw_raise_event( p_ctx, event_id_frame_end );
 
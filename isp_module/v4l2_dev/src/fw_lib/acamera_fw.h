@@ -25,7 +25,9 @@
 #include "acamera_calibrations.h"
 #include "system_interrupts.h"
 #include "system_semaphore.h"
+#include "system_spinlock.h"
 #include "acamera_firmware_api.h"
+#include "acamera_ctrl_batch.h"
 #include "acamera_isp_core_nomem_settings.h"
 #include "acamera_firmware_config.h"
 #include "acamera_isp_config.h"
@@ -103,6 +105,8 @@ typedef struct _sytem_tab {
 
 typedef struct _acamera_isp_sw_regs_map {
     volatile uint8_t *isp_sw_config_map;
+    volatile uint8_t *isp_sw_config_commit; // last consistent config, uploaded at frame start
+    volatile uint8_t *isp_sw_metering_dma;  // metering dma target, latched into the context at new_frame
 } acamera_isp_sw_regs_map;
 
 
@@ -128,6 +132,9 @@ struct _acamera_context_t {
     // current calibration set
     ACameraCalibrations acameraCalibrations;
 
+    // last modulation segment used per calibration table
+    uint16_t calibration_mod_hint[CALIBRATION_TOTAL_SIZE];
+
     // global settings which can be shared through fsms
     system_tab stab;
 
@@ -145,11 +152,55 @@ struct _acamera_context_t {
     /* frame counters */
     uint32_t isp_frame_counter_raw; // frame counter for raw callback
     uint32_t isp_frame_counter;     // frame counter for frame / metadata callbacks
+    uint32_t isp_frame_hw_offset;   // isp_frame_counter minus the hardware frame id, latched at frame end
 
     acamera_isp_sw_regs_map sw_reg_map;
 };
 
 
+/* ISP error recovery */
+#define ISP_RECOVERY_IDLE 0
+#define ISP_RECOVERY_STOPPING 1  // safe stop requested, waiting for the input port and pipeline
+#define ISP_RECOVERY_RESETTING 2 // global FSM reset done, waiting for the pipeline to drain
+
+#define ISP_RECOVERY_LEVEL_RETRY 0      // safe stop and FSM reset
+#define ISP_RECOVERY_LEVEL_FULL_RESET 1 // FSM reset without waiting for the stop, config reloaded
+#define ISP_RECOVERY_LEVEL_REPORT 2     // full reset and the application is told
+
+#if defined( ISP_INTERRUPT_EVENT_BROKEN_FRAME ) && defined( ISP_INTERRUPT_EVENT_MULTICTX_ERROR ) && defined( ISP_INTERRUPT_EVENT_DMA_ERROR ) && defined( ISP_INTERRUPT_EVENT_WATCHDOG_EXP ) && defined( ISP_INTERRUPT_EVENT_FRAME_COLLISION )
+#define ISP_RECOVERY_ERROR_MASK ( ( 1u << ISP_INTERRUPT_EVENT_BROKEN_FRAME ) |  \
+                                  ( 1u << ISP_INTERRUPT_EVENT_MULTICTX_ERROR ) | \
+                                  ( 1u << ISP_INTERRUPT_EVENT_DMA_ERROR ) |      \
+                                  ( 1u << ISP_INTERRUPT_EVENT_WATCHDOG_EXP ) |   \
+                                  ( 1u << ISP_INTERRUPT_EVENT_FRAME_COLLISION ) )
+#endif
+
+typedef struct _acamera_isp_recovery_t {
+    sys_spinlock lock;
+    uint32_t state;
+    uint32_t level;
+    uint32_t attempt;    // safe stop requests in the current recovery
+    uint32_t irq_mask;   // errors seen during the current recovery
+    uint32_t reload;     // isp config to be uploaded again by the firmware thread
+    uint32_t report;     // application to be told by the firmware thread
+    uint32_t start_time; // system timer ticks
+    uint32_t step_time;  // when the current state was entered
+    uint32_t end_time;   // end of the last recovery
+    uint32_t finished;   // recoveries ended since init, unlike the stats not cleared from sysfs
+    acamera_isp_error_stats_t stats;
+} acamera_isp_recovery_t;
+
+
+typedef struct _acamera_ctrl_batch_queue_t {
+    sys_spinlock lock;
+    uint32_t frame;                   // frame id of the last frame start
+    acamera_ctrl_batch_list_t queued; // batches waiting for their frame
+    // applied batches waiting for their exposure, firmware thread only
+    uint32_t report_num;
+    acamera_ctrl_batch_report_t report[ACAMERA_CTRL_BATCH_QUEUE_SIZE];
+} acamera_ctrl_batch_queue_t;
+
+
 struct _acamera_firmware_t {
 #if ISP_DMA_RAW_CAPTURE
     // dma_capture
@@ -165,10 +216,26 @@ struct _acamera_firmware_t {
     uint32_t dma_flag_isp_config_completed;
     void *dma_chan_isp_metering;
     uint32_t dma_flag_isp_metering_completed;
+    uint32_t metering_stats_pending; // stats in the metering dma buffer not latched yet
+
+    /* frame start statistics */
+    uint32_t frame_start_count;   // frame starts that uploaded a config
+    uint32_t stale_config_count;  // of those, frames started with events still pending
+    uint32_t config_commit_count; // configs committed by the firmware thread
+    uint32_t metering_stale_count; // new_frame events which reused the previous stats
 
     uint32_t initialized;
 
     semaphore_t sem_evt_avail;
+
+    /* pending wake sources of the processing loop */
+    sys_spinlock wake_lock;
+    uint32_t wake_mask;
+    uint32_t wake_count[32];
+
+    acamera_isp_recovery_t recovery;
+
+    acamera_ctrl_batch_queue_t ctrl_batch;
 };
 
 void acamera_load_isp_sequence( uintptr_t isp_base, const acam_reg_t **sequence, uint8_t num );
@@ -211,6 +278,9 @@ static __inline void acamera_isp_interrupts_disable( acamera_fsm_mgr_t *p_fsm_mg
 
 void acamera_fw_raise_event( acamera_context_ptr_t p_ctx, event_id_t event_id );
 
+// take the metering stats of the new frame into the software context, firmware thread only
+void acamera_latch_metering_stats( acamera_context_ptr_t p_ctx );
+
 void acamera_fw_process( acamera_context_t *p_ctx );
 
 void acamera_fw_init( acamera_context_t *p_ctx );
@@ -222,7 +292,10 @@ void acamera_general_interrupt_hanlder( acamera_context_ptr_t p_ctx, uint8_t eve
 int32_t acamera_init_calibrations( acamera_context_ptr_t p_ctx );
 void acamera_change_resolution( acamera_context_ptr_t p_ctx, uint32_t exposure_correction );
 void configure_buffers( acamera_context_ptr_t p_ctx, uint32_t start_addr, uint16_t width, uint16_t height );
+void acamera_fw_error_init( acamera_isp_recovery_t *p_rec );
+void acamera_fw_error_deinit( acamera_isp_recovery_t *p_rec );
 void acamera_fw_error_routine( acamera_context_t *p_ctx, uint32_t irq_mask );
+uint32_t acamera_fw_error_process( acamera_context_t *p_ctx );
 
 #define ACAMERA_MGR2CTX_PTR( p_fsm_mgr ) \
     ( ( p_fsm_mgr )->p_ctx )
@@ -20,6 +20,26 @@
 #include "acamera_logger.h"
 #include "acamera_math.h"
 
+/*
+ * FW_FAST_MATH selects the CLZ based bit position search and the
+ * multiplication free 32 and 64 bit square roots. Both variants return
+ * exactly the same values as the generic code below for the whole input
+ * range.
+ */
+#if FW_FAST_MATH
+
+static inline uint8_t leading_one_position( const uint32_t in )
+{
+    return ( in == 0 ) ? 0 : ( uint8_t )( 31 - __builtin_clz( in ) );
+}
+
+static inline int leading_one_position_64( uint64_t val )
+{
+    return ( val == 0 ) ? 0 : 63 - __builtin_clzll( val );
+}
+
+#else
+
 static uint8_t leading_one_position( const uint32_t in )
 {
     uint8_t pos = 0;
@@ -74,6 +94,9 @@ static int leading_one_position_64( uint64_t val )
     }
     return pos;
 }
+
+#endif // FW_FAST_MATH
+
 //  y = log2(x)
 //
 //    input:  Integer: val
@@ -181,6 +204,55 @@ uint32_t acamera_math_exp2( uint32_t val, const unsigned char shift_in, const un
     }
 }
 
+#if FW_FAST_MATH
+
+//  Digit by digit square root, y = floor(sqrt(x))
+//  starts from the leading one of the argument and uses only shifts and
+//  subtractions, the digit selection is done with a mask to avoid branches
+uint32_t acamera_sqrt64( uint64_t arg )
+{
+    uint64_t rem = arg;
+    uint64_t res = 0;
+    uint64_t bit;
+
+    if ( arg == 0 ) {
+        return 0;
+    }
+
+    bit = (uint64_t)1 << ( leading_one_position_64( arg ) & ~1 );
+    while ( bit != 0 ) {
+        uint64_t trial = res + bit;
+        uint64_t mask = -(uint64_t)( rem >= trial );
+        rem -= trial & mask;
+        res = ( res >> 1 ) + ( bit & mask );
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+uint16_t acamera_sqrt32( uint32_t arg )
+{
+    uint32_t rem = arg;
+    uint32_t res = 0;
+    uint32_t bit;
+
+    if ( arg == 0 ) {
+        return 0;
+    }
+
+    bit = (uint32_t)1 << ( leading_one_position( arg ) & ~1 );
+    while ( bit != 0 ) {
+        uint32_t trial = res + bit;
+        uint32_t mask = -(uint32_t)( rem >= trial );
+        rem -= trial & mask;
+        res = ( res >> 1 ) + ( bit & mask );
+        bit >>= 2;
+    }
+    return (uint16_t)res;
+}
+
+#else
+
 uint32_t acamera_sqrt64( uint64_t arg )
 {
     uint64_t mask = (uint64_t)1 << 31;
@@ -207,6 +279,9 @@ uint16_t acamera_sqrt32( uint32_t arg )
     return res;
 }
 
+#endif // FW_FAST_MATH
+
+// 8 result bits, the digit by digit variant is not faster here
 uint8_t acamera_sqrt16( uint16_t arg )
 {
     uint8_t mask = 128;
@@ -220,6 +295,7 @@ uint8_t acamera_sqrt16( uint16_t arg )
     }
     return res;
 }
+
 //  y = log2(x)
 //
 //    input:  Integer: val
@@ -347,7 +423,58 @@ uint16_t acamera_line_offset( uint16_t line_len, uint8_t bytes_per_pixel )
     return ( bytes_per_pixel * line_len + alignment - 1 ) & ~( alignment - 1 );
 }
 
-uint16_t acamera_calc_modulation_u16( uint16_t x, const modulation_entry_t *p_table, int table_len )
+// Tables up to this length are scanned linearly, longer ones are bisected
+#define MODULATION_BSEARCH_MIN_LEN 8
+
+/*
+ * Return the first segment end i in [1, table_len - 1] with x < p_table[i].x.
+ * The caller has already clamped x to ( p_table[0].x, p_table[table_len - 1].x )
+ * and the calibration x values are non-decreasing, so such an i always exists.
+ * When p_hint is given the segment found last time is tried first, which is
+ * the common case as gain moves slowly from frame to frame.
+ */
+#define MODULATION_FIND_SEGMENT( name, x_type, entry_type )                                 \
+    static int name( x_type x, const entry_type *p_table, int table_len, uint16_t *p_hint ) \
+    {                                                                                       \
+        int i;                                                                              \
+                                                                                            \
+        if ( p_hint != NULL ) {                                                             \
+            i = *p_hint;                                                                    \
+            if ( i >= 1 && i < table_len && p_table[i - 1].x <= x && x < p_table[i].x ) {   \
+                return i;                                                                   \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        if ( table_len <= MODULATION_BSEARCH_MIN_LEN ) {                                    \
+            for ( i = 1; i < table_len; ++i ) {                                             \
+                if ( x < p_table[i].x ) {                                                   \
+                    break;                                                                  \
+                }                                                                           \
+            }                                                                               \
+        } else {                                                                            \
+            int hi = table_len - 1;                                                         \
+            i = 1;                                                                          \
+            while ( i < hi ) {                                                              \
+                int mid = ( i + hi ) >> 1;                                                  \
+                if ( x < p_table[mid].x ) {                                                 \
+                    hi = mid;                                                               \
+                } else {                                                                    \
+                    i = mid + 1;                                                            \
+                }                                                                           \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        if ( p_hint != NULL ) {                                                             \
+            *p_hint = i;                                                                    \
+        }                                                                                   \
+                                                                                            \
+        return i;                                                                           \
+    }
+
+MODULATION_FIND_SEGMENT( modulation_find_segment_u16, uint16_t, modulation_entry_t )
+MODULATION_FIND_SEGMENT( modulation_find_segment_u32, uint32_t, modulation_entry_32_t )
+
+uint16_t acamera_calc_modulation_u16_hint( uint16_t x, const modulation_entry_t *p_table, int table_len, uint16_t *p_hint )
 {
     if ( x <= p_table->x ) {
         return p_table->y;
@@ -356,12 +483,7 @@ uint16_t acamera_calc_modulation_u16( uint16_t x, const modulation_entry_t *p_ta
         return p_table[table_len - 1].y;
     }
     {
-        int i;
-        for ( i = 1; i < table_len; ++i ) {
-            if ( x < p_table[i].x ) {
-                break;
-            }
-        }
+        int i = modulation_find_segment_u16( x, p_table, table_len, p_hint );
         if ( ( p_table[i].x - p_table[i - 1].x ) != 0 ) {
             int alpha = ( x - p_table[i - 1].x ) * 256 / ( p_table[i].x - p_table[i - 1].x ); // division by zero is checked
             return ( p_table[i].y * alpha + p_table[i - 1].y * ( 256 - alpha ) ) >> 8;
@@ -372,7 +494,12 @@ uint16_t acamera_calc_modulation_u16( uint16_t x, const modulation_entry_t *p_ta
     }
 }
 
-uint32_t acamera_calc_modulation_u32( uint32_t x, const modulation_entry_32_t *p_table, int table_len )
+uint16_t acamera_calc_modulation_u16( uint16_t x, const modulation_entry_t *p_table, int table_len )
+{
+    return acamera_calc_modulation_u16_hint( x, p_table, table_len, NULL );
+}
+
+uint32_t acamera_calc_modulation_u32_hint( uint32_t x, const modulation_entry_32_t *p_table, int table_len, uint16_t *p_hint )
 {
     if ( x <= p_table->x ) {
         return p_table->y;
@@ -381,12 +508,7 @@ uint32_t acamera_calc_modulation_u32( uint32_t x, const modulation_entry_32_t *p
         return p_table[table_len - 1].y;
     }
     {
-        uint16_t i;
-        for ( i = 1; i < table_len; ++i ) {
-            if ( x < p_table[i].x ) {
-                break;
-            }
-        }
+        uint16_t i = modulation_find_segment_u32( x, p_table, table_len, p_hint );
         if ( ( p_table[i].x - p_table[i - 1].x ) != 0 ) {
             // 32bit choosen to prevent overflows
             uint32_t alpha = ( x - p_table[i - 1].x ) * 256 / ( p_table[i].x - p_table[i - 1].x ); // division by zero is checked
@@ -398,6 +520,11 @@ uint32_t acamera_calc_modulation_u32( uint32_t x, const modulation_entry_32_t *p
     }
 }
 
+uint32_t acamera_calc_modulation_u32( uint32_t x, const modulation_entry_32_t *p_table, int table_len )
+{
+    return acamera_calc_modulation_u32_hint( x, p_table, table_len, NULL );
+}
+
 uint16_t acamera_calc_scaled_modulation_u16( uint16_t x, uint16_t target_min_y, uint16_t target_max_y, const modulation_entry_t *p_table, int table_len )
 {
     if ( x <= p_table[0].x ) {
@@ -414,12 +541,7 @@ uint16_t acamera_calc_scaled_modulation_u16( uint16_t x, uint16_t target_min_y,
         uint32_t scale_max_y = (uint32_t)target_max_y * 256 / p_table[table_len - 1].y;       // division by zero is checked
         int alpha = ( x - p_table[0].x ) * 256 / ( p_table[table_len - 1].x - p_table[0].x ); // division by zero is checked
         uint32_t scale_factor = ( scale_max_y * alpha + scale_min_y * ( 256 - alpha ) ) >> 8;
-        int i;
-        for ( i = 1; i < table_len; ++i ) {
-            if ( x < p_table[i].x ) {
-                break;
-            }
-        }
+        int i = modulation_find_segment_u16( x, p_table, table_len, NULL );
         if ( ( p_table[i].x - p_table[i - 1].x ) != 0 ) {
             alpha = ( x - p_table[i - 1].x ) * 256 / ( p_table[i].x - p_table[i - 1].x ); // division by zero is checked
             return scale_factor * ( p_table[i].y * alpha + p_table[i - 1].y * ( 256 - alpha ) ) >> 16;
@@ -408,10 +408,9 @@ void awb_normalise( AWB_fsm_t *p_fsm )
             }
         }
 
-        fsm_param_sensor_info_t sensor_info;
-        acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+        const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-        diff = ( ISP_INPUT_BITS << LOG2_GAIN_SHIFT ) - acamera_log2_fixed_to_fixed( ( 1 << ISP_INPUT_BITS ) - sensor_info.black_level, 0, LOG2_GAIN_SHIFT ) - min_wb;
+        diff = ( ISP_INPUT_BITS << LOG2_GAIN_SHIFT ) - acamera_log2_fixed_to_fixed( ( 1 << ISP_INPUT_BITS ) - sensor_info->black_level, 0, LOG2_GAIN_SHIFT ) - min_wb;
         for ( i = 0; i < 4; ++i ) {
             int32_t _wb = wb[i] + diff;
             p_fsm->wb_log2[i] = _wb;
@@ -32,7 +32,12 @@ void cmos_fsm_clear( cmos_fsm_t *p_fsm )
     p_fsm->exposure = 256;
     p_fsm->exposure_log2 = 2 << LOG2_GAIN_SHIFT;
     p_fsm->max_exposure_log2 = 2 << LOG2_GAIN_SHIFT;
-    p_fsm->exposure_hist_pos = -1;
+    system_memset( p_fsm->exposure_hist, 0, sizeof( p_fsm->exposure_hist ) );
+    p_fsm->exposure_hist_frame_id = 0;
+    p_fsm->exp_next_seq = 0;
+    p_fsm->exp_update_count = 0;
+    p_fsm->exp_adjust_req = 0;
+    p_fsm->exp_adjust_done = 0;
     p_fsm->flicker_freq = 50 * 256;
     p_fsm->exposure_ratio_in = 64;
     p_fsm->integration_time_short = 0;
@@ -143,7 +148,6 @@ int cmos_fsm_set_param( void *fsm, uint32_t param_id, void *input, uint32_t inpu
         break;
 
     case FSM_PARAM_SET_CMOS_ADJUST_EXP: {
-        int i;
         int32_t corr = 0;
 
         if ( !input || input_size != sizeof( int32_t ) ) {
@@ -154,13 +158,8 @@ int cmos_fsm_set_param( void *fsm, uint32_t param_id, void *input, uint32_t inpu
 
         corr = *(int32_t *)input;
 
-        // adjust exposure
-        for ( i = 0; i < array_size( p_fsm->exposure_hist ); i++ ) {
-            exposure_info_set_t *info = &cmos_get_frame_exposure_set( p_fsm, i )->info;
-            info->exposure_log2 += corr;
-            if ( info->exposure_log2 < 0 )
-                info->exposure_log2 = 0;
-        }
+        // the history is owned by frame start, which applies the correction to every stored frame
+        p_fsm->exp_adjust_req += corr;
         break;
     }
 
@@ -249,12 +248,21 @@ int cmos_fsm_get_param( void *fsm, uint32_t param_id, void *input, uint32_t inpu
             break;
         }
 
-        exposure_set_t *p_set_get = NULL;
-        exposure_set_t *p_set_out = (exposure_set_t *)output;
+        cmos_get_frame_exposure_set( p_fsm, *( (int *)input ), (exposure_set_t *)output );
 
-        p_set_get = cmos_get_frame_exposure_set( p_fsm, *( (int *)input ) );
+        break;
+    }
+
+    case FSM_PARAM_GET_FRAME_EXPOSURE_SET_BY_ID: {
+        if ( ( !input || input_size != sizeof( uint32_t ) ) ||
+             ( !output || output_size != sizeof( exposure_set_t ) ) ) {
+            LOG( LOG_ERR, "Inavlid param, param_id: %d.", param_id );
+            rc = -1;
+            break;
+        }
 
-        *p_set_out = *p_set_get;
+        // fails when the frame has already left the history or is not scheduled yet
+        rc = cmos_get_exposure_set_by_frame_id( p_fsm, *( (uint32_t *)input ), (exposure_set_t *)output );
 
         break;
     }
@@ -333,6 +341,17 @@ int cmos_fsm_get_param( void *fsm, uint32_t param_id, void *input, uint32_t inpu
 
         break;
 
+    case FSM_PARAM_GET_CMOS_EXPOSURE_UPDATES:
+        if ( ( !output || output_size != sizeof( uint32_t ) ) ) {
+            LOG( LOG_ERR, "Inavlid param, param_id: %d.", param_id );
+            rc = -1;
+            break;
+        }
+
+        *(uint32_t *)output = p_fsm->exp_update_count;
+
+        break;
+
     case FSM_PARAM_GET_CMOS_SPLIT_STRATEGY:
         if ( ( !output || output_size != sizeof( uint32_t ) ) ) {
             LOG( LOG_ERR, "Inavlid param, param_id: %d.", param_id );
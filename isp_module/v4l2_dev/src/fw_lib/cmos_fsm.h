@@ -33,6 +33,10 @@ typedef const struct _cmos_fsm_t *cmos_fsm_const_ptr_t;
 
 #define API_OTAE_ITERATION_COUNT ( 15 )
 
+// exposure history ring, the size must be a power of two
+#define CMOS_EXPOSURE_HIST_SIZE ( 8 )
+#define CMOS_EXPOSURE_HIST_MASK ( CMOS_EXPOSURE_HIST_SIZE - 1 )
+
 #if FILTER_LONG_INT_TIME
 typedef struct _it_long_hist_t {
     uint32_t v[FILTER_LONG_INT_TIME];
@@ -101,6 +105,17 @@ typedef struct _fps_counter_t {
     uint32_t avg_frame_ticks;
 } fps_counter_t;
 
+/*
+ * One exposure per frame, keyed by the frame id the exposure is applied to.
+ * Slots are only written from the frame start interrupt; seq is odd while a
+ * slot is being written and 0 for a slot which has never been written.
+ */
+typedef struct _cmos_exposure_slot_t {
+    volatile uint32_t seq;
+    uint32_t frame_id;
+    exposure_set_t set;
+} cmos_exposure_slot_t;
+
 void cmos_update_exposure_partitioning_lut( cmos_fsm_ptr_t p_fsm );
 void cmos_init( cmos_fsm_ptr_t p_fsm );
 void cmos_deinit( cmos_fsm_ptr_t p_fsm );
@@ -117,7 +132,8 @@ void cmos_calc_target_gain( cmos_fsm_ptr_t p_fsm );
 void cmos_update_exposure( cmos_fsm_ptr_t p_fsm );
 void cmos_update_exposure_history( cmos_fsm_ptr_t p_fsm );
 void cmos_set_exposure_target( cmos_fsm_ptr_t p_fsm, int32_t exposure_log2, uint32_t exposure_ratio );
-exposure_set_t *cmos_get_frame_exposure_set( cmos_fsm_ptr_t p_fsm, int i_frame );
+void cmos_get_frame_exposure_set( cmos_fsm_const_ptr_t p_fsm, int i_frame, exposure_set_t *p_set );
+int cmos_get_exposure_set_by_frame_id( cmos_fsm_const_ptr_t p_fsm, uint32_t frame_id, exposure_set_t *p_set );
 uint16_t cmos_get_fps( cmos_fsm_ptr_t p_fsm );
 
 struct _cmos_fsm_t {
@@ -130,8 +146,11 @@ struct _cmos_fsm_t {
     uint32_t manual_gain;
     uint32_t exposure;
     int32_t exposure_log2;
-    sys_spinlock exp_lock;
-    exposure_set_t exp_next_set;
+    /* latched copies of the next exposure: readers use exp_next_set[exp_next_seq & 1] */
+    volatile uint32_t exp_next_seq;
+    exposure_set_t exp_next_set[2];
+    /* exposures computed so far, stamped into each set as update_count */
+    uint32_t exp_update_count;
     exposure_data_set_t exp_write_set;
     int32_t max_exposure_log2;
 #if FILTER_LONG_INT_TIME
@@ -140,8 +159,12 @@ struct _cmos_fsm_t {
 #if FILTER_SHORT_INT_TIME
     it_short_hist_t short_it_hist;
 #endif
-    exposure_set_t exposure_hist[8];
-    int exposure_hist_pos;
+    cmos_exposure_slot_t exposure_hist[CMOS_EXPOSURE_HIST_SIZE];
+    /* frame id seen by the last frame start */
+    volatile uint32_t exposure_hist_frame_id;
+    /* exposure corrections requested by the thread and applied to the ring by frame start */
+    volatile int32_t exp_adjust_req;
+    int32_t exp_adjust_done;
     fps_counter_t fps_cnt;
     uint16_t flicker_freq;
     uint32_t lines_per_500ms;
@@ -104,10 +104,9 @@ void cmos_update_exposure_partitioning_lut( cmos_fsm_ptr_t p_fsm )
     }
 #endif
 
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-    int32_t max_gain = sensor_info.again_log2_max + sensor_info.dgain_log2_max + p_fsm->maximum_isp_digital_gain;
+    int32_t max_gain = sensor_info->again_log2_max + sensor_info->dgain_log2_max + p_fsm->maximum_isp_digital_gain;
     for ( i = 0; i < EXPOSURE_PARTIONS_COUNT; ++i ) {
         int i_param = exposure_partitions[i].i;
         if ( ( i_param < 0 ) || ( i_param >= 2 ) ) {
@@ -118,11 +117,11 @@ void cmos_update_exposure_partitioning_lut( cmos_fsm_ptr_t p_fsm )
         switch ( i_param ) {
         case EXPOSURE_PARAMETER_INTEGRATION_TIME_INDEX:
             if ( !v ) {
-                addon = acamera_log2_fixed_to_fixed( sensor_info.integration_time_limit, 0, LOG2_GAIN_SHIFT );
+                addon = acamera_log2_fixed_to_fixed( sensor_info->integration_time_limit, 0, LOG2_GAIN_SHIFT );
             } else {
                 int32_t lines = cmos_convert_integration_time_ms2lines( p_fsm, v );
-                if ( lines < sensor_info.integration_time_min ) {
-                    lines = sensor_info.integration_time_min;
+                if ( lines < sensor_info->integration_time_min ) {
+                    lines = sensor_info->integration_time_min;
                 }
                 addon = acamera_log2_fixed_to_fixed( lines, 0, LOG2_GAIN_SHIFT );
             }
@@ -208,8 +207,6 @@ void cmos_init( cmos_fsm_ptr_t p_fsm )
     p_fsm->short_it_hist.sum = FILTER_SHORT_INT_TIME;
     p_fsm->short_it_hist.p = &( p_fsm->short_it_hist.v[0] );
 #endif
-
-    system_spinlock_init( &p_fsm->exp_lock );
 }
 
 void cmos_alloc_integration_time( cmos_fsm_ptr_t p_fsm, int32_t int_time )
@@ -218,11 +215,10 @@ void cmos_alloc_integration_time( cmos_fsm_ptr_t p_fsm, int32_t int_time )
     unsigned int new_integration_time_short;
     cmos_control_param_t *param = (cmos_control_param_t *)_GET_UINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_CMOS_CONTROL );
 
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-    uint32_t min_integration_time_short = sensor_info.integration_time_min;
-    uint32_t max_integration_time_short = sensor_info.integration_time_limit;
+    uint32_t min_integration_time_short = sensor_info->integration_time_min;
+    uint32_t max_integration_time_short = sensor_info->integration_time_limit;
     if ( param->global_manual_max_integration_time && max_integration_time_short > param->global_max_integration_time ) {
         max_integration_time_short = param->global_max_integration_time;
     }
@@ -260,9 +256,6 @@ int32_t cmos_alloc_sensor_analog_gain( cmos_fsm_ptr_t p_fsm, int32_t gain )
         return 0;
     }
 
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
-
     int32_t max_gain = param->global_max_sensor_analog_gain << ( LOG2_GAIN_SHIFT - 5 );
     if ( gain > max_gain ) {
         gain = max_gain;
@@ -281,10 +274,9 @@ int32_t cmos_alloc_sensor_digital_gain( cmos_fsm_ptr_t p_fsm, int32_t gain )
         return 0;
     }
 
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-    int32_t max_gain = MIN( sensor_info.dgain_log2_max, (int32_t)param->global_max_sensor_digital_gain << ( LOG2_GAIN_SHIFT - 5 ) );
+    int32_t max_gain = MIN( sensor_info->dgain_log2_max, (int32_t)param->global_max_sensor_digital_gain << ( LOG2_GAIN_SHIFT - 5 ) );
     if ( gain > max_gain ) {
         gain = max_gain;
     }
@@ -345,36 +337,94 @@ int32_t cmos_get_manual_isp_dgain_log2( cmos_fsm_ptr_t p_fsm )
 
 int cmos_convert_integration_time_ms2lines( cmos_fsm_ptr_t p_fsm, int time_ms )
 {
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-    int res = sensor_info.lines_per_second * time_ms / 1000; // division by zero is checked
+    int res = sensor_info->lines_per_second * time_ms / 1000; // division by zero is checked
     return res;
 }
 
-exposure_set_t *cmos_get_frame_exposure_set( cmos_fsm_ptr_t p_fsm, int i_frame )
+static void cmos_read_next_exposure( cmos_fsm_const_ptr_t p_fsm, exposure_set_t *p_set )
 {
-    int pos = p_fsm->exposure_hist_pos + i_frame;
-    if ( pos < 0 ) {
-        pos += ( sizeof( p_fsm->exposure_hist ) / sizeof( p_fsm->exposure_hist[0] ) );          // division by zero is checked
-    } else if ( pos >= ( sizeof( p_fsm->exposure_hist ) / sizeof( p_fsm->exposure_hist[0] ) ) ) // division by zero is checked
-    {
-        pos -= ( sizeof( p_fsm->exposure_hist ) / sizeof( p_fsm->exposure_hist[0] ) ); // division by zero is checked
+    uint32_t seq;
+
+    // latch read: the copy selected by seq is never the one being written
+    do {
+        seq = p_fsm->exp_next_seq;
+        system_smp_rmb();
+        *p_set = p_fsm->exp_next_set[seq & 1];
+        system_smp_rmb();
+    } while ( seq != p_fsm->exp_next_seq );
+}
+
+static void cmos_write_next_exposure( cmos_fsm_ptr_t p_fsm, const exposure_set_t *p_set )
+{
+    p_fsm->exp_next_seq++;
+    system_smp_wmb();
+    p_fsm->exp_next_set[0] = *p_set;
+    system_smp_wmb();
+    p_fsm->exp_next_seq++;
+    system_smp_wmb();
+    p_fsm->exp_next_set[1] = *p_set;
+}
+
+static void cmos_write_hist_slot( cmos_fsm_ptr_t p_fsm, uint32_t frame_id, const exposure_set_t *p_set )
+{
+    cmos_exposure_slot_t *slot = &p_fsm->exposure_hist[frame_id & CMOS_EXPOSURE_HIST_MASK];
+
+    slot->seq++;
+    system_smp_wmb();
+    slot->frame_id = frame_id;
+    slot->set = *p_set;
+    system_smp_wmb();
+    slot->seq++;
+}
+
+int cmos_get_exposure_set_by_frame_id( cmos_fsm_const_ptr_t p_fsm, uint32_t frame_id, exposure_set_t *p_set )
+{
+    const cmos_exposure_slot_t *slot = &p_fsm->exposure_hist[frame_id & CMOS_EXPOSURE_HIST_MASK];
+    uint32_t seq;
+
+    // the slot is only rewritten once per frame, so a retry is rare and short
+    do {
+        seq = slot->seq;
+        system_smp_rmb();
+        if ( seq == 0 || slot->frame_id != frame_id ) {
+            return -1;
+        }
+        *p_set = slot->set;
+        system_smp_rmb();
+    } while ( ( seq & 1 ) || seq != slot->seq );
+
+    return 0;
+}
+
+void cmos_get_frame_exposure_set( cmos_fsm_const_ptr_t p_fsm, int i_frame, exposure_set_t *p_set )
+{
+    // frames which are not in the ring yet run with the latest exposure
+    if ( cmos_get_exposure_set_by_frame_id( p_fsm, p_fsm->exposure_hist_frame_id + i_frame, p_set ) != 0 ) {
+        cmos_read_next_exposure( p_fsm, p_set );
     }
-    return p_fsm->exposure_hist + pos;
 }
 
 static void cmos_store_frame_exposure_set( cmos_fsm_ptr_t p_fsm, exposure_set_t *p_set )
 {
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
+
+    // the set is published to the history as a whole, fields a mode does not use stay 0
+    system_memset( p_set, 0, sizeof( *p_set ) );
 
     p_set->data.integration_time = p_fsm->integration_time_short;
+    // FS_LIN with one exposure sends this one to the sensor at frame start
+    p_set->data.actual_integration_time = p_fsm->integration_time_short;
 
     p_set->data.isp_dgain_log2 = p_fsm->isp_dgain_log2;
     int32_t prev_again;
+    exposure_set_t prev_set;
 
-    if ( sensor_info.sensor_exp_number == 4 ) {
+    cmos_get_frame_exposure_set( p_fsm, sensor_info->integration_time_apply_delay, &prev_set );
+    prev_again = prev_set.info.again_log2;
+
+    if ( sensor_info->sensor_exp_number == 4 ) {
 
         p_set->data.integration_time_long = p_fsm->integration_time_long;
         p_set->data.integration_time_medium = p_fsm->integration_time_medium;
@@ -383,9 +433,8 @@ static void cmos_store_frame_exposure_set( cmos_fsm_ptr_t p_fsm, exposure_set_t
         p_set->data.exposure_ratio_short = 64 * (uint32_t)p_fsm->integration_time_medium / p_fsm->integration_time_short;
         p_set->data.exposure_ratio_medium = 64 * (uint32_t)p_fsm->integration_time_medium2 / p_fsm->integration_time_medium;
 
-        switch ( sensor_info.isp_exposure_channel_delay ) {
+        switch ( sensor_info->isp_exposure_channel_delay ) {
         case 1:
-            prev_again = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->info.again_log2;
             p_set->data.exposure_ratio_medium2 = 64 * (uint32_t)p_fsm->integration_time_long / p_fsm->integration_time_medium2 * acamera_math_exp2( prev_again - p_fsm->again_val_log2, LOG2_GAIN_SHIFT, 8 ) >> 8;
             break;
         default:
@@ -393,14 +442,13 @@ static void cmos_store_frame_exposure_set( cmos_fsm_ptr_t p_fsm, exposure_set_t
             break;
         }
 
-    } else if ( sensor_info.sensor_exp_number == 3 ) {
+    } else if ( sensor_info->sensor_exp_number == 3 ) {
         p_set->data.integration_time_medium = p_fsm->integration_time_medium;
         p_set->data.exposure_ratio_short = 64 * (uint32_t)p_fsm->integration_time_medium / p_fsm->integration_time_short;
         p_set->data.integration_time_long = p_fsm->integration_time_long;
 
-        switch ( sensor_info.isp_exposure_channel_delay ) {
+        switch ( sensor_info->isp_exposure_channel_delay ) {
         case 1:
-            prev_again = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->info.again_log2;
             p_set->data.exposure_ratio_medium = 64 * (uint32_t)p_fsm->integration_time_long / p_fsm->integration_time_medium * acamera_math_exp2( prev_again - p_fsm->again_val_log2, LOG2_GAIN_SHIFT, 8 ) >> 8;
             break;
         default:
@@ -408,12 +456,11 @@ static void cmos_store_frame_exposure_set( cmos_fsm_ptr_t p_fsm, exposure_set_t
             break;
         }
 
-    } else if ( sensor_info.sensor_exp_number == 2 ) {
+    } else if ( sensor_info->sensor_exp_number == 2 ) {
         p_set->data.integration_time_long = p_fsm->integration_time_long;
 
-        switch ( sensor_info.isp_exposure_channel_delay ) {
+        switch ( sensor_info->isp_exposure_channel_delay ) {
         case 1:
-            prev_again = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->info.again_log2;
             p_set->data.exposure_ratio = 64 * (uint32_t)p_fsm->integration_time_long / p_fsm->integration_time_short * acamera_math_exp2( prev_again - p_fsm->again_val_log2, LOG2_GAIN_SHIFT, 8 ) >> 8;
             break;
         default:
@@ -434,28 +481,18 @@ static void cmos_store_frame_exposure_set( cmos_fsm_ptr_t p_fsm, exposure_set_t
     p_set->info.exposure_log2 += acamera_log2_fixed_to_fixed( p_set->data.integration_time, 0, LOG2_GAIN_SHIFT );
 
     p_set->data.frame_id_tracking = p_fsm->frame_id_tracking;
+    p_set->data.update_count = p_fsm->exp_update_count;
 }
 
 void cmos_update_exposure_history( cmos_fsm_ptr_t p_fsm )
 {
-    unsigned long irq_flags;
+    exposure_set_t next_set;
     cmos_control_param_t *param = (cmos_control_param_t *)_GET_UINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_CMOS_CONTROL );
-    //uint32_t gain;
-    if ( p_fsm->exposure_hist_pos < 0 ) {
-        int pos;
-        fsm_param_sensor_info_t sensor_info;
-        acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
-
-        p_fsm->exposure_hist_pos = 0;
-        // reset state
-        for ( pos = 0; pos <= sensor_info.integration_time_apply_delay; ++pos ) {
-            cmos_store_frame_exposure_set( p_fsm, cmos_get_frame_exposure_set( p_fsm, pos ) );
-        }
-    }
 
-    irq_flags = system_spinlock_lock( p_fsm->exp_lock );
-    cmos_store_frame_exposure_set( p_fsm, &( p_fsm->exp_next_set ) );
-    system_spinlock_unlock( p_fsm->exp_lock, irq_flags );
+    // control batches look for the first frame with an exposure computed after them
+    p_fsm->exp_update_count++;
+    cmos_store_frame_exposure_set( p_fsm, &next_set );
+    cmos_write_next_exposure( p_fsm, &next_set );
 
     // display gains in control tool
     if ( !param->global_manual_integration_time ) {
@@ -511,20 +548,50 @@ static void cmos_mointor_frame_end( cmos_fsm_ptr_t p_fsm )
 
 static void cmos_move_exposure_history( cmos_fsm_ptr_t p_fsm )
 {
-    unsigned long irq_flags;
+    exposure_set_t next_set;
+    uint32_t frame_id = acamera_fsm_util_get_cur_frame_id( &p_fsm->cmn );
+    int32_t corr = p_fsm->exp_adjust_req - p_fsm->exp_adjust_done;
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
+    uint32_t i;
+
+    // apply exposure corrections requested since the previous frame start
+    if ( corr ) {
+        for ( i = 0; i < CMOS_EXPOSURE_HIST_SIZE; i++ ) {
+            cmos_exposure_slot_t *slot = &p_fsm->exposure_hist[i];
+            exposure_set_t set;
+
+            if ( slot->seq == 0 ) {
+                continue;
+            }
 
-    int pos = p_fsm->exposure_hist_pos + 1;
-    if ( pos >= ( sizeof( p_fsm->exposure_hist ) / sizeof( p_fsm->exposure_hist[0] ) ) ) // division by zero is checked
-    {
-        pos = 0;
+            set = slot->set;
+            set.info.exposure_log2 += corr;
+            if ( set.info.exposure_log2 < 0 )
+                set.info.exposure_log2 = 0;
+            cmos_write_hist_slot( p_fsm, slot->frame_id, &set );
+        }
+        p_fsm->exp_adjust_done += corr;
     }
-    p_fsm->exposure_hist_pos = pos;
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
 
-    irq_flags = system_spinlock_lock( p_fsm->exp_lock );
-    *cmos_get_frame_exposure_set( p_fsm, sensor_info.integration_time_apply_delay ) = p_fsm->exp_next_set;
-    system_spinlock_unlock( p_fsm->exp_lock, irq_flags );
+    p_fsm->exposure_hist_frame_id = frame_id;
+
+    if ( p_fsm->exp_next_seq == 0 ) {
+        // nothing has been calculated yet
+        return;
+    }
+
+    cmos_read_next_exposure( p_fsm, &next_set );
+
+    // frames already in flight keep their exposure, gaps (startup, dropped frame starts) are filled with the latest one
+    for ( i = 0; i < sensor_info->integration_time_apply_delay; i++ ) {
+        const cmos_exposure_slot_t *slot = &p_fsm->exposure_hist[( frame_id + i ) & CMOS_EXPOSURE_HIST_MASK];
+
+        if ( slot->seq == 0 || slot->frame_id != frame_id + i ) {
+            cmos_write_hist_slot( p_fsm, frame_id + i, &next_set );
+        }
+    }
+
+    cmos_write_hist_slot( p_fsm, frame_id + sensor_info->integration_time_apply_delay, &next_set );
 }
 
 void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
@@ -537,8 +604,7 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
 
     uint32_t wdr_mode = 0;
 
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
     acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_WDR_MODE, NULL, 0, &wdr_mode, sizeof( wdr_mode ) );
 
     switch ( irq_event ) {
@@ -546,10 +612,16 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
         cmos_move_exposure_history( (cmos_fsm_ptr_t)p_fsm );
         {
             exposure_data_set_t exp_set = {0};
-            if ( ( wdr_mode == WDR_MODE_FS_LIN ) || ( ( wdr_mode == WDR_MODE_NATIVE ) && ( sensor_info.sensor_exp_number == 3 ) ) ) {
-                if ( sensor_info.sensor_exp_number == 1 ) {
-                    exp_set.integration_time = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.actual_integration_time;
-                    exp_set.exposure_ratio = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio;
+            exposure_set_t sensor_set;
+            exposure_set_t isp_set;
+
+            cmos_get_frame_exposure_set( p_fsm, sensor_info->integration_time_apply_delay, &sensor_set );
+            cmos_get_frame_exposure_set( p_fsm, 2, &isp_set );
+
+            if ( ( wdr_mode == WDR_MODE_FS_LIN ) || ( ( wdr_mode == WDR_MODE_NATIVE ) && ( sensor_info->sensor_exp_number == 3 ) ) ) {
+                if ( sensor_info->sensor_exp_number == 1 ) {
+                    exp_set.integration_time = sensor_set.data.actual_integration_time;
+                    exp_set.exposure_ratio = isp_set.data.exposure_ratio;
                     if ( is_short_exposure_frame( p_fsm->cmn.isp_base ) == 0 ) {
                         ACAMERA_FSM2CTX_PTR( p_fsm )
                             ->stab.global_long_integration_time = exp_set.integration_time;
@@ -559,21 +631,21 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
                     }
                     exp_set.actual_integration_time = exp_set.integration_time;
 
-                } else if ( sensor_info.sensor_exp_number == 2 ) {
-                    exp_set.integration_time = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time;
-                    exp_set.integration_time_long = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time_long;
-                    exp_set.exposure_ratio = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio;
+                } else if ( sensor_info->sensor_exp_number == 2 ) {
+                    exp_set.integration_time = sensor_set.data.integration_time;
+                    exp_set.integration_time_long = sensor_set.data.integration_time_long;
+                    exp_set.exposure_ratio = isp_set.data.exposure_ratio;
                     ACAMERA_FSM2CTX_PTR( p_fsm )
                         ->stab.global_long_integration_time = ( exp_set.integration_time_long );
                     ACAMERA_FSM2CTX_PTR( p_fsm )
                         ->stab.global_short_integration_time = ( exp_set.integration_time );
 
-                } else if ( sensor_info.sensor_exp_number == 3 ) {
-                    exp_set.integration_time = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time;
-                    exp_set.integration_time_medium = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time_medium;
-                    exp_set.integration_time_long = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time_long;
-                    exp_set.exposure_ratio_short = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_short;
-                    exp_set.exposure_ratio_medium = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_medium;
+                } else if ( sensor_info->sensor_exp_number == 3 ) {
+                    exp_set.integration_time = sensor_set.data.integration_time;
+                    exp_set.integration_time_medium = sensor_set.data.integration_time_medium;
+                    exp_set.integration_time_long = sensor_set.data.integration_time_long;
+                    exp_set.exposure_ratio_short = isp_set.data.exposure_ratio_short;
+                    exp_set.exposure_ratio_medium = isp_set.data.exposure_ratio_medium;
                     //LOG( LOG_ERR, " short %d medium %d long %d Rs %d Rm %d", exp_set.integration_time, exp_set.integration_time_medium, exp_set.integration_time_long, exp_set.exposure_ratio_short, exp_set.exposure_ratio_medium );
 
                     ACAMERA_FSM2CTX_PTR( p_fsm )
@@ -582,13 +654,13 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
                         ->stab.global_short_integration_time = ( exp_set.integration_time );
 
                 } else /* sensor_exp_number == 4 */ {
-                    exp_set.integration_time = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time;
-                    exp_set.integration_time_medium = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time_medium;
-                    exp_set.integration_time_medium2 = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time_medium2;
-                    exp_set.integration_time_long = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time_long;
-                    exp_set.exposure_ratio_short = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_short;
-                    exp_set.exposure_ratio_medium = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_medium;
-                    exp_set.exposure_ratio_medium2 = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_medium2;
+                    exp_set.integration_time = sensor_set.data.integration_time;
+                    exp_set.integration_time_medium = sensor_set.data.integration_time_medium;
+                    exp_set.integration_time_medium2 = sensor_set.data.integration_time_medium2;
+                    exp_set.integration_time_long = sensor_set.data.integration_time_long;
+                    exp_set.exposure_ratio_short = isp_set.data.exposure_ratio_short;
+                    exp_set.exposure_ratio_medium = isp_set.data.exposure_ratio_medium;
+                    exp_set.exposure_ratio_medium2 = isp_set.data.exposure_ratio_medium2;
                     //LOG( LOG_ERR, " short %d medium %d long %d Rs %d Rm %d", exp_set.integration_time, exp_set.integration_time_medium, exp_set.integration_time_long, exp_set.exposure_ratio_short, exp_set.exposure_ratio_medium );
 
                     ACAMERA_FSM2CTX_PTR( p_fsm )
@@ -597,40 +669,40 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
                         ->stab.global_short_integration_time = ( exp_set.integration_time );
                 }
             } else {
-                exp_set.integration_time = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time;
+                exp_set.integration_time = sensor_set.data.integration_time;
                 ACAMERA_FSM2CTX_PTR( p_fsm )
                     ->stab.global_short_integration_time = ( exp_set.integration_time );
 
-                if ( sensor_info.sensor_exp_number == 1 ) {
+                if ( sensor_info->sensor_exp_number == 1 ) {
                     exp_set.actual_integration_time = exp_set.integration_time;
                     exp_set.exposure_ratio = 64;
 
-                } else if ( sensor_info.sensor_exp_number == 2 ) {
-                    exp_set.integration_time = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time;
-                    exp_set.integration_time_long = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time_long;
-                    exp_set.exposure_ratio = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio;
+                } else if ( sensor_info->sensor_exp_number == 2 ) {
+                    exp_set.integration_time = sensor_set.data.integration_time;
+                    exp_set.integration_time_long = sensor_set.data.integration_time_long;
+                    exp_set.exposure_ratio = isp_set.data.exposure_ratio;
 
-                } else if ( sensor_info.sensor_exp_number == 3 ) {
-                    exp_set.integration_time = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time;
+                } else if ( sensor_info->sensor_exp_number == 3 ) {
+                    exp_set.integration_time = sensor_set.data.integration_time;
                     exp_set.integration_time_medium = exp_set.integration_time;
                     exp_set.integration_time_long = exp_set.integration_time;
-                    exp_set.exposure_ratio_short = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_short;
-                    exp_set.exposure_ratio_medium = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_medium;
+                    exp_set.exposure_ratio_short = isp_set.data.exposure_ratio_short;
+                    exp_set.exposure_ratio_medium = isp_set.data.exposure_ratio_medium;
 
                 } else /* sensor_exp_number == 4 */ {
-                    exp_set.integration_time = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, sensor_info.integration_time_apply_delay )->data.integration_time;
+                    exp_set.integration_time = sensor_set.data.integration_time;
                     exp_set.integration_time_medium = exp_set.integration_time;
                     exp_set.integration_time_medium2 = exp_set.integration_time;
                     exp_set.integration_time_long = exp_set.integration_time;
-                    exp_set.exposure_ratio_short = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_short;
-                    exp_set.exposure_ratio_medium = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_medium;
-                    exp_set.exposure_ratio_medium2 = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.exposure_ratio_medium2;
+                    exp_set.exposure_ratio_short = isp_set.data.exposure_ratio_short;
+                    exp_set.exposure_ratio_medium = isp_set.data.exposure_ratio_medium;
+                    exp_set.exposure_ratio_medium2 = isp_set.data.exposure_ratio_medium2;
                 }
             }
-            exp_set.isp_dgain_log2 = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.isp_dgain_log2;
+            exp_set.isp_dgain_log2 = isp_set.data.isp_dgain_log2;
 
             // tracking integration time and isp_dgain separately?
-            exp_set.frame_id_tracking = cmos_get_frame_exposure_set( (cmos_fsm_ptr_t)p_fsm, 2 )->data.frame_id_tracking;
+            exp_set.frame_id_tracking = isp_set.data.frame_id_tracking;
 
             ( (cmos_fsm_ptr_t)p_fsm )->exp_write_set = exp_set;
 
@@ -673,7 +745,7 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
 
         if ( ( wdr_mode == WDR_MODE_FS_LIN ) && ( ACAMERA_FSM2CTX_PTR( p_fsm )->stab.global_manual_frame_stitch == 0 ) ) {
 
-            if ( sensor_info.sensor_exp_number == 4 ) {
+            if ( sensor_info->sensor_exp_number == 4 ) {
                 acamera_isp_frame_stitch_svs_exposure_ratio_write( p_fsm->cmn.isp_base, p_fsm->exp_write_set.exposure_ratio_short );
                 acamera_isp_frame_stitch_ms_exposure_ratio_write( p_fsm->cmn.isp_base, p_fsm->exp_write_set.exposure_ratio_medium );
                 acamera_isp_frame_stitch_lm_exposure_ratio_write( p_fsm->cmn.isp_base, p_fsm->exp_write_set.exposure_ratio_medium2 );
@@ -700,7 +772,7 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
                 acamera_isp_frame_stitch_mcoff_lm_scaler_write( p_fsm->cmn.isp_base, (uint16_t)SF3 );
                 acamera_isp_frame_stitch_mcoff_lms_scaler_write( p_fsm->cmn.isp_base, (uint16_t)SF4 );
 
-            } else if ( sensor_info.sensor_exp_number == 3 ) {
+            } else if ( sensor_info->sensor_exp_number == 3 ) {
 
                 acamera_isp_frame_stitch_ms_exposure_ratio_write( p_fsm->cmn.isp_base, p_fsm->exp_write_set.exposure_ratio_short );
                 acamera_isp_frame_stitch_lm_exposure_ratio_write( p_fsm->cmn.isp_base, p_fsm->exp_write_set.exposure_ratio_medium );
@@ -732,7 +804,7 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
                 acamera_isp_frame_stitch_mcoff_lm_scaler_write( p_fsm->cmn.isp_base, (uint16_t)SF3 );
                 acamera_isp_frame_stitch_mcoff_lms_scaler_write( p_fsm->cmn.isp_base, (uint16_t)SF4 );
 
-            } else if ( sensor_info.sensor_exp_number == 2 ) {
+            } else if ( sensor_info->sensor_exp_number == 2 ) {
                 int32_t SF2, R12; //U0.11 registers
                 R12 = p_fsm->exp_write_set.exposure_ratio;
                 SF2 = 262144 / ( 2048 + R12 );
@@ -791,15 +863,15 @@ void cmos_fsm_process_interrupt( cmos_fsm_const_ptr_t p_fsm, uint8_t irq_event )
 
         uint32_t cur_frame_id = acamera_fsm_util_get_cur_frame_id( &( (cmos_fsm_ptr_t)p_fsm )->cmn );
 
-        // "sensor_info.integration_time_apply_delay + 1" because the current frame_id is not so accurate.
+        // "sensor_info->integration_time_apply_delay + 1" because the current frame_id is not so accurate.
         if ( p_fsm->exp_write_set.frame_id_tracking && ( p_fsm->exp_write_set.frame_id_tracking != p_fsm->prev_dgain_frame_id ) &&
-             ( cur_frame_id - p_fsm->exp_write_set.frame_id_tracking > sensor_info.integration_time_apply_delay + 1 ) ) {
+             ( cur_frame_id - p_fsm->exp_write_set.frame_id_tracking > sensor_info->integration_time_apply_delay + 1 ) ) {
             fsm_param_mon_err_head_t mon_err;
             mon_err.err_type = MON_TYPE_ERR_CMOS_UPDATE_DGAIN_WRONG_TIMING;
-            mon_err.err_param = cur_frame_id - p_fsm->exp_write_set.frame_id_tracking - sensor_info.integration_time_apply_delay;
+            mon_err.err_param = cur_frame_id - p_fsm->exp_write_set.frame_id_tracking - sensor_info->integration_time_apply_delay;
             acamera_fsm_mgr_set_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_SET_MON_ERROR_REPORT, &mon_err, sizeof( mon_err ) );
             ( (cmos_fsm_ptr_t)p_fsm )->prev_dgain_frame_id = p_fsm->exp_write_set.frame_id_tracking;
-            LOG( LOG_INFO, "cmos_dgain_upd_wrong: cur: %u, tracking: %u, delay: %u.", cur_frame_id, p_fsm->exp_write_set.frame_id_tracking, sensor_info.integration_time_apply_delay );
+            LOG( LOG_INFO, "cmos_dgain_upd_wrong: cur: %u, tracking: %u, delay: %u.", cur_frame_id, p_fsm->exp_write_set.frame_id_tracking, sensor_info->integration_time_apply_delay );
         }
 
         // frame_id should not be 0, at the beginning, it's initialized to 0 and we should skip it.
@@ -879,10 +951,9 @@ void cmos_inttime_update( cmos_fsm_ptr_t p_fsm )
                 }
             }
             if ( p_fsm->flicker_freq && !p_fsm->manual_gain_mode && param->global_antiflicker_enable ) {
-                fsm_param_sensor_info_t sensor_info;
-                acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+                const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-                uint32_t line_per_half_period = ( sensor_info.lines_per_second << 8 ) / ( p_fsm->flicker_freq * 2 ); // division by zero is checked
+                uint32_t line_per_half_period = ( sensor_info->lines_per_second << 8 ) / ( p_fsm->flicker_freq * 2 ); // division by zero is checked
                 if ( line_per_half_period != 0 ) {
                     int32_t half_period_log2 = acamera_log2_fixed_to_fixed( line_per_half_period, 0, LOG2_GAIN_SHIFT );
                     if ( int_time < half_period_log2 ) {
@@ -974,10 +1045,9 @@ uint32_t get_quantised_integration_time( cmos_fsm_ptr_t p_fsm, uint32_t int_time
         return int_time;
     }
 
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-    uint32_t line_per_half_period = ( sensor_info.lines_per_second << 8 ) / ( p_fsm->flicker_freq * 2 ); // division by zero is checked
+    uint32_t line_per_half_period = ( sensor_info->lines_per_second << 8 ) / ( p_fsm->flicker_freq * 2 ); // division by zero is checked
     if ( line_per_half_period != 0 && ( int_time >= line_per_half_period && int_time <= ( line_per_half_period << 2 ) ) ) {
         uint32_t N = int_time / line_per_half_period; // division by zero is checked
         if ( N < 1 ) {
@@ -991,11 +1061,10 @@ uint32_t get_quantised_integration_time( cmos_fsm_ptr_t p_fsm, uint32_t int_time
 
 uint32_t get_quantised_long_integration_time( cmos_fsm_ptr_t p_fsm, uint32_t int_time, uint32_t max_int_time )
 {
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-    if ( int_time < sensor_info.integration_time_min ) {
-        int_time = sensor_info.integration_time_min;
+    if ( int_time < sensor_info->integration_time_min ) {
+        int_time = sensor_info->integration_time_min;
     } else if ( int_time > max_int_time ) {
         int_time = max_int_time;
     }
@@ -1032,8 +1101,7 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
 {
     fsm_param_sensor_int_time_t time;
 
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
     cmos_control_param_t *param = (cmos_control_param_t *)_GET_UINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_CMOS_CONTROL );
     uint32_t exposure_ratio, integration_time_long, integration_time_long_quant;
@@ -1041,10 +1109,10 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
 
     acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_WDR_MODE, NULL, 0, &wdr_mode, sizeof( wdr_mode ) );
 
-    if ( ( wdr_mode == WDR_MODE_FS_LIN ) || ( ( wdr_mode == WDR_MODE_NATIVE ) && ( sensor_info.sensor_exp_number == 3 ) ) ) {
-        uint32_t integration_time_long_max = sensor_info.integration_time_long_max;
+    if ( ( wdr_mode == WDR_MODE_FS_LIN ) || ( ( wdr_mode == WDR_MODE_NATIVE ) && ( sensor_info->sensor_exp_number == 3 ) ) ) {
+        uint32_t integration_time_long_max = sensor_info->integration_time_long_max;
         if ( !integration_time_long_max ) {
-            uint32_t integration_time_long_max = sensor_info.integration_time_limit;
+            uint32_t integration_time_long_max = sensor_info->integration_time_limit;
 
             if ( param->global_manual_max_integration_time && integration_time_long_max > param->global_max_integration_time ) {
                 integration_time_long_max = param->global_max_integration_time;
@@ -1055,14 +1123,14 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
             exposure_ratio = 64;
         }
 #if EXPOSURE_DRIVES_LONG_INTEGRATION_TIME
-        uint32_t min_integration_time_short = sensor_info.integration_time_min;
+        uint32_t min_integration_time_short = sensor_info->integration_time_min;
         // Inverse long and short exposure
         integration_time_long = p_fsm->integration_time_short;
         p_fsm->integration_time_short = ( (uint32_t)integration_time_long << 6 ) / exposure_ratio; // division by zero is checked
         if ( p_fsm->integration_time_short < min_integration_time_short ) {
             p_fsm->integration_time_short = min_integration_time_short;
         }
-        uint32_t integration_time_max = sensor_info.integration_time_max;
+        uint32_t integration_time_max = sensor_info->integration_time_max;
         if ( p_fsm->integration_time_short > integration_time_max ) {
             p_fsm->integration_time_short = integration_time_max;
         }
@@ -1094,7 +1162,7 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
 #endif
 
         p_fsm->integration_time_long = integration_time_long_quant;
-        if ( sensor_info.sensor_exp_number == 4 ) {
+        if ( sensor_info->sensor_exp_number == 4 ) {
 
             const uint32_t exposure_ratio_thresholded = exposure_ratio > 256 ? exposure_ratio / 2 : exposure_ratio;
             const uint32_t ratio_cube_root = acamera_math_exp2( acamera_log2_fixed_to_fixed( exposure_ratio_thresholded, 6, 16 ) / 3, 16, 6 );
@@ -1126,7 +1194,7 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
             p_fsm->integration_time_medium2 = time.int_time_M2;
             p_fsm->integration_time_long = time.int_time_L;
 
-        } else if ( sensor_info.sensor_exp_number == 3 ) {
+        } else if ( sensor_info->sensor_exp_number == 3 ) {
             uint32_t integration_time_medium;
             if ( exposure_ratio > 256 ) {
                 //half ML ratio by two
@@ -1157,7 +1225,7 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
             p_fsm->integration_time_medium = time.int_time_M;
             p_fsm->integration_time_long = time.int_time_L;
 
-        } else if ( sensor_info.sensor_exp_number == 2 ) {
+        } else if ( sensor_info->sensor_exp_number == 2 ) {
             time.int_time = p_fsm->integration_time_short;
             time.int_time_L = p_fsm->integration_time_long;
 
@@ -1183,7 +1251,7 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
     } else {
         p_fsm->exposure_ratio = 64;
 
-        if ( sensor_info.sensor_exp_number == 4 ) {
+        if ( sensor_info->sensor_exp_number == 4 ) {
 
             time.int_time = p_fsm->integration_time_short;
             time.int_time_M = p_fsm->integration_time_short;
@@ -1198,7 +1266,7 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
             // parameter to save back into the 'p_fsm->integration_time_short' variable.
             p_fsm->integration_time_short = time.int_time_L;
 
-        } else if ( sensor_info.sensor_exp_number == 3 ) {
+        } else if ( sensor_info->sensor_exp_number == 3 ) {
             time.int_time = p_fsm->integration_time_short;
             time.int_time_M = p_fsm->integration_time_short;
             time.int_time_L = p_fsm->integration_time_short;
@@ -1208,7 +1276,7 @@ void cmos_long_exposure_update( cmos_fsm_ptr_t p_fsm )
             // time is updated in above function, save it.
             p_fsm->integration_time_short = time.int_time_L;
 
-        } else if ( sensor_info.sensor_exp_number == 2 ) {
+        } else if ( sensor_info->sensor_exp_number == 2 ) {
             time.int_time = p_fsm->integration_time_short;
             time.int_time_L = p_fsm->integration_time_short;
 
@@ -1268,12 +1336,11 @@ void cmos_set_exposure_target( cmos_fsm_ptr_t p_fsm, int32_t exposure_log2, uint
 
         uint32_t wdr_mode = 0;
 
-        fsm_param_sensor_info_t sensor_info;
-        acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+        const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
         acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_WDR_MODE, NULL, 0, &wdr_mode, sizeof( wdr_mode ) );
 
         // for HDR mode with one exposure we can set new exposure only every second frame
-        if ( !( ( ( wdr_mode == WDR_MODE_FS_LIN ) ) && ( sensor_info.sensor_exp_number == 1 ) && !is_short_exposure_frame( p_fsm->cmn.isp_base ) ) ) {
+        if ( !( ( ( wdr_mode == WDR_MODE_FS_LIN ) ) && ( sensor_info->sensor_exp_number == 1 ) && !is_short_exposure_frame( p_fsm->cmn.isp_base ) ) ) {
             cmos_control_param_t *param_cmos = (cmos_control_param_t *)_GET_UINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_CMOS_CONTROL );
             p_fsm->exposure_log2 = exposure_log2;
             p_fsm->exposure_ratio_in = exposure_ratio;
@@ -1291,18 +1358,17 @@ void cmos_set_exposure_target( cmos_fsm_ptr_t p_fsm, int32_t exposure_log2, uint
 #else
     cmos_control_param_t *param = (cmos_control_param_t *)_GET_UINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_CMOS_CONTROL );
 
-    fsm_param_sensor_info_t sensor_info;
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-    param->global_max_sensor_analog_gain = MIN( param->global_max_sensor_analog_gain, sensor_info.again_log2_max >> ( LOG2_GAIN_SHIFT - 5 ) );
-    param->global_max_sensor_digital_gain = MIN( param->global_max_sensor_digital_gain, sensor_info.dgain_log2_max >> ( LOG2_GAIN_SHIFT - 5 ) );
-    param->global_max_integration_time = MIN( param->global_max_integration_time, sensor_info.integration_time_limit );
+    param->global_max_sensor_analog_gain = MIN( param->global_max_sensor_analog_gain, sensor_info->again_log2_max >> ( LOG2_GAIN_SHIFT - 5 ) );
+    param->global_max_sensor_digital_gain = MIN( param->global_max_sensor_digital_gain, sensor_info->dgain_log2_max >> ( LOG2_GAIN_SHIFT - 5 ) );
+    param->global_max_integration_time = MIN( param->global_max_integration_time, sensor_info->integration_time_limit );
 
 
-    int32_t max_again_log2 = MIN( sensor_info.again_log2_max, (int32_t)param->global_max_sensor_analog_gain << ( LOG2_GAIN_SHIFT - 5 ) );
-    int32_t max_dgain_log2 = MIN( sensor_info.dgain_log2_max, (int32_t)param->global_max_sensor_digital_gain << ( LOG2_GAIN_SHIFT - 5 ) );
+    int32_t max_again_log2 = MIN( sensor_info->again_log2_max, (int32_t)param->global_max_sensor_analog_gain << ( LOG2_GAIN_SHIFT - 5 ) );
+    int32_t max_dgain_log2 = MIN( sensor_info->dgain_log2_max, (int32_t)param->global_max_sensor_digital_gain << ( LOG2_GAIN_SHIFT - 5 ) );
     int32_t max_isp_gain_log2 = MIN( p_fsm->maximum_isp_digital_gain, (int32_t)param->global_max_isp_digital_gain << ( LOG2_GAIN_SHIFT - 5 ) );
-    int32_t max_integration_time_log2 = acamera_log2_fixed_to_fixed( sensor_info.integration_time_limit, 0, LOG2_GAIN_SHIFT );
+    int32_t max_integration_time_log2 = acamera_log2_fixed_to_fixed( sensor_info->integration_time_limit, 0, LOG2_GAIN_SHIFT );
     p_fsm->max_exposure_log2 = max_again_log2 + max_dgain_log2 + max_isp_gain_log2 + max_integration_time_log2;
 #endif // #if USER_MODULE
 #endif
@@ -1310,5 +1376,4 @@ void cmos_set_exposure_target( cmos_fsm_ptr_t p_fsm, int32_t exposure_log2, uint
 
 void cmos_deinit( cmos_fsm_ptr_t p_fsm )
 {
-    system_spinlock_destroy( p_fsm->exp_lock );
 }
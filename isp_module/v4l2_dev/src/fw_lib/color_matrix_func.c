@@ -110,7 +110,7 @@ void saturation_modulate_strength( color_matrix_fsm_ptr_t p_fsm )
     uint32_t ccm_saturation_table_idx = CALIBRATION_SATURATION_STRENGTH;
     modulation_entry_t *ccm_saturation_table = _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), ccm_saturation_table_idx );
     uint32_t ccm_saturation_table_len = _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), ccm_saturation_table_idx );
-    strength = acamera_calc_modulation_u16( log2_gain, ccm_saturation_table, ccm_saturation_table_len );
+    strength = acamera_calc_modulation_u16_hint( log2_gain, ccm_saturation_table, ccm_saturation_table_len, _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), ccm_saturation_table_idx ) );
     ACAMERA_FSM2CTX_PTR( p_fsm )
         ->stab.global_saturation_target = ( strength );
 }
@@ -144,7 +144,7 @@ static void mesh_shading_modulate_strength( color_matrix_fsm_ptr_t p_fsm )
     if ( ACAMERA_FSM2CTX_PTR( p_fsm )->stab.global_manual_shading == 0 ) {
         acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_CMOS_TOTAL_GAIN, NULL, 0, &total_gain, sizeof( total_gain ) );
         uint16_t log2_gain = total_gain >> ( LOG2_GAIN_SHIFT - 8 );
-        uint16_t strength = acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_MESH_SHADING_STRENGTH ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_MESH_SHADING_STRENGTH ) );
+        uint16_t strength = acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_MESH_SHADING_STRENGTH ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_MESH_SHADING_STRENGTH ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_MESH_SHADING_STRENGTH ) );
         acamera_isp_mesh_shading_mesh_strength_write( p_fsm->cmn.isp_base, strength );
     }
 }
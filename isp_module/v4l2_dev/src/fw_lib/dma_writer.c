@@ -22,6 +22,7 @@
 #include "system_stdlib.h"
 #include "dma_writer_api.h"
 #include "dma_writer.h"
+#include "dma_writer_fps.h"
 #include "acamera_firmware_config.h"
 #include "acamera.h"
 
@@ -190,7 +191,9 @@ dma_error dma_writer_reset( void *handle, dma_type type )
         pipe->settings.enabled = 0;
         pipe->settings.c_fps = 0;
         pipe->settings.t_fps = 0;
-        pipe->settings.inter_val = 0;
+        pipe->settings.fps_acc = 0;
+        pipe->settings.frames_delivered = 0;
+        pipe->settings.frames_skipped = 0;
         pipe->settings.back_tframe = NULL;
     } else {
         result = edma_fail;
@@ -203,7 +206,6 @@ dma_error dma_writer_set_pipe_fps(void *handle, dma_type type,
 {
     dma_handle *p_dma = NULL;
     dma_pipe *pipe = NULL;
-    uint32_t inter_val = 0;
 
     if (handle == NULL || c_fps == 0 || t_fps == 0 || (t_fps > c_fps)) {
         LOG(LOG_ERR, "Error input param\n");
@@ -215,13 +217,30 @@ dma_error dma_writer_set_pipe_fps(void *handle, dma_type type,
     pipe->settings.c_fps = c_fps;
     pipe->settings.t_fps = t_fps;
 
-    inter_val = c_fps / t_fps;
-    if (c_fps % t_fps != 0)
-        inter_val += 1;
+    pipe->settings.fps_acc = dma_writer_fps_acc_init(c_fps, t_fps);
+    pipe->settings.frames_delivered = 0;
+    pipe->settings.frames_skipped = 0;
 
-    pipe->settings.inter_val = inter_val;
+    LOG(LOG_INFO, "c_fps: %d, t_fps: %d\n", c_fps, t_fps);
 
-    LOG(LOG_INFO, "c_fps: %d, t_fps: %d, interval %d\n", c_fps, t_fps, inter_val);
+    return edma_ok;
+}
+
+dma_error dma_writer_get_pipe_fps(void *handle, dma_type type, uint32_t *c_fps, uint32_t *t_fps,
+                                uint32_t *delivered, uint32_t *skipped)
+{
+    dma_handle *p_dma = handle;
+    dma_pipe *pipe = NULL;
+
+    if (handle == NULL || type >= dma_max) {
+        return edma_wrong_parameters;
+    }
+
+    pipe = &p_dma->pipe[type];
+    *c_fps = pipe->settings.c_fps;
+    *t_fps = pipe->settings.t_fps;
+    *delivered = pipe->settings.frames_delivered;
+    *skipped = pipe->settings.frames_skipped;
 
     return edma_ok;
 }
@@ -510,45 +529,40 @@ dma_error dma_writer_pipe_update( dma_pipe *pipe , bool drop_frame)
 
 dma_error dma_writer_pipe_set_fps(dma_pipe *pipe)
 {
-    int frm_count = 0;
-    uint32_t inter_val = 0;
     uint32_t c_fps = 0;
     uint32_t t_fps = 0;
+    tframe_t *next_tframe = NULL;
 
     if (pipe == NULL || pipe->settings.p_ctx == NULL) {
         LOG(LOG_ERR, "Error input param:p_ctx %p\n", pipe->settings.p_ctx);
         return edma_invalid_pipe;
     }
 
-    frm_count = pipe->settings.p_ctx->isp_frame_counter;
-    inter_val = pipe->settings.inter_val;
     pipe->settings.back_tframe = NULL;
     c_fps = pipe->settings.c_fps;
     t_fps = pipe->settings.t_fps;
+    // frame just programmed into the writer, NULL when it ran out of buffers
+    next_tframe = pipe->settings.inqueue_tframe[1];
 
-    if ((pipe->settings.inqueue_tframe[1] == NULL)
-        || (inter_val == 0) || (inter_val == 1))
+    if (t_fps == 0 || t_fps >= c_fps) {
+        if (next_tframe != NULL)
+            pipe->settings.frames_delivered++;
         return edma_ok;
+    }
 
-    if (inter_val > 2) {
-        if (frm_count % inter_val != 0) {
-            pipe->api.p_acamera_isp_dma_writer_frame_write_on_write( pipe->settings.isp_base, 0 );
-            pipe->api.p_acamera_isp_dma_writer_frame_write_on_write_uv( pipe->settings.isp_base, 0 );
-            pipe->settings.back_tframe = pipe->settings.inqueue_tframe[1];
-            pipe->settings.inqueue_tframe[1] = NULL;
-        } else {
-            pipe->settings.back_tframe = NULL;
-        }
-    } else {
-        inter_val = c_fps  / (c_fps - t_fps);
-        if (frm_count % inter_val == 0) {
-            pipe->api.p_acamera_isp_dma_writer_frame_write_on_write( pipe->settings.isp_base, 0 );
-            pipe->api.p_acamera_isp_dma_writer_frame_write_on_write_uv( pipe->settings.isp_base, 0 );
-            pipe->settings.back_tframe = pipe->settings.inqueue_tframe[1];
-            pipe->settings.inqueue_tframe[1] = NULL;
-        } else {
-            pipe->settings.back_tframe = NULL;
-        }
+    // one step per sensor frame whether or not a buffer was available, so the phase never drifts
+    if (dma_writer_fps_acc_step(&pipe->settings.fps_acc, c_fps, t_fps)) {
+        if (next_tframe != NULL)
+            pipe->settings.frames_delivered++;
+        return edma_ok;
+    }
+
+    if (next_tframe != NULL) {
+        pipe->api.p_acamera_isp_dma_writer_frame_write_on_write( pipe->settings.isp_base, 0 );
+        pipe->api.p_acamera_isp_dma_writer_frame_write_on_write_uv( pipe->settings.isp_base, 0 );
+        pipe->settings.back_tframe = next_tframe;
+        pipe->settings.inqueue_tframe[1] = NULL;
+        pipe->settings.frames_skipped++;
     }
 
     return edma_ok;
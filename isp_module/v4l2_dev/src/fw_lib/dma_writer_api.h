@@ -111,7 +111,9 @@ typedef struct dma_pipe_settings {
     tframe_t *back_tframe; //used to backup last tframe
     uint32_t c_fps; //current sensor setting fps
     uint32_t t_fps; //pipe target fps
-    uint32_t inter_val; //interval frames
+    uint32_t fps_acc; //decimation accumulator, t_fps added per sensor frame
+    uint32_t frames_delivered; //frames written since the rate was set
+    uint32_t frames_skipped; //frames dropped by the decimation
     uint32_t init_delay;
     tframe_t *inqueue_tframe[2];
 } dma_pipe_settings;
@@ -252,8 +254,23 @@ dma_error dma_writer_reset( void *handle, dma_type type );
  */
 dma_error dma_writer_process_interrupt( void *handle, uint32_t irq_event );
 
+/**
+ *   Decimate a pipe from the sensor rate to a target rate
+ *
+ *   The pipe writes t_fps out of every c_fps sensor frames, spread as evenly as possible:
+ *   consecutive written frames are floor(c_fps / t_fps) or ceil(c_fps / t_fps) sensor frames apart.
+ *   Both rates only need to be in the same unit. t_fps equal to c_fps writes every frame.
+ *
+ *   @return edma_ok - success
+ *           edma_wrong_parameters - zero rate or t_fps above c_fps
+ */
 dma_error dma_writer_set_pipe_fps(void *handle, dma_type type, uint32_t c_fps, uint32_t t_fps);
 
+/**
+ *   Read the rates and frame counters of a pipe since its rate was last set
+ */
+dma_error dma_writer_get_pipe_fps(void *handle, dma_type type, uint32_t *c_fps, uint32_t *t_fps, uint32_t *delivered, uint32_t *skipped);
+
 uint16_t dma_writer_write_frame_queue( void *handle, dma_type type, tframe_t *frame_buf_array, uint16_t frame_buf_len );
 metadata_t *dma_writer_return_metadata( void *handle, dma_type type );
 tframe_t *dma_writer_api_return_next_ready_frame( void *handle, dma_type type );
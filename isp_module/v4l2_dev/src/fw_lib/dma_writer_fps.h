@@ -0,0 +1,50 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __DMA_WRITER_FPS__
+#define __DMA_WRITER_FPS__
+
+/*
+ * Frame rate decimation of the dma writer pipes.
+ *
+ * The accumulator gains t_fps per sensor frame and the frame is written when
+ * it reaches c_fps, so exactly t_fps out of every c_fps sensor frames are
+ * written. Kept free of other headers so the host test can use it as is,
+ * include it after the integer types.
+ */
+
+// the first frame after a rate change is written
+static inline uint32_t dma_writer_fps_acc_init( uint32_t c_fps, uint32_t t_fps )
+{
+    return c_fps - t_fps;
+}
+
+// one step per sensor frame, returns 1 when the frame is written
+static inline int dma_writer_fps_acc_step( uint32_t *acc, uint32_t c_fps, uint32_t t_fps )
+{
+    *acc += t_fps;
+    if ( *acc >= c_fps ) {
+        *acc -= c_fps;
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif /* __DMA_WRITER_FPS__ */
@@ -173,6 +173,17 @@ int dma_writer_fsm_get_param( void *fsm, uint32_t param_id, void *input, uint32_
 
         break;
 
+    case FSM_PARAM_GET_PATH_FPS:
+        if ( !input || input_size != sizeof( dma_type ) || !output || output_size != sizeof( fsm_param_path_fps_t ) ) {
+            LOG( LOG_ERR, "Size mismatch, param_id: %d.", param_id );
+            rc = -1;
+            break;
+        }
+
+        dma_writer_get_path_fps( p_fsm, *(dma_type *)input, (fsm_param_path_fps_t *)output );
+
+        break;
+
     default:
         rc = -1;
         break;
@@ -71,6 +71,7 @@ int acamera_frame_fr_set_ready_interrupt( acamera_firmware_t *g_fw );
 void dma_writer_update_address_interrupt( dma_writer_fsm_const_ptr_t p_fsm, uint8_t irq_event );
 void acamera_frame_buffer_update( dma_writer_fsm_const_ptr_t p_fsm );
 void dma_writer_set_path_fps(dma_writer_fsm_ptr_t p_fsm, dma_type type, uint32_t c_fps, uint32_t t_fps);
+void dma_writer_get_path_fps(dma_writer_fsm_ptr_t p_fsm, dma_type type, fsm_param_path_fps_t *p_fps);
 
 
 struct _dma_writer_fsm_t {
@@ -469,6 +469,18 @@ void dma_writer_set_path_fps(dma_writer_fsm_ptr_t p_fsm, dma_type type,
     dma_writer_set_pipe_fps(p_fsm->handle, type, c_fps, t_fps);
 }
 
+void dma_writer_get_path_fps(dma_writer_fsm_ptr_t p_fsm, dma_type type, fsm_param_path_fps_t *p_fps)
+{
+    if (p_fsm == NULL || p_fsm->handle == NULL || p_fps == NULL) {
+        LOG(LOG_ERR, "Error input param\n");
+        return;
+    }
+
+    p_fps->pipe_id = type;
+    dma_writer_get_pipe_fps(p_fsm->handle, type, &p_fps->c_fps, &p_fps->t_fps,
+                            &p_fps->delivered, &p_fps->skipped);
+}
+
 void frame_buffer_get_next_empty_frame(dma_writer_fsm_ptr_t p_fsm, dma_type type)
 {
     if (p_fsm == NULL || p_fsm->handle == NULL) {
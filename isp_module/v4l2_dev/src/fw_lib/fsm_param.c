@@ -260,6 +260,18 @@ int acamera_fsm_mgr_get_param(acamera_fsm_mgr_t * p_fsm_mgr, uint32_t param_id,
     return rc;
 }
 
+const fsm_param_sensor_snapshot_t *acamera_fsm_mgr_get_sensor_snapshot( acamera_fsm_mgr_t * p_fsm_mgr )
+{
+    static const fsm_param_sensor_snapshot_t empty_snapshot;
+    const fsm_param_sensor_snapshot_t *p_snapshot = NULL;
+
+    if( acamera_fsm_mgr_get_param( p_fsm_mgr, FSM_PARAM_GET_SENSOR_SNAPSHOT, NULL, 0, &p_snapshot, sizeof( p_snapshot ) ) != 0 || p_snapshot == NULL ) {
+        return &empty_snapshot;
+    }
+
+    return p_snapshot;
+}
+
 void acamera_fsm_mgr_dma_writer_update_address_interrupt( acamera_fsm_mgr_t * p_fsm_mgr, uint8_t irq_event )
 {
 #if defined(ISP_HAS_DMA_WRITER_FSM)
@@ -65,6 +65,34 @@ typedef struct _fsm_param_sensor_info_ {
     uint8_t sensor_bits;
 } fsm_param_sensor_info_t;
 
+// Read-mostly copy of the sensor configuration owned by the sensor FSM.
+// It is republished, and generation incremented, only when the sensor is
+// reconfigured (init, preset switch, black level change), so consumers can
+// read it in place and compare generation to refresh derived values.
+typedef struct _fsm_param_sensor_snapshot_ {
+    uint32_t generation;
+    fsm_param_sensor_info_t info;
+} fsm_param_sensor_snapshot_t;
+
+enum fsm_param_sensor_preset_diff_bit {
+    SENSOR_PRESET_DIFF_MODE = ( 1 << 0 ),
+    SENSOR_PRESET_DIFF_SIZE = ( 1 << 1 ),
+    SENSOR_PRESET_DIFF_BITS = ( 1 << 2 ),
+    SENSOR_PRESET_DIFF_WDR = ( 1 << 3 ),
+    SENSOR_PRESET_DIFF_CALIBRATION = ( 1 << 4 ),
+};
+
+// any of these differences needs the ISP input port to be stopped
+#define SENSOR_PRESET_DIFF_COLD_MASK ( SENSOR_PRESET_DIFF_SIZE | SENSOR_PRESET_DIFF_BITS | SENSOR_PRESET_DIFF_WDR | SENSOR_PRESET_DIFF_CALIBRATION )
+
+typedef struct _fsm_param_sensor_switch_info_ {
+    // diff is a combination of fsm_param_sensor_preset_diff_bit.
+    uint32_t diff;
+    uint32_t switch_time_ms;
+    uint32_t warm_switch_num;
+    uint32_t cold_switch_num;
+} fsm_param_sensor_switch_info_t;
+
 typedef struct _fsm_param_ae_info_ {
     int32_t exposure_log2;
     int32_t ae_hist_mean;
@@ -138,6 +166,8 @@ typedef struct _fsm_param_path_fps_ {
 	dma_type pipe_id;
 	uint32_t c_fps;
 	uint32_t t_fps;
+	uint32_t delivered; // FSM_PARAM_GET_PATH_FPS only
+	uint32_t skipped;   // FSM_PARAM_GET_PATH_FPS only
 }fsm_param_path_fps_t;
 
 
@@ -265,6 +295,7 @@ typedef struct _exposure_data_set_t {
     uint32_t integration_time_medium2;
 
     uint32_t frame_id_tracking;
+    uint32_t update_count; // cmos exposure updates up to the one which computed the set
 } exposure_data_set_t;
 
 typedef struct _exposure_info_set_t {
@@ -354,6 +385,7 @@ typedef struct _fsm_param_fw_status_info_ {
 
 int acamera_fsm_mgr_get_param( acamera_fsm_mgr_t *p_fsm_mgr, uint32_t param_id, void *input, uint32_t input_size, void *output, uint32_t output_size );
 int acamera_fsm_mgr_set_param( acamera_fsm_mgr_t *p_fsm_mgr, uint32_t param_id, void *input, uint32_t input_size );
+const fsm_param_sensor_snapshot_t *acamera_fsm_mgr_get_sensor_snapshot( acamera_fsm_mgr_t *p_fsm_mgr );
 
 void acamera_fsm_mgr_dma_writer_update_address_interrupt( acamera_fsm_mgr_t *p_fsm_mgr, uint8_t irq_event );
 
@@ -176,6 +176,8 @@ typedef enum {
     FSM_PARAM_GET_SENSOR_INFO_PRESET_NUM,
     FSM_PARAM_GET_SENSOR_REG,
     FSM_PARAM_GET_SENSOR_ID,
+    FSM_PARAM_GET_SENSOR_SWITCH_INFO,
+    FSM_PARAM_GET_SENSOR_SNAPSHOT,
     FSM_PARAM_GET_SENSOR_END,
 
     /* CMOS */
@@ -183,12 +185,14 @@ typedef enum {
     FSM_PARAM_GET_CMOS_EXPOSURE_LOG2,
     FSM_PARAM_GET_CMOS_EXPOSURE_RATIO,
     FSM_PARAM_GET_FRAME_EXPOSURE_SET,
+    FSM_PARAM_GET_FRAME_EXPOSURE_SET_BY_ID,
     FSM_PARAM_GET_CMOS_TOTAL_GAIN,
     FSM_PARAM_GET_FPS,
     FSM_PARAM_GET_AE_MODE,
     FSM_PARAM_GET_GAIN,
     FSM_PARAM_GET_CMOS_EXP_WRITE_SET,
     FSM_PARAM_GET_CMOS_SPLIT_STRATEGY,
+    FSM_PARAM_GET_CMOS_EXPOSURE_UPDATES,
     FSM_PARAM_GET_CMOS_END,
 
     /* CROP */
@@ -258,6 +262,7 @@ typedef enum {
     FSM_PARAM_GET_DMA_WRITER_START,
     FSM_PARAM_GET_DMA_READER_OUTPUT,
     FSM_PARAM_GET_DMA_VFLIP,
+    FSM_PARAM_GET_PATH_FPS,
     FSM_PARAM_GET_DMA_WRITER_END,
 
     /* AF */
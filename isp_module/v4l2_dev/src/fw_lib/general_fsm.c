@@ -327,6 +327,9 @@ uint8_t general_fsm_process_event( general_fsm_t *p_fsm, event_id_t event_id )
     default:
         break;
     case event_id_new_frame:
+        // the previous frame is done with the stats, take the ones of this frame
+        acamera_latch_metering_stats( ACAMERA_FSM2CTX_PTR( p_fsm ) );
+
         acamera_general_interrupt_hanlder( ACAMERA_FSM2CTX_PTR( p_fsm ), ACAMERA_IRQ_FRAME_START );
         acamera_general_interrupt_hanlder( ACAMERA_FSM2CTX_PTR( p_fsm ), ACAMERA_IRQ_FRAME_END );
         acamera_general_interrupt_hanlder( ACAMERA_FSM2CTX_PTR( p_fsm ), ACAMERA_IRQ_ANTIFOG_HIST );
@@ -27,6 +27,7 @@
 
 void metadata_fsm_clear( metadata_fsm_t *p_fsm )
 {
+    p_fsm->fe_frame_id = 0;
 }
 
 void metadata_request_interrupt( metadata_fsm_ptr_t p_fsm, system_fw_interrupt_mask_t mask )
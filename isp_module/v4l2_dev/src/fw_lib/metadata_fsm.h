@@ -39,6 +39,8 @@ struct _metadata_fsm_t {
     fsm_irq_mask_t mask;
     firmware_metadata_t cur_metadata;
     metadata_callback_t callback_meta;
+    /* frame id of the last frame end, used to look up the exposure of that frame */
+    uint32_t fe_frame_id;
 };
 
 
@@ -67,11 +67,9 @@ void metadata_update_meta( metadata_fsm_t *p_fsm )
     uint32_t avg_GB = -1;
     int32_t temperature_detected = -1;
 
-    fsm_param_sensor_info_t sensor_info;
+    const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
     fsm_param_awb_info_t awb_info;
 
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
-
 #if defined( ISP_HAS_AF_LMS_FSM ) || defined( ISP_HAS_AF_MANUAL_FSM )
     lens_param_t lens_param;
     acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_LENS_PARAM, NULL, 0, &lens_param, sizeof( lens_param ) );
@@ -98,6 +96,7 @@ void metadata_update_meta( metadata_fsm_t *p_fsm )
 #if ISP_HAS_CMOS_FSM
     exposure_set_t exp_set;
     int32_t frame = 3; // NUMBER_OF_USED_BANKS;
+    uint32_t fe_frame_id = p_fsm->fe_frame_id;
 #endif
 
 
@@ -108,10 +107,10 @@ void metadata_update_meta( metadata_fsm_t *p_fsm )
 
     // Basic info
     md->image_format = 1;
-    md->sensor_width = sensor_info.total_width;
-    md->sensor_height = sensor_info.total_height;
+    md->sensor_width = sensor_info->total_width;
+    md->sensor_height = sensor_info->total_height;
 
-    md->sensor_bits = sensor_info.sensor_bits;
+    md->sensor_bits = sensor_info->sensor_bits;
     md->rggb_start = 0;
 
     md->isp_mode = wdr_mode;
@@ -120,7 +119,10 @@ void metadata_update_meta( metadata_fsm_t *p_fsm )
 #if ISP_HAS_CMOS_FSM
     memset( &exp_set, 0x0, sizeof( exposure_set_t ) );
 
-    acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_FRAME_EXPOSURE_SET, &frame, sizeof( frame ), &exp_set, sizeof( exp_set ) );
+    // exact exposure of the frame which has just ended, the relative lookup is only used when it has left the history
+    if ( acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_FRAME_EXPOSURE_SET_BY_ID, &fe_frame_id, sizeof( fe_frame_id ), &exp_set, sizeof( exp_set ) ) != 0 ) {
+        acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_FRAME_EXPOSURE_SET, &frame, sizeof( frame ), &exp_set, sizeof( exp_set ) );
+    }
 
     md->int_time = exp_set.data.integration_time;
     md->int_time_ms = ( md->int_time * 100000 / md->sensor_height ) * 256 / md->fps;
@@ -323,6 +325,7 @@ void metadata_fsm_process_interrupt( metadata_fsm_const_ptr_t p_fsm, uint8_t irq
         return;
     switch ( irq_event ) {
     case ACAMERA_IRQ_FRAME_END:
+        ( (metadata_fsm_ptr_t)p_fsm )->fe_frame_id = acamera_fsm_util_get_cur_frame_id( &( (metadata_fsm_ptr_t)p_fsm )->cmn );
         fsm_raise_event( p_fsm, event_id_metadata_update );
         fsm_raise_event( p_fsm, event_id_metadata_ready );
         break;
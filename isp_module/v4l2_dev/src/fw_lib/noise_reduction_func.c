@@ -74,8 +74,8 @@ void dynamic_dpc_strength_calculate( noise_reduction_fsm_t *p_fsm )
         modulation_entry_t *dp_threshold_table = _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), dp_threshold_table_idx );
         uint32_t dp_threshold_table_len = _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), dp_threshold_table_idx );
 
-        dp_slope = acamera_calc_modulation_u16( log2_gain, dp_slope_table, dp_slope_table_len );
-        dp_threshold = acamera_calc_modulation_u16( log2_gain, dp_threshold_table, dp_threshold_table_len );
+        dp_slope = acamera_calc_modulation_u16_hint( log2_gain, dp_slope_table, dp_slope_table_len, _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), dp_slope_table_idx ) );
+        dp_threshold = acamera_calc_modulation_u16_hint( log2_gain, dp_threshold_table, dp_threshold_table_len, _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), dp_threshold_table_idx ) );
     }
     acamera_isp_raw_frontend_dp_slope_write( p_fsm->cmn.isp_base, dp_slope );
     acamera_isp_raw_frontend_dp_threshold_write( p_fsm->cmn.isp_base, dp_threshold );
@@ -99,14 +99,14 @@ void stitching_error_calculate( noise_reduction_fsm_t *p_fsm )
 
     uint16_t log2_gain = total_gain >> ( LOG2_GAIN_SHIFT - 8 );
     //long medium motion
-    uint16_t lm_np = acamera_calc_modulation_u16( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_NP ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_NP ) );
-    uint16_t lm_mov_mult = acamera_calc_modulation_u16( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MOV_MULT ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MOV_MULT ) );
+    uint16_t lm_np = acamera_calc_modulation_u16_hint( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_NP ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_NP ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_NP ) );
+    uint16_t lm_mov_mult = acamera_calc_modulation_u16_hint( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MOV_MULT ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MOV_MULT ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MOV_MULT ) );
     //medium short motion
-    uint16_t ms_np = acamera_calc_modulation_u16( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_NP ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_NP ) );
-    uint16_t ms_mov_mult = acamera_calc_modulation_u16( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_MOV_MULT ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_MOV_MULT ) );
+    uint16_t ms_np = acamera_calc_modulation_u16_hint( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_NP ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_NP ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_NP ) );
+    uint16_t ms_mov_mult = acamera_calc_modulation_u16_hint( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_MOV_MULT ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_MOV_MULT ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_MS_MOV_MULT ) );
     //short very short motion
-    uint16_t svs_np = acamera_calc_modulation_u16( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_NP ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_NP ) );
-    uint16_t svs_mov_mult = acamera_calc_modulation_u16( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_MOV_MULT ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_MOV_MULT ) );
+    uint16_t svs_np = acamera_calc_modulation_u16_hint( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_NP ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_NP ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_NP ) );
+    uint16_t svs_mov_mult = acamera_calc_modulation_u16_hint( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_MOV_MULT ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_MOV_MULT ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_SVS_MOV_MULT ) );
 
 
     //change to MC off mode when gain is higher than gain_log2 value found in calibration
@@ -120,17 +120,16 @@ void stitching_error_calculate( noise_reduction_fsm_t *p_fsm )
         // printf("%d %d %d\n",(int)log2_gain, 0,(int)MC_off_enable_gain );
     }
 
-    uint16_t stitching_lm_med_noise_intensity_thresh = acamera_calc_modulation_u16( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MED_NOISE_INTENSITY ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MED_NOISE_INTENSITY ) );
+    uint16_t stitching_lm_med_noise_intensity_thresh = acamera_calc_modulation_u16_hint( log2_gain, (modulation_entry_t *)_GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MED_NOISE_INTENSITY ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MED_NOISE_INTENSITY ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_STITCHING_LM_MED_NOISE_INTENSITY ) );
 
 #if ISP_WDR_SWITCH
 
     uint32_t wdr_mode = 0;
     acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_WDR_MODE, NULL, 0, &wdr_mode, sizeof( wdr_mode ) );
     if ( WDR_MODE_FS_LIN == wdr_mode ) {
-        fsm_param_sensor_info_t sensor_info;
-        acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+        const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
-        switch ( sensor_info.sensor_exp_number ) {
+        switch ( sensor_info->sensor_exp_number ) {
         case 4:
             acamera_isp_frame_stitch_lm_np_mult_write( p_fsm->cmn.isp_base, lm_np );
             acamera_isp_frame_stitch_lm_alpha_mov_slope_write( p_fsm->cmn.isp_base, lm_mov_mult );
@@ -156,7 +155,7 @@ void stitching_error_calculate( noise_reduction_fsm_t *p_fsm )
             break;
 
         default:
-            LOG( LOG_ERR, "Unsupported exposures number: %d", sensor_info.sensor_exp_number );
+            LOG( LOG_ERR, "Unsupported exposures number: %d", sensor_info->sensor_exp_number );
             break;
         }
     }
@@ -187,7 +186,7 @@ void sinter_strength_calculate( noise_reduction_fsm_t *p_fsm )
         uint16_t log2_gain = total_gain >> ( LOG2_GAIN_SHIFT - 8 );
 
         // LOG( LOG_ERR, "log2_gain %d total_gain %d", log2_gain, total_gain );
-        snr_thresh_master = acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_idx ) );
+        snr_thresh_master = acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_idx ) );
 #if ( defined( ISP_HAS_IRIDIX8_FSM ) || defined( ISP_HAS_IRIDIX8_MANUAL_FSM ) ) && defined( CALIBRATION_SINTER_STRENGTH_MC_CONTRAST ) //CHECK LOGIC IS CORRECT
         uint32_t sinter_strength_mc_contrast_idx = CALIBRATION_SINTER_STRENGTH_MC_CONTRAST;
         // Adjust strength according to contrast
@@ -196,7 +195,7 @@ void sinter_strength_calculate( noise_reduction_fsm_t *p_fsm )
         acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_IRIDIX_CONTRAST, NULL, 0, &iridix_contrast, sizeof( iridix_contrast ) );
 
         iridix_contrast = iridix_contrast >> 8;
-        uint32_t snr_thresh_master_contrast = acamera_calc_modulation_u16( iridix_contrast, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_mc_contrast_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_mc_contrast_idx ) );
+        uint32_t snr_thresh_master_contrast = acamera_calc_modulation_u16_hint( iridix_contrast, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_mc_contrast_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_mc_contrast_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength_mc_contrast_idx ) );
         if ( snr_thresh_master_contrast > 0xFF )
             snr_thresh_master_contrast = 0xFF;
         //it will only affect short exposure
@@ -209,22 +208,22 @@ void sinter_strength_calculate( noise_reduction_fsm_t *p_fsm )
 
         ACAMERA_FSM2CTX_PTR( p_fsm )
             ->stab.global_sinter_threshold_target = ( snr_thresh_master );
-        uint16_t sinter_strenght1 = acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength1_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength1_idx ) );
+        uint16_t sinter_strenght1 = acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength1_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength1_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_strength1_idx ) );
         // LOG( LOG_CRIT, "sinter_strenght1 %d log2_gain %d ", (int)sinter_strenght1, (int)log2_gain );
         acamera_isp_sinter_strength_1_write( p_fsm->cmn.isp_base, sinter_strenght1 );
-        uint16_t sinter_thresh1 = acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh1_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh1_idx ) );
+        uint16_t sinter_thresh1 = acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh1_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh1_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh1_idx ) );
         acamera_isp_sinter_thresh_1h_write( p_fsm->cmn.isp_base, sinter_thresh1 );
         acamera_isp_sinter_thresh_1v_write( p_fsm->cmn.isp_base, sinter_thresh1 );
-        uint16_t sinter_thresh4 = acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh4_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh4_idx ) );
+        uint16_t sinter_thresh4 = acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh4_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh4_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_thresh4_idx ) );
         acamera_isp_sinter_thresh_4h_write( p_fsm->cmn.isp_base, sinter_thresh4 );
         acamera_isp_sinter_thresh_4v_write( p_fsm->cmn.isp_base, sinter_thresh4 );
 
-        uint16_t sinter_int_config = acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_int_config_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_int_config_idx ) );
+        uint16_t sinter_int_config = acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_int_config_idx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_int_config_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_int_config_idx ) );
         acamera_isp_sinter_int_config_write( p_fsm->cmn.isp_base, sinter_int_config );
 
         if ( acamera_isp_isp_global_parameter_status_sinter_version_read( p_fsm->cmn.isp_base ) ) { //sinter 3 is used
             int sinter_sad_inx = CALIBRATION_SINTER_SAD;
-            acamera_isp_sinter_sad_filt_thresh_write( p_fsm->cmn.isp_base, acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_sad_inx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_sad_inx ) ) );
+            acamera_isp_sinter_sad_filt_thresh_write( p_fsm->cmn.isp_base, acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_sad_inx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_sad_inx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sinter_sad_inx ) ) );
         }
     } else {
         snr_thresh_master = ACAMERA_FSM2CTX_PTR( p_fsm )->stab.global_sinter_threshold_target;
@@ -248,20 +247,19 @@ void temper_strength_calculate( noise_reduction_fsm_t *p_fsm )
         acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_CMOS_TOTAL_GAIN, NULL, 0, &total_gain, sizeof( total_gain ) );
         uint16_t log2_gain = total_gain >> ( LOG2_GAIN_SHIFT - 8 );
         //this drives global offset
-        tnr_thresh_master = acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_TEMPER_STRENGTH ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_TEMPER_STRENGTH ) );
+        tnr_thresh_master = acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_TEMPER_STRENGTH ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_TEMPER_STRENGTH ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_TEMPER_STRENGTH ) );
         ACAMERA_FSM2CTX_PTR( p_fsm )
             ->stab.global_temper_threshold_target = ( tnr_thresh_master );
 
         switch ( wdr_mode ) {
         case WDR_MODE_FS_LIN: {
 
-            fsm_param_sensor_info_t sensor_info;
-            acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
+            const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
 
             exposure_data_set_t exp_write_set;
             acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_CMOS_EXP_WRITE_SET, NULL, 0, &exp_write_set, sizeof( exp_write_set ) );
 
-            switch ( sensor_info.sensor_exp_number ) {
+            switch ( sensor_info->sensor_exp_number ) {
 
             case 4: {
                 const uint32_t SVS_exp_ratio = exp_write_set.exposure_ratio_short;  //Usomething.6
@@ -438,7 +436,7 @@ void temper_strength_calculate( noise_reduction_fsm_t *p_fsm )
             } break;
 
             default: {
-                LOG( LOG_ERR, "Unsupported exposures number: %d", sensor_info.sensor_exp_number );
+                LOG( LOG_ERR, "Unsupported exposures number: %d", sensor_info->sensor_exp_number );
             } break;
             }
             break;
@@ -489,14 +487,14 @@ void noise_reduction_update( noise_reduction_fsm_t *p_fsm )
     uint16_t log2_gain = total_gain >> ( LOG2_GAIN_SHIFT - 8 );
     if ( ACAMERA_FSM2CTX_PTR( p_fsm )->stab.global_manual_demosaic == 0 ) {
         int tbl_inx = CALIBRATION_DEMOSAIC_NP_OFFSET;
-        acamera_isp_demosaic_rgb_np_offset_write( p_fsm->cmn.isp_base, acamera_calc_modulation_u16( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), tbl_inx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), tbl_inx ) ) );
+        acamera_isp_demosaic_rgb_np_offset_write( p_fsm->cmn.isp_base, acamera_calc_modulation_u16_hint( log2_gain, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), tbl_inx ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), tbl_inx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), tbl_inx ) ) );
     }
 
     //  Do not update values if manual mode
     if ( ACAMERA_FSM2CTX_PTR( p_fsm )->stab.global_manual_cnr == 0 ) {
         const modulation_entry_t *cnr_uv_delta12_slope = _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_CNR_UV_DELTA12_SLOPE );
         uint32_t cnr_uv_delta12_slope_len = _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_CNR_UV_DELTA12_SLOPE );
-        uint16_t uv_delta_slope = acamera_calc_modulation_u16( log2_gain, cnr_uv_delta12_slope, cnr_uv_delta12_slope_len );
+        uint16_t uv_delta_slope = acamera_calc_modulation_u16_hint( log2_gain, cnr_uv_delta12_slope, cnr_uv_delta12_slope_len, _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_CNR_UV_DELTA12_SLOPE ) );
         acamera_isp_cnr_uv_delta1_slope_write( p_fsm->cmn.isp_base, uv_delta_slope );
         acamera_isp_cnr_uv_delta2_slope_write( p_fsm->cmn.isp_base, uv_delta_slope );
     }
@@ -517,9 +515,8 @@ void noise_reduction_update( noise_reduction_fsm_t *p_fsm )
             exposure_data_set_t exp_write_set;
             acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_CMOS_EXP_WRITE_SET, NULL, 0, &exp_write_set, sizeof( exp_write_set ) );
 
-            fsm_param_sensor_info_t sensor_info;
-            acamera_fsm_mgr_get_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_SENSOR_INFO, NULL, 0, &sensor_info, sizeof( sensor_info ) );
-            switch ( sensor_info.sensor_exp_number ) {
+            const fsm_param_sensor_info_t *sensor_info = &acamera_fsm_mgr_get_sensor_snapshot( p_fsm->cmn.p_fsm_mgr )->info;
+            switch ( sensor_info->sensor_exp_number ) {
             case 4: {
                 // Noise level: 4:1
                 // noise level 0 => (very short) = 64:
@@ -583,7 +580,7 @@ void noise_reduction_update( noise_reduction_fsm_t *p_fsm )
             } break;
 
             default: {
-                LOG( LOG_ERR, "Unsupported exposures number: %d", sensor_info.sensor_exp_number );
+                LOG( LOG_ERR, "Unsupported exposures number: %d", sensor_info->sensor_exp_number );
             } break;
             }
         }
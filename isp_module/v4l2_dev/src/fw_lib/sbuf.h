@@ -226,6 +226,66 @@ struct fw_sbuf {
 #endif
 };
 
+/*
+ * Recorder: while /dev/ac_sbufN_rec is open every stats set handed to the
+ * user FW by read() and every parameter set written back by write() is
+ * queued as a record, the reader gets a byte stream that can be stored as is.
+ *
+ * Stream: struct sbuf_rec_hdr, then records. A record is struct sbuf_rec_entry
+ * followed by 'size' bytes of payload:
+ *   SBUF_REC_KF_INFO: struct kf_info, once at the start of a recording.
+ *   SBUF_REC_STATS: struct cmos_info, then the sbuf item of every valid index
+ *                   in idx_set in enum sbuf_type order.
+ *   SBUF_REC_PARAM: the UF -> KF part of the sbuf item of every valid index
+ *                   in idx_set, the statistics are not repeated.
+ *   SBUF_REC_DROP: no payload, frame_id holds the number of records lost
+ *                  because the reader was too slow.
+ * The header describes where the items live in struct fw_sbuf, so a replay
+ * does not need this header to rebuild the shared buffer.
+ *
+ * The layout is ABI, sbuf_replay/sbuf_rec.h mirrors it.
+ */
+#define SBUF_REC_DEV_FORMAT "ac_sbuf%d_rec"
+#define SBUF_REC_MAGIC 0x43455253 /* 'SREC' */
+#define SBUF_REC_VERSION 1
+#define SBUF_REC_FIFO_SIZE ( 2 * 1024 * 1024 ) /* power of two */
+
+enum sbuf_rec_type {
+    SBUF_REC_KF_INFO,
+    SBUF_REC_STATS,
+    SBUF_REC_PARAM,
+    SBUF_REC_DROP,
+};
+
+struct sbuf_rec_layout {
+    uint32_t offset;       /* of item 0 from the start of struct fw_sbuf */
+    uint32_t size;         /* of one item, 0 if the type is not built in */
+    uint32_t param_offset; /* of the UF -> KF part in an item */
+    uint32_t param_size;
+};
+
+struct sbuf_rec_hdr {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t fw_id;
+    uint32_t sbuf_size; /* sizeof( struct fw_sbuf ) */
+    uint32_t kf_info_size;
+    uint32_t cmos_info_offset;
+    uint32_t cmos_info_size;
+    uint32_t fetched_offset; /* of kf_info.cali_info.is_fetched */
+    uint32_t array_size;     /* SBUF_STATS_ARRAY_SIZE */
+    struct sbuf_rec_layout item[SBUF_TYPE_MAX];
+};
+
+struct sbuf_rec_entry {
+    uint32_t type;
+    uint32_t frame_id;
+    uint64_t ts_ns;
+    uint32_t size; /* payload bytes following this entry */
+    struct sbuf_idx_set idx_set;
+    uint8_t reserved[2];
+};
+
 /**
  * sbuf_get_item - get a sbuf item from sbuf_mgr to use
  *
@@ -26,8 +26,11 @@
 #include <linux/spinlock_types.h>
 #include <linux/wait.h>
 #include <linux/version.h>
+#include <linux/kfifo.h>
+#include <linux/vmalloc.h>
 #include "sbuf.h"
 #include "acamera.h"
+#include "system_timer.h"
 #include "sbuf_fsm.h"
 #include "acamera_firmware_settings.h"
 
@@ -131,6 +134,17 @@ struct sbuf_context {
     struct mutex idx_set_lock;
     struct sbuf_idx_set idx_set;
     wait_queue_head_t idx_set_wait_queue;
+
+    /* recorder, active while rec_dev is open */
+    struct miscdevice rec_dev;
+    int rec_minor_id;
+    char rec_dev_name[SBUF_DEV_NAME_LEN];
+    struct mutex rec_lock;
+    struct kfifo rec_fifo;
+    void *rec_buf;
+    int rec_opened;
+    uint32_t rec_dropped;
+    wait_queue_head_t rec_wait_queue;
 };
 
 static struct sbuf_context sbuf_contexts[FIRMWARE_CONTEXT_NUMBER];
@@ -1509,6 +1523,184 @@ int sbuf_set_item( int fw_id, struct sbuf_item *item )
     return rc;
 }
 
+/* an item and where it and its UF -> KF part live in struct fw_sbuf */
+static void *sbuf_rec_get_item( struct sbuf_context *p_ctx, uint32_t type, uint32_t idx, struct sbuf_rec_layout *layout )
+{
+    struct fw_sbuf *p_sbuf = p_ctx->sbuf_mgr.sbuf_base;
+    uint8_t *arr = NULL;
+    uint32_t param_end = 0;
+
+    memset( layout, 0, sizeof( *layout ) );
+    if ( idx >= SBUF_STATS_ARRAY_SIZE )
+        return NULL;
+
+    switch ( type ) {
+#if defined( ISP_HAS_AE_MANUAL_FSM )
+    case SBUF_TYPE_AE:
+        arr = (uint8_t *)p_sbuf->ae_sbuf;
+        layout->size = sizeof( sbuf_ae_t );
+        layout->param_offset = offsetof( sbuf_ae_t, ae_exposure );
+        param_end = offsetof( sbuf_ae_t, frame_id );
+        break;
+#endif
+
+#if defined( ISP_HAS_AWB_MANUAL_FSM )
+    case SBUF_TYPE_AWB:
+        arr = (uint8_t *)p_sbuf->awb_sbuf;
+        layout->size = sizeof( sbuf_awb_t );
+        layout->param_offset = offsetof( sbuf_awb_t, awb_red_gain );
+        param_end = offsetof( sbuf_awb_t, frame_id );
+        break;
+#endif
+
+#if defined( ISP_HAS_AF_MANUAL_FSM )
+    case SBUF_TYPE_AF:
+        arr = (uint8_t *)p_sbuf->af_sbuf;
+        layout->size = sizeof( sbuf_af_t );
+        layout->param_offset = offsetof( sbuf_af_t, frame_to_skip );
+        param_end = sizeof( sbuf_af_t );
+        break;
+#endif
+
+#if defined( ISP_HAS_GAMMA_MANUAL_FSM )
+    case SBUF_TYPE_GAMMA:
+        arr = (uint8_t *)p_sbuf->gamma_sbuf;
+        layout->size = sizeof( sbuf_gamma_t );
+        layout->param_offset = offsetof( sbuf_gamma_t, gamma_gain );
+        param_end = offsetof( sbuf_gamma_t, frame_id );
+        break;
+#endif
+
+#if defined( ISP_HAS_IRIDIX_MANUAL_FSM ) || defined( ISP_HAS_IRIDIX8_MANUAL_FSM )
+    case SBUF_TYPE_IRIDIX:
+        arr = (uint8_t *)p_sbuf->iridix_sbuf;
+        layout->size = sizeof( sbuf_iridix_t );
+        layout->param_offset = offsetof( sbuf_iridix_t, strength_target );
+        param_end = offsetof( sbuf_iridix_t, frame_id );
+        break;
+#endif
+    default:
+        return NULL;
+    }
+
+    layout->offset = arr - (uint8_t *)p_sbuf;
+    layout->param_size = param_end - layout->param_offset;
+
+    return arr + idx * layout->size;
+}
+
+/* returns 1 and the index if the idx_set holds a valid item of this type */
+static int sbuf_rec_get_idx( const struct sbuf_idx_set *p_idx_set, uint32_t type, uint32_t *idx )
+{
+    switch ( type ) {
+    case SBUF_TYPE_AE:
+        *idx = p_idx_set->ae_idx;
+        return p_idx_set->ae_idx_valid;
+    case SBUF_TYPE_AWB:
+        *idx = p_idx_set->awb_idx;
+        return p_idx_set->awb_idx_valid;
+    case SBUF_TYPE_AF:
+        *idx = p_idx_set->af_idx;
+        return p_idx_set->af_idx_valid;
+    case SBUF_TYPE_GAMMA:
+        *idx = p_idx_set->gamma_idx;
+        return p_idx_set->gamma_idx_valid;
+    case SBUF_TYPE_IRIDIX:
+        *idx = p_idx_set->iridix_idx;
+        return p_idx_set->iridix_idx_valid;
+    default:
+        return 0;
+    }
+}
+
+/* frame id of the first valid item which carries one */
+static uint32_t sbuf_rec_get_frame_id( struct sbuf_context *p_ctx, const struct sbuf_idx_set *p_idx_set )
+{
+    uint32_t idx;
+
+#if defined( ISP_HAS_AE_MANUAL_FSM )
+    if ( sbuf_rec_get_idx( p_idx_set, SBUF_TYPE_AE, &idx ) && idx < SBUF_STATS_ARRAY_SIZE )
+        return p_ctx->sbuf_mgr.sbuf_base->ae_sbuf[idx].frame_id;
+#endif
+#if defined( ISP_HAS_AWB_MANUAL_FSM )
+    if ( sbuf_rec_get_idx( p_idx_set, SBUF_TYPE_AWB, &idx ) && idx < SBUF_STATS_ARRAY_SIZE )
+        return p_ctx->sbuf_mgr.sbuf_base->awb_sbuf[idx].frame_id;
+#endif
+#if defined( ISP_HAS_GAMMA_MANUAL_FSM )
+    if ( sbuf_rec_get_idx( p_idx_set, SBUF_TYPE_GAMMA, &idx ) && idx < SBUF_STATS_ARRAY_SIZE )
+        return p_ctx->sbuf_mgr.sbuf_base->gamma_sbuf[idx].frame_id;
+#endif
+#if defined( ISP_HAS_AF_MANUAL_FSM )
+    if ( sbuf_rec_get_idx( p_idx_set, SBUF_TYPE_AF, &idx ) && idx < SBUF_STATS_ARRAY_SIZE )
+        return p_ctx->sbuf_mgr.sbuf_base->af_sbuf[idx].frame_num;
+#endif
+
+    return 0;
+}
+
+/* queue one record, the caller holds rec_lock and the recorder is open */
+static int sbuf_rec_put_locked( struct sbuf_context *p_ctx, uint32_t type, uint32_t frame_id, const struct sbuf_idx_set *p_idx_set, const void *extra, uint32_t extra_size )
+{
+    struct sbuf_rec_entry entry;
+    struct sbuf_rec_layout layout;
+    uint8_t *item;
+    uint32_t t, idx;
+
+    memset( &entry, 0, sizeof( entry ) );
+    entry.type = type;
+    entry.frame_id = frame_id;
+    entry.ts_ns = system_timer_timestamp_ns();
+    entry.size = extra_size;
+
+    if ( p_idx_set ) {
+        entry.idx_set = *p_idx_set;
+        for ( t = 0; t < SBUF_TYPE_MAX; t++ ) {
+            if ( sbuf_rec_get_idx( p_idx_set, t, &idx ) && sbuf_rec_get_item( p_ctx, t, idx, &layout ) )
+                entry.size += ( type == SBUF_REC_PARAM ) ? layout.param_size : layout.size;
+        }
+    }
+
+    if ( kfifo_avail( &p_ctx->rec_fifo ) < sizeof( entry ) + entry.size )
+        return -ENOSPC;
+
+    kfifo_in( &p_ctx->rec_fifo, &entry, sizeof( entry ) );
+    if ( extra_size )
+        kfifo_in( &p_ctx->rec_fifo, extra, extra_size );
+
+    if ( p_idx_set ) {
+        for ( t = 0; t < SBUF_TYPE_MAX; t++ ) {
+            if ( !sbuf_rec_get_idx( p_idx_set, t, &idx ) || ( item = sbuf_rec_get_item( p_ctx, t, idx, &layout ) ) == NULL )
+                continue;
+
+            if ( type == SBUF_REC_PARAM )
+                kfifo_in( &p_ctx->rec_fifo, item + layout.param_offset, layout.param_size );
+            else
+                kfifo_in( &p_ctx->rec_fifo, item, layout.size );
+        }
+    }
+
+    return 0;
+}
+
+static void sbuf_rec_put( struct sbuf_context *p_ctx, uint32_t type, const struct sbuf_idx_set *p_idx_set, const void *extra, uint32_t extra_size )
+{
+    if ( !p_ctx->rec_opened )
+        return;
+
+    mutex_lock( &p_ctx->rec_lock );
+    if ( p_ctx->rec_opened ) {
+        // tell the reader about lost records as soon as there is room again
+        if ( p_ctx->rec_dropped && !sbuf_rec_put_locked( p_ctx, SBUF_REC_DROP, p_ctx->rec_dropped, NULL, NULL, 0 ) )
+            p_ctx->rec_dropped = 0;
+
+        if ( p_ctx->rec_dropped || sbuf_rec_put_locked( p_ctx, type, sbuf_rec_get_frame_id( p_ctx, p_idx_set ), p_idx_set, extra, extra_size ) )
+            p_ctx->rec_dropped++;
+        else
+            wake_up_interruptible( &p_ctx->rec_wait_queue );
+    }
+    mutex_unlock( &p_ctx->rec_lock );
+}
+
 static int sbuf_fops_open( struct inode *inode, struct file *f )
 {
     int rc;
@@ -1615,7 +1807,11 @@ static ssize_t sbuf_fops_write( struct file *file, const char __user *buf, size_
          idx_set.gamma_idx_valid, idx_set.gamma_idx,
          idx_set.iridix_idx_valid, idx_set.iridix_idx );
 
+    if ( !rc )
+        sbuf_rec_put( p_ctx, SBUF_REC_PARAM, &idx_set, NULL, 0 );
+
     sbuf_mgr_apply_new_param( p_ctx, &idx_set );
+    acamera_wake( ACAMERA_WAKE_SBUF | ACAMERA_WAKE_CTX( p_ctx->fw_id ) );
 
     return rc ? rc : len_to_copy;
 }
@@ -1674,6 +1870,9 @@ static ssize_t sbuf_fops_read( struct file *file, char __user *buf, size_t count
     acamera_fsm_mgr_get_param( p_ctx->p_fsm->cmn.p_fsm_mgr, FSM_PARAM_GET_CMOS_TOTAL_GAIN, NULL, 0, &total_gain_log2, sizeof( total_gain_log2 ) );
     p_ctx->sbuf_mgr.sbuf_base->kf_info.cmos_info.total_gain_log2 = total_gain_log2;
 
+    if ( !rc )
+        sbuf_rec_put( p_ctx, SBUF_REC_STATS, &idx_set, &p_ctx->sbuf_mgr.sbuf_base->kf_info.cmos_info, sizeof( struct cmos_info ) );
+
     return rc ? rc : len_to_copy;
 }
 
@@ -1770,6 +1969,148 @@ static struct file_operations sbuf_mgr_fops = {
     .mmap = sbuf_fops_mmap,
 };
 
+static int sbuf_rec_fops_open( struct inode *inode, struct file *f )
+{
+    int rc;
+    int i;
+    uint32_t t;
+    struct sbuf_context *p_ctx = NULL;
+    struct sbuf_rec_hdr hdr;
+    int minor = iminor( inode );
+
+    for ( i = 0; i < acamera_get_context_number(); i++ ) {
+        if ( sbuf_contexts[i].rec_dev.name && sbuf_contexts[i].rec_minor_id == minor ) {
+            p_ctx = &sbuf_contexts[i];
+            break;
+        }
+    }
+
+    if ( !p_ctx ) {
+        LOG( LOG_ERR, "no sbuf context for recorder minor: %d.", minor );
+        return -ENODEV;
+    }
+
+    if ( !is_sbuf_inited( &p_ctx->sbuf_mgr ) ) {
+        LOG( LOG_ERR, "Error: sbuf is not inited, can't record." );
+        return -ENOMEM;
+    }
+
+    rc = mutex_lock_interruptible( &p_ctx->rec_lock );
+    if ( rc ) {
+        LOG( LOG_ERR, "access lock failed, rc: %d.", rc );
+        return rc;
+    }
+
+    if ( p_ctx->rec_opened ) {
+        LOG( LOG_ERR, "open failed, recorder already opened." );
+        rc = -EBUSY;
+        goto out;
+    }
+
+    p_ctx->rec_buf = vmalloc( SBUF_REC_FIFO_SIZE );
+    if ( !p_ctx->rec_buf ) {
+        rc = -ENOMEM;
+        goto out;
+    }
+    kfifo_init( &p_ctx->rec_fifo, p_ctx->rec_buf, SBUF_REC_FIFO_SIZE );
+
+    memset( &hdr, 0, sizeof( hdr ) );
+    hdr.magic = SBUF_REC_MAGIC;
+    hdr.version = SBUF_REC_VERSION;
+    hdr.fw_id = p_ctx->fw_id;
+    hdr.sbuf_size = sizeof( struct fw_sbuf );
+    hdr.kf_info_size = sizeof( struct kf_info );
+    hdr.cmos_info_offset = offsetof( struct fw_sbuf, kf_info.cmos_info );
+    hdr.cmos_info_size = sizeof( struct cmos_info );
+    hdr.array_size = SBUF_STATS_ARRAY_SIZE;
+    hdr.fetched_offset = offsetof( struct fw_sbuf, kf_info.cali_info.is_fetched );
+    for ( t = 0; t < SBUF_TYPE_MAX; t++ )
+        sbuf_rec_get_item( p_ctx, t, 0, &hdr.item[t] );
+    kfifo_in( &p_ctx->rec_fifo, &hdr, sizeof( hdr ) );
+
+    // the calibration in kf_info is what the user FW starts from
+    sbuf_rec_put_locked( p_ctx, SBUF_REC_KF_INFO, 0, NULL, &p_ctx->sbuf_mgr.sbuf_base->kf_info, sizeof( struct kf_info ) );
+
+    p_ctx->rec_dropped = 0;
+    p_ctx->rec_opened = 1;
+    f->private_data = p_ctx;
+    LOG( LOG_INFO, "fw_id: %d, recording started.", p_ctx->fw_id );
+
+out:
+    mutex_unlock( &p_ctx->rec_lock );
+
+    return rc;
+}
+
+static int sbuf_rec_fops_release( struct inode *inode, struct file *f )
+{
+    struct sbuf_context *p_ctx = (struct sbuf_context *)f->private_data;
+
+    mutex_lock( &p_ctx->rec_lock );
+    p_ctx->rec_opened = 0;
+    vfree( p_ctx->rec_buf );
+    p_ctx->rec_buf = NULL;
+    f->private_data = NULL;
+    mutex_unlock( &p_ctx->rec_lock );
+
+    LOG( LOG_INFO, "fw_id: %d, recording stopped, dropped: %u.", p_ctx->fw_id, p_ctx->rec_dropped );
+
+    return 0;
+}
+
+static ssize_t sbuf_rec_fops_read( struct file *file, char __user *buf, size_t count, loff_t *ppos )
+{
+    int rc;
+    unsigned int copied = 0;
+    struct sbuf_context *p_ctx = (struct sbuf_context *)file->private_data;
+
+    // the only reader, records are queued under rec_lock by the sbuf fops
+    if ( kfifo_is_empty( &p_ctx->rec_fifo ) ) {
+        if ( file->f_flags & O_NONBLOCK )
+            return -EAGAIN;
+
+        rc = wait_event_interruptible( p_ctx->rec_wait_queue, !kfifo_is_empty( &p_ctx->rec_fifo ) );
+        if ( rc )
+            return rc;
+    }
+
+    rc = kfifo_to_user( &p_ctx->rec_fifo, buf, count, &copied );
+
+    return rc ? rc : copied;
+}
+
+static struct file_operations sbuf_rec_fops = {
+    .owner = THIS_MODULE,
+    .open = sbuf_rec_fops_open,
+    .release = sbuf_rec_fops_release,
+    .read = sbuf_rec_fops_read,
+    .llseek = noop_llseek,
+};
+
+static void sbuf_rec_dev_register( struct sbuf_context *p_ctx )
+{
+    int rc;
+    struct miscdevice *p_dev = &p_ctx->rec_dev;
+
+    mutex_init( &p_ctx->rec_lock );
+    init_waitqueue_head( &p_ctx->rec_wait_queue );
+
+    snprintf( p_ctx->rec_dev_name, SBUF_DEV_NAME_LEN, SBUF_REC_DEV_FORMAT, p_ctx->fw_id );
+    p_dev->name = p_ctx->rec_dev_name;
+    p_dev->minor = MISC_DYNAMIC_MINOR;
+    p_dev->fops = &sbuf_rec_fops;
+
+    // the recorder is a debug aid, sbuf works without it
+    rc = misc_register( p_dev );
+    if ( rc ) {
+        LOG( LOG_ERR, "register sbuf recorder device failed, ret: %d.", rc );
+        p_dev->name = NULL;
+        return;
+    }
+
+    p_ctx->rec_minor_id = p_dev->minor;
+}
+
 void sbuf_fsm_initialize( sbuf_fsm_t *p_fsm )
 {
     int rc;
@@ -1829,6 +2170,8 @@ void sbuf_fsm_initialize( sbuf_fsm_t *p_fsm )
     mutex_init( &p_ctx->idx_set_lock );
     init_waitqueue_head( &p_ctx->idx_set_wait_queue );
 
+    sbuf_rec_dev_register( p_ctx );
+
     LOG( LOG_INFO, "sbuf FSM init OK, fw_id: %d, name: '%s', minor_id: %d, p_fsm: %p.", p_ctx->fw_id, p_dev->name, p_ctx->dev_minor_id, p_ctx->p_fsm );
 
     return;
@@ -1854,6 +2197,11 @@ void sbuf_deinit( sbuf_fsm_ptr_t p_fsm )
          p_ctx->dev_name,
          p_ctx->dev_minor_id );
 
+    if ( p_ctx->rec_dev.name ) {
+        misc_deregister( &p_ctx->rec_dev );
+        p_ctx->rec_dev.name = NULL;
+    }
+
     sbuf_mgr_free( &p_ctx->sbuf_mgr );
 
     p_dev = &p_ctx->sbuf_dev;
@@ -19,6 +19,7 @@
 
 #include "acamera_fw.h"
 #include "sensor_fsm.h"
+#include "system_timer.h"
 
 #ifdef LOG_MODULE
 #undef LOG_MODULE
@@ -32,6 +33,10 @@ void sensor_fsm_clear( sensor_fsm_t *p_fsm )
     p_fsm->isp_output_mode = ( ISP_DISPLAY_MODE );
     p_fsm->is_streaming = ( 0 );
     p_fsm->info_preset_num = SENSOR_DEFAULT_PRESET_MODE;
+    p_fsm->switch_diff = 0;
+    p_fsm->switch_time_ms = 0;
+    p_fsm->warm_switch_num = 0;
+    p_fsm->cold_switch_num = 0;
     p_fsm->boot_status = sensor_boot_init( p_fsm );
 }
 
@@ -86,41 +91,27 @@ int sensor_fsm_get_param( void *fsm, uint32_t param_id, void *input, uint32_t in
 
         break;
 
-    case FSM_PARAM_GET_SENSOR_INFO: {
-        const sensor_param_t *param;
+    case FSM_PARAM_GET_SENSOR_INFO:
         if ( !output || output_size != sizeof( fsm_param_sensor_info_t ) ) {
             LOG( LOG_ERR, "Invalid param, param_id: %d.", param_id );
             rc = -1;
             break;
         }
 
-        param = p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx );
-        fsm_param_sensor_info_t *p_sensor_info = (fsm_param_sensor_info_t *)output;
-
-        p_sensor_info->total_width = param->total.width;
-        p_sensor_info->total_height = param->total.height;
-        p_sensor_info->active_width = param->active.width;
-        p_sensor_info->active_height = param->active.height;
-        p_sensor_info->pixels_per_line = param->pixels_per_line;
-        p_sensor_info->lines_per_second = param->lines_per_second;
-
-        p_sensor_info->again_log2_max = param->again_log2_max;
-        p_sensor_info->dgain_log2_max = param->dgain_log2_max;
-        p_sensor_info->integration_time_min = param->integration_time_min;
-        p_sensor_info->integration_time_max = param->integration_time_max;
-        p_sensor_info->integration_time_long_max = param->integration_time_long_max;
-        p_sensor_info->integration_time_limit = param->integration_time_limit;
-
-        p_sensor_info->integration_time_apply_delay = param->integration_time_apply_delay;
-        p_sensor_info->sensor_exp_number = param->sensor_exp_number;
-        p_sensor_info->isp_exposure_channel_delay = param->isp_exposure_channel_delay;
-
-        p_sensor_info->isp_output_mode = p_fsm->isp_output_mode;
-        p_sensor_info->resolution_mode = p_fsm->mode;
-        p_sensor_info->black_level = p_fsm->black_level;
-        p_sensor_info->sensor_bits = param->modes_table[param->mode].bits;
+        *(fsm_param_sensor_info_t *)output = p_fsm->snapshot.info;
+
+        break;
+
+    case FSM_PARAM_GET_SENSOR_SNAPSHOT:
+        if ( !output || output_size != sizeof( fsm_param_sensor_snapshot_t * ) ) {
+            LOG( LOG_ERR, "Invalid param, param_id: %d.", param_id );
+            rc = -1;
+            break;
+        }
+
+        *( (const fsm_param_sensor_snapshot_t **)output ) = &p_fsm->snapshot;
+
         break;
-    }
 
     case FSM_PARAM_GET_SENSOR_PARAM:
         if ( !output || output_size != sizeof( sensor_param_t ** ) ) {
@@ -164,6 +155,19 @@ int sensor_fsm_get_param( void *fsm, uint32_t param_id, void *input, uint32_t in
 
         *(uint32_t *)output = p_fsm->ctrl.get_id( p_fsm->sensor_ctx );
         break;
+    case FSM_PARAM_GET_SENSOR_SWITCH_INFO: {
+        if ( !output || output_size != sizeof( fsm_param_sensor_switch_info_t ) ) {
+            LOG( LOG_ERR, "Invalid param, param_id: %d.", param_id );
+            rc = -1;
+            break;
+        }
+        fsm_param_sensor_switch_info_t *p_info = (fsm_param_sensor_switch_info_t *)output;
+        p_info->diff = p_fsm->switch_diff;
+        p_info->switch_time_ms = p_fsm->switch_time_ms;
+        p_info->warm_switch_num = p_fsm->warm_switch_num;
+        p_info->cold_switch_num = p_fsm->cold_switch_num;
+        break;
+    }
 
     default:
         rc = -1;
@@ -206,12 +210,34 @@ int sensor_fsm_set_param( void *fsm, uint32_t param_id, void *input, uint32_t in
             break;
         }
 
+        if ( *(uint32_t *)input >= p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx )->modes_num ) {
+            LOG( LOG_ERR, "Invalid sensor preset: %u.", (unsigned int)*(uint32_t *)input );
+            rc = -1;
+            break;
+        }
+
         ctx_ptr = ACAMERA_FSM2CTX_PTR(p_fsm);
         ctx_ptr->irq_flag++;
-        p_fsm->preset_mode = *(uint32_t *)input;
-        sensor_hw_init( p_fsm );
-        sensor_configure_buffers( p_fsm );
-        sensor_sw_init( p_fsm );
+        {
+            uint32_t start = system_timer_timestamp();
+            uint32_t preset = *(uint32_t *)input;
+
+            p_fsm->switch_diff = sensor_get_preset_diff( p_fsm, preset );
+            p_fsm->preset_mode = preset;
+            sensor_switch_preset( p_fsm, p_fsm->switch_diff );
+
+            if ( p_fsm->switch_diff & SENSOR_PRESET_DIFF_COLD_MASK ) {
+                p_fsm->cold_switch_num++;
+            } else if ( p_fsm->switch_diff ) {
+                p_fsm->warm_switch_num++;
+                // line timing may have changed, recalculate exposure limits
+                fsm_raise_event( p_fsm, event_id_exposure_changed );
+            }
+
+            p_fsm->switch_time_ms = ( system_timer_timestamp() - start ) * 1000 / system_timer_frequency();
+            LOG( LOG_INFO, "Sensor preset switch to %d took %u ms (%s)", p_fsm->preset_mode, (unsigned int)p_fsm->switch_time_ms,
+                 !p_fsm->switch_diff ? "none" : ( p_fsm->switch_diff & SENSOR_PRESET_DIFF_COLD_MASK ) ? "cold" : "warm" );
+        }
         ctx_ptr->irq_flag--;
         break;
 
@@ -39,6 +39,9 @@ void sensor_sw_init( sensor_fsm_ptr_t p_fsm );
 void sensor_deinit( sensor_fsm_ptr_t p_fsm );
 void sensor_update_black( sensor_fsm_ptr_t p_fsm );
 uint32_t sensor_get_lines_second( sensor_fsm_ptr_t p_fsm );
+uint32_t sensor_get_preset_diff( sensor_fsm_ptr_t p_fsm, uint32_t preset );
+void sensor_switch_preset( sensor_fsm_ptr_t p_fsm, uint32_t diff );
+void sensor_publish_info( sensor_fsm_ptr_t p_fsm );
 
 struct _sensor_fsm_t {
     fsm_common_t cmn;
@@ -54,6 +57,16 @@ struct _sensor_fsm_t {
     uint8_t is_streaming;
     uint8_t info_preset_num;
     uint32_t boot_status;
+
+    // mode which is currently programmed to the sensor and the ISP
+    sensor_mode_t applied_mode;
+    uint32_t switch_diff;
+    uint32_t switch_time_ms;
+    uint32_t warm_switch_num;
+    uint32_t cold_switch_num;
+
+    // sensor info handed out by FSM_PARAM_GET_SENSOR_SNAPSHOT
+    fsm_param_sensor_snapshot_t snapshot;
 };
 
 
@@ -113,6 +113,8 @@ void sensor_hw_init( sensor_fsm_ptr_t p_fsm )
 
     // 2): set to wdr_mode through general router (wdr_mode changed in sensor param in 1st step).
     const sensor_param_t *param = p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx );
+    p_fsm->applied_mode = param->modes_table[param->mode];
+    sensor_publish_info( p_fsm );
 
     fsm_param_set_wdr_param_t set_wdr_param;
     set_wdr_param.wdr_mode = param->modes_table[param->mode].wdr_mode;
@@ -199,11 +201,11 @@ static void sensor_update_bayer_bits(sensor_fsm_ptr_t p_fsm)
 }
 
 
-void sensor_sw_init( sensor_fsm_ptr_t p_fsm )
+static void sensor_update_input_size( sensor_fsm_ptr_t p_fsm )
 {
+#if FW_DO_INITIALIZATION
     const sensor_param_t *param = p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx );
 
-#if FW_DO_INITIALIZATION
     /* sensor resolution */
     acamera_isp_top_active_width_write( p_fsm->cmn.isp_base, param->active.width );
     acamera_isp_top_active_height_write( p_fsm->cmn.isp_base, param->active.height );
@@ -220,6 +222,14 @@ void sensor_sw_init( sensor_fsm_ptr_t p_fsm )
 
     sensor_init_output( p_fsm, p_fsm->isp_output_mode );
 #endif //FW_DO_INITIALIZATION
+}
+
+
+void sensor_sw_init( sensor_fsm_ptr_t p_fsm )
+{
+    const sensor_param_t *param = p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx );
+
+    sensor_update_input_size( p_fsm );
 
     acamera_isp_input_port_mode_request_write( p_fsm->cmn.isp_base, ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_START );
 
@@ -231,6 +241,8 @@ void sensor_sw_init( sensor_fsm_ptr_t p_fsm )
 
     acamera_update_cur_settings_to_isp(ISP_CONFIG_PING);
 
+    sensor_publish_info( p_fsm );
+
     LOG( LOG_NOTICE, "Sensor initialization is complete, ID 0x%04X resolution %dx%d", p_fsm->ctrl.get_id( p_fsm->sensor_ctx ), param->active.width, param->active.height );
 }
 
@@ -249,12 +261,16 @@ void sensor_update_black( sensor_fsm_ptr_t p_fsm )
     uint32_t idx_b = CALIBRATION_BLACK_LEVEL_B;
     uint32_t idx_gr = CALIBRATION_BLACK_LEVEL_GR;
     uint32_t idx_gb = CALIBRATION_BLACK_LEVEL_GB;
-    uint32_t r = acamera_calc_modulation_u16( again_log2, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_r ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_r ) );
-    uint32_t b = acamera_calc_modulation_u16( again_log2, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_b ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_b ) );
-    uint32_t gr = acamera_calc_modulation_u16( again_log2, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gr ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gr ) );
-    uint32_t gb = acamera_calc_modulation_u16( again_log2, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gb ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gb ) );
+    uint32_t r = acamera_calc_modulation_u16_hint( again_log2, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_r ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_r ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_r ) );
+    uint32_t b = acamera_calc_modulation_u16_hint( again_log2, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_b ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_b ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_b ) );
+    uint32_t gr = acamera_calc_modulation_u16_hint( again_log2, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gr ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gr ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gr ) );
+    uint32_t gb = acamera_calc_modulation_u16_hint( again_log2, _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gb ), _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gb ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), idx_gb ) );
 
     p_fsm->black_level = r;
+    if ( p_fsm->snapshot.info.black_level != r ) {
+        p_fsm->snapshot.info.black_level = r;
+        p_fsm->snapshot.generation++;
+    }
 
     if ( wdr_mode == WDR_MODE_FS_LIN ) {
         if ( ACAMERA_FSM2CTX_PTR( p_fsm )->stab.global_manual_frame_stitch == 0 ) {
@@ -285,6 +301,150 @@ void sensor_update_black( sensor_fsm_ptr_t p_fsm )
     }
 }
 
+uint32_t sensor_get_preset_diff( sensor_fsm_ptr_t p_fsm, uint32_t preset )
+{
+    const sensor_param_t *param = p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx );
+    const sensor_mode_t *cur = &p_fsm->applied_mode;
+    const sensor_mode_t *next;
+    uint32_t diff = 0;
+
+    // callers check the preset against modes_num, keep the table read in range anyway
+    if ( preset >= param->modes_num ) {
+        LOG( LOG_ERR, "Invalid sensor preset %u, %u presets supported.", (unsigned int)preset, (unsigned int)param->modes_num );
+        return 0;
+    }
+
+    next = &param->modes_table[preset];
+
+    if ( preset != p_fsm->preset_mode || cur->fps != next->fps ) {
+        diff |= SENSOR_PRESET_DIFF_MODE;
+    }
+
+    if ( cur->resolution.width != next->resolution.width || cur->resolution.height != next->resolution.height ) {
+        diff |= SENSOR_PRESET_DIFF_SIZE;
+    }
+
+    if ( cur->bits != next->bits ) {
+        diff |= SENSOR_PRESET_DIFF_BITS;
+    }
+
+    if ( cur->wdr_mode != next->wdr_mode || cur->exposures != next->exposures ) {
+        diff |= SENSOR_PRESET_DIFF_WDR;
+    }
+
+    // calibration set is selected by the wdr mode of the preset
+    if ( cur->wdr_mode != next->wdr_mode ) {
+        diff |= SENSOR_PRESET_DIFF_CALIBRATION;
+    }
+
+    return diff;
+}
+
+/*
+ * Re-apply only the parts of the configuration which differ between the
+ * previously applied preset and p_fsm->preset_mode. When only the sensor
+ * timing changes (fps switch) the ISP input port, the calibrations and the
+ * frame buffers are left untouched so the DMA writer keeps running.
+ *
+ * A cold switch stops the ISP input port here and is the only teardown of
+ * the switch; the port is started again only if the sensor is streaming.
+ */
+void sensor_switch_preset( sensor_fsm_ptr_t p_fsm, uint32_t diff )
+{
+    const sensor_param_t *param;
+
+    if ( diff == 0 ) {
+        LOG( LOG_INFO, "Sensor preset %d is already applied, nothing to switch", p_fsm->preset_mode );
+        return;
+    }
+
+    if ( diff & SENSOR_PRESET_DIFF_COLD_MASK ) {
+#if FW_DO_INITIALIZATION
+        acamera_isp_input_port_mode_request_write( p_fsm->cmn.isp_base, ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_STOP );
+#endif
+    }
+
+    p_fsm->ctrl.set_mode( p_fsm->sensor_ctx, p_fsm->preset_mode );
+    p_fsm->ctrl.disable_sensor_isp( p_fsm->sensor_ctx );
+
+    param = p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx );
+    p_fsm->applied_mode = param->modes_table[param->mode];
+    sensor_publish_info( p_fsm );
+
+    if ( diff & SENSOR_PRESET_DIFF_WDR ) {
+        fsm_param_set_wdr_param_t set_wdr_param;
+        set_wdr_param.wdr_mode = param->modes_table[param->mode].wdr_mode;
+        set_wdr_param.exp_number = param->modes_table[param->mode].exposures;
+        acamera_fsm_mgr_set_param( p_fsm->cmn.p_fsm_mgr, FSM_PARAM_SET_WDR_MODE, &set_wdr_param, sizeof( set_wdr_param ) );
+    }
+
+    if ( diff & SENSOR_PRESET_DIFF_CALIBRATION ) {
+        acamera_init_calibrations( ACAMERA_FSM2CTX_PTR( p_fsm ) );
+    }
+
+    if ( diff & SENSOR_PRESET_DIFF_SIZE ) {
+        sensor_configure_buffers( p_fsm );
+        sensor_update_input_size( p_fsm );
+    }
+
+    // bayer order may change with the mode even when the bit depth does not
+    sensor_update_bayer_bits( p_fsm );
+
+    if ( diff & SENSOR_PRESET_DIFF_COLD_MASK ) {
+        sensor_update_black( p_fsm );
+
+        if ( p_fsm->is_streaming ) {
+            acamera_isp_input_port_mode_request_write( p_fsm->cmn.isp_base, ACAMERA_ISP_INPUT_PORT_MODE_REQUEST_SAFE_START );
+
+            acamera_reset_ping_pong_port();
+            acamera_update_cur_settings_to_isp( ISP_CONFIG_PING );
+        }
+    } else if ( p_fsm->is_streaming ) {
+        // set_mode() reloads the sensor sequence, restart the sensor output
+        p_fsm->ctrl.start_streaming( p_fsm->sensor_ctx );
+    }
+
+    // output mode and black level may have changed above
+    sensor_publish_info( p_fsm );
+
+    LOG( LOG_NOTICE, "Sensor preset %d applied, diff 0x%x, resolution %dx%d", p_fsm->preset_mode, (unsigned int)diff, param->active.width, param->active.height );
+}
+
+/*
+ * Rebuild the sensor info snapshot from the current sensor mode. Called only
+ * when the sensor is (re)configured, consumers read the snapshot in place.
+ */
+void sensor_publish_info( sensor_fsm_ptr_t p_fsm )
+{
+    const sensor_param_t *param = p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx );
+    fsm_param_sensor_info_t *p_sensor_info = &p_fsm->snapshot.info;
+
+    p_sensor_info->total_width = param->total.width;
+    p_sensor_info->total_height = param->total.height;
+    p_sensor_info->active_width = param->active.width;
+    p_sensor_info->active_height = param->active.height;
+    p_sensor_info->pixels_per_line = param->pixels_per_line;
+    p_sensor_info->lines_per_second = param->lines_per_second;
+
+    p_sensor_info->again_log2_max = param->again_log2_max;
+    p_sensor_info->dgain_log2_max = param->dgain_log2_max;
+    p_sensor_info->integration_time_min = param->integration_time_min;
+    p_sensor_info->integration_time_max = param->integration_time_max;
+    p_sensor_info->integration_time_long_max = param->integration_time_long_max;
+    p_sensor_info->integration_time_limit = param->integration_time_limit;
+
+    p_sensor_info->integration_time_apply_delay = param->integration_time_apply_delay;
+    p_sensor_info->sensor_exp_number = param->sensor_exp_number;
+    p_sensor_info->isp_exposure_channel_delay = param->isp_exposure_channel_delay;
+
+    p_sensor_info->isp_output_mode = p_fsm->isp_output_mode;
+    p_sensor_info->resolution_mode = p_fsm->mode;
+    p_sensor_info->black_level = p_fsm->black_level;
+    p_sensor_info->sensor_bits = param->modes_table[param->mode].bits;
+
+    p_fsm->snapshot.generation++;
+}
+
 uint32_t sensor_get_lines_second( sensor_fsm_ptr_t p_fsm )
 {
     const sensor_param_t *param = p_fsm->ctrl.get_parameters( p_fsm->sensor_ctx );
@@ -69,12 +69,12 @@ void sharpening_update( sharpening_fsm_t *p_fsm )
     if ( ACAMERA_FSM2CTX_PTR( p_fsm )->stab.global_manual_demosaic == 0 ) {
 #if ISP_WDR_SWITCH
         //use luts for modulation instead!
-        alt_d = acamera_calc_modulation_u16( log2_gain, sharp_alt_d_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_d_idx ) );
+        alt_d = acamera_calc_modulation_u16_hint( log2_gain, sharp_alt_d_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_d_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_d_idx ) );
 #else
-        alt_d = acamera_calc_modulation_u16( log2_gain, sharp_alt_d_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARP_ALT_D ) );
+        alt_d = acamera_calc_modulation_u16_hint( log2_gain, sharp_alt_d_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARP_ALT_D ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARP_ALT_D ) );
 #endif
 
-        alt_du = acamera_calc_modulation_u16( log2_gain, sharp_alt_du_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_du_idx ) );
+        alt_du = acamera_calc_modulation_u16_hint( log2_gain, sharp_alt_du_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_du_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_du_idx ) );
         alt_d = ( alt_d * p_fsm->sharpening_mult ) / 128;
         if ( alt_d >= ( 1 << ACAMERA_ISP_DEMOSAIC_RGB_SHARP_ALT_D_DATASIZE ) ) {
             alt_d = ( 1 << ACAMERA_ISP_DEMOSAIC_RGB_SHARP_ALT_D_DATASIZE ) - 1;
@@ -82,9 +82,9 @@ void sharpening_update( sharpening_fsm_t *p_fsm )
 
 #if ISP_WDR_SWITCH
         //use luts for modulation instead!
-        alt_ud = acamera_calc_modulation_u16( log2_gain, sharp_alt_ud_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_ud_idx ) );
+        alt_ud = acamera_calc_modulation_u16_hint( log2_gain, sharp_alt_ud_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_ud_idx ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), sharp_alt_ud_idx ) );
 #else
-        alt_ud = acamera_calc_modulation_u16( log2_gain, sharp_alt_ud_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARP_ALT_UD ) );
+        alt_ud = acamera_calc_modulation_u16_hint( log2_gain, sharp_alt_ud_table_ptr, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARP_ALT_UD ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARP_ALT_UD ) );
 #endif
 
         alt_ud = ( alt_ud * p_fsm->sharpening_mult ) / 128;
@@ -103,11 +103,11 @@ void sharpening_update( sharpening_fsm_t *p_fsm )
 
     if ( ACAMERA_FSM2CTX_PTR( p_fsm )->stab.global_manual_sharpen == 0 ) {
         const modulation_entry_t *sharpen_fr_table = _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARPEN_FR );
-        acamera_isp_fr_sharpen_strength_write( p_fsm->cmn.isp_base, acamera_calc_modulation_u16( log2_gain, sharpen_fr_table, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARPEN_FR ) ) );
+        acamera_isp_fr_sharpen_strength_write( p_fsm->cmn.isp_base, acamera_calc_modulation_u16_hint( log2_gain, sharpen_fr_table, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARPEN_FR ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARPEN_FR ) ) );
 
 #if ISP_HAS_DS1
         const modulation_entry_t *sharpen_ds1_table = _GET_MOD_ENTRY16_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARPEN_DS1 );
-        acamera_isp_ds1_sharpen_strength_write( p_fsm->cmn.isp_base, acamera_calc_modulation_u16( log2_gain, sharpen_ds1_table, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARPEN_DS1 ) ) );
+        acamera_isp_ds1_sharpen_strength_write( p_fsm->cmn.isp_base, acamera_calc_modulation_u16_hint( log2_gain, sharpen_ds1_table, _GET_ROWS( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARPEN_DS1 ), _GET_MOD_HINT_PTR( ACAMERA_FSM2CTX_PTR( p_fsm ), CALIBRATION_SHARPEN_DS1 ) ) );
 #endif //ISP_HAS_DS1
     }
 }
@@ -20,41 +20,55 @@
 #include "system_interrupts.h"
 #include "acamera_firmware_config.h"
 #include <linux/kernel.h>
+#include <linux/module.h>
 #include <linux/interrupt.h>
+#include <linux/spinlock.h>
+#include <linux/ktime.h>
+#include <linux/sched.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/version.h>
+#if ( LINUX_VERSION_CODE >= KERNEL_VERSION( 4, 11, 0 ) )
+#include <linux/sched/types.h>
+#endif
 #include "acamera_logger.h"
 #include "acamera_isp_config.h"
 #include <linux/delay.h>
 
-//#define ENABLE_BOTTOM_HALF_TASKLET
-
-#ifdef ENABLE_BOTTOM_HALF_TASKLET
-#include <linux/list.h>
+/*
+ * The hard interrupt only latches and clears the ISP status vector and
+ * timestamps it. Everything else, the firmware handler included, runs in
+ * the threaded handler at irq_thread_prio.
+ */
+static int irq_thread_prio = 50;
+module_param( irq_thread_prio, int, 0644 );
+MODULE_PARM_DESC( irq_thread_prio, "SCHED_FIFO priority of the ISP interrupt thread" );
 
-#define ISP_TASKLET_Q_SIZE 16
+#define ISP_IRQ_Q_SIZE 16
+#define ISP_IRQ_HIST_BUCKETS 12 // power of two buckets in us, the last one collects the rest
 
-// tasklet queue command structure
-struct isp_tasklet_q_cmd {
-    struct list_head list;
-    uint32_t irq_status;
-    uint8_t cmd_used;
-};
+typedef struct _isp_irq_event_t {
+    uint32_t status;
+    u64 ts;
+} isp_irq_event_t;
 
-// tasklet structure
-struct isp_tasklet_t {
-    // tasklet
-    atomic_t tasklet_irq_cnt;
-    spinlock_t tasklet_lock;
-    struct tasklet_struct tasklet_obj;
-    // tasklet q
-    uint8_t tasklet_q_idx;
-    struct list_head tasklet_q;
-    struct isp_tasklet_q_cmd tasklet_q_cmd[ISP_TASKLET_Q_SIZE];
-};
+typedef struct _isp_irq_stat_t {
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t hist[ISP_IRQ_HIST_BUCKETS];
+} isp_irq_stat_t;
 
-// gloval variable for tasklet access
-static struct isp_tasklet_t isp_tasklet;
-static int temp_irq = 0;
-#endif
+static struct {
+    spinlock_t lock;
+    isp_irq_event_t q[ISP_IRQ_Q_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t merged; // events folded into the newest entry on overflow
+    isp_irq_stat_t stat[ACAMERA_IRQ_COUNT];
+    struct task_struct *thread;
+    int prio;
+    struct dentry *debugfs;
+} isp_irq;
 
 typedef enum {
     ISP_IRQ_STATUS_DEINIT = 0,
@@ -70,79 +84,173 @@ static int interrupt_line_ACAMERA_JUNO_IRQ_FLAGS = -1;
 static irq_status interrupt_request_status = ISP_IRQ_STATUS_DEINIT;
 static const char dev_id[] = "isp_dev";
 
-#ifdef ENABLE_BOTTOM_HALF_TASKLET
-void isp_do_tasklet( unsigned long data )
+static void isp_irq_account( uint32_t status, u64 ts )
 {
-    unsigned long flags;
-    uint32_t irq_status;
-    struct isp_tasklet_q_cmd *queue_cmd;
-
-    while ( atomic_read( &isp_tasklet.tasklet_irq_cnt ) ) {
-        spin_lock_irqsave( &isp_tasklet.tasklet_lock, flags );
-        queue_cmd = list_first_entry( &isp_tasklet.tasklet_q, struct isp_tasklet_q_cmd, list );
-        if ( !queue_cmd ) {
-            atomic_set( &isp_tasklet.tasklet_irq_cnt, 0 );
-            spin_unlock_irqrestore( &isp_tasklet.tasklet_lock, flags );
-            return;
+    uint32_t us = (uint32_t)div_u64( ktime_get_ns() - ts, 1000 );
+    uint32_t bucket = us ? min( fls( us ), ISP_IRQ_HIST_BUCKETS - 1 ) : 0;
+    int bit;
+
+    for ( bit = 0; bit < ACAMERA_IRQ_COUNT; bit++ ) {
+        if ( status & ( 1u << bit ) ) {
+            isp_irq_stat_t *st = &isp_irq.stat[bit];
+            st->count++;
+            st->hist[bucket]++;
+            if ( us > st->max_us )
+                st->max_us = us;
         }
-        atomic_sub( 1, &isp_tasklet.tasklet_irq_cnt );
-        list_del( &queue_cmd->list );
-        queue_cmd->cmd_used = 0;
-        irq_status = queue_cmd->irq_status;
+    }
+}
+
+static void isp_irq_set_prio( void )
+{
+    int prio = irq_thread_prio;
+    int rc;
 
-        spin_unlock_irqrestore( &isp_tasklet.tasklet_lock, flags );
+    if ( prio == isp_irq.prio )
+        return;
 
-        LOG( LOG_INFO, "debug value on tasklet: 0x%x\n", irq_status );
+    if ( prio < 1 || prio >= MAX_RT_PRIO ) {
+        LOG( LOG_ERR, "invalid irq thread priority %d", prio );
+        irq_thread_prio = isp_irq.prio ? isp_irq.prio : 50;
+        return;
+    }
+#if ( LINUX_VERSION_CODE >= KERNEL_VERSION( 5, 9, 0 ) )
+    {
+        // sched_set_fifo() only offers MAX_RT_PRIO / 2, the GPL export still takes a priority
+        struct sched_attr attr = {
+            .size = sizeof( attr ),
+            .sched_policy = SCHED_FIFO,
+            .sched_priority = prio,
+        };
+        rc = sched_setattr_nocheck( current, &attr );
+    }
+#else
+    {
+        struct sched_param param = {.sched_priority = prio};
+        rc = sched_setscheduler( current, SCHED_FIFO, &param );
     }
-}
 #endif
-irqreturn_t system_interrupt_handler( int irq, void *dev_id )
+    if ( rc )
+        LOG( LOG_ERR, "failed to set irq thread priority %d, rc %d", prio, rc );
+
+    // report what the scheduler applied, a later parameter change tries again
+    isp_irq.prio = current->rt_priority;
+    irq_thread_prio = isp_irq.prio;
+    LOG( LOG_INFO, "irq thread running at SCHED_FIFO %d, requested %d", isp_irq.prio, prio );
+}
+
+static irqreturn_t system_interrupt_thread( int irq, void *dev_id )
 {
-#ifdef ENABLE_BOTTOM_HALF_TASKLET
+    isp_irq_event_t ev;
     unsigned long flags;
-    uint32_t irq_status;
-    struct isp_tasklet_q_cmd *queue_cmd;
-    irq_status = temp_irq++;
-    LOG( LOG_INFO, "debug value: 0x%x\n", irq_status );
-
-    spin_lock_irqsave( &isp_tasklet.tasklet_lock, flags );
-    queue_cmd = &isp_tasklet.tasklet_q_cmd[isp_tasklet.tasklet_q_idx];
-    if ( queue_cmd->cmd_used ) {
-        LOG( LOG_ERR, "Error: isp tasklet queue overflow !\n" );
-        list_del( &queue_cmd->list );
-    } else {
-        atomic_add( 1, &isp_tasklet.tasklet_irq_cnt );
+
+    isp_irq.thread = current;
+    isp_irq_set_prio();
+
+    for ( ;; ) {
+        spin_lock_irqsave( &isp_irq.lock, flags );
+        if ( isp_irq.tail == isp_irq.head ) {
+            spin_unlock_irqrestore( &isp_irq.lock, flags );
+            break;
+        }
+        ev = isp_irq.q[isp_irq.tail % ISP_IRQ_Q_SIZE];
+        isp_irq.tail++;
+        spin_unlock_irqrestore( &isp_irq.lock, flags );
+
+        isp_irq_account( ev.status, ev.ts );
+
+        if ( app_handler )
+            app_handler( app_param, ev.status );
     }
-    queue_cmd->irq_status = irq_status;
-    queue_cmd->cmd_used = 1;
-    isp_tasklet.tasklet_q_idx =
-        ( isp_tasklet.tasklet_q_idx + 1 ) % ISP_TASKLET_Q_SIZE;
-    list_add_tail( &queue_cmd->list, &isp_tasklet.tasklet_q );
-    spin_unlock_irqrestore( &isp_tasklet.tasklet_lock, flags );
 
-    tasklet_schedule( &isp_tasklet.tasklet_obj );
+    return IRQ_HANDLED;
+}
 
-    if ( app_handler )
-        app_handler( app_param, 0 );
-#else
-    //LOG( LOG_INFO, "interrupt comes in (irq = %d)\n", irq );
-    if ( app_handler )
-        app_handler( app_param, 0 );
-#endif
-    if (!app_handler) {
-        u32 status_val = acamera_isp_isp_global_interrupt_status_vector_read(0);
-        u32 pulse_mode = acamera_isp_isp_global_interrupt_pulse_mode_read(0);
+irqreturn_t system_interrupt_handler( int irq, void *dev_id )
+{
+    uint32_t status = acamera_isp_isp_global_interrupt_status_vector_read( 0 );
+    u64 ts = ktime_get_ns();
+
+    if ( !status )
+        return IRQ_NONE; // the line is shared
 
-        printk("interrupt comes in (irq = %d) without app handler, status: 0x%x, pusle mode:%d\n", irq, status_val, pulse_mode);
+    if ( !app_handler ) {
+        u32 pulse_mode = acamera_isp_isp_global_interrupt_pulse_mode_read( 0 );
 
-        acamera_isp_isp_global_interrupt_clear_vector_write(0, 0xffffffff);
+        printk( "interrupt comes in (irq = %d) without app handler, status: 0x%x, pusle mode:%d\n", irq, status, pulse_mode );
+
+        acamera_isp_isp_global_interrupt_clear_vector_write( 0, 0xffffffff );
         acamera_isp_isp_global_interrupt_clear_write( 0, 0 );
         acamera_isp_isp_global_interrupt_clear_write( 0, 1 );
         acamera_isp_isp_global_interrupt_clear_write( 0, 0 );
+        return IRQ_HANDLED;
     }
-    return IRQ_HANDLED;
+
+    // clear irq vector
+    acamera_isp_isp_global_interrupt_clear_write( 0, 0 );
+    acamera_isp_isp_global_interrupt_clear_write( 0, 1 );
+
+    spin_lock( &isp_irq.lock );
+    if ( isp_irq.head - isp_irq.tail < ISP_IRQ_Q_SIZE ) {
+        isp_irq.q[isp_irq.head % ISP_IRQ_Q_SIZE].status = status;
+        isp_irq.q[isp_irq.head % ISP_IRQ_Q_SIZE].ts = ts;
+        isp_irq.head++;
+    } else {
+        // keep the bits, the thread handles them with the newest event
+        isp_irq.q[( isp_irq.head - 1 ) % ISP_IRQ_Q_SIZE].status |= status;
+        isp_irq.merged++;
+    }
+    spin_unlock( &isp_irq.lock );
+
+    return IRQ_WAKE_THREAD;
+}
+
+static int isp_irq_latency_show( struct seq_file *m, void *unused )
+{
+    int bit, i;
+
+    seq_printf( m, "thread prio %d, merged %u\n", isp_irq.prio, isp_irq.merged );
+    seq_printf( m, "bit      count   max_us " );
+    for ( i = 0; i < ISP_IRQ_HIST_BUCKETS - 1; i++ )
+        seq_printf( m, " <%-6u", 1u << i );
+    seq_printf( m, " rest\n" );
+
+    for ( bit = 0; bit < ACAMERA_IRQ_COUNT; bit++ ) {
+        isp_irq_stat_t *st = &isp_irq.stat[bit];
+
+        if ( !st->count )
+            continue;
+        seq_printf( m, "%3d %10u %8u ", bit, st->count, st->max_us );
+        for ( i = 0; i < ISP_IRQ_HIST_BUCKETS; i++ )
+            seq_printf( m, " %-7u", st->hist[i] );
+        seq_printf( m, "\n" );
+    }
+
+    return 0;
 }
 
+static int isp_irq_latency_open( struct inode *inode, struct file *file )
+{
+    return single_open( file, isp_irq_latency_show, inode->i_private );
+}
+
+static ssize_t isp_irq_latency_write( struct file *file, const char __user *buf, size_t count, loff_t *ppos )
+{
+    // any write resets the histogram
+    memset( isp_irq.stat, 0, sizeof( isp_irq.stat ) );
+    isp_irq.merged = 0;
+    return count;
+}
+
+static const struct file_operations isp_irq_latency_fops = {
+    .owner = THIS_MODULE,
+    .open = isp_irq_latency_open,
+    .read = seq_read,
+    .write = isp_irq_latency_write,
+    .llseek = seq_lseek,
+    .release = single_release,
+};
+
 void system_interrupts_set_irq( int irq_num, int flags )
 {
     interrupt_line_ACAMERA_JUNO_IRQ = irq_num;
@@ -165,23 +273,24 @@ void system_interrupts_init( void )
     }
     interrupt_request_status = ISP_IRQ_STATUS_ENABLED;
 
-#ifdef ENABLE_BOTTOM_HALF_TASKLET
-    // init tasklet and tasklet_q
-    atomic_set( &isp_tasklet.tasklet_irq_cnt, 0 );
-    spin_lock_init( &isp_tasklet.tasklet_lock );
-    isp_tasklet.tasklet_q_idx = 0;
-    INIT_LIST_HEAD( &isp_tasklet.tasklet_q );
-    tasklet_init( &isp_tasklet.tasklet_obj, isp_do_tasklet, (unsigned long)&isp_tasklet );
-#endif
+    spin_lock_init( &isp_irq.lock );
+    isp_irq.head = isp_irq.tail = 0;
+    isp_irq.thread = NULL;
+    isp_irq.prio = 0;
 
     // No dev_id for now, but will need this to be shared
-    if ( ( ret = request_irq( interrupt_line_ACAMERA_JUNO_IRQ,
-        &system_interrupt_handler, interrupt_line_ACAMERA_JUNO_IRQ_FLAGS, "isp", (void *)dev_id ) ) ) {
+    if ( ( ret = request_threaded_irq( interrupt_line_ACAMERA_JUNO_IRQ,
+        &system_interrupt_handler, &system_interrupt_thread, interrupt_line_ACAMERA_JUNO_IRQ_FLAGS, "isp", (void *)dev_id ) ) ) {
         LOG( LOG_ERR, "Could not get interrupt %d (ret=%d)\n", interrupt_line_ACAMERA_JUNO_IRQ, ret );
     } else {
         LOG( LOG_INFO, "Interrupt %d requested (flags = 0x%x, ret = %d)\n",
              interrupt_line_ACAMERA_JUNO_IRQ, interrupt_line_ACAMERA_JUNO_IRQ_FLAGS, ret );
     }
+
+    // latency statistics are optional, interrupts work without debugfs
+    isp_irq.debugfs = debugfs_create_dir( "isp_irq", NULL );
+    if ( !IS_ERR_OR_NULL( isp_irq.debugfs ) )
+        debugfs_create_file( "latency", 0644, isp_irq.debugfs, NULL, &isp_irq_latency_fops );
 }
 
 void system_interrupts_deinit( void )
@@ -200,11 +309,9 @@ void system_interrupts_deinit( void )
     app_handler = NULL;
     app_param = NULL;
 
-#ifdef ENABLE_BOTTOM_HALF_TASKLET
-    // kill tasklet
-    tasklet_kill( &isp_tasklet.tasklet_obj );
-    atomic_set( &isp_tasklet.tasklet_irq_cnt, 0 );
-#endif
+    debugfs_remove_recursive( isp_irq.debugfs );
+    isp_irq.debugfs = NULL;
+    isp_irq.thread = NULL;
 }
 
 void system_interrupt_set_handler( system_interrupt_handler_t handler, void *param )
@@ -224,7 +331,11 @@ void system_interrupts_enable( void )
 void system_interrupts_disable( void )
 {
     if ( interrupt_request_status == ISP_IRQ_STATUS_ENABLED ) {
-        disable_irq( interrupt_line_ACAMERA_JUNO_IRQ );
+        // disable_irq() waits for the irq thread, which must not wait for itself
+        if ( current == isp_irq.thread )
+            disable_irq_nosync( interrupt_line_ACAMERA_JUNO_IRQ );
+        else
+            disable_irq( interrupt_line_ACAMERA_JUNO_IRQ );
         interrupt_request_status = ISP_IRQ_STATUS_DISABLED;
     }
 }
@@ -58,3 +58,13 @@ void system_spinlock_destroy( sys_spinlock lock )
     if ( slock )
         kfree( slock );
 }
+
+void system_smp_wmb( void )
+{
+    smp_wmb();
+}
+
+void system_smp_rmb( void )
+{
+    smp_rmb();
+}
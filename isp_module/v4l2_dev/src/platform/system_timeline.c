@@ -0,0 +1,271 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "system_timeline.h"
+
+#if ISP_FRAME_TIMELINE
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/spinlock.h>
+#include <linux/ktime.h>
+#include <linux/slab.h>
+#include <linux/sort.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+
+/*
+ * Per frame timestamps from frame start to the vb2 buffer done, one ring per
+ * firmware context indexed by frame id. A zero timestamp means the frame
+ * never reached the stage, e.g. an output that was not streaming or a frame
+ * the dma writer decimated.
+ */
+
+typedef struct _sys_timeline_rec_t {
+    uint32_t frame_id;
+    u64 ts[SYS_TIMELINE_STAGE_MAX];
+} sys_timeline_rec_t;
+
+typedef sys_timeline_rec_t sys_timeline_ring_t[FIRMWARE_CONTEXT_NUMBER][SYS_TIMELINE_DEPTH];
+
+static struct {
+    spinlock_t lock;
+    sys_timeline_ring_t ring;
+    struct dentry *debugfs;
+} isp_timeline;
+
+static const char *const timeline_stage_name[SYS_TIMELINE_STAGE_MAX] = {
+    "fs", "cfg_dma", "fsm", "commit",
+    "wr_fr", "wr_ds1", "wr_ds2",
+    "cb_fr", "cb_ds1", "cb_ds2",
+    "cp_fr", "cp_ds1", "cp_ds2",
+    "done_fr", "done_ds1", "done_ds2"};
+
+static void system_timeline_stamp( uint32_t ctx_id, uint32_t frame_id, uint32_t stage, int restart )
+{
+    u64 ts = ktime_get_ns();
+    sys_timeline_rec_t *rec;
+    unsigned long flags;
+
+    if ( ctx_id >= FIRMWARE_CONTEXT_NUMBER || stage >= SYS_TIMELINE_STAGE_MAX )
+        return;
+
+    rec = &isp_timeline.ring[ctx_id][frame_id & ( SYS_TIMELINE_DEPTH - 1 )];
+
+    spin_lock_irqsave( &isp_timeline.lock, flags );
+    if ( rec->frame_id != frame_id || restart ) {
+        // a late stamp of a frame that was already overwritten
+        if ( (int32_t)( frame_id - rec->frame_id ) < 0 ) {
+            spin_unlock_irqrestore( &isp_timeline.lock, flags );
+            return;
+        }
+        memset( rec->ts, 0, sizeof( rec->ts ) );
+        rec->frame_id = frame_id;
+    }
+    if ( !rec->ts[stage] )
+        rec->ts[stage] = ts;
+    spin_unlock_irqrestore( &isp_timeline.lock, flags );
+}
+
+void system_timeline_frame_start( uint32_t ctx_id, uint32_t frame_id )
+{
+    system_timeline_stamp( ctx_id, frame_id, SYS_TIMELINE_FRAME_START, 1 );
+}
+
+void system_timeline_mark( uint32_t ctx_id, uint32_t frame_id, uint32_t stage )
+{
+    system_timeline_stamp( ctx_id, frame_id, stage, 0 );
+}
+
+// the readers work on a copy so the stamps never wait for seq_printf
+static sys_timeline_rec_t *system_timeline_snapshot( void )
+{
+    sys_timeline_rec_t *snap = kmalloc( sizeof( sys_timeline_ring_t ), GFP_KERNEL );
+    unsigned long flags;
+
+    if ( snap ) {
+        spin_lock_irqsave( &isp_timeline.lock, flags );
+        memcpy( snap, isp_timeline.ring, sizeof( sys_timeline_ring_t ) );
+        spin_unlock_irqrestore( &isp_timeline.lock, flags );
+    }
+
+    return snap;
+}
+
+static uint32_t timeline_delta_us( const sys_timeline_rec_t *rec, uint32_t stage )
+{
+    return (uint32_t)div_u64( rec->ts[stage] - rec->ts[SYS_TIMELINE_FRAME_START], 1000 );
+}
+
+static int isp_timeline_records_show( struct seq_file *m, void *unused )
+{
+    sys_timeline_rec_t *snap = system_timeline_snapshot();
+    uint32_t ctx, i, stage;
+
+    if ( !snap )
+        return -ENOMEM;
+
+    // one line per frame, oldest first: frame start in ns, the stages in us after it
+    seq_printf( m, "ctx  frame           fs_ns" );
+    for ( stage = SYS_TIMELINE_FRAME_START + 1; stage < SYS_TIMELINE_STAGE_MAX; stage++ )
+        seq_printf( m, " %8s", timeline_stage_name[stage] );
+    seq_printf( m, "\n" );
+
+    for ( ctx = 0; ctx < FIRMWARE_CONTEXT_NUMBER; ctx++ ) {
+        const sys_timeline_rec_t *ring = &snap[ctx * SYS_TIMELINE_DEPTH];
+        uint32_t newest = 0;
+
+        for ( i = 1; i < SYS_TIMELINE_DEPTH; i++ ) {
+            if ( (int32_t)( ring[i].frame_id - ring[newest].frame_id ) > 0 )
+                newest = i;
+        }
+
+        for ( i = 1; i <= SYS_TIMELINE_DEPTH; i++ ) {
+            const sys_timeline_rec_t *rec = &ring[( newest + i ) & ( SYS_TIMELINE_DEPTH - 1 )];
+
+            if ( !rec->ts[SYS_TIMELINE_FRAME_START] )
+                continue;
+            seq_printf( m, "%3u %6u %15llu", ctx, rec->frame_id, rec->ts[SYS_TIMELINE_FRAME_START] );
+            for ( stage = SYS_TIMELINE_FRAME_START + 1; stage < SYS_TIMELINE_STAGE_MAX; stage++ ) {
+                // not stamped, or stamped before the frame start: skipped as in the summary
+                if ( rec->ts[stage] >= rec->ts[SYS_TIMELINE_FRAME_START] )
+                    seq_printf( m, " %8u", timeline_delta_us( rec, stage ) );
+                else
+                    seq_printf( m, " %8s", "-" );
+            }
+            seq_printf( m, "\n" );
+        }
+    }
+
+    kfree( snap );
+
+    return 0;
+}
+
+static int timeline_cmp_u32( const void *a, const void *b )
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+// nearest rank percentile of a sorted array
+static uint32_t timeline_percentile( const uint32_t *v, uint32_t n, uint32_t p )
+{
+    uint32_t rank = ( n * p + 99 ) / 100;
+
+    return v[rank ? rank - 1 : 0];
+}
+
+static int isp_timeline_summary_show( struct seq_file *m, void *unused )
+{
+    sys_timeline_rec_t *snap = system_timeline_snapshot();
+    uint32_t delta[SYS_TIMELINE_DEPTH];
+    uint32_t ctx, i, stage;
+
+    if ( !snap )
+        return -ENOMEM;
+
+    // latency of each stage after the frame start over the frames in the ring
+    seq_printf( m, "ctx stage     count   p50_us   p90_us   p99_us   max_us\n" );
+    for ( ctx = 0; ctx < FIRMWARE_CONTEXT_NUMBER; ctx++ ) {
+        const sys_timeline_rec_t *ring = &snap[ctx * SYS_TIMELINE_DEPTH];
+
+        for ( stage = SYS_TIMELINE_FRAME_START + 1; stage < SYS_TIMELINE_STAGE_MAX; stage++ ) {
+            uint32_t n = 0;
+
+            for ( i = 0; i < SYS_TIMELINE_DEPTH; i++ ) {
+                if ( ring[i].ts[SYS_TIMELINE_FRAME_START] && ring[i].ts[stage] >= ring[i].ts[SYS_TIMELINE_FRAME_START] )
+                    delta[n++] = timeline_delta_us( &ring[i], stage );
+            }
+            if ( !n )
+                continue;
+
+            sort( delta, n, sizeof( delta[0] ), timeline_cmp_u32, NULL );
+            seq_printf( m, "%3u %-8s %6u %8u %8u %8u %8u\n", ctx, timeline_stage_name[stage], n,
+                        timeline_percentile( delta, n, 50 ), timeline_percentile( delta, n, 90 ),
+                        timeline_percentile( delta, n, 99 ), delta[n - 1] );
+        }
+    }
+
+    kfree( snap );
+
+    return 0;
+}
+
+static int isp_timeline_records_open( struct inode *inode, struct file *file )
+{
+    return single_open( file, isp_timeline_records_show, inode->i_private );
+}
+
+static int isp_timeline_summary_open( struct inode *inode, struct file *file )
+{
+    return single_open( file, isp_timeline_summary_show, inode->i_private );
+}
+
+static ssize_t isp_timeline_write( struct file *file, const char __user *buf, size_t count, loff_t *ppos )
+{
+    unsigned long flags;
+
+    // any write clears the rings
+    spin_lock_irqsave( &isp_timeline.lock, flags );
+    memset( isp_timeline.ring, 0, sizeof( isp_timeline.ring ) );
+    spin_unlock_irqrestore( &isp_timeline.lock, flags );
+    return count;
+}
+
+static const struct file_operations isp_timeline_records_fops = {
+    .owner = THIS_MODULE,
+    .open = isp_timeline_records_open,
+    .read = seq_read,
+    .write = isp_timeline_write,
+    .llseek = seq_lseek,
+    .release = single_release,
+};
+
+static const struct file_operations isp_timeline_summary_fops = {
+    .owner = THIS_MODULE,
+    .open = isp_timeline_summary_open,
+    .read = seq_read,
+    .write = isp_timeline_write,
+    .llseek = seq_lseek,
+    .release = single_release,
+};
+
+void system_timeline_init( void )
+{
+    spin_lock_init( &isp_timeline.lock );
+    memset( isp_timeline.ring, 0, sizeof( isp_timeline.ring ) );
+
+    // the stamps are taken regardless, debugfs only exposes them
+    isp_timeline.debugfs = debugfs_create_dir( "isp_timeline", NULL );
+    if ( !IS_ERR_OR_NULL( isp_timeline.debugfs ) ) {
+        debugfs_create_file( "records", 0644, isp_timeline.debugfs, NULL, &isp_timeline_records_fops );
+        debugfs_create_file( "summary", 0644, isp_timeline.debugfs, NULL, &isp_timeline_summary_fops );
+    }
+}
+
+void system_timeline_deinit( void )
+{
+    debugfs_remove_recursive( isp_timeline.debugfs );
+    isp_timeline.debugfs = NULL;
+}
+
+#endif // ISP_FRAME_TIMELINE
@@ -20,6 +20,7 @@
 #include "acamera_types.h"
 #include <linux/jiffies.h>
 #include <linux/delay.h>
+#include <linux/ktime.h>
 
 
 //================================================================================
@@ -31,6 +32,12 @@ uint32_t system_timer_timestamp( void )
 }
 
 
+uint64_t system_timer_timestamp_ns( void )
+{
+    return ktime_get_ns();
+}
+
+
 void system_timer_init( void )
 {
 }
@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+
+
+#ifndef __SBUF_REC_H__
+#define __SBUF_REC_H__
+/*
+ * Header-only reader and writer of sbuf recordings.
+ *
+ * A recording is what /dev/ac_sbufN_rec streams while it is open: a header
+ * that describes the shared buffer layout, the kf_info the user FW started
+ * from, then one record per stats set read by the user FW and one per
+ * parameter set it wrote back.
+ *
+ * Layout mirrors the recorder part of sbuf.h in the kernel module.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SBUF_DEV_FORMAT                 "/dev/ac_sbuf%d"
+#define SBUF_CTRL_DEV                   "/dev/ac_isp4uf"
+
+#define SBUF_REC_MAGIC                  0x43455253  /* 'SREC' */
+#define SBUF_REC_VERSION                1
+
+enum sbuf_type {
+    SBUF_TYPE_AE,
+    SBUF_TYPE_AWB,
+    SBUF_TYPE_AF,
+    SBUF_TYPE_GAMMA,
+    SBUF_TYPE_IRIDIX,
+    SBUF_TYPE_MAX,
+};
+
+enum sbuf_rec_type {
+    SBUF_REC_KF_INFO,
+    SBUF_REC_STATS,
+    SBUF_REC_PARAM,
+    SBUF_REC_DROP,
+    SBUF_REC_TYPE_MAX,
+};
+
+struct sbuf_idx_set {
+    uint8_t             ae_idx;
+    uint8_t             ae_idx_valid;
+
+    uint8_t             awb_idx;
+    uint8_t             awb_idx_valid;
+
+    uint8_t             af_idx;
+    uint8_t             af_idx_valid;
+
+    uint8_t             gamma_idx;
+    uint8_t             gamma_idx_valid;
+
+    uint8_t             iridix_idx;
+    uint8_t             iridix_idx_valid;
+};
+
+struct sbuf_rec_layout {
+    uint32_t            offset;
+    uint32_t            size;
+    uint32_t            param_offset;
+    uint32_t            param_size;
+};
+
+struct sbuf_rec_hdr {
+    uint32_t            magic;
+    uint32_t            version;
+    uint32_t            fw_id;
+    uint32_t            sbuf_size;
+    uint32_t            kf_info_size;
+    uint32_t            cmos_info_offset;
+    uint32_t            cmos_info_size;
+    uint32_t            fetched_offset;
+    uint32_t            array_size;
+    struct sbuf_rec_layout item[SBUF_TYPE_MAX];
+};
+
+struct sbuf_rec_entry {
+    uint32_t            type;
+    uint32_t            frame_id;
+    uint64_t            ts_ns;
+    uint32_t            size;
+    struct sbuf_idx_set idx_set;
+    uint8_t             reserved[2];
+};
+
+/* one record with its payload, the payload buffer is reused between reads */
+typedef struct _sbuf_rec_t {
+    struct sbuf_rec_entry entry;
+    uint8_t             *payload;
+    uint32_t            capacity;
+} sbuf_rec_t;
+
+static const char *const sbuf_type_name[SBUF_TYPE_MAX] = {"ae", "awb", "af", "gamma", "iridix"};
+
+/* returns 1 and the index if the idx_set holds a valid item of this type */
+static inline int sbuf_rec_get_idx(const struct sbuf_idx_set *set, uint32_t type, uint32_t *idx)
+{
+    const uint8_t *p = (const uint8_t *)set + type * 2;
+
+    if (type >= SBUF_TYPE_MAX)
+        return 0;
+
+    *idx = p[0];
+    return p[1];
+}
+
+/* read and check the stream header, returns 0 on success */
+static inline int sbuf_rec_read_hdr(FILE *fp, struct sbuf_rec_hdr *hdr)
+{
+    uint32_t t;
+
+    if (fread(hdr, sizeof(*hdr), 1, fp) != 1)
+        return -1;
+
+    if (hdr->magic != SBUF_REC_MAGIC || hdr->version != SBUF_REC_VERSION)
+        return -1;
+
+    if (hdr->kf_info_size > hdr->sbuf_size ||
+        hdr->cmos_info_offset + hdr->cmos_info_size > hdr->kf_info_size ||
+        hdr->fetched_offset + sizeof(uint32_t) > hdr->kf_info_size)
+        return -1;
+
+    for (t = 0; t < SBUF_TYPE_MAX; t++) {
+        const struct sbuf_rec_layout *l = &hdr->item[t];
+
+        if (l->size && (l->offset + hdr->array_size * l->size > hdr->sbuf_size ||
+                        l->param_offset + l->param_size > l->size))
+            return -1;
+    }
+
+    return 0;
+}
+
+/* read the next record, returns 1 on success, 0 at the end and -1 on a truncated stream */
+static inline int sbuf_rec_read(FILE *fp, sbuf_rec_t *rec)
+{
+    if (fread(&rec->entry, sizeof(rec->entry), 1, fp) != 1)
+        return 0;
+
+    if (rec->entry.size > rec->capacity) {
+        uint8_t *p = realloc(rec->payload, rec->entry.size);
+
+        if (!p)
+            return -1;
+        rec->payload = p;
+        rec->capacity = rec->entry.size;
+    }
+
+    if (rec->entry.size && fread(rec->payload, rec->entry.size, 1, fp) != 1)
+        return -1;
+
+    return 1;
+}
+
+static inline int sbuf_rec_write(FILE *fp, const struct sbuf_rec_entry *entry, const void *payload)
+{
+    if (fwrite(entry, sizeof(*entry), 1, fp) != 1)
+        return -1;
+
+    if (entry->size && fwrite(payload, entry->size, 1, fp) != 1)
+        return -1;
+
+    return 0;
+}
+
+static inline void sbuf_rec_free(sbuf_rec_t *rec)
+{
+    free(rec->payload);
+    memset(rec, 0, sizeof(*rec));
+}
+
+#endif // __SBUF_REC_H__
@@ -0,0 +1,366 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * sbuf_rec_tool info <rec>
+ *     header, record counts, frame range and the stats to parameter latency
+ *     of the user FW in a recording.
+ *
+ * sbuf_rec_tool cmp <rec_a> <rec_b>
+ *     compare the parameters written back for the same frames, e.g. a live
+ *     recording against its replay with another 3A build, and show where each
+ *     algorithm converged.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logs.h"
+#include "sbuf_rec.h"
+
+/* the parameters written back for one frame, split per sbuf type */
+typedef struct _rec_param_t {
+    uint32_t            frame_id;
+    uint32_t            seq;
+    uint32_t            valid_mask;
+    uint32_t            offset[SBUF_TYPE_MAX];
+} rec_param_t;
+
+typedef struct _rec_file_t {
+    const char          *name;
+    struct sbuf_rec_hdr hdr;
+    uint32_t            cnt[SBUF_REC_TYPE_MAX];
+    uint32_t            dropped;
+    uint32_t            first_frame;
+    uint32_t            last_frame;
+    uint64_t            first_ns;
+    uint64_t            last_ns;
+
+    // read to write latency of every parameter set
+    uint32_t            *lat_us;
+    uint32_t            lat_num;
+
+    rec_param_t         *params;
+    uint32_t            param_num;
+    uint8_t             *param_data;
+    uint32_t            param_data_size;
+} rec_file_t;
+
+static void *grow(void *p, uint32_t num, uint32_t *capacity, size_t elem)
+{
+    if (num < *capacity)
+        return p;
+
+    *capacity = *capacity ? *capacity * 2 : 1024;
+    p = realloc(p, *capacity * elem);
+    if (!p) {
+        ERR("out of memory\n");
+        exit(1);
+    }
+
+    return p;
+}
+
+static int rec_load(rec_file_t *f, const char *name)
+{
+    FILE *fp;
+    sbuf_rec_t rec = {0};
+    uint64_t last_stats_ns = 0;
+    uint32_t lat_cap = 0, param_cap = 0, data_cap = 0;
+    rec_param_t *p;
+    uint32_t t, idx, pos;
+    int rc;
+
+    memset(f, 0, sizeof(*f));
+    f->name = name;
+
+    fp = fopen(name, "rb");
+    if (!fp) {
+        ERR("can't open %s\n", name);
+        return -1;
+    }
+
+    if (sbuf_rec_read_hdr(fp, &f->hdr)) {
+        ERR("%s is not a sbuf recording of version %d\n", name, SBUF_REC_VERSION);
+        fclose(fp);
+        return -1;
+    }
+
+    while ((rc = sbuf_rec_read(fp, &rec)) == 1) {
+        const struct sbuf_rec_entry *e = &rec.entry;
+
+        if (e->type >= SBUF_REC_TYPE_MAX)
+            continue;
+        f->cnt[e->type]++;
+
+        if (e->type == SBUF_REC_DROP) {
+            f->dropped += e->frame_id;
+            continue;
+        }
+        if (e->type == SBUF_REC_KF_INFO)
+            continue;
+
+        if (!f->first_ns)
+            f->first_ns = e->ts_ns;
+        f->last_ns = e->ts_ns;
+
+        if (e->type == SBUF_REC_STATS) {
+            if (f->cnt[SBUF_REC_STATS] == 1)
+                f->first_frame = e->frame_id;
+            f->last_frame = e->frame_id;
+            last_stats_ns = e->ts_ns;
+            continue;
+        }
+
+        // SBUF_REC_PARAM
+        if (last_stats_ns && e->ts_ns >= last_stats_ns) {
+            f->lat_us = grow(f->lat_us, f->lat_num, &lat_cap, sizeof(*f->lat_us));
+            f->lat_us[f->lat_num++] = (uint32_t)((e->ts_ns - last_stats_ns) / 1000);
+        }
+
+        f->params = grow(f->params, f->param_num, &param_cap, sizeof(*f->params));
+        while (f->param_data_size + e->size > data_cap)
+            f->param_data = grow(f->param_data, data_cap, &data_cap, 1);
+
+        p = &f->params[f->param_num];
+        memset(p, 0, sizeof(*p));
+        p->frame_id = e->frame_id;
+        p->seq = f->param_num++;
+        pos = 0;
+        for (t = 0; t < SBUF_TYPE_MAX; t++) {
+            uint32_t size = f->hdr.item[t].param_size;
+
+            if (!sbuf_rec_get_idx(&e->idx_set, t, &idx) || !f->hdr.item[t].size)
+                continue;
+            if (pos + size > e->size)
+                break;
+
+            p->valid_mask |= 1 << t;
+            p->offset[t] = f->param_data_size + pos;
+            pos += size;
+        }
+        memcpy(f->param_data + f->param_data_size, rec.payload, e->size);
+        f->param_data_size += e->size;
+    }
+
+    if (rc < 0)
+        ERR("WARNING: %s is truncated, using the complete records\n", name);
+
+    sbuf_rec_free(&rec);
+    fclose(fp);
+
+    return 0;
+}
+
+static void rec_free(rec_file_t *f)
+{
+    free(f->lat_us);
+    free(f->params);
+    free(f->param_data);
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+// nearest rank percentile of a sorted array
+static uint32_t percentile(const uint32_t *v, uint32_t n, uint32_t p)
+{
+    uint32_t rank = (n * p + 99) / 100;
+
+    return v[rank ? rank - 1 : 0];
+}
+
+static int cmd_info(const char *name)
+{
+    rec_file_t f;
+    uint64_t sum = 0;
+    uint32_t i, t;
+
+    if (rec_load(&f, name))
+        return 1;
+
+    MSG("%s: fw_id %u, sbuf %u bytes, %u items per type\n", name, f.hdr.fw_id, f.hdr.sbuf_size, f.hdr.array_size);
+    for (t = 0; t < SBUF_TYPE_MAX; t++) {
+        if (f.hdr.item[t].size)
+            MSG("  %-6s item %6u bytes at %8u, parameters %3u bytes\n", sbuf_type_name[t],
+                f.hdr.item[t].size, f.hdr.item[t].offset, f.hdr.item[t].param_size);
+    }
+
+    MSG("stats sets: %u, parameter sets: %u, dropped records: %u\n",
+        f.cnt[SBUF_REC_STATS], f.cnt[SBUF_REC_PARAM], f.dropped);
+    if (f.cnt[SBUF_REC_STATS])
+        MSG("frames: %u - %u, duration: %llu ms\n", f.first_frame, f.last_frame,
+            (unsigned long long)((f.last_ns - f.first_ns) / 1000000));
+
+    if (f.lat_num) {
+        for (i = 0; i < f.lat_num; i++)
+            sum += f.lat_us[i];
+        qsort(f.lat_us, f.lat_num, sizeof(*f.lat_us), cmp_u32);
+        MSG("read to write latency us: avg %llu, p50 %u, p99 %u, max %u\n",
+            (unsigned long long)(sum / f.lat_num), percentile(f.lat_us, f.lat_num, 50),
+            percentile(f.lat_us, f.lat_num, 99), f.lat_us[f.lat_num - 1]);
+    }
+
+    rec_free(&f);
+
+    return 0;
+}
+
+static int cmp_param_frame(const void *a, const void *b)
+{
+    const rec_param_t *x = a;
+    const rec_param_t *y = b;
+
+    if (x->frame_id != y->frame_id)
+        return x->frame_id < y->frame_id ? -1 : 1;
+
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+/* last frame at which the parameters of a type changed and how often they did */
+static void show_convergence(const rec_file_t *f)
+{
+    uint32_t i, t;
+
+    for (t = 0; t < SBUF_TYPE_MAX; t++) {
+        uint32_t size = f->hdr.item[t].param_size;
+        const uint8_t *prev = NULL;
+        uint32_t changes = 0, last = 0;
+
+        if (!f->hdr.item[t].size)
+            continue;
+
+        for (i = 0; i < f->param_num; i++) {
+            const uint8_t *cur = f->param_data + f->params[i].offset[t];
+
+            if (!(f->params[i].valid_mask & (1 << t)))
+                continue;
+            if (prev && memcmp(prev, cur, size)) {
+                changes++;
+                last = f->params[i].frame_id;
+            }
+            prev = cur;
+        }
+
+        if (prev)
+            MSG("  %-6s %-24s changes: %6u, last change at frame %u\n", sbuf_type_name[t], f->name, changes, last);
+    }
+}
+
+static int cmd_cmp(const char *name_a, const char *name_b)
+{
+    rec_file_t a, b;
+    uint32_t i = 0, j = 0, t;
+    uint32_t compared = 0, identical = 0, first_diff = 0, diff = 0;
+    uint32_t type_diff[SBUF_TYPE_MAX] = {0};
+    int rc = 0;
+
+    if (rec_load(&a, name_a))
+        return 1;
+    if (rec_load(&b, name_b)) {
+        rec_free(&a);
+        return 1;
+    }
+
+    for (t = 0; t < SBUF_TYPE_MAX; t++) {
+        if (a.hdr.item[t].size != b.hdr.item[t].size || a.hdr.item[t].param_size != b.hdr.item[t].param_size) {
+            ERR("%s and %s come from different sbuf layouts\n", name_a, name_b);
+            rc = 1;
+            goto out;
+        }
+    }
+
+    // in recording order within a frame, so the last parameter set of a frame wins below
+    qsort(a.params, a.param_num, sizeof(*a.params), cmp_param_frame);
+    qsort(b.params, b.param_num, sizeof(*b.params), cmp_param_frame);
+
+    while (i < a.param_num && j < b.param_num) {
+        const rec_param_t *pa, *pb;
+        uint32_t frame_diff = 0;
+
+        if (a.params[i].frame_id < b.params[j].frame_id) {
+            i++;
+            continue;
+        }
+        if (a.params[i].frame_id > b.params[j].frame_id) {
+            j++;
+            continue;
+        }
+
+        while (i + 1 < a.param_num && a.params[i + 1].frame_id == a.params[i].frame_id)
+            i++;
+        while (j + 1 < b.param_num && b.params[j + 1].frame_id == b.params[j].frame_id)
+            j++;
+        pa = &a.params[i++];
+        pb = &b.params[j++];
+
+        for (t = 0; t < SBUF_TYPE_MAX; t++) {
+            if (!(pa->valid_mask & pb->valid_mask & (1 << t)))
+                continue;
+            if (memcmp(a.param_data + pa->offset[t], b.param_data + pb->offset[t], a.hdr.item[t].param_size)) {
+                type_diff[t]++;
+                frame_diff = 1;
+            }
+        }
+
+        compared++;
+        if (!frame_diff) {
+            identical++;
+        } else if (!diff++) {
+            first_diff = pa->frame_id;
+        }
+    }
+
+    MSG("frames compared: %u, identical: %u, different: %u\n", compared, identical, diff);
+    if (diff) {
+        MSG("first different frame: %u\n", first_diff);
+        for (t = 0; t < SBUF_TYPE_MAX; t++) {
+            if (type_diff[t])
+                MSG("  %-6s different in %u frames\n", sbuf_type_name[t], type_diff[t]);
+        }
+    }
+
+    MSG("convergence:\n");
+    show_convergence(&a);
+    show_convergence(&b);
+
+    rc = diff ? 2 : 0;
+
+out:
+    rec_free(&a);
+    rec_free(&b);
+
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && !strcmp(argv[1], "info"))
+        return cmd_info(argv[2]);
+
+    if (argc == 4 && !strcmp(argv[1], "cmp"))
+        return cmd_cmp(argv[2], argv[3]);
+
+    ERR("usage: %s info <rec>\n", argv[0]);
+    ERR("       %s cmp <rec_a> <rec_b>\n", argv[0]);
+
+    return 1;
+}
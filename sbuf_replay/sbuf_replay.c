@@ -0,0 +1,514 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * Userspace stand-in of the sbuf device for the user FW.
+ *
+ * Preloaded into the 3A process it answers the sbuf read() with the stats of
+ * a recording instead of the live ISP, so two 3A builds can be fed exactly
+ * the same input and their parameter write-backs compared afterwards with
+ * sbuf_rec_tool.
+ *
+ *   SBUF_REPLAY_FILE   recording made from /dev/ac_sbufN_rec (required)
+ *   SBUF_REPLAY_OUT    write the replayed stats and the parameters of this
+ *                      run to a new recording (optional)
+ *   SBUF_REPLAY_SPEED  "orig" keeps the recorded pacing (default),
+ *                      "max" hands out the next stats set immediately
+ *
+ * The control channel is backed by /dev/null, the user FW sees no commands.
+ * At the end of the recording a summary is printed and the process exits.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+
+#include "sbuf_rec.h"
+
+#define REPLAY_ERR(...) fprintf(stderr, "sbuf_replay: " __VA_ARGS__)
+
+static struct {
+    pthread_mutex_t     lock;
+    int                 inited;
+    int                 failed;
+
+    FILE                *in;
+    FILE                *out;
+    int                 max_speed;
+    struct sbuf_rec_hdr hdr;
+    uint8_t             *kf_info;
+    sbuf_rec_t          rec;
+
+    int                 sbuf_fd;
+    int                 ctrl_fd;
+    uint8_t             *sbuf;
+    size_t              sbuf_len;
+
+    uint64_t            rec_start_ns;
+    uint64_t            wall_start_ns;
+    uint64_t            last_read_ns;
+    uint32_t            last_frame_id;
+
+    uint32_t            stats_cnt;
+    uint32_t            param_cnt;
+    uint32_t            drop_cnt;
+    uint64_t            lat_sum_ns;
+    uint64_t            lat_max_ns;
+} replay = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .sbuf_fd = -1,
+    .ctrl_fd = -1,
+};
+
+static int (*real_open)(const char *, int, ...);
+static int (*real_open64)(const char *, int, ...);
+static ssize_t (*real_read)(int, void *, size_t);
+static ssize_t (*real_write)(int, const void *, size_t);
+static int (*real_close)(int);
+static void *(*real_mmap)(void *, size_t, int, int, int, off_t);
+static int (*real_munmap)(void *, size_t);
+
+static uint64_t replay_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void replay_sleep_until(uint64_t deadline_ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = deadline_ns / 1000000000ULL;
+    ts.tv_nsec = deadline_ns % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+static void replay_resolve(void)
+{
+    real_open = dlsym(RTLD_NEXT, "open");
+    real_open64 = dlsym(RTLD_NEXT, "open64");
+    real_read = dlsym(RTLD_NEXT, "read");
+    real_write = dlsym(RTLD_NEXT, "write");
+    real_close = dlsym(RTLD_NEXT, "close");
+    real_mmap = dlsym(RTLD_NEXT, "mmap");
+    real_munmap = dlsym(RTLD_NEXT, "munmap");
+}
+
+/* open the recording and pick up the kf_info the user FW starts from, called under lock */
+static int replay_init(void)
+{
+    const char *in_name = getenv("SBUF_REPLAY_FILE");
+    const char *out_name = getenv("SBUF_REPLAY_OUT");
+    const char *speed = getenv("SBUF_REPLAY_SPEED");
+    int rc;
+
+    if (replay.inited)
+        return replay.failed ? -1 : 0;
+
+    replay.inited = 1;
+    replay.failed = 1;
+
+    if (!in_name) {
+        REPLAY_ERR("SBUF_REPLAY_FILE is not set\n");
+        return -1;
+    }
+
+    replay.in = fopen(in_name, "rb");
+    if (!replay.in) {
+        REPLAY_ERR("can't open %s: %s\n", in_name, strerror(errno));
+        return -1;
+    }
+
+    if (sbuf_rec_read_hdr(replay.in, &replay.hdr)) {
+        REPLAY_ERR("%s is not a sbuf recording of version %d\n", in_name, SBUF_REC_VERSION);
+        return -1;
+    }
+
+    // the recorder always starts with the kf_info
+    rc = sbuf_rec_read(replay.in, &replay.rec);
+    if (rc != 1 || replay.rec.entry.type != SBUF_REC_KF_INFO || replay.rec.entry.size != replay.hdr.kf_info_size) {
+        REPLAY_ERR("%s does not start with the kf_info\n", in_name);
+        return -1;
+    }
+
+    replay.kf_info = malloc(replay.hdr.kf_info_size);
+    if (!replay.kf_info)
+        return -1;
+    memcpy(replay.kf_info, replay.rec.payload, replay.hdr.kf_info_size);
+
+    if (out_name) {
+        struct sbuf_rec_hdr hdr = replay.hdr;
+
+        replay.out = fopen(out_name, "wb");
+        if (!replay.out || fwrite(&hdr, sizeof(hdr), 1, replay.out) != 1 ||
+            sbuf_rec_write(replay.out, &replay.rec.entry, replay.kf_info)) {
+            REPLAY_ERR("can't write %s: %s\n", out_name, strerror(errno));
+            return -1;
+        }
+    }
+
+    replay.max_speed = speed && !strcmp(speed, "max");
+    replay.failed = 0;
+
+    REPLAY_ERR("replaying %s to fw_id %u at %s speed\n", in_name, replay.hdr.fw_id, replay.max_speed ? "max" : "orig");
+
+    return 0;
+}
+
+static void replay_finish(void)
+{
+    uint64_t wall_ns = replay.stats_cnt ? replay_now_ns() - replay.wall_start_ns : 0;
+
+    if (replay.out)
+        fclose(replay.out);
+    replay.out = NULL;
+
+    REPLAY_ERR("end of recording: stats sets: %u, parameter sets: %u, recorded drops: %u\n",
+               replay.stats_cnt, replay.param_cnt, replay.drop_cnt);
+    REPLAY_ERR("wall time: %llu ms, read to write latency avg: %llu us, max: %llu us\n",
+               (unsigned long long)(wall_ns / 1000000),
+               (unsigned long long)(replay.param_cnt ? replay.lat_sum_ns / replay.param_cnt / 1000 : 0),
+               (unsigned long long)(replay.lat_max_ns / 1000));
+}
+
+/* copy a recorded stats set into the shared buffer, called under lock */
+static int replay_apply_stats(const sbuf_rec_t *rec)
+{
+    const struct sbuf_rec_hdr *hdr = &replay.hdr;
+    const uint8_t *p = rec->payload;
+    const uint8_t *end = rec->payload + rec->entry.size;
+    uint32_t t, idx;
+
+    if (p + hdr->cmos_info_size > end)
+        return -1;
+    memcpy(replay.sbuf + hdr->cmos_info_offset, p, hdr->cmos_info_size);
+    p += hdr->cmos_info_size;
+
+    for (t = 0; t < SBUF_TYPE_MAX; t++) {
+        const struct sbuf_rec_layout *l = &hdr->item[t];
+
+        if (!sbuf_rec_get_idx(&rec->entry.idx_set, t, &idx) || !l->size)
+            continue;
+        if (idx >= hdr->array_size || p + l->size > end)
+            return -1;
+
+        memcpy(replay.sbuf + l->offset + idx * l->size, p, l->size);
+        p += l->size;
+    }
+
+    return 0;
+}
+
+/* record the parameters the user FW wrote back for a set, called under lock */
+static void replay_put_param(const struct sbuf_idx_set *set, uint64_t now_ns)
+{
+    const struct sbuf_rec_hdr *hdr = &replay.hdr;
+    uint8_t payload[4096];
+    struct sbuf_rec_entry entry;
+    uint32_t t, idx;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.type = SBUF_REC_PARAM;
+    entry.frame_id = replay.last_frame_id;
+    entry.ts_ns = now_ns;
+    entry.idx_set = *set;
+
+    for (t = 0; t < SBUF_TYPE_MAX; t++) {
+        const struct sbuf_rec_layout *l = &hdr->item[t];
+
+        if (!sbuf_rec_get_idx(set, t, &idx) || !l->size)
+            continue;
+        if (idx >= hdr->array_size || entry.size + l->param_size > sizeof(payload)) {
+            REPLAY_ERR("parameter set with bad index %u of %s dropped\n", idx, sbuf_type_name[t]);
+            return;
+        }
+
+        memcpy(payload + entry.size, replay.sbuf + l->offset + idx * l->size + l->param_offset, l->param_size);
+        entry.size += l->param_size;
+    }
+
+    sbuf_rec_write(replay.out, &entry, payload);
+}
+
+static ssize_t replay_read(void *buf, size_t count)
+{
+    uint64_t deadline_ns = 0;
+    uint64_t now_ns;
+    int rc;
+
+    if (count != sizeof(struct sbuf_idx_set)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_mutex_lock(&replay.lock);
+
+    // like the driver: no stats until the user FW took the calibration
+    if (!replay.sbuf || !*(volatile uint32_t *)(replay.sbuf + replay.hdr.fetched_offset)) {
+        pthread_mutex_unlock(&replay.lock);
+        errno = ENODATA;
+        return -1;
+    }
+
+    for (;;) {
+        rc = sbuf_rec_read(replay.in, &replay.rec);
+        if (rc <= 0) {
+            if (rc < 0)
+                REPLAY_ERR("recording is truncated\n");
+            replay_finish();
+            pthread_mutex_unlock(&replay.lock);
+            exit(0);
+        }
+
+        // the parameters of the recording are what the run under test replaces
+        if (replay.rec.entry.type == SBUF_REC_STATS)
+            break;
+        if (replay.rec.entry.type == SBUF_REC_DROP)
+            replay.drop_cnt += replay.rec.entry.frame_id;
+    }
+
+    if (!replay.stats_cnt) {
+        replay.rec_start_ns = replay.rec.entry.ts_ns;
+        replay.wall_start_ns = replay_now_ns();
+    } else if (!replay.max_speed) {
+        deadline_ns = replay.wall_start_ns + (replay.rec.entry.ts_ns - replay.rec_start_ns);
+    }
+
+    pthread_mutex_unlock(&replay.lock);
+
+    if (deadline_ns)
+        replay_sleep_until(deadline_ns);
+
+    pthread_mutex_lock(&replay.lock);
+
+    if (!replay.sbuf || replay_apply_stats(&replay.rec)) {
+        pthread_mutex_unlock(&replay.lock);
+        REPLAY_ERR("stats set of frame %u does not fit the shared buffer\n", replay.rec.entry.frame_id);
+        errno = ENODATA;
+        return -1;
+    }
+
+    now_ns = replay_now_ns();
+    replay.stats_cnt++;
+    replay.last_read_ns = now_ns;
+    replay.last_frame_id = replay.rec.entry.frame_id;
+    memcpy(buf, &replay.rec.entry.idx_set, sizeof(struct sbuf_idx_set));
+
+    if (replay.out) {
+        replay.rec.entry.ts_ns = now_ns;
+        sbuf_rec_write(replay.out, &replay.rec.entry, replay.rec.payload);
+    }
+
+    pthread_mutex_unlock(&replay.lock);
+
+    return count;
+}
+
+static ssize_t replay_write(const void *buf, size_t count)
+{
+    struct sbuf_idx_set set;
+    uint64_t now_ns = replay_now_ns();
+    uint64_t lat_ns;
+
+    if (count != sizeof(set)) {
+        errno = EINVAL;
+        return -1;
+    }
+    memcpy(&set, buf, sizeof(set));
+
+    pthread_mutex_lock(&replay.lock);
+
+    if (replay.stats_cnt) {
+        lat_ns = now_ns - replay.last_read_ns;
+        replay.lat_sum_ns += lat_ns;
+        if (lat_ns > replay.lat_max_ns)
+            replay.lat_max_ns = lat_ns;
+    }
+    replay.param_cnt++;
+
+    if (replay.out && replay.sbuf)
+        replay_put_param(&set, now_ns);
+
+    pthread_mutex_unlock(&replay.lock);
+
+    return count;
+}
+
+static int replay_open(int (*next)(const char *, int, ...), const char *path, int flags, mode_t mode)
+{
+    char sbuf_path[32];
+    int fd;
+
+    if (path && !strncmp(path, "/dev/ac_", 8)) {
+        pthread_mutex_lock(&replay.lock);
+        if (replay_init()) {
+            pthread_mutex_unlock(&replay.lock);
+            errno = ENODEV;
+            return -1;
+        }
+
+        snprintf(sbuf_path, sizeof(sbuf_path), SBUF_DEV_FORMAT, replay.hdr.fw_id);
+        if (!strcmp(path, sbuf_path) || !strcmp(path, SBUF_CTRL_DEV)) {
+            fd = real_open("/dev/null", O_RDWR);
+            if (fd >= 0 && !strcmp(path, sbuf_path))
+                replay.sbuf_fd = fd;
+            else if (fd >= 0)
+                replay.ctrl_fd = fd;
+        } else {
+            // the other contexts have nothing recorded
+            fd = -1;
+            errno = ENODEV;
+        }
+        pthread_mutex_unlock(&replay.lock);
+
+        return fd;
+    }
+
+    return next(path, flags, mode);
+}
+
+int open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    va_list ap;
+
+    if (!real_open)
+        replay_resolve();
+
+    if (flags & (O_CREAT | O_TMPFILE)) {
+        va_start(ap, flags);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+
+    return replay_open(real_open, path, flags, mode);
+}
+
+int open64(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    va_list ap;
+
+    if (!real_open)
+        replay_resolve();
+
+    if (flags & (O_CREAT | O_TMPFILE)) {
+        va_start(ap, flags);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+
+    return replay_open(real_open64 ? real_open64 : real_open, path, flags, mode);
+}
+
+ssize_t read(int fd, void *buf, size_t count)
+{
+    if (!real_read)
+        replay_resolve();
+
+    if (fd >= 0 && fd == replay.sbuf_fd)
+        return replay_read(buf, count);
+
+    return real_read(fd, buf, count);
+}
+
+ssize_t write(int fd, const void *buf, size_t count)
+{
+    if (!real_write)
+        replay_resolve();
+
+    if (fd >= 0 && fd == replay.sbuf_fd)
+        return replay_write(buf, count);
+
+    return real_write(fd, buf, count);
+}
+
+void *mmap(void *addr, size_t len, int prot, int flags, int fd, off_t offset)
+{
+    void *p;
+
+    if (!real_mmap)
+        replay_resolve();
+
+    if (fd < 0 || fd != replay.sbuf_fd)
+        return real_mmap(addr, len, prot, flags, fd, offset);
+
+    // the driver also refuses a mapping that does not cover struct fw_sbuf
+    if (len < replay.hdr.sbuf_size) {
+        REPLAY_ERR("mmap of %zu bytes, the recorded sbuf has %u\n", len, replay.hdr.sbuf_size);
+        errno = EINVAL;
+        return MAP_FAILED;
+    }
+
+    p = real_mmap(addr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return p;
+
+    pthread_mutex_lock(&replay.lock);
+    memcpy(p, replay.kf_info, replay.hdr.kf_info_size);
+    // the user FW fetches the recorded calibration first
+    memset((uint8_t *)p + replay.hdr.fetched_offset, 0, sizeof(uint32_t));
+    replay.sbuf = p;
+    replay.sbuf_len = len;
+    pthread_mutex_unlock(&replay.lock);
+
+    return p;
+}
+
+int munmap(void *addr, size_t len)
+{
+    if (!real_munmap)
+        replay_resolve();
+
+    pthread_mutex_lock(&replay.lock);
+    if (addr && addr == replay.sbuf) {
+        replay.sbuf = NULL;
+        replay.sbuf_len = 0;
+    }
+    pthread_mutex_unlock(&replay.lock);
+
+    return real_munmap(addr, len);
+}
+
+int close(int fd)
+{
+    if (!real_close)
+        replay_resolve();
+
+    if (fd >= 0) {
+        pthread_mutex_lock(&replay.lock);
+        if (fd == replay.sbuf_fd)
+            replay.sbuf_fd = -1;
+        else if (fd == replay.ctrl_fd)
+            replay.ctrl_fd = -1;
+        pthread_mutex_unlock(&replay.lock);
+    }
+
+    return real_close(fd);
+}
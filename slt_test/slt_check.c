@@ -0,0 +1,449 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <math.h>
+
+#include "slt_check.h"
+#include "logs.h"
+
+/**********
+ * xxHash64, streaming form so multi-plane frames hash without a copy
+ */
+#define XXH_PRIME64_1   0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2   0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3   0x165667B19E3779F9ULL
+#define XXH_PRIME64_4   0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5   0x27D4EB2F165667C5ULL
+
+#define XXH_ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline uint64_t xxh_read64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t xxh_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = XXH_ROTL64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxh_merge_round(uint64_t acc, uint64_t val)
+{
+    acc ^= xxh_round(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+void slt_hash_init(slt_hash_t *h)
+{
+    memset(h, 0, sizeof(*h));
+    h->v[0] = XXH_PRIME64_1 + XXH_PRIME64_2;
+    h->v[1] = XXH_PRIME64_2;
+    h->v[2] = 0;
+    h->v[3] = -XXH_PRIME64_1;
+}
+
+void slt_hash_update(slt_hash_t *h, const uint8_t *data, uint32_t len)
+{
+    const uint8_t *end = data + len;
+
+    h->total_len += len;
+
+    if (h->mem_size + len < 32) {
+        memcpy(h->mem + h->mem_size, data, len);
+        h->mem_size += len;
+        return;
+    }
+
+    if (h->mem_size) {
+        memcpy(h->mem + h->mem_size, data, 32 - h->mem_size);
+        data += 32 - h->mem_size;
+        h->v[0] = xxh_round(h->v[0], xxh_read64(h->mem));
+        h->v[1] = xxh_round(h->v[1], xxh_read64(h->mem + 8));
+        h->v[2] = xxh_round(h->v[2], xxh_read64(h->mem + 16));
+        h->v[3] = xxh_round(h->v[3], xxh_read64(h->mem + 24));
+        h->mem_size = 0;
+    }
+
+    if (data + 32 <= end) {
+        uint64_t v1 = h->v[0], v2 = h->v[1], v3 = h->v[2], v4 = h->v[3];
+        do {
+            v1 = xxh_round(v1, xxh_read64(data));
+            v2 = xxh_round(v2, xxh_read64(data + 8));
+            v3 = xxh_round(v3, xxh_read64(data + 16));
+            v4 = xxh_round(v4, xxh_read64(data + 24));
+            data += 32;
+        } while (data + 32 <= end);
+        h->v[0] = v1;
+        h->v[1] = v2;
+        h->v[2] = v3;
+        h->v[3] = v4;
+    }
+
+    if (data < end) {
+        memcpy(h->mem, data, end - data);
+        h->mem_size = end - data;
+    }
+}
+
+uint64_t slt_hash_digest(const slt_hash_t *h)
+{
+    const uint8_t *p = h->mem;
+    const uint8_t *end = h->mem + h->mem_size;
+    uint64_t h64;
+
+    if (h->total_len >= 32) {
+        h64 = XXH_ROTL64(h->v[0], 1) + XXH_ROTL64(h->v[1], 7) +
+              XXH_ROTL64(h->v[2], 12) + XXH_ROTL64(h->v[3], 18);
+        h64 = xxh_merge_round(h64, h->v[0]);
+        h64 = xxh_merge_round(h64, h->v[1]);
+        h64 = xxh_merge_round(h64, h->v[2]);
+        h64 = xxh_merge_round(h64, h->v[3]);
+    } else {
+        h64 = XXH_PRIME64_5;
+    }
+    h64 += h->total_len;
+
+    while (p + 8 <= end) {
+        h64 ^= xxh_round(0, xxh_read64(p));
+        h64 = XXH_ROTL64(h64, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h64 ^= (uint64_t)xxh_read32(p) * XXH_PRIME64_1;
+        h64 = XXH_ROTL64(h64, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        h64 ^= (*p) * XXH_PRIME64_5;
+        h64 = XXH_ROTL64(h64, 11) * XXH_PRIME64_1;
+        p++;
+    }
+
+    h64 ^= h64 >> 33;
+    h64 *= XXH_PRIME64_2;
+    h64 ^= h64 >> 29;
+    h64 *= XXH_PRIME64_3;
+    h64 ^= h64 >> 32;
+
+    return h64;
+}
+
+/**********
+ * helper functions
+ */
+static uint64_t hash_planes(const slt_plane_t *planes, int num_planes)
+{
+    slt_hash_t h;
+    int i;
+
+    slt_hash_init(&h);
+    for (i = 0; i < num_planes; i++)
+        slt_hash_update(&h, planes[i].ptr, planes[i].size);
+
+    return slt_hash_digest(&h);
+}
+
+static void copy_planes(uint8_t *dst, const slt_plane_t *planes, int num_planes)
+{
+    int i;
+
+    for (i = 0; i < num_planes; i++) {
+        memcpy(dst, planes[i].ptr, planes[i].size);
+        dst += planes[i].size;
+    }
+}
+
+static void dump_buffer(const char *name, const slt_plane_t *planes, int num_planes)
+{
+    int fd;
+    int i;
+
+    fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        printf("%s:Error open file %s\n", __func__, name);
+        return;
+    }
+    for (i = 0; i < num_planes; i++) {
+        if (write(fd, planes[i].ptr, planes[i].size) != (ssize_t)planes[i].size)
+            printf("%s:Error write file %s\n", __func__, name);
+    }
+    close(fd);
+}
+
+/*
+ * Fuzzy compare against the golden reference. Returns the overall max pixel
+ * difference, per-channel maxima in max_diff and the PSNR in psnr (INFINITY
+ * for identical buffers).
+ */
+static int compare_golden(slt_check_t *chk, const slt_plane_t *planes, int num_planes,
+                          int *max_diff, double *psnr)
+{
+    const uint8_t *ref = chk->golden_buf;
+    uint64_t sse = 0;
+    uint32_t offset = 0;
+    int max_all = 0;
+    int i, c;
+
+    for (c = 0; c < SLT_MAX_CHANNELS; c++)
+        max_diff[c] = 0;
+
+    for (i = 0; i < num_planes; i++) {
+        const uint8_t *p = planes[i].ptr;
+        uint32_t j;
+
+        for (j = 0; j < planes[i].size; j++) {
+            int d = abs((int)p[j] - (int)ref[offset + j]);
+            c = (offset + j) % chk->channels;
+            if (d > max_diff[c])
+                max_diff[c] = d;
+            sse += d * d;
+        }
+        offset += planes[i].size;
+    }
+
+    for (c = 0; c < chk->channels; c++) {
+        if (max_diff[c] > max_all)
+            max_all = max_diff[c];
+    }
+
+    if (sse == 0) {
+        *psnr = INFINITY;
+    } else {
+        double mse = (double)sse / chk->frame_size;
+        *psnr = 10.0 * log10(255.0 * 255.0 / mse);
+    }
+
+    return max_all;
+}
+
+/*
+ * Check one frame whose hash is not the golden one. count is the number of
+ * identical frames it stands for, window candidates are only compared once.
+ */
+static int check_fuzzy(slt_check_t *chk, uint32_t frame_id, const slt_plane_t *planes, int num_planes, int count)
+{
+    int max_diff[SLT_MAX_CHANNELS];
+    double psnr;
+    int delta;
+    int c;
+
+    delta = compare_golden(chk, planes, num_planes, max_diff, &psnr);
+
+    if (delta > chk->diff_worst)
+        chk->diff_worst = delta;
+    if (psnr < chk->psnr_worst)
+        chk->psnr_worst = psnr;
+
+    if (delta <= chk->delta_allow && (chk->psnr_min <= 0 || psnr >= chk->psnr_min)) {
+        chk->frames_fuzzy += count;
+        return 0;
+    }
+
+    chk->frames_fail += count;
+    if (delta > chk->delta_allow)
+        printf("WARNING: frame_%d: pixel diff max:%d larger than allow %d\n", frame_id, delta, chk->delta_allow);
+    else
+        printf("WARNING: frame_%d: psnr %.2f dB lower than allow %.2f dB\n", frame_id, psnr, chk->psnr_min);
+    for (c = 0; c < chk->channels; c++)
+        printf("    channel %d: pixel diff max:%d\n", c, max_diff[c]);
+    if (count > 1)
+        printf("    %d identical frames in the golden window\n", count);
+
+    if (chk->dump_on_fail) {
+        char name[64];
+        sprintf(name, SLT_DUMP_PATH "/ca_%d.rgb", frame_id);
+        dump_buffer(name, planes, num_planes);
+    }
+
+    return -1;
+}
+
+/*
+ * Pick the most frequent frame of the window as golden reference and check
+ * the other distinct frames of the window against it.
+ */
+static void choose_golden(slt_check_t *chk)
+{
+    int choosen = 0;
+    int i;
+    int rc = 0;
+
+    for (i = 1; i < chk->cand_num; i++) {
+        if (chk->cand_count[i] > chk->cand_count[choosen])
+            choosen = i;
+    }
+
+    chk->golden_valid = 1;
+    chk->golden_frame = chk->cand_frame[choosen];
+    chk->golden_hash = chk->cand_hash[choosen];
+    chk->golden_buf = chk->cand_buf[choosen];
+    chk->cand_buf[choosen] = NULL;
+    chk->frames_same += chk->cand_count[choosen];
+
+    printf("choose frame_%d as base, same frames = %d\n", chk->golden_frame, chk->cand_count[choosen]);
+
+    for (i = 0; i < chk->cand_num; i++) {
+        slt_plane_t plane;
+
+        if (chk->cand_buf[i] == NULL)
+            continue;
+
+        plane.ptr = chk->cand_buf[i];
+        plane.size = chk->frame_size;
+        if (check_fuzzy(chk, chk->cand_frame[i], &plane, 1, chk->cand_count[i]) < 0)
+            rc = -1;
+
+        free(chk->cand_buf[i]);
+        chk->cand_buf[i] = NULL;
+    }
+
+    if (rc < 0 && chk->dump_on_fail) {
+        slt_plane_t plane;
+        plane.ptr = chk->golden_buf;
+        plane.size = chk->frame_size;
+        dump_buffer(SLT_DUMP_PATH "/ca_golden.rgb", &plane, 1);
+    }
+}
+
+/**********
+ * checker interface
+ */
+int slt_check_init(slt_check_t *chk, uint32_t frame_size, int channels, int window_len,
+                   int delta_allow, double psnr_min, int dump_on_fail)
+{
+    memset(chk, 0, sizeof(*chk));
+
+    if (frame_size == 0 || channels <= 0 || channels > SLT_MAX_CHANNELS) {
+        printf("%s:Error input param\n", __func__);
+        return -1;
+    }
+
+    if (window_len <= 0 || window_len > SLT_GOLDEN_WINDOW)
+        window_len = SLT_GOLDEN_WINDOW;
+
+    chk->frame_size = frame_size;
+    chk->channels = channels;
+    chk->window_len = window_len;
+    chk->delta_allow = delta_allow;
+    chk->psnr_min = psnr_min;
+    chk->dump_on_fail = dump_on_fail;
+    chk->psnr_worst = INFINITY;
+
+    return 0;
+}
+
+int slt_check_frame(slt_check_t *chk, uint32_t frame_id, const slt_plane_t *planes, int num_planes)
+{
+    uint32_t size = 0;
+    uint64_t hash;
+    int i;
+
+    for (i = 0; i < num_planes; i++)
+        size += planes[i].size;
+    if (size != chk->frame_size) {
+        printf("%s:frame_%d size %u, expected %u\n", __func__, frame_id, size, chk->frame_size);
+        return -1;
+    }
+
+    hash = hash_planes(planes, num_planes);
+    chk->frames_checked++;
+
+    if (chk->golden_valid) {
+        if (hash == chk->golden_hash) {
+            chk->frames_same++;
+            return 0;
+        }
+        return check_fuzzy(chk, frame_id, planes, num_planes, 1);
+    }
+
+    /* still voting for the golden reference */
+    for (i = 0; i < chk->cand_num; i++) {
+        if (chk->cand_hash[i] == hash)
+            break;
+    }
+
+    if (i < chk->cand_num) {
+        chk->cand_count[i]++;
+    } else {
+        chk->cand_buf[i] = malloc(chk->frame_size);
+        if (chk->cand_buf[i] == NULL) {
+            printf("%s:Error alloc %u bytes\n", __func__, chk->frame_size);
+            return -1;
+        }
+        copy_planes(chk->cand_buf[i], planes, num_planes);
+        chk->cand_hash[i] = hash;
+        chk->cand_frame[i] = frame_id;
+        chk->cand_count[i] = 1;
+        chk->cand_num++;
+    }
+
+    if (++chk->window_num == chk->window_len)
+        choose_golden(chk);
+
+    return 0;
+}
+
+int slt_check_finish(slt_check_t *chk)
+{
+    /* test range shorter than the golden window */
+    if (!chk->golden_valid && chk->cand_num > 0)
+        choose_golden(chk);
+
+    if (!chk->golden_valid) {
+        printf("%s:no frame checked\n", __func__);
+        return -1;
+    }
+
+    printf("frames checked: %u, identical: %u, within tolerance: %u, failed: %u\n",
+        chk->frames_checked, chk->frames_same, chk->frames_fuzzy, chk->frames_fail);
+    printf("worst pixel diff: %d, worst psnr: %.2f dB\n", chk->diff_worst, chk->psnr_worst);
+
+    if (chk->frames_fail)
+        printf("slt test fail!\n");
+    else
+        printf("slt test success!\n");
+
+    return 0;
+}
+
+void slt_check_release(slt_check_t *chk)
+{
+    int i;
+
+    for (i = 0; i < SLT_GOLDEN_WINDOW; i++) {
+        free(chk->cand_buf[i]);
+        chk->cand_buf[i] = NULL;
+    }
+    free(chk->golden_buf);
+    chk->golden_buf = NULL;
+    chk->golden_valid = 0;
+}
@@ -0,0 +1,86 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+
+#ifndef __SLT_CHECK_H__
+#define __SLT_CHECK_H__
+/*
+ * In-memory frame checker for the SLT test.
+ *
+ * Frames are hashed (xxHash64) straight from the dequeued buffers. The first
+ * frames of the test range vote for the golden reference which is then kept
+ * in RAM, every later frame is matched by hash and only fuzzy compared
+ * (per-channel max difference and PSNR) when the hash differs.
+ */
+
+#include <stdint.h>
+
+#define SLT_MAX_CHANNELS        4
+#define SLT_GOLDEN_WINDOW       10
+#define SLT_DUMP_PATH           "/media"
+
+typedef struct _slt_plane_t {
+    const uint8_t       *ptr;
+    uint32_t            size;
+} slt_plane_t;
+
+typedef struct _slt_hash_t {
+    uint64_t            v[4];
+    uint64_t            total_len;
+    uint8_t             mem[32];
+    uint32_t            mem_size;
+} slt_hash_t;
+
+typedef struct _slt_check_t {
+    /* config */
+    uint32_t            frame_size;
+    int                 channels;
+    int                 window_len;
+    int                 delta_allow;
+    double              psnr_min;
+    int                 dump_on_fail;
+
+    /* golden reference voting, one RAM copy per distinct frame */
+    int                 window_num;
+    int                 cand_num;
+    uint64_t            cand_hash[SLT_GOLDEN_WINDOW];
+    uint32_t            cand_frame[SLT_GOLDEN_WINDOW];
+    int                 cand_count[SLT_GOLDEN_WINDOW];
+    uint8_t             *cand_buf[SLT_GOLDEN_WINDOW];
+
+    int                 golden_valid;
+    uint32_t            golden_frame;
+    uint64_t            golden_hash;
+    uint8_t             *golden_buf;
+
+    /* statistics */
+    uint32_t            frames_checked;
+    uint32_t            frames_same;
+    uint32_t            frames_fuzzy;
+    uint32_t            frames_fail;
+    int                 diff_worst;
+    double              psnr_worst;
+} slt_check_t;
+
+void slt_hash_init(slt_hash_t *h);
+void slt_hash_update(slt_hash_t *h, const uint8_t *data, uint32_t len);
+uint64_t slt_hash_digest(const slt_hash_t *h);
+
+int slt_check_init(slt_check_t *chk, uint32_t frame_size, int channels, int window_len,
+                   int delta_allow, double psnr_min, int dump_on_fail);
+int slt_check_frame(slt_check_t *chk, uint32_t frame_id, const slt_plane_t *planes, int num_planes);
+int slt_check_finish(slt_check_t *chk);
+void slt_check_release(slt_check_t *chk);
+
+#endif // __SLT_CHECK_H__
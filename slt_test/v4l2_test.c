@@ -37,12 +37,7 @@
 
 #include "common.h"
 #include "logs.h"
-
-#define STR_VALUE(val) #val
-#define STR(name) STR_VALUE(name)
-
-#define PATH_LEN 256
-#define MD5_LEN 32
+#include "slt_check.h"
 
 #define STATIC_STREAM_COUNT (ARM_V4L2_TEST_STREAM_MAX - ARM_V4L2_TEST_HAS_RAW)
 #define NB_BUFFER           6
@@ -94,8 +89,6 @@ typedef struct _capture_module_t {
 static int sensor_bits = 10;
 
 static char *str_on_off[2] = { "ON", "OFF" };
-static unsigned char uv_buffer[1920*1080*3];
-static unsigned char buffer[1920*1080*3];
 
 uint64_t start_time,end_time;
 
@@ -124,6 +117,8 @@ unsigned char *displaybuf_meta;
 int from_md5 = 0;
 int to_md5 = 0;
 int slt_control = 10;
+int slt_dump_fail = 0;
+double slt_psnr_min = 0;
 /**********
  * thread parameters
  */
@@ -160,26 +155,6 @@ pthread_t tid[STATIC_STREAM_COUNT];
 /**********
  * helper functions
  */
- int CalcFileMD5(char *file_name, char *md5_sum)
-{
-    #define MD5SUM_CMD_FMT "md5sum %." STR(PATH_LEN) "s 2>/dev/null"
-    char cmd[PATH_LEN + sizeof (MD5SUM_CMD_FMT)];
-    sprintf(cmd, MD5SUM_CMD_FMT, file_name);
-    #undef MD5SUM_CMD_FMT
-
-    FILE *p = popen(cmd, "r");
-    if (p == NULL) return 0;
-
-    int i, ch;
-    for (i = 0; i < MD5_LEN && isxdigit(ch = fgetc(p)); i++) {
-        *md5_sum++ = ch;
-    }
-
-    *md5_sum = '\0';
-    pclose(p);
-    return i == MD5_LEN;
-}
-
 uint64_t getTimestamp() {
     struct timespec ts;
     int rc;
@@ -198,115 +173,6 @@ int64_t GetTimeMsec() {
     return tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
 
-int slttest(int f, int t, int delta_s){
-    FILE * read_file =NULL;
-    FILE * write_file =NULL;
-    int width = 1920;
-    int height = 1080;
-    int ret = -1;
-    char name[60] = {'\0'};
-    int i, j, k, err_flag;
-	int delta_set,delta;
-	int temp = 0;
-    char md5[MD5_LEN + 1];
-    char tempmd5[MD5_LEN + 1];
-	int index;
-	int max = 0,choosen = 0;
-	int from, to;
-	from = f;
-	to = t;
-	delta_set = delta_s;
-	err_flag = 0;
-	printf("from: frame_%d to frame_%d\n", from, to - 1);
-	for (j = from; j < to; j++) {
-		sprintf(name, "/media/ca_%d.rgb", j);
-		if (!CalcFileMD5(name, tempmd5)) {
-			printf("Error occured1: read MD5 fail!\n");
-			return -1;
-		} else {
-			memcpy(md5, tempmd5, sizeof(tempmd5));
-		}
-		index = 0;
-		for (k = j; k < to; k++) {
-			sprintf(name, "/media/ca_%d.rgb", k);
-			if (CalcFileMD5(name, tempmd5)) {
-				if (strcmp(tempmd5, md5) == 0) {
-					index ++;
-				} else {
-					continue;
-				}
-			} else {
-				printf("Error occured2: read MD5 fail!\n");
-				return -1;
-			}
-		}
-		if (index > max) {
-			max = index;
-			choosen = j;
-		}
-		if (max > ( to - from + 1)/2)
-			break;
-	}
-	sprintf(name, "/media/ca_%d.rgb", choosen);
-	printf("choose frame_%d as base, same frames = %d\n", choosen, max);
-	if (!CalcFileMD5(name, md5)) {
-		printf("Error occured3: read MD5 fail!\n");
-		return -1;
-	}
-	read_file = fopen(name, "r");
-	for (i = 0; i < width * height * 3; i++) {
-		ret = fread(buffer + i, 1, 1, read_file);
-		if (ret < 0)
-			printf("read fail\n");
-	}
-	for (j = from; j < to; j++) {
-		sprintf(name, "/media/ca_%d.rgb", j);
-		if (!CalcFileMD5(name, tempmd5)) {
-			printf("Error occured4: read MD5 fail!\n");
-			return -1;
-		}
-		if (strcmp(tempmd5, md5) == 0) {
-			continue;
-		}
-		write_file = fopen(name, "r");
-		if (read_file == NULL || write_file == NULL) {
-			printf("open file error!\n");
-			return -1;
-		}
-
-		for (i = 0; i < width * height * 3; i++) {
-			ret = fread(uv_buffer + i, 1, 1, write_file);
-			if (ret < 0) {
-				printf("write fail\n");
-				return -1;
-			}
-		}
-		delta = 0;
-		for (i = 0; i < width * height * 3; i++) {
-			temp = abs(uv_buffer[i] - buffer[i]);
-			if (temp > delta) {
-				delta = temp;
-			}
-			if (temp > delta_set) {
-				//printf("location: x: %d, y: %d, temp: %d\n", i / 3 % width , i / (width * 3), temp);
-			}
-		}
-		if (delta > delta_set) {
-			printf("WARNING: frame_%d: pixel diff max:%d larger than allow %d\n", j, delta, delta_set);
-			err_flag = 1;
-		}
-		if (write_file)
-			fclose(write_file);
-	}
-	if (err_flag)
-		printf("slt test fail!\n");
-	else
-		printf("slt test success!\n");
-	if (read_file)
-		fclose(read_file);
-	system("rm -rf /media/ca_*");
-	return 0;
-}
 static uint8_t cmd_do_af_refocus = 0;
 
 static void do_af_refocus(int videofd)
@@ -353,29 +219,6 @@ static void set_manual_exposure(int videofd, int enable)
     }
 }
 
-void save_imgae(char *buff, unsigned int size, int flag, int count)
-{
-    char name[60] = {'\0'};
-    int fd = -1;
-
-    if (buff == NULL || size == 0) {
-        printf("%s:Error input param\n", __func__);
-        return;
-    }
-	if(count < from_md5 )
-		return;
-    sprintf(name, "/media/ca_%d.rgb", count);
-
-    fd = open(name, O_RDWR | O_CREAT, 0666);
-    if (fd < 0) {
-        printf("%s:Error open file\n", __func__);
-        return;
-    }
-    write(fd, buff, size);
-    close(fd);
-}
-
-
 /**********
  * thread function
  */
@@ -404,6 +247,9 @@ void * video_thread(void *arg)
     unsigned char *displaybuf = NULL;
     uint64_t display_count = 0;
     int64_t start, end;
+    slt_check_t slt_chk;
+
+    memset(&slt_chk, 0, sizeof(slt_chk));
     /**************************************************
      * find thread id
      *************************************************/
@@ -501,6 +347,27 @@ void * video_thread(void *arg)
         break;
     }
 
+    /* FR frames are checked in place from the mmapped buffers */
+    if (stream_type == ARM_V4L2_TEST_STREAM_FR) {
+        uint32_t frame_size = 0;
+        int channels = 1;
+
+        for (i = 0; i < v4l2_fmt.fmt.pix_mp.num_planes; i++)
+            frame_size += v4l2_fmt.fmt.pix_mp.plane_fmt[i].sizeimage;
+
+        if (v4l2_fmt.fmt.pix_mp.pixelformat == V4L2_PIX_FMT_RGB24)
+            channels = 3;
+        else if (v4l2_fmt.fmt.pix_mp.pixelformat == V4L2_PIX_FMT_RGB32)
+            channels = 4;
+
+        rc = slt_check_init(&slt_chk, frame_size, channels, SLT_GOLDEN_WINDOW,
+                            slt_control, slt_psnr_min, slt_dump_fail);
+        if (rc < 0) {
+            printf("Error: slt check init.\n");
+            goto fatal;
+        }
+    }
+
     /**************************************************
      * buffer preparation
      *************************************************/
@@ -612,7 +479,6 @@ void * video_thread(void *arg)
 
         switch (stream_type) {
         case ARM_V4L2_TEST_STREAM_FR:
-            memset(displaybuf_fr, 0, tparm->width * tparm->height * 3);
             displaybuf = displaybuf_fr;
             break;
         case ARM_V4L2_TEST_STREAM_META:
@@ -713,7 +579,17 @@ void * video_thread(void *arg)
         src.bpp = 32; // Todo: fixed to ARGB for now
         src.fmt = v4l2_fmt.fmt.pix.pixelformat;
 
-        if (src.fmt == V4L2_PIX_FMT_NV12) {
+        if (stream_type == ARM_V4L2_TEST_STREAM_FR) {
+            /* check before the buffer goes back to the driver */
+            if (display_count >= from_md5 && display_count < to_md5) {
+                slt_plane_t planes[VIDEO_MAX_PLANES];
+                for (i = 0; i < newframe.num_planes; i++) {
+                    planes[i].ptr = newframe.paddr[i];
+                    planes[i].size = v4l2_fmt.fmt.pix_mp.plane_fmt[i].sizeimage;
+                }
+                slt_check_frame(&slt_chk, display_count, planes, newframe.num_planes);
+            }
+        } else if (src.fmt == V4L2_PIX_FMT_NV12) {
 			memcpy(displaybuf, v4l2_mem[idx * 2], v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage);
 			memcpy(displaybuf + v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage, v4l2_mem[idx * 2 + 1],
 									v4l2_fmt.fmt.pix_mp.plane_fmt[1].sizeimage);
@@ -729,13 +605,13 @@ void * video_thread(void *arg)
 
         /***** select save file or display through different stream_type *****/
         if (stream_type == ARM_V4L2_TEST_STREAM_FR) {
-			save_imgae(displaybuf, v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage, stream_type, display_count);
+        //checked above
         } else if (stream_type == ARM_V4L2_TEST_STREAM_META) {
         //do nothing
         } else if (stream_type == ARM_V4L2_TEST_STREAM_DS1) {
-        //save_imgae(displaybuf, v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage, stream_type);
+        //do nothing
         } else if (stream_type == ARM_V4L2_TEST_STREAM_DS2) {
-        //save_imgae(displaybuf, v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage, stream_type);
+        //do nothing
         }
 
         display_count++;
@@ -775,7 +651,7 @@ void * video_thread(void *arg)
     }
 
     if (stream_type == ARM_V4L2_TEST_STREAM_FR) {
-        rc = slttest(from_md5,to_md5, slt_control);
+        rc = slt_check_finish(&slt_chk);
         if (rc < 0)
             printf("Error: slt test exit due to error,pls check if isp is ok!\n");
     }
@@ -784,6 +660,7 @@ void * video_thread(void *arg)
     printf("cost time : %ld\n", end_time);
 fatal:
 
+    slt_check_release(&slt_chk);
     close(videofd);
 
     MSG("thread %d terminated ...\n", stream_type);
@@ -960,13 +837,15 @@ int main(int argc, char *argv[])
         printf("    t : run the port count, default is 1\n");
         printf("    x : fps print port. default: -1, no print. 0:  fr, 1: meta, 2: ds1, 3: ds2\n");
 		printf("    y : pixel diff between frames\n");
+        printf("    z : min psnr in dB between frames, default 0: not checked\n");
+        printf("    k : dump failed frames and golden to " SLT_DUMP_PATH ", default 0\n");
         return -1;
     }
 
     int c;
 	system("echo 0xff15c0e8 > /sys/kernel/debug/aml_reg/paddr;");
     while(optind < argc){
-        if ((c = getopt (argc, argv, "c:p:F:f:D:R:r:d:N:n:w:e:v:t:x:y:")) != -1) {
+        if ((c = getopt (argc, argv, "c:p:F:f:D:R:r:d:N:n:w:e:v:t:x:y:z:k:")) != -1) {
             switch (c) {
             case 'c':
                 command = atoi(optarg);
@@ -1016,6 +895,12 @@ int main(int argc, char *argv[])
             case 'y':
                 slt_control = atoi(optarg);
                 break;
+            case 'z':
+                slt_psnr_min = atof(optarg);
+                break;
+            case 'k':
+                slt_dump_fail = atoi(optarg);
+                break;
             case '?':
                 usage(argv[0]);
                 exit(1);
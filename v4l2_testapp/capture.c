@@ -4,14 +4,23 @@
  * This is debugging purpose SW tool running on JUNO.
  */
 
+#define _GNU_SOURCE /* O_DIRECT */
+
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <pthread.h>
+#include <time.h>
 #include <sys/ioctl.h>
 #include <linux/videodev2.h>
 #include <math.h>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include "common.h"
 #include "isp_metadata.h"
@@ -21,6 +30,8 @@
 
 #define SD_HEADER_SIZE          0x100
 #define SD_META_SIZE            0x1000
+#define CAPTURE_IO_ALIGN        4096
+#define CAPTURE_WRITE_CHUNK     (4 * 1024 * 1024)
 
 static int32_t fill_header(int stream_type, char *header, frame_t *pframe, int plane) {
     char *buf = header;
@@ -89,18 +100,8 @@ static int32_t fill_header(int stream_type, char *header, frame_t *pframe, int p
 }
 
 
-static int store_data_to_file( int stream_type, uint32_t frame_id, struct tm *tm,
-                                char * filename, char * postfix, char * ext,
-                                const char * header, uint32_t header_size,
-                                const char * buf, uint32_t buf_size ) {
-    FILE *bfp;
-
-    MSG("[Stream-%d] Capturing started.\n", stream_type);
-
-    if (filename == NULL || postfix == NULL) {
-        ERR("[Stream-%d] NULL string ! (filename = %p, postfix = %p)\n", stream_type, filename, postfix);
-        return -1;
-    }
+static void make_capture_filename(char * filename, uint32_t frame_id, struct tm *tm,
+                                  const char * postfix, const char * ext) {
 #if 1
     sprintf(filename, "IMG%06d_%04d%02d%02d_%02d%02d%02d_%s.%s",
             frame_id, tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, postfix, ext);
@@ -108,77 +109,209 @@ static int store_data_to_file( int stream_type, uint32_t frame_id, struct tm *tm
     sprintf(filename, "IMG%06d_%04d%02d%02d_%02d%02d%02d.%s",
             frame_id, tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, ext);
 #endif
-    MSG("[Stream-%d]   - filename: %s, frame_id = %d\n", stream_type, filename, frame_id);
+}
+
+static int32_t fill_frm_header(char *header, frame_t *pframe) {
+    return sprintf(header, "#ISP1.width.height.depth.type.layers.%d.%d.%d.%d.%d.",
+                   pframe->width[0], pframe->height[0], pframe->bit_depth[0],
+                   (pframe->bytes_per_line[0] / pframe->width[0]) * 8, //type or allignment in bits
+                   pframe->num_planes);
+}
+
+static uint32_t get_plane_bytesused(frame_t *pframe, int plane) {
+    if (pframe->vbuf.type == V4L2_BUF_TYPE_VIDEO_CAPTURE)
+        return pframe->vbuf.bytesused;
+    else if (pframe->vbuf.type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+        return pframe->vbuf.m.planes[plane].bytesused;
+    return 0;
+}
+
+/**********
+ * unpack kernels
+ */
+
+/* RAW16 rows to 4 bytes per pixel apical-raw rows, upper half zeroed */
+void capture_widen_raw16(uint8_t *dst, const uint8_t *src, int width, int height, int src_stride) {
+    int i;
+
+    for (i = 0; i < height; i++) {
+        memcpy(dst, src, width * 2);
+        memset(dst + width * 2, 0, width * 2);
+        dst += width * 4;
+        src += src_stride;
+    }
+}
+
+/* remove the 4 bit LSB padding of two packed Apical RAW12 samples per word */
+void capture_unpack_raw12(uint32_t *dst, const uint32_t *src, int count) {
+    int i = 0;
+
+#if defined(__ARM_NEON)
+    const uint32x4_t mask = vdupq_n_u32(0x0FFF0FFF);
+
+    for (; i + 8 <= count; i += 8) {
+        uint32x4_t v0 = vld1q_u32(src + i);
+        uint32x4_t v1 = vld1q_u32(src + i + 4);
+        vst1q_u32(dst + i, vandq_u32(vshrq_n_u32(v0, 4), mask));
+        vst1q_u32(dst + i + 4, vandq_u32(vshrq_n_u32(v1, 4), mask));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = (src[i] >> 4) & 0x0FFF0FFF;
+}
 
-    if (buf == NULL || buf_size == 0) {
-        ERR("[Stream-%d] invalid parameter ! (buf = %p, buf_size = %d)\n", stream_type, buf, buf_size);
+/**********
+ * capture writer
+ */
+static capture_file_t * slot_add_file(capture_slot_t *slot, const char *filename, uint32_t size) {
+    capture_file_t *f;
+
+    if (slot->file_num >= CAPTURE_FILE_MAX) {
+        ERR("Error, too many capture files in one slot !\n");
+        return NULL;
+    }
+
+    f = &slot->file[slot->file_num];
+    if (f->buf_len < size) {
+        /* grow only, the slot keeps its buffers for the next capture */
+        uint32_t len = (size + CAPTURE_IO_ALIGN - 1) & ~(CAPTURE_IO_ALIGN - 1);
+        void *buf = NULL;
+
+        free(f->buf);
+        f->buf = NULL;
+        f->buf_len = 0;
+        if (posix_memalign(&buf, CAPTURE_IO_ALIGN, len) != 0) {
+            ERR("Error, can't allocate %d bytes for capture !\n", len);
+            return NULL;
+        }
+        f->buf = buf;
+        f->buf_len = len;
+    }
+
+    if (filename)
+        strncpy(f->filename, filename, FILE_NAME_LENGTH - 1);
+    else
+        f->filename[0] = '\0';
+    f->size = 0;
+    slot->file_num++;
+
+    return f;
+}
+
+static int write_capture_file(const capture_file_t *f, int direct_io) {
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    uint32_t direct_size = 0;
+    uint32_t done = 0;
+    int fd = -1;
+
+    /* O_DIRECT covers the aligned part, the tail goes through the page cache */
+    if (direct_io) {
+        fd = open(f->filename, flags | O_DIRECT, 0666);
+        if (fd >= 0)
+            direct_size = f->size & ~(CAPTURE_IO_ALIGN - 1);
+    }
+    if (fd < 0)
+        fd = open(f->filename, flags, 0666);
+    if (fd < 0) {
+        ERR("Error, can't open %s !\n", f->filename);
         return -1;
     }
 
-    MSG("[Stream-%d]   - header = %p, header_size = %d\n", stream_type, header, header_size);
-    MSG("[Stream-%d]   - buffer = %p, buf_size = %d\n", stream_type, buf, buf_size);
+    while (done < f->size) {
+        uint32_t len;
+        ssize_t ret;
 
-    bfp = fopen(filename, "wb");
-    if (bfp) {
-        if (header != NULL && header_size > 0) {
-            fwrite(header, sizeof(uint8_t), header_size, bfp);
+        if (done < direct_size) {
+            len = direct_size - done;
+        } else {
+            if (direct_size && done == direct_size)
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            len = f->size - done;
+        }
+        if (len > CAPTURE_WRITE_CHUNK)
+            len = CAPTURE_WRITE_CHUNK;
+
+        ret = write(fd, f->buf + done, len);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0) {
+            ERR("Error, write %s failed at %d/%d (%s) !\n", f->filename, done, f->size, strerror(errno));
+            close(fd);
+            return -1;
         }
-        fwrite(buf, sizeof(uint8_t), buf_size, bfp);
-        fflush(bfp);
-        fclose(bfp) ;
+        done += ret;
     }
-    MSG("[Stream-%d] Capture data done.\n", stream_type);
 
+    close(fd);
     return 0;
 }
 
-static FILE * prepare_frm_file(int stream_type, uint32_t frame_id, struct tm *tm,
-        char * filename, char * postfix, char * ext,
-		frame_t *pframe){
-	FILE *bfp;
-	MSG("[Stream-%d] FRM Capturing started %d %d %d.\n", stream_type,pframe->width[0],pframe->height[0],pframe->bytes_per_line[0]);
+static void * capture_writer_thread(void *arg) {
+    capture_module_t *cap_mod = (capture_module_t *)arg;
+    capture_slot_t *slot;
+    int i;
 
-	if (filename == NULL || postfix == NULL) {
-		ERR("[Stream-%d] NULL string ! (filename = %p, postfix = %p)\n", stream_type, filename, postfix);
-		return NULL;
-	}
+    while (1) {
+        pthread_mutex_lock(&cap_mod->wmutex);
+        while (cap_mod->slot_cnt == 0 && !cap_mod->writer_exit)
+            pthread_cond_wait(&cap_mod->wcond, &cap_mod->wmutex);
+        if (cap_mod->slot_cnt == 0) {
+            pthread_mutex_unlock(&cap_mod->wmutex);
+            break;
+        }
+        slot = &cap_mod->slot[cap_mod->slot_rd];
+        pthread_mutex_unlock(&cap_mod->wmutex);
 
-	sprintf(filename, "IMG%06d_%04d%02d%02d_%02d%02d%02d_%s.%s",
-		frame_id, tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, postfix, ext);
+        switch (slot->type) {
+        case V4L2_TEST_CAPTURE_LEGACY:
+        case V4L2_TEST_CAPTURE_FRM:
+            for (i = 0; i < slot->file_num; i++) {
+                MSG("[writer] %s, size = %d\n", slot->file[i].filename, slot->file[i].size);
+                write_capture_file(&slot->file[i], cap_mod->direct_io);
+            }
+            break;
+#if ARM_V4L2_TEST_HAS_DNG
+        case V4L2_TEST_CAPTURE_DNG:
+            process_capture_dng(&slot->pack);
+            break;
+#endif
+        default:
+            break;
+        }
+        MSG("Capture of frame id %d is written.\n", slot->pack.frame_id);
 
-	bfp = fopen(filename, "wb");
+        pthread_mutex_lock(&cap_mod->wmutex);
+        cap_mod->slot_rd = (cap_mod->slot_rd + 1) % FRAME_PACK_QUEUE_SIZE;
+        cap_mod->slot_cnt--;
+        pthread_cond_broadcast(&cap_mod->wcond);
+        pthread_mutex_unlock(&cap_mod->wmutex);
+    }
 
-	if(bfp){
-		fprintf(bfp,"#ISP1.width.height.depth.type.layers.");
-		fprintf(bfp,"%d.", pframe->width[0]);
-		fprintf(bfp,"%d.", pframe->height[0]);
-		fprintf(bfp,"%d.",pframe->bit_depth[0]);
-		fprintf(bfp,"%d.",(pframe->bytes_per_line[0]/pframe->width[0])*8); //type or allignment in bits
-		fprintf(bfp,"%d.", pframe->num_planes);
-		fflush(bfp);
-	}
+    return NULL;
+}
 
-	return bfp;
+/* wait for a free slot, only blocks when the writer is a whole pool behind */
+static capture_slot_t * get_free_slot(capture_module_t * cap_mod) {
+    capture_slot_t *slot;
 
-}
+    pthread_mutex_lock(&cap_mod->wmutex);
+    if (cap_mod->slot_cnt == FRAME_PACK_QUEUE_SIZE)
+        MSG("Capture writer is busy, waiting for a free slot ...\n");
+    while (cap_mod->slot_cnt == FRAME_PACK_QUEUE_SIZE)
+        pthread_cond_wait(&cap_mod->wcond, &cap_mod->wmutex);
+    slot = &cap_mod->slot[cap_mod->slot_wr];
+    pthread_mutex_unlock(&cap_mod->wmutex);
 
-static int write_frm_file(FILE * frm_file,const char * buf, uint32_t buf_size){
-	if (buf == NULL || buf_size == 0 || frm_file==NULL) {
-		ERR("[File-%p] invalid parameter ! (buf = %p, buf_size = %d)\n", frm_file, buf, buf_size);
-		return -1;
-	}
-	if (frm_file) {
-		fwrite(buf, sizeof(uint8_t), buf_size, frm_file);
-		fflush(frm_file);
-	}
-	return 0;
+    slot->file_num = 0;
+    return slot;
 }
 
-static void finish_frm_file(FILE * frm_file){
-	if (frm_file) {
-		fflush(frm_file);
-		fclose(frm_file);
-	}
+static void submit_slot(capture_module_t * cap_mod) {
+    pthread_mutex_lock(&cap_mod->wmutex);
+    cap_mod->slot_wr = (cap_mod->slot_wr + 1) % FRAME_PACK_QUEUE_SIZE;
+    cap_mod->slot_cnt++;
+    pthread_cond_broadcast(&cap_mod->wcond);
+    pthread_mutex_unlock(&cap_mod->wmutex);
 }
 
 static void release_frame_pack(capture_module_t * cap_mod, int index) {
@@ -200,86 +333,77 @@ static void release_frame_pack(capture_module_t * cap_mod, int index) {
     }
 }
 
-static void process_capture_legacy(capture_module_t * cap_mod, int index, int frm) {
+/*
+ * Legacy / FRM capture: build the complete file images (header + data) in the
+ * slot so the buffers can go back to the driver before anything touches disk.
+ */
+static int process_capture_legacy(capture_module_t * cap_mod, int index, int frm, capture_slot_t *slot) {
     int                     frame_id = cap_mod->frame_pack_queue[index].frame_id;
     frame_t                 * pframe;
 
     time_t                  t = time(NULL);
     struct tm               tm = *localtime(&t);
 
+    capture_file_t          * f;
     uint8_t                 * buf = NULL;
     uint32_t                buf_size = 0;
-    char                    * header = NULL;
-    static uint32_t         header_size = 0;
-#if ARM_V4L2_TEST_HAS_META
-    firmware_metadata_t     * meta = NULL;
-    char                    * metadata_buf = NULL;
-    uint32_t                metadata_buf_size = 0;
-#endif
+    uint32_t                header_size = 0;
+    char                    filename[FILE_NAME_LENGTH];
     int j;
-    FILE * frm_file;
 
     MSG("Doing legacy capture for all streams.\n");
 
-    /* allocate buffer */
-    header = (char *)malloc(SD_HEADER_SIZE);
-
     /* do fr capture */
     pframe = &cap_mod->frame_pack_queue[index].frame_data[ARM_V4L2_TEST_STREAM_FR];
 
     if(frm==1){
-    	char postfix[8];
-    	sprintf(postfix, "fr %d",j);
-    	frm_file=prepare_frm_file(ARM_V4L2_TEST_STREAM_FR, frame_id, &tm,
-				(cap_mod->last_capture_filename[ARM_V4L2_TEST_STREAM_FR]),
-				postfix, "FRM",pframe);
+        make_capture_filename(filename, frame_id, &tm, "fr", "FRM");
+        buf_size = 0;
+        for(j=0;j<pframe->num_planes;j++)
+            buf_size += get_plane_bytesused(pframe, j);
+        f = slot_add_file(slot, filename, SD_HEADER_SIZE + buf_size);
+        if (f == NULL)
+            return -1;
+        header_size = fill_frm_header((char *)f->buf, pframe);
+        f->size = header_size;
     }
 
     //mutiplane support
     for(j=0;j<pframe->num_planes;j++){
-		buf = pframe->paddr[j];
-		if(pframe->vbuf.type==V4L2_BUF_TYPE_VIDEO_CAPTURE)
-			buf_size = pframe->vbuf.bytesused;
-		else if(pframe->vbuf.type==V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
-			buf_size = pframe->vbuf.m.planes[j].bytesused;
-		MSG("[fr]  buffer = %p, buf_size = %d\n",  buf, buf_size);
-		if(frm==0){
-			header_size = fill_header(ARM_V4L2_TEST_STREAM_FR, header, pframe,j);
-			char postfix[8];
-			sprintf(postfix, "fr-%d",j);
-			char pformat[4];
-			if(pframe->pixelformat==V4L2_PIX_FMT_NV12)
-				sprintf(pformat, "YUV");
-			else
-				sprintf(pformat, "RGB");
-			//MSG("[fr]  buffer = %p, buf_size = %d\n",  buf, buf_size);
-			store_data_to_file(ARM_V4L2_TEST_STREAM_FR, frame_id, &tm,
-								(cap_mod->last_capture_filename[ARM_V4L2_TEST_STREAM_FR]),
-								postfix, pformat, header, header_size, buf, buf_size);
-		}else{
-			write_frm_file(frm_file,buf,buf_size);
-		}
-		cap_mod->last_buf_size = buf_size;
-		cap_mod->last_header_size = header_size;
-    }
-
-    if(frm==1){
-    	finish_frm_file(frm_file);
+        buf = pframe->paddr[j];
+        buf_size = get_plane_bytesused(pframe, j);
+        MSG("[fr]  buffer = %p, buf_size = %d\n",  buf, buf_size);
+        if(frm==0){
+            char postfix[8];
+            sprintf(postfix, "fr-%d",j);
+            make_capture_filename(filename, frame_id, &tm, postfix,
+                                  (pframe->pixelformat==V4L2_PIX_FMT_NV12) ? "YUV" : "RGB");
+            f = slot_add_file(slot, filename, SD_HEADER_SIZE + buf_size);
+            if (f == NULL)
+                return -1;
+            header_size = fill_header(ARM_V4L2_TEST_STREAM_FR, (char *)f->buf, pframe,j);
+            f->size = header_size;
+        }
+        memcpy(f->buf + f->size, buf, buf_size);
+        f->size += buf_size;
+        strcpy(cap_mod->last_capture_filename[ARM_V4L2_TEST_STREAM_FR], f->filename);
+        cap_mod->last_buf_size = buf_size;
+        cap_mod->last_header_size = header_size;
     }
 
 #if ARM_V4L2_TEST_HAS_META
     /* do meta capture */
-    metadata_buf = (char *)malloc(SD_META_SIZE);
-    meta = (firmware_metadata_t *)cap_mod->frame_pack_queue[index].frame_data[ARM_V4L2_TEST_STREAM_META].paddr[0];
+    firmware_metadata_t *meta = (firmware_metadata_t *)cap_mod->frame_pack_queue[index].frame_data[ARM_V4L2_TEST_STREAM_META].paddr[0];
 
-    metadata_buf_size = fill_meta_buf(metadata_buf, meta);
-    MSG("[meta]  buffer = %p, buf_size = %d\n",  metadata_buf, metadata_buf_size);
-    store_data_to_file(ARM_V4L2_TEST_STREAM_META, frame_id, &tm,
-                        cap_mod->last_capture_filename[ARM_V4L2_TEST_STREAM_META],
-                        "meta", "TXT", NULL, 0, metadata_buf, metadata_buf_size);
-    free(metadata_buf);
+    make_capture_filename(filename, frame_id, &tm, "meta", "TXT");
+    f = slot_add_file(slot, filename, SD_META_SIZE);
+    if (f == NULL)
+        return -1;
+    f->size = fill_meta_buf((char *)f->buf, meta);
+    MSG("[meta]  buffer = %p, buf_size = %d\n",  f->buf, f->size);
+    strcpy(cap_mod->last_capture_filename[ARM_V4L2_TEST_STREAM_META], f->filename);
 
-    cap_mod->last_metadata_buf_size = metadata_buf_size;
+    cap_mod->last_metadata_buf_size = f->size;
 #endif
 
 #if ARM_V4L2_TEST_HAS_RAW
@@ -287,56 +411,108 @@ static void process_capture_legacy(capture_module_t * cap_mod, int index, int fr
     pframe = &cap_mod->frame_pack_queue[index].frame_data[ARM_V4L2_TEST_STREAM_RAW];
 
     if(frm==1){
-		char postfix[8];
-		sprintf(postfix, "raw",j);
-		frm_file=prepare_frm_file(ARM_V4L2_TEST_STREAM_RAW, frame_id, &tm,
-				(cap_mod->last_capture_filename[ARM_V4L2_TEST_STREAM_RAW]),
-				postfix, "FRM",pframe);
-	}
+        make_capture_filename(filename, frame_id, &tm, "raw", "FRM");
+        buf_size = 0;
+        for(j=0;j<pframe->num_planes;j++)
+            buf_size += get_plane_bytesused(pframe, j);
+        f = slot_add_file(slot, filename, SD_HEADER_SIZE + buf_size);
+        if (f == NULL)
+            return -1;
+        header_size = fill_frm_header((char *)f->buf, pframe);
+        f->size = header_size;
+    }
     //mutiplane support
     for(j=0;j<pframe->num_planes;j++){
-		buf = pframe->paddr[j];
-		if(pframe->vbuf.type==V4L2_BUF_TYPE_VIDEO_CAPTURE)
-			buf_size = pframe->vbuf.bytesused;
-		else if(pframe->vbuf.type==V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
-			buf_size = pframe->vbuf.m.planes[j].bytesused;
-
-		MSG("[raw]  buffer = %p, buf_size = %d\n",  buf, buf_size);
-	//#if CONVERT_RAW_4_TO_2 // Hardcoded to convert 2byte raw to 4byte apical-raw
-		if(frm==0){
-			header_size = fill_header(ARM_V4L2_TEST_STREAM_RAW, header, pframe,j);
-			uint32_t buf_padded_size = pframe->width[j] * 4 * pframe->height[j];
-			uint8_t * buf_padded = malloc(buf_padded_size);
-			{
-				int i, offset_d, offset_s;
-				for(i = 0; i < pframe->height[j]; i++) {
-					offset_d = i * pframe->width[j] * 4;
-					offset_s = i * pframe->bytes_per_line[j];
-					memcpy(buf_padded + offset_d, buf + offset_s, pframe->width[j] * 2);
-				}
-			}
-			buf = buf_padded;
-			buf_size = buf_padded_size;
-		//}
-	//#endif
-			char postfix[8];
-			sprintf(postfix, (frm?"frm-%d":"raw-%d"),j);
-			store_data_to_file(ARM_V4L2_TEST_STREAM_RAW, frame_id, &tm,
-								(cap_mod->last_capture_filename[ARM_V4L2_TEST_STREAM_RAW]),
-								postfix,(frm?"FRM":"RAW"), header, header_size, buf, buf_size);
-	//#if CONVERT_RAW_4_TO_2 // Hardcoded to convert 2byte raw to 4byte apical-raw
-			free(buf_padded);
-    	}else{
-    		write_frm_file(frm_file,buf,buf_size);
-    	}
-	//#endif
+        buf = pframe->paddr[j];
+        buf_size = get_plane_bytesused(pframe, j);
+
+        MSG("[raw]  buffer = %p, buf_size = %d\n",  buf, buf_size);
+        if(frm==0){
+            // Hardcoded to convert 2byte raw to 4byte apical-raw
+            uint32_t buf_padded_size = pframe->width[j] * 4 * pframe->height[j];
+            char postfix[8];
+            sprintf(postfix, "raw-%d",j);
+            make_capture_filename(filename, frame_id, &tm, postfix, "RAW");
+            f = slot_add_file(slot, filename, SD_HEADER_SIZE + buf_padded_size);
+            if (f == NULL)
+                return -1;
+            header_size = fill_header(ARM_V4L2_TEST_STREAM_RAW, (char *)f->buf, pframe,j);
+            capture_widen_raw16(f->buf + header_size, buf, pframe->width[j], pframe->height[j], pframe->bytes_per_line[j]);
+            f->size = header_size + buf_padded_size;
+        }else{
+            memcpy(f->buf + f->size, buf, buf_size);
+            f->size += buf_size;
+        }
+        strcpy(cap_mod->last_capture_filename[ARM_V4L2_TEST_STREAM_RAW], f->filename);
     }
-    if(frm==1){
-		finish_frm_file(frm_file);
-	}
 #endif
 
-    free(header);
+    return 0;
+}
+
+#if ARM_V4L2_TEST_HAS_DNG
+/*
+ * DNG capture: copy the frame pack into the slot, libtiff runs on the writer
+ * thread against the copy.
+ */
+static int process_capture_dng_copy(capture_module_t * cap_mod, int index, capture_slot_t *slot) {
+    frame_pack_t *pack = &cap_mod->frame_pack_queue[index];
+    capture_file_t *f;
+    int i, j;
+
+    slot->pack = *pack;
+
+    for (i = 0; i < ARM_V4L2_TEST_STREAM_MAX; i++) {
+        frame_t *pframe = &slot->pack.frame_data[i];
+
+        if (!(pack->frame_flag & ID_TO_FLAG(i)))
+            continue;
+
+        if (pframe->vbuf.type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+            memcpy(slot->planes[i], pframe->vbuf.m.planes, pframe->num_planes * sizeof(struct v4l2_plane));
+            pframe->vbuf.m.planes = slot->planes[i];
+        }
+
+        for (j = 0; j < pframe->num_planes; j++) {
+            uint32_t size = get_plane_bytesused(pframe, j);
+            f = slot_add_file(slot, NULL, size);
+            if (f == NULL)
+                return -1;
+            memcpy(f->buf, pframe->paddr[j], size);
+            f->size = size;
+            pframe->paddr[j] = f->buf;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+static int submit_capture(capture_module_t * cap_mod, int index, capture_type_t type) {
+    capture_slot_t *slot = get_free_slot(cap_mod);
+    int rc = -1;
+
+    slot->type = type;
+    slot->pack.frame_id = cap_mod->frame_pack_queue[index].frame_id;
+
+    switch (type) {
+    case V4L2_TEST_CAPTURE_LEGACY:
+    case V4L2_TEST_CAPTURE_FRM:
+        rc = process_capture_legacy(cap_mod, index, (type == V4L2_TEST_CAPTURE_FRM) ? 1 : 0, slot);
+        break;
+#if ARM_V4L2_TEST_HAS_DNG
+    case V4L2_TEST_CAPTURE_DNG:
+        rc = process_capture_dng_copy(cap_mod, index, slot);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    if (rc == 0)
+        submit_slot(cap_mod);
+
+    return rc;
 }
 
 int enqueue_buffer(capture_module_t *cap_mod, uint32_t stream_type,
@@ -390,10 +566,15 @@ int enqueue_buffer(capture_module_t *cap_mod, uint32_t stream_type,
         switch(try_capture) {
         case V4L2_TEST_CAPTURE_LEGACY:
         case V4L2_TEST_CAPTURE_FRM:
-            process_capture_legacy(cap_mod, index,(try_capture==V4L2_TEST_CAPTURE_FRM)?1:0);
+#if ARM_V4L2_TEST_HAS_DNG
+        case V4L2_TEST_CAPTURE_DNG:
+#endif
+            /* data is copied to a writer slot, buffers go back right away */
+            if (submit_capture(cap_mod, index, try_capture) < 0)
+                ERR("Capture of frame id %d failed !\n", frame_id);
             release_frame_pack(cap_mod, index);
             captured = 1;
-            break; 
+            break;
         default:
             ERR("Capture type is not supported now !");
             break;
@@ -417,6 +598,17 @@ void init_capture_module(capture_module_t * cap_mod) {
     /* init mutex */
     pthread_mutex_init(&cap_mod->vmutex, NULL);
 
+    /* init writer */
+    memset(cap_mod->slot, 0, sizeof(cap_mod->slot));
+    cap_mod->slot_wr = 0;
+    cap_mod->slot_rd = 0;
+    cap_mod->slot_cnt = 0;
+    cap_mod->writer_exit = 0;
+    pthread_mutex_init(&cap_mod->wmutex, NULL);
+    pthread_cond_init(&cap_mod->wcond, NULL);
+    if (pthread_create(&cap_mod->writer, NULL, &capture_writer_thread, cap_mod) != 0)
+        ERR("Error, can't create capture writer thread !\n");
+
     /* init capture history */
     cap_mod->capture_performed = 0;
     cap_mod->last_buf_size = 0;
@@ -450,3 +642,25 @@ void release_capture_module_stream(capture_module_t * cap_mod, int stream_type)
 
     pthread_mutex_unlock(&cap_mod->vmutex);
 }
+
+void release_capture_module(capture_module_t * cap_mod) {
+    int i, j;
+
+    /* let the writer drain pending captures */
+    pthread_mutex_lock(&cap_mod->wmutex);
+    cap_mod->writer_exit = 1;
+    pthread_cond_broadcast(&cap_mod->wcond);
+    pthread_mutex_unlock(&cap_mod->wmutex);
+    pthread_join(cap_mod->writer, NULL);
+
+    for (i = 0; i < FRAME_PACK_QUEUE_SIZE; i++) {
+        for (j = 0; j < CAPTURE_FILE_MAX; j++) {
+            free(cap_mod->slot[i].file[j].buf);
+            cap_mod->slot[i].file[j].buf = NULL;
+            cap_mod->slot[i].file[j].buf_len = 0;
+        }
+    }
+
+    pthread_cond_destroy(&cap_mod->wcond);
+    pthread_mutex_destroy(&cap_mod->wmutex);
+}
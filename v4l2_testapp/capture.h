@@ -51,6 +51,24 @@ typedef struct _frame_pack_t {
     frame_t             frame_data[ARM_V4L2_TEST_STREAM_MAX];
 } frame_pack_t;
 
+#define CAPTURE_FILE_MAX        (ARM_V4L2_TEST_STREAM_MAX * VIDEO_MAX_PLANES)
+
+typedef struct _capture_file_t {
+    char                filename[FILE_NAME_LENGTH];
+    uint8_t             * buf;          /* aligned, kept for the next capture */
+    uint32_t            buf_len;
+    uint32_t            size;
+} capture_file_t;
+
+/* copy of a captured frame_pack waiting for the writer thread */
+typedef struct _capture_slot_t {
+    capture_type_t      type;
+    frame_pack_t        pack;
+    struct v4l2_plane   planes[ARM_V4L2_TEST_STREAM_MAX][VIDEO_MAX_PLANES];
+    capture_file_t      file[CAPTURE_FILE_MAX];
+    int                 file_num;
+} capture_slot_t;
+
 typedef struct _capture_module_t {
     /* frame queue */
     frame_pack_t        frame_pack_queue[FRAME_PACK_QUEUE_SIZE];
@@ -64,10 +82,25 @@ typedef struct _capture_module_t {
 #if ARM_V4L2_TEST_HAS_META
     uint32_t            last_metadata_buf_size;
 #endif
+
+    /* writer thread, fed from a fixed pool of slots */
+    capture_slot_t      slot[FRAME_PACK_QUEUE_SIZE];
+    int                 slot_wr;
+    int                 slot_rd;
+    int                 slot_cnt;
+    pthread_mutex_t     wmutex;
+    pthread_cond_t      wcond;
+    pthread_t           writer;
+    int                 writer_exit;
+    int                 direct_io;
 } capture_module_t;
 
 void init_capture_module(capture_module_t * cap_mod);
+void release_capture_module(capture_module_t * cap_mod);
 void release_capture_module_stream(capture_module_t * cap_mod, int stream_type);
 int  enqueue_buffer(capture_module_t *cap_mod, uint32_t stream_type,
                     frame_t *newframe, capture_type_t try_capture);
+
+void capture_widen_raw16(uint8_t *dst, const uint8_t *src, int width, int height, int src_stride);
+void capture_unpack_raw12(uint32_t *dst, const uint32_t *src, int count);
 #endif
@@ -220,6 +220,48 @@ static void get_dng_opcode2_lsc_gain_map_4ch(uint8_t * dst,
     free(opcode2);
 }
 
+/*
+ * The opcode2 blob only depends on the shading calibration, image size and
+ * CFA order, so it is built and byte swapped once and reused for every frame.
+ */
+typedef struct _dng_opcode2_cache {
+    int             valid;
+    uint32_t        width;
+    uint32_t        height;
+    const uint8_t   *tbl_r;
+    const uint8_t   *tbl_g;
+    const uint8_t   *tbl_b;
+    cfa_order_t     cfa_order;
+    uint8_t         data[sizeof(dng_opcode2_t)];
+} dng_opcode2_cache_t;
+
+static dng_opcode2_cache_t opcode2_cache;
+
+static const uint8_t *get_dng_opcode2_cached(uint32_t width, uint32_t height,
+                                            const uint8_t *tbl_r,
+                                            const uint8_t *tbl_g,
+                                            const uint8_t *tbl_b,
+                                            cfa_order_t cfa_order)
+{
+    dng_opcode2_cache_t *cache = &opcode2_cache;
+
+    if (!cache->valid || cache->width != width || cache->height != height ||
+            cache->tbl_r != tbl_r || cache->tbl_g != tbl_g || cache->tbl_b != tbl_b ||
+            cache->cfa_order != cfa_order) {
+        memset(cache->data, 0x0, sizeof(cache->data));
+        get_dng_opcode2_lsc_gain_map_4ch(cache->data, width, height, tbl_r, tbl_g, tbl_b, cfa_order);
+        cache->width = width;
+        cache->height = height;
+        cache->tbl_r = tbl_r;
+        cache->tbl_g = tbl_g;
+        cache->tbl_b = tbl_b;
+        cache->cfa_order = cfa_order;
+        cache->valid = 1;
+    }
+
+    return cache->data;
+}
+
 void process_capture_dng(frame_pack_t * pframep) {
     int             frame_id = pframep->frame_id;
     char            filename[FILE_NAME_LENGTH];
@@ -394,11 +436,8 @@ void process_capture_dng(frame_pack_t * pframep) {
 		};
 
 		/* OpCodeList2 tag values */
-		uint8_t *opcode2_data = (uint8_t *)malloc(sizeof(dng_opcode2_t));
 		uint32_t opcode2_size = sizeof(dng_opcode2_t);
-		memset(opcode2_data, 0x0, sizeof(dng_opcode2_t));
-		get_dng_opcode2_lsc_gain_map_4ch(
-								opcode2_data,
+		const uint8_t *opcode2_data = get_dng_opcode2_cached(
 								pframe->width[l], pframe->height[l],
 								calibration_shading_ls_d65_r,
 								calibration_shading_ls_d65_g,
@@ -542,9 +581,7 @@ void process_capture_dng(frame_pack_t * pframep) {
 			uint32_t *dst_pos = (uint32_t *)scanline;
 
 			/* bit shiftto remove 0 padding on LSB from Apical RAW12 */
-			for (j = 0; j < linesize / 4; j++) {
-				dst_pos[j] = (src_pos[j] >> 4) & 0x0FFF0FFF;
-			}
+			capture_unpack_raw12(dst_pos, src_pos, linesize / 4);
 			TIFFWriteScanline(tiffout, scanline, i, 0);
 		}
 		free(scanline);
@@ -0,0 +1,469 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include "logs.h"
+#include "capture_engine.h"
+
+uint64_t cap_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static int cap_ioctl(int fd, unsigned long req, void *arg)
+{
+    int rc;
+
+    do {
+        rc = ioctl(fd, req, arg);
+    } while (rc < 0 && errno == EINTR);
+
+    return rc;
+}
+
+/* point the scratch v4l2_buffer at the preallocated planes */
+static struct v4l2_buffer *cap_stream_vbuf(cap_stream_t *st, uint32_t index)
+{
+    memset(&st->vbuf, 0, sizeof(st->vbuf));
+    st->vbuf.index = index;
+    st->vbuf.type = st->type;
+    st->vbuf.memory = V4L2_MEMORY_MMAP;
+    if (st->mplane) {
+        memset(st->planes, 0, sizeof(st->planes));
+        st->vbuf.m.planes = st->planes;
+        st->vbuf.length = st->num_planes;
+    }
+
+    return &st->vbuf;
+}
+
+static int cap_stream_map(cap_stream_t *st)
+{
+    struct v4l2_requestbuffers rb;
+    struct v4l2_buffer *vbuf;
+    int i, j;
+
+    memset(&rb, 0, sizeof(rb));
+    rb.count = st->num_buffers;
+    rb.type = st->type;
+    rb.memory = V4L2_MEMORY_MMAP;
+    if (cap_ioctl(st->fd, VIDIOC_REQBUFS, &rb) < 0) {
+        ERR("[%s] Error: request buffer: %s\n", st->name, strerror(errno));
+        return -1;
+    }
+    if (rb.count < 2 || rb.count > CAP_MAX_BUFFERS) {
+        ERR("[%s] Error: got %u buffers\n", st->name, rb.count);
+        return -1;
+    }
+    st->num_buffers = rb.count;
+
+    for (i = 0; i < st->num_buffers; i++) {
+        vbuf = cap_stream_vbuf(st, i);
+        if (cap_ioctl(st->fd, VIDIOC_QUERYBUF, vbuf) < 0) {
+            ERR("[%s] Error: query buffer %d: %s\n", st->name, i, strerror(errno));
+            return -1;
+        }
+
+        for (j = 0; j < st->num_planes; j++) {
+            struct v4l2_exportbuffer ex_buf;
+            uint32_t len = st->mplane ? vbuf->m.planes[j].length : vbuf->length;
+            uint32_t off = st->mplane ? vbuf->m.planes[j].m.mem_offset : vbuf->m.offset;
+
+            st->mem[i][j] = mmap(0, len, PROT_READ, MAP_SHARED, st->fd, off);
+            if (st->mem[i][j] == MAP_FAILED) {
+                st->mem[i][j] = NULL;
+                ERR("[%s] Error: mmap buffer %d plane %d\n", st->name, i, j);
+                return -1;
+            }
+            st->mem_len[i][j] = len;
+
+            /* dmabuf export is optional, sinks fall back to the mapping */
+            memset(&ex_buf, 0, sizeof(ex_buf));
+            ex_buf.type = st->type;
+            ex_buf.index = i;
+            ex_buf.plane = j;
+            ex_buf.flags = O_CLOEXEC;
+            ex_buf.fd = -1;
+            if (cap_ioctl(st->fd, VIDIOC_EXPBUF, &ex_buf) < 0)
+                ex_buf.fd = -1;
+            st->dma_fd[i][j] = ex_buf.fd;
+        }
+    }
+
+    for (i = 0; i < st->num_buffers; i++) {
+        vbuf = cap_stream_vbuf(st, i);
+        if (cap_ioctl(st->fd, VIDIOC_QBUF, vbuf) < 0) {
+            ERR("[%s] Error: queue buffer %d: %s\n", st->name, i, strerror(errno));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int cap_stream_open(cap_stream_t *st, const char *name, const char *devname,
+        uint32_t width, uint32_t height, uint32_t pixformat, int num_buffers)
+{
+    struct v4l2_capability cap;
+    uint32_t caps;
+    int i, j;
+
+    memset(st, 0, sizeof(*st));
+    snprintf(st->name, sizeof(st->name), "%s", name);
+    for (i = 0; i < CAP_MAX_BUFFERS; i++)
+        for (j = 0; j < VIDEO_MAX_PLANES; j++)
+            st->dma_fd[i][j] = -1;
+
+    st->fd = open(devname, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (st->fd < 0) {
+        ERR("[%s] Error: cannot open %s: %s\n", name, devname, strerror(errno));
+        return -1;
+    }
+
+    memset(&cap, 0, sizeof(cap));
+    if (cap_ioctl(st->fd, VIDIOC_QUERYCAP, &cap) < 0) {
+        ERR("[%s] Error: get capability.\n", name);
+        goto fail;
+    }
+    caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_STREAMING)) {
+        ERR("[%s] Error: %s can't stream\n", name, devname);
+        goto fail;
+    }
+
+    if (caps & V4L2_CAP_VIDEO_CAPTURE_MPLANE) {
+        st->mplane = 1;
+        st->type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    } else if (caps & V4L2_CAP_VIDEO_CAPTURE) {
+        st->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    } else {
+        ERR("[%s] Error: %s is no capture device\n", name, devname);
+        goto fail;
+    }
+
+    st->fmt.type = st->type;
+    if (st->mplane) {
+        st->fmt.fmt.pix_mp.width = width;
+        st->fmt.fmt.pix_mp.height = height;
+        st->fmt.fmt.pix_mp.pixelformat = pixformat;
+        st->fmt.fmt.pix_mp.field = V4L2_FIELD_ANY;
+    } else {
+        st->fmt.fmt.pix.width = width;
+        st->fmt.fmt.pix.height = height;
+        st->fmt.fmt.pix.pixelformat = pixformat;
+        st->fmt.fmt.pix.field = V4L2_FIELD_ANY;
+    }
+
+    if (cap_ioctl(st->fd, VIDIOC_S_FMT, &st->fmt) < 0 ||
+        cap_ioctl(st->fd, VIDIOC_G_FMT, &st->fmt) < 0) {
+        ERR("[%s] Error: set format: %s\n", name, strerror(errno));
+        goto fail;
+    }
+
+    st->num_planes = st->mplane ? st->fmt.fmt.pix_mp.num_planes : 1;
+    if (st->num_planes < 1 || st->num_planes > VIDEO_MAX_PLANES)
+        goto fail;
+
+    st->num_buffers = num_buffers;
+    if (cap_stream_map(st) < 0)
+        goto fail;
+
+    INFO("[%s] %s %ux%u fmt 0x%x, %d planes, %d buffers%s\n", name, devname,
+        st->mplane ? st->fmt.fmt.pix_mp.width : st->fmt.fmt.pix.width,
+        st->mplane ? st->fmt.fmt.pix_mp.height : st->fmt.fmt.pix.height,
+        st->mplane ? st->fmt.fmt.pix_mp.pixelformat : st->fmt.fmt.pix.pixelformat,
+        st->num_planes, st->num_buffers, st->dma_fd[0][0] >= 0 ? ", dmabuf" : "");
+
+    return 0;
+
+fail:
+    cap_stream_close(st);
+    return -1;
+}
+
+int cap_stream_add_sink(cap_stream_t *st, cap_sink_t *sink)
+{
+    if (st->num_sinks >= CAP_MAX_SINKS)
+        return -1;
+
+    st->sinks[st->num_sinks++] = sink;
+    return 0;
+}
+
+void cap_stream_close(cap_stream_t *st)
+{
+    struct v4l2_requestbuffers rb;
+    int i, j;
+
+    if (st->fd < 0)
+        return;
+
+    if (st->streaming) {
+        cap_ioctl(st->fd, VIDIOC_STREAMOFF, &st->type);
+        st->streaming = 0;
+    }
+
+    for (i = 0; i < CAP_MAX_BUFFERS; i++) {
+        for (j = 0; j < VIDEO_MAX_PLANES; j++) {
+            if (st->mem[i][j]) {
+                munmap(st->mem[i][j], st->mem_len[i][j]);
+                st->mem[i][j] = NULL;
+            }
+            if (st->dma_fd[i][j] >= 0) {
+                close(st->dma_fd[i][j]);
+                st->dma_fd[i][j] = -1;
+            }
+        }
+    }
+
+    memset(&rb, 0, sizeof(rb));
+    rb.type = st->type;
+    rb.memory = V4L2_MEMORY_MMAP;
+    if (st->type)
+        cap_ioctl(st->fd, VIDIOC_REQBUFS, &rb);
+
+    close(st->fd);
+    st->fd = -1;
+}
+
+static void cap_stats_frame(cap_stream_t *st, struct v4l2_buffer *vbuf, uint64_t now)
+{
+    cap_stats_t *s = &st->stats;
+
+    if (s->frames && vbuf->sequence > s->last_sequence + 1)
+        s->gaps += vbuf->sequence - s->last_sequence - 1;
+    s->last_sequence = vbuf->sequence;
+
+    if ((vbuf->flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        uint64_t ts = vbuf->timestamp.tv_sec * 1000000ULL + vbuf->timestamp.tv_usec;
+        uint64_t lat = (now > ts) ? now - ts : 0;
+
+        s->latency_total_us += lat;
+        if (lat > s->latency_max_us)
+            s->latency_max_us = lat;
+    }
+
+    s->frames++;
+    s->window_frames++;
+    if (s->window_start_us == 0) {
+        s->window_start_us = now;
+        s->window_frames = 0;
+    } else if (now - s->window_start_us >= 1000000) {
+        s->fps_x100 = s->window_frames * 100000000ULL / (now - s->window_start_us);
+        s->window_start_us = now;
+        s->window_frames = 0;
+    }
+}
+
+void cap_stream_print_stats(cap_stream_t *st)
+{
+    cap_stats_t *s = &st->stats;
+
+    printf("[%s] %llu frames, %u.%02u fps, %llu gaps, %llu errors, dq latency avg %llu us max %llu us\n",
+        st->name, (unsigned long long)s->frames, s->fps_x100 / 100, s->fps_x100 % 100,
+        (unsigned long long)s->gaps, (unsigned long long)s->errors,
+        (unsigned long long)(s->frames ? s->latency_total_us / s->frames : 0),
+        (unsigned long long)s->latency_max_us);
+}
+
+int cap_engine_init(cap_engine_t *eng)
+{
+    memset(eng, 0, sizeof(*eng));
+
+    eng->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (eng->epfd < 0) {
+        ERR("Error: epoll_create1: %s\n", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+int cap_engine_add_stream(cap_engine_t *eng, cap_stream_t *st)
+{
+    struct epoll_event ev;
+
+    if (eng->num_streams >= CAP_MAX_STREAMS || st->fd < 0)
+        return -1;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = st;
+    if (epoll_ctl(eng->epfd, EPOLL_CTL_ADD, st->fd, &ev) < 0) {
+        ERR("[%s] Error: epoll add: %s\n", st->name, strerror(errno));
+        return -1;
+    }
+
+    eng->streams[eng->num_streams++] = st;
+    return 0;
+}
+
+/* also stops the sinks of a stream which failed to start */
+static void cap_engine_finish(cap_engine_t *eng, cap_stream_t *st)
+{
+    int i;
+
+    if (st->streaming) {
+        epoll_ctl(eng->epfd, EPOLL_CTL_DEL, st->fd, NULL);
+        cap_ioctl(st->fd, VIDIOC_STREAMOFF, &st->type);
+        st->streaming = 0;
+        eng->active--;
+    }
+
+    for (i = 0; i < st->sinks_started; i++)
+        if (st->sinks[i]->stop)
+            st->sinks[i]->stop(st->sinks[i], st);
+    st->sinks_started = 0;
+}
+
+/* dequeue everything ready on one stream */
+static void cap_engine_drain(cap_engine_t *eng, cap_stream_t *st)
+{
+    cap_frame_t *f = &st->frame;
+    struct v4l2_buffer *vbuf;
+    uint64_t now;
+    int i;
+
+    while (st->streaming) {
+        vbuf = cap_stream_vbuf(st, 0);
+        if (cap_ioctl(st->fd, VIDIOC_DQBUF, vbuf) < 0) {
+            if (errno != EAGAIN) {
+                st->stats.errors++;
+                ERR("[%s] Error: dequeue buffer: %s\n", st->name, strerror(errno));
+            }
+            return;
+        }
+
+        now = cap_now_us();
+        cap_stats_frame(st, vbuf, now);
+
+        f->vbuf = vbuf;
+        f->index = vbuf->index;
+        f->sequence = vbuf->sequence;
+        f->dq_us = now;
+        f->num_planes = st->num_planes;
+        for (i = 0; i < st->num_planes; i++) {
+            f->plane[i] = st->mem[vbuf->index][i];
+            f->bytes[i] = st->mplane ? vbuf->m.planes[i].bytesused : vbuf->bytesused;
+            f->dma_fd[i] = st->dma_fd[vbuf->index][i];
+        }
+        if (vbuf->flags & V4L2_BUF_FLAG_ERROR)
+            st->stats.errors++;
+
+        for (i = 0; i < st->num_sinks; i++)
+            st->sinks[i]->frame(st->sinks[i], st, f);
+
+        /* sinks may not keep the buffer, it goes straight back */
+        if (cap_ioctl(st->fd, VIDIOC_QBUF, vbuf) < 0) {
+            st->stats.errors++;
+            ERR("[%s] Error: queue buffer: %s\n", st->name, strerror(errno));
+        }
+
+        if (st->max_frames > 0 && st->stats.frames >= (uint64_t)st->max_frames)
+            cap_engine_finish(eng, st);
+    }
+}
+
+int cap_engine_run(cap_engine_t *eng)
+{
+    struct epoll_event events[CAP_MAX_STREAMS];
+    cap_stream_t *st;
+    uint64_t now;
+    int i, j, n;
+    int rc = 0;
+
+    for (i = 0; i < eng->num_streams; i++) {
+        st = eng->streams[i];
+        for (j = 0; j < st->num_sinks; j++) {
+            if (st->sinks[j]->start && st->sinks[j]->start(st->sinks[j], st) < 0) {
+                ERR("[%s] Error: sink %s failed to start\n", st->name, st->sinks[j]->name);
+                rc = -1;
+                goto stop;
+            }
+            st->sinks_started = j + 1;
+        }
+        if (cap_ioctl(st->fd, VIDIOC_STREAMON, &st->type) < 0) {
+            ERR("[%s] Error: streamon: %s\n", st->name, strerror(errno));
+            rc = -1;
+            goto stop;
+        }
+        st->streaming = 1;
+        eng->active++;
+    }
+
+    eng->last_stats_us = cap_now_us();
+
+    while (!eng->stop && eng->active > 0) {
+        n = epoll_wait(eng->epfd, events, CAP_MAX_STREAMS, 1000);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            ERR("Error: epoll_wait: %s\n", strerror(errno));
+            rc = -1;
+            break;
+        }
+
+        for (i = 0; i < n; i++) {
+            st = events[i].data.ptr;
+            if (events[i].events & EPOLLERR) {
+                st->stats.errors++;
+                ERR("[%s] Error: device error, stopping stream\n", st->name);
+                cap_engine_finish(eng, st);
+                rc = -1;
+                continue;
+            }
+            cap_engine_drain(eng, st);
+        }
+
+        now = cap_now_us();
+        if (eng->stats_period_ms > 0 &&
+            now - eng->last_stats_us >= (uint64_t)eng->stats_period_ms * 1000) {
+            for (i = 0; i < eng->num_streams; i++)
+                cap_stream_print_stats(eng->streams[i]);
+            eng->last_stats_us = now;
+        }
+    }
+
+stop:
+    for (i = 0; i < eng->num_streams; i++)
+        cap_engine_finish(eng, eng->streams[i]);
+
+    return rc;
+}
+
+void cap_engine_stop(cap_engine_t *eng)
+{
+    eng->stop = 1;
+}
+
+void cap_engine_release(cap_engine_t *eng)
+{
+    if (eng->epfd >= 0)
+        close(eng->epfd);
+    eng->epfd = -1;
+    eng->num_streams = 0;
+}
@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#ifndef __CAPTURE_ENGINE_H__
+#define __CAPTURE_ENGINE_H__
+/*
+ * Multi-stream capture engine.
+ *
+ * One thread and one epoll set drive every stream: a stream is a video
+ * node opened, formatted and mmap'ed up front, with its v4l2_buffer and
+ * plane arrays allocated once. Each dequeued frame is handed to the sinks
+ * of its stream in order and queued back when the last one returns, so
+ * nothing is allocated per frame. Works against any mmap capable capture
+ * node, the vivid driver included.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <linux/videodev2.h>
+
+#define CAP_MAX_STREAMS     8
+#define CAP_MAX_BUFFERS     8
+#define CAP_MAX_SINKS       4
+
+struct cap_stream;
+
+typedef struct cap_frame {
+    struct v4l2_buffer  *vbuf;
+    uint32_t            index;
+    uint32_t            sequence;
+    uint64_t            dq_us;              /* dequeue time, monotonic */
+    int                 num_planes;
+    void                *plane[VIDEO_MAX_PLANES];
+    uint32_t            bytes[VIDEO_MAX_PLANES];
+    int                 dma_fd[VIDEO_MAX_PLANES];
+} cap_frame_t;
+
+/* frame consumer, attached to one or more streams */
+typedef struct cap_sink {
+    const char          *name;
+    int                 (*start)(struct cap_sink *sink, struct cap_stream *st);
+    void                (*frame)(struct cap_sink *sink, struct cap_stream *st, cap_frame_t *f);
+    void                (*stop)(struct cap_sink *sink, struct cap_stream *st);
+    void                *priv;
+} cap_sink_t;
+
+typedef struct cap_stats {
+    uint64_t            frames;
+    uint64_t            gaps;               /* frames missing from v4l2_buffer.sequence */
+    uint64_t            errors;
+    uint64_t            latency_total_us;   /* buffer timestamp to dequeue */
+    uint64_t            latency_max_us;
+    uint32_t            last_sequence;
+
+    /* fps window */
+    uint64_t            window_start_us;
+    uint64_t            window_frames;
+    uint32_t            fps_x100;
+} cap_stats_t;
+
+typedef struct cap_stream {
+    char                name[16];
+    int                 fd;
+    int                 mplane;
+    uint32_t            type;
+    struct v4l2_format  fmt;
+    int                 num_planes;
+    int                 num_buffers;
+    int                 max_frames;         /* stop after this many, <= 0 forever */
+    int                 streaming;
+
+    void                *mem[CAP_MAX_BUFFERS][VIDEO_MAX_PLANES];
+    uint32_t            mem_len[CAP_MAX_BUFFERS][VIDEO_MAX_PLANES];
+    int                 dma_fd[CAP_MAX_BUFFERS][VIDEO_MAX_PLANES];
+
+    /* dqbuf/qbuf scratch, reused for every frame */
+    struct v4l2_buffer  vbuf;
+    struct v4l2_plane   planes[VIDEO_MAX_PLANES];
+    cap_frame_t         frame;
+
+    cap_sink_t          *sinks[CAP_MAX_SINKS];
+    int                 num_sinks;
+    int                 sinks_started;      /* sinks to stop, in order */
+    cap_stats_t         stats;
+} cap_stream_t;
+
+typedef struct cap_engine {
+    int                 epfd;
+    cap_stream_t        *streams[CAP_MAX_STREAMS];
+    int                 num_streams;
+    int                 active;             /* streams not done yet */
+    volatile int        stop;
+    int                 stats_period_ms;    /* print stats this often, 0 never */
+    uint64_t            last_stats_us;
+} cap_engine_t;
+
+/* stream setup, buffers are requested, mapped and queued by open */
+int  cap_stream_open(cap_stream_t *st, const char *name, const char *devname,
+        uint32_t width, uint32_t height, uint32_t pixformat, int num_buffers);
+int  cap_stream_add_sink(cap_stream_t *st, cap_sink_t *sink);
+void cap_stream_close(cap_stream_t *st);
+void cap_stream_print_stats(cap_stream_t *st);
+
+/* event loop, run returns -1 when a stream failed to start or ended on an error */
+int  cap_engine_init(cap_engine_t *eng);
+int  cap_engine_add_stream(cap_engine_t *eng, cap_stream_t *st);
+int  cap_engine_run(cap_engine_t *eng);
+void cap_engine_stop(cap_engine_t *eng);
+void cap_engine_release(cap_engine_t *eng);
+
+/* stock sinks, embed the sink state and add &x.sink to the stream */
+struct renderer;
+struct gdc_usr_ctx_s;
+
+typedef struct cap_file_sink {
+    cap_sink_t          sink;
+    FILE                *fp;
+    int                 every_nth;          /* write one frame out of n */
+    uint64_t            count;
+} cap_file_sink_t;
+
+typedef struct cap_display_sink {
+    cap_sink_t          sink;
+    struct renderer     *r;
+} cap_display_sink_t;
+
+typedef struct cap_gdc_sink {
+    cap_sink_t          sink;
+    struct gdc_usr_ctx_s *ctx;              /* set up by gdc_handle_init_cfg() or alike */
+    struct renderer     *display;           /* draw the gdc output, may be NULL */
+    uint64_t            done;
+    uint64_t            failed;
+} cap_gdc_sink_t;
+
+void cap_sink_null_init(cap_sink_t *sink);
+void cap_sink_file_init(cap_file_sink_t *fs, FILE *fp, int every_nth);
+void cap_sink_display_init(cap_display_sink_t *ds, struct renderer *r);
+void cap_sink_gdc_init(cap_gdc_sink_t *gs, struct gdc_usr_ctx_s *ctx, struct renderer *display);
+
+uint64_t cap_now_us(void);
+
+#endif // __CAPTURE_ENGINE_H__
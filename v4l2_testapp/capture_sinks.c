@@ -0,0 +1,178 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <linux/videodev2.h>
+
+#include "common.h"
+#include "logs.h"
+#include "renderer.h"
+#include "gdc_api.h"
+#include "capture_engine.h"
+
+/* null: frames are dropped, only the stream statistics remain */
+static void cap_null_frame(cap_sink_t *sink, cap_stream_t *st, cap_frame_t *f)
+{
+}
+
+void cap_sink_null_init(cap_sink_t *sink)
+{
+    memset(sink, 0, sizeof(*sink));
+    sink->name = "null";
+    sink->frame = cap_null_frame;
+}
+
+/* file: planes of every nth frame appended to one file */
+static void cap_file_frame(cap_sink_t *sink, cap_stream_t *st, cap_frame_t *f)
+{
+    cap_file_sink_t *fs = (cap_file_sink_t *)sink;
+    int i;
+
+    if (fs->count++ % fs->every_nth)
+        return;
+
+    for (i = 0; i < f->num_planes; i++) {
+        if (fwrite(f->plane[i], f->bytes[i], 1, fs->fp) != 1) {
+            ERR("[%s] Error: file sink write failed\n", st->name);
+            return;
+        }
+    }
+}
+
+static void cap_file_stop(cap_sink_t *sink, cap_stream_t *st)
+{
+    fflush(((cap_file_sink_t *)sink)->fp);
+}
+
+void cap_sink_file_init(cap_file_sink_t *fs, FILE *fp, int every_nth)
+{
+    memset(fs, 0, sizeof(*fs));
+    fs->sink.name = "file";
+    fs->sink.frame = cap_file_frame;
+    fs->sink.stop = cap_file_stop;
+    fs->fp = fp;
+    fs->every_nth = every_nth > 0 ? every_nth : 1;
+}
+
+/* display: converted straight from the capture planes into the fb */
+static void cap_frame_image(cap_stream_t *st, cap_frame_t *f, image_info_t *img)
+{
+    memset(img, 0, sizeof(*img));
+    img->ptr = f->plane[0];
+    if (st->mplane) {
+        img->width = st->fmt.fmt.pix_mp.width;
+        img->height = st->fmt.fmt.pix_mp.height;
+        img->stride = st->fmt.fmt.pix_mp.plane_fmt[0].bytesperline;
+        img->fmt = st->fmt.fmt.pix_mp.pixelformat;
+        if (f->num_planes > 1)
+            img->uv = f->plane[1];
+    } else {
+        img->width = st->fmt.fmt.pix.width;
+        img->height = st->fmt.fmt.pix.height;
+        img->stride = st->fmt.fmt.pix.bytesperline;
+        img->fmt = st->fmt.fmt.pix.pixelformat;
+    }
+
+    /* single plane nv12 keeps uv right after y */
+    if (img->fmt == V4L2_PIX_FMT_NV12 && img->uv == NULL)
+        img->uv = img->ptr + (img->stride ? img->stride : img->width) * img->height;
+}
+
+static int cap_display_start(cap_sink_t *sink, cap_stream_t *st)
+{
+    uint32_t fmt = st->mplane ? st->fmt.fmt.pix_mp.pixelformat : st->fmt.fmt.pix.pixelformat;
+
+    if (fmt != V4L2_PIX_FMT_NV12 && fmt != V4L2_PIX_FMT_RGB24 && fmt != ISP_V4L2_PIX_FMT_RGB24) {
+        ERR("[%s] Error: display sink can't show fmt 0x%x\n", st->name, fmt);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void cap_display_frame(cap_sink_t *sink, cap_stream_t *st, cap_frame_t *f)
+{
+    cap_display_sink_t *ds = (cap_display_sink_t *)sink;
+    image_info_t img;
+
+    cap_frame_image(st, f, &img);
+    renderer_draw(ds->r, &img, AFD_RENDER_MODE_CENTER);
+}
+
+void cap_sink_display_init(cap_display_sink_t *ds, struct renderer *r)
+{
+    memset(ds, 0, sizeof(*ds));
+    ds->sink.name = "display";
+    ds->sink.start = cap_display_start;
+    ds->sink.frame = cap_display_frame;
+    ds->r = r;
+}
+
+/* gdc: dmabuf input when the planes were exported, copy input otherwise */
+static void cap_gdc_frame(cap_sink_t *sink, cap_stream_t *st, cap_frame_t *f)
+{
+    cap_gdc_sink_t *gs = (cap_gdc_sink_t *)sink;
+    gdc_config_t *cfg = &gs->ctx->gs.gdc_config;
+    image_info_t img;
+    int rc;
+
+    if (f->num_planes > 1 && f->dma_fd[0] >= 0 && f->dma_fd[1] >= 0)
+        rc = gdc_process_dma(gs->ctx, f->dma_fd[0], f->dma_fd[1]);
+    else if (f->num_planes > 1)
+        rc = gdc_process_copy(gs->ctx, f->plane[0], f->bytes[0], f->plane[1], f->bytes[1]);
+    else if (f->bytes[0] > cfg->input_y_stride * cfg->input_height)
+        rc = gdc_process_copy(gs->ctx, f->plane[0], cfg->input_y_stride * cfg->input_height,
+            (char *)f->plane[0] + cfg->input_y_stride * cfg->input_height,
+            f->bytes[0] - cfg->input_y_stride * cfg->input_height);
+    else
+        rc = gdc_process_copy(gs->ctx, f->plane[0], f->bytes[0], NULL, 0);
+
+    if (rc < 0) {
+        gs->failed++;
+        return;
+    }
+    gs->done++;
+
+    if (gs->display == NULL || cfg->format != NV12)
+        return;
+
+    memset(&img, 0, sizeof(img));
+    img.ptr = (unsigned char *)gs->ctx->o_buff;
+    img.uv = img.ptr + cfg->output_y_stride * cfg->output_height;
+    img.width = cfg->output_width;
+    img.height = cfg->output_height;
+    img.stride = cfg->output_y_stride;
+    img.fmt = V4L2_PIX_FMT_NV12;
+    renderer_draw(gs->display, &img, AFD_RENDER_MODE_CENTER);
+}
+
+static void cap_gdc_stop(cap_sink_t *sink, cap_stream_t *st)
+{
+    cap_gdc_sink_t *gs = (cap_gdc_sink_t *)sink;
+
+    INFO("[%s] gdc: %llu frames, %llu failed\n", st->name,
+        (unsigned long long)gs->done, (unsigned long long)gs->failed);
+}
+
+void cap_sink_gdc_init(cap_gdc_sink_t *gs, struct gdc_usr_ctx_s *ctx, struct renderer *display)
+{
+    memset(gs, 0, sizeof(*gs));
+    gs->sink.name = "gdc";
+    gs->sink.frame = cap_gdc_frame;
+    gs->sink.stop = cap_gdc_stop;
+    gs->ctx = ctx;
+    gs->display = display;
+}
@@ -26,6 +26,7 @@
 /* feature definitions */
 #define ARM_V4L2_TEST_HAS_META  1
 #define ARM_V4L2_TEST_HAS_RAW   0
+#define ARM_V4L2_TEST_HAS_DNG   0   /* needs capture_dng.c and libtiff */
 
 #define CONVERT_RAW_4_TO_2      1
 #define TIFF_USE_EXIF           1
@@ -27,11 +27,26 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
 
 #include "gdc_api.h"
+#include "gdc_model.h"
+
+static unsigned long long gdc_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
 
 int gdc_create_ctx(struct gdc_usr_ctx_s *ctx)
 {
+    if (ctx->use_model) {
+        ctx->gdc_client = -1;
+        return 0;
+    }
+
     ctx->gdc_client = open("/dev/gdc", O_RDWR);
 
     if (ctx->gdc_client < 0)
@@ -86,6 +101,33 @@ int gdc_alloc_dma_buffer (struct gdc_usr_ctx_s *ctx,
 	buf_cfg.type = type;
 	buf_cfg.len = len;
 
+	if (ctx->use_model) {
+		void *p = gdc_model_alloc(len);
+
+		if (p == NULL) {
+			printf("%s: model alloc failed\n", __func__);
+			return -1;
+		}
+		switch (type) {
+		case INPUT_BUFF_TYPE:
+			ctx->i_len = len;
+			ctx->i_buff = p;
+			return 0;
+		case OUTPUT_BUFF_TYPE:
+			ctx->o_len = len;
+			ctx->o_buff = p;
+			return 0;
+		case CONFIG_BUFF_TYPE:
+			ctx->c_len = len;
+			ctx->c_buff = p;
+			return 0;
+		default:
+			munmap(p, len);
+			printf("Error no such buff type\n");
+			return -1;
+		}
+	}
+
 	ret = ioctl(ctx->gdc_client, GDC_REQUEST_BUFF, &buf_cfg);
     if (ret < 0) {
         printf("%s failed: %s\n", __func__, strerror(ret));
@@ -137,6 +179,9 @@ int gdc_process(struct gdc_usr_ctx_s *ctx)
     int ret = 0;
     struct gdc_settings *gs = &ctx->gs;
 
+    if (ctx->use_model)
+        return gdc_model_run(ctx);
+
     ret = ioctl(ctx->gdc_client, GDC_RUN, gs);
     if (ret < 0)
         printf("GDC_PROCESS ioctl failed\n");
@@ -149,9 +194,62 @@ int gdc_handle(struct gdc_usr_ctx_s *ctx)
     int ret = 0;
     struct gdc_settings *gs = &ctx->gs;
 
+    if (ctx->use_model)
+        return gdc_model_handle(ctx);
+
     ret = ioctl(ctx->gdc_client, GDC_HANDLE, gs);
     if (ret < 0)
         printf("GDC_HANDLE ioctl failed\n");
 
     return ret;
 }
+
+int gdc_process_dma(struct gdc_usr_ctx_s *ctx, int y_fd, int uv_fd)
+{
+    unsigned long long start;
+    int ret;
+
+    if (y_fd < 0 || (ctx->gs.gdc_config.format == NV12 && uv_fd < 0)) {
+        printf("%s: invalid dma buf fd %d/%d\n", __func__, y_fd, uv_fd);
+        return -1;
+    }
+
+    ctx->gs.in_fd = y_fd;
+    ctx->gs.y_base_fd = y_fd;
+    ctx->gs.uv_base_fd = uv_fd;
+
+    start = gdc_now_us();
+    ret = gdc_handle(ctx);
+    ctx->time.run_us += gdc_now_us() - start;
+    ctx->time.frames++;
+
+    return ret;
+}
+
+int gdc_process_copy(struct gdc_usr_ctx_s *ctx, const void *y, size_t y_len,
+			const void *uv, size_t uv_len)
+{
+    struct gdc_config *cfg = &ctx->gs.gdc_config;
+    size_t uv_offset = cfg->input_y_stride * cfg->input_height;
+    unsigned long long start;
+    int ret;
+
+    if (ctx->i_buff == NULL || y_len > uv_offset ||
+            uv_offset + (uv ? uv_len : 0) > ctx->i_len) {
+        printf("%s: input does not fit the gdc input buffer\n", __func__);
+        return -1;
+    }
+
+    start = gdc_now_us();
+    memcpy(ctx->i_buff, y, y_len);
+    if (uv)
+        memcpy(ctx->i_buff + uv_offset, uv, uv_len);
+    ctx->time.copy_us += gdc_now_us() - start;
+
+    start = gdc_now_us();
+    ret = gdc_process(ctx);
+    ctx->time.run_us += gdc_now_us() - start;
+    ctx->time.frames++;
+
+    return ret;
+}
@@ -99,10 +99,18 @@ struct gdc_buf_cfg {
 	unsigned long len;
 };
 
+// accumulated time of each stage of the gdc path, in microseconds
+struct gdc_stage_time {
+	unsigned long long copy_us;	//input copy into i_buff (copy path only)
+	unsigned long long run_us;	//gdc job, from submit to done
+	unsigned long frames;
+};
+
 struct gdc_usr_ctx_s {
     //TODO  currently donot support multi-context
     int gdc_client;
     int ion_client;
+    int use_model;		//run jobs on the cpu model instead of /dev/gdc
     struct gdc_settings gs;
 	char *i_buff;
 	char *o_buff;
@@ -110,6 +118,7 @@ struct gdc_usr_ctx_s {
 	unsigned long i_len;
 	unsigned long o_len;
 	unsigned long c_len;
+	struct gdc_stage_time time;
 };
 
 /**
@@ -145,6 +154,46 @@ int gdc_init(struct gdc_usr_ctx_s *ctx, struct gdc_settings *gs);
  */
 int gdc_process(struct gdc_usr_ctx_s *ctx);
 
+/**
+ *   This function runs gdc on buffers which are referenced by dmabuf fds,
+ *   the output is written into ctx->o_buff
+ *
+ *   @param  ctx - contains client of gdc and ion.
+ *
+ *   @return 0 - success
+ *           -1 - no interrupt from GDC.
+ */
+int gdc_handle(struct gdc_usr_ctx_s *ctx);
+
+/**
+ *   Zero copy input: runs gdc directly on the exported (VIDIOC_EXPBUF) planes
+ *   of a capture buffer.
+ *
+ *   @param  ctx   - contains client of gdc and ion.
+ *   @param  y_fd  - dmabuf fd of the y (or only) plane
+ *   @param  uv_fd - dmabuf fd of the uv plane, -1 for single plane formats
+ *
+ *   @return 0 - success
+ *           -1 - fail
+ */
+int gdc_process_dma(struct gdc_usr_ctx_s *ctx, int y_fd, int uv_fd);
+
+/**
+ *   Copy input: copies the planes into the gdc input buffer (ctx->i_buff)
+ *   and runs gdc on it. Used when the capture buffers can't be exported.
+ *
+ *   @param  ctx    - contains client of gdc and ion.
+ *   @param  y      - y plane
+ *   @param  y_len  - y plane size
+ *   @param  uv     - uv plane, NULL for single plane formats
+ *   @param  uv_len - uv plane size
+ *
+ *   @return 0 - success
+ *           -1 - fail
+ */
+int gdc_process_copy(struct gdc_usr_ctx_s *ctx, const void *y, size_t y_len,
+			const void *uv, size_t uv_len);
+
 /**
  *   This function points gdc to its input resolution and yuv address and offsets
  *
@@ -0,0 +1,80 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "gdc_api.h"
+#include "gdc_model.h"
+
+int gdc_model_run(struct gdc_usr_ctx_s *ctx)
+{
+	gdc_config_t *cfg = &ctx->gs.gdc_config;
+	struct gdc_model_plane in[GDC_MODEL_MAX_PLANES];
+	struct gdc_model_plane out[GDC_MODEL_MAX_PLANES];
+
+	// the copy path packs the chroma planes right after the y plane
+	gdc_model_split(cfg, 0, ctx->i_buff, ctx->i_len, in);
+	gdc_model_split(cfg, 1, ctx->o_buff, ctx->o_len, out);
+
+	return gdc_model_process(cfg, in, out);
+}
+
+static int gdc_model_map_fd(int fd, struct gdc_model_plane *plane)
+{
+	off_t size;
+	void *p;
+
+	size = lseek(fd, 0, SEEK_END);
+	if (size <= 0)
+		return -1;
+
+	p = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED) {
+		printf("gdc model: failed to map fd %d: %s\n", fd, strerror(errno));
+		return -1;
+	}
+
+	plane->base = p;
+	plane->len = size;
+	return 0;
+}
+
+int gdc_model_handle(struct gdc_usr_ctx_s *ctx)
+{
+	struct gdc_settings *gs = &ctx->gs;
+	int fds[GDC_MODEL_MAX_PLANES] = { gs->y_base_fd, gs->uv_base_fd, gs->v_base_fd };
+	struct gdc_model_plane in[GDC_MODEL_MAX_PLANES];
+	struct gdc_model_plane out[GDC_MODEL_MAX_PLANES];
+	int n = gdc_model_planes(&gs->gdc_config);
+	int mapped, ret = -1;
+
+	// each plane is bounded by the size of its dmabuf
+	for (mapped = 0; mapped < n; mapped++)
+		if (gdc_model_map_fd(fds[mapped], &in[mapped]) < 0)
+			goto unmap;
+
+	gdc_model_split(&gs->gdc_config, 1, ctx->o_buff, ctx->o_len, out);
+	ret = gdc_model_process(&gs->gdc_config, in, out);
+
+unmap:
+	while (mapped--)
+		munmap(in[mapped].base, in[mapped].len);
+
+	return ret;
+}
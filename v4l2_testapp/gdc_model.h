@@ -0,0 +1,34 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+#ifndef __GDC_MODEL_H__
+#define __GDC_MODEL_H__
+
+/*
+ * CPU stand-in for /dev/gdc.
+ *
+ * It accepts the same settings as the driver and runs the job on the CPU
+ * model shared with cma_gdc_test (gdc_test/cma_gdc_test/gdc_model_core.h),
+ * so the zero copy (dmabuf) and the copy input paths can be exercised
+ * without the GDC hardware.
+ */
+
+#include "gdc_model_core.h"
+
+struct gdc_usr_ctx_s;
+
+int gdc_model_run(struct gdc_usr_ctx_s *ctx);
+int gdc_model_handle(struct gdc_usr_ctx_s *ctx);
+
+#endif
@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+
+
+#ifndef __ISP_META_RING_H__
+#define __ISP_META_RING_H__
+/*
+ * Header-only reader for the kernel metadata ring.
+ *
+ * The driver keeps the metadata of the last ISP_META_RING_SLOTS frames in a
+ * ring which any process can mmap read-only from the video node. Records are
+ * indexed by frame id, so a 3A or analytics process picks the metadata of
+ * exactly the frame it is looking at without owning the META stream.
+ *
+ * Layout mirrors isp-v4l2-meta-ring.h in the kernel module.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define ISP_V4L2_META_RING_MMAP_OFFSET  (1UL << 30)
+
+#define ISP_META_RING_MAGIC             0x474E524D  /* 'MRNG' */
+#define ISP_META_RING_VERSION           1
+#define ISP_META_RING_SLOTS             64
+#define ISP_META_RING_RECORD_SIZE       512
+#define ISP_META_RING_RETRY             16
+
+typedef struct _isp_meta_ring_hdr_t {
+    uint32_t            magic;
+    uint32_t            version;
+    uint32_t            num_slots;
+    uint32_t            record_size;
+    uint32_t            records_offset;
+    uint32_t            payload_size;
+    uint32_t            write_count;
+    uint32_t            last_frame_id;
+} isp_meta_ring_hdr_t;
+
+typedef struct _isp_meta_ring_record_t {
+    uint32_t            seq;
+    uint32_t            frame_id;
+    uint32_t            ctx_num;
+    uint32_t            reserved;
+    uint8_t             payload[ISP_META_RING_RECORD_SIZE - 4 * sizeof(uint32_t)];
+} isp_meta_ring_record_t;
+
+typedef struct _isp_meta_ring_t {
+    void                        *base;
+    size_t                      size;
+    const isp_meta_ring_hdr_t   *hdr;
+    const isp_meta_ring_record_t *records;
+} isp_meta_ring_t;
+
+static inline uint32_t isp_meta_ring_load(const uint32_t *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+/* map the ring of an opened video node, returns 0 on success */
+static inline int isp_meta_ring_open(isp_meta_ring_t *ring, int fd)
+{
+    size_t size = sysconf(_SC_PAGESIZE) + ISP_META_RING_SLOTS * ISP_META_RING_RECORD_SIZE;
+    void *base;
+
+    memset(ring, 0, sizeof(*ring));
+
+    base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, ISP_V4L2_META_RING_MMAP_OFFSET);
+    if (base == MAP_FAILED)
+        return -1;
+
+    ring->base = base;
+    ring->size = size;
+    ring->hdr = (const isp_meta_ring_hdr_t *)base;
+
+    if (ring->hdr->magic != ISP_META_RING_MAGIC || ring->hdr->version != ISP_META_RING_VERSION ||
+        ring->hdr->record_size != ISP_META_RING_RECORD_SIZE ||
+        ring->hdr->records_offset + ring->hdr->num_slots * ring->hdr->record_size > size) {
+        munmap(base, size);
+        memset(ring, 0, sizeof(*ring));
+        return -1;
+    }
+
+    ring->records = (const isp_meta_ring_record_t *)((const uint8_t *)base + ring->hdr->records_offset);
+
+    return 0;
+}
+
+static inline void isp_meta_ring_close(isp_meta_ring_t *ring)
+{
+    if (ring->base)
+        munmap(ring->base, ring->size);
+    memset(ring, 0, sizeof(*ring));
+}
+
+/* frame id of the newest record, valid once isp_meta_ring_count() is non zero */
+static inline uint32_t isp_meta_ring_latest(const isp_meta_ring_t *ring)
+{
+    return isp_meta_ring_load(&ring->hdr->last_frame_id);
+}
+
+static inline uint32_t isp_meta_ring_count(const isp_meta_ring_t *ring)
+{
+    return isp_meta_ring_load(&ring->hdr->write_count);
+}
+
+/*
+ * Copy up to size bytes of the metadata of frame_id into buf.
+ * Returns the number of bytes copied, 0 when the frame is not (or no longer)
+ * in the ring and -1 when the writer kept the slot busy for every retry.
+ */
+static inline int isp_meta_ring_read(const isp_meta_ring_t *ring, uint32_t frame_id, void *buf, uint32_t size)
+{
+    const isp_meta_ring_record_t *rec = &ring->records[frame_id & (ring->hdr->num_slots - 1)];
+    uint32_t payload_size;
+    uint32_t seq;
+    int i;
+
+    for (i = 0; i < ISP_META_RING_RETRY; i++) {
+        seq = isp_meta_ring_load(&rec->seq);
+        if (seq & 1)
+            continue;
+        if (seq == 0 || rec->frame_id != frame_id)
+            return 0;
+
+        payload_size = ring->hdr->payload_size;
+        if (size > payload_size)
+            size = payload_size;
+        memcpy(buf, rec->payload, size);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (isp_meta_ring_load(&rec->seq) == seq)
+            return size;
+    }
+
+    return -1;
+}
+
+#endif // __ISP_META_RING_H__
@@ -16,93 +16,395 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <linux/fb.h>
 #include <linux/videodev2.h>
 
 #include "common.h"
+#include "logs.h"
 #include "renderer.h"
 
-int renderImage(unsigned char *dst, struct fb_var_screeninfo vinfo, struct fb_fix_screeninfo finfo,
-    unsigned char *src, int width, int height, render_mode_t mode, int fb_fd, int fb_index)
+/* 4 pixels per step, one 128 bit neon / sse register per colour */
+#define RENDER_LANES 4
+typedef int32_t render_v4 __attribute__((vector_size(RENDER_LANES * 4)));
+
+struct render_pix {
+    int bytes;                  /* bytes per fb pixel, 3 or 4 */
+    int r, g, b;                /* byte position of each colour */
+    int a;                      /* byte position of alpha, -1 without */
+};
+
+static unsigned long long render_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void render_pix_init(struct render_pix *pix, struct fb_var_screeninfo *vinfo)
+{
+    pix->bytes = vinfo->bits_per_pixel / 8;
+    pix->r = vinfo->red.offset / 8;
+    pix->g = vinfo->green.offset / 8;
+    pix->b = vinfo->blue.offset / 8;
+    pix->a = (vinfo->transp.length && pix->bytes == 4) ? vinfo->transp.offset / 8 : -1;
+
+    /* 32bpp without alpha: fill the spare byte anyway */
+    if (pix->bytes == 4 && pix->a < 0)
+        pix->a = 6 - pix->r - pix->g - pix->b;
+}
+
+static inline void render_put(unsigned char *dst, const struct render_pix *pix,
+    int r, int g, int b)
+{
+    dst[pix->r] = r;
+    dst[pix->g] = g;
+    dst[pix->b] = b;
+    if (pix->a >= 0)
+        dst[pix->a] = 0xff;
+}
+
+static inline int render_clamp(int v)
+{
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static inline render_v4 render_clamp_v4(render_v4 v)
+{
+    const render_v4 max = { 255, 255, 255, 255 };
+    render_v4 over = v > max;
+
+    v &= ~(v >> 31);
+    return (v & ~over) | (max & over);
+}
+
+/* bt.601 limited range, 8 bit fixed point */
+static void render_nv12_line(unsigned char *dst, const struct render_pix *pix,
+    const unsigned char *y, const unsigned char *uv, int w)
+{
+    int i = 0, k;
+
+    for (; i + RENDER_LANES <= w; i += RENDER_LANES) {
+        render_v4 c, d, e, r, g, b;
+
+        for (k = 0; k < RENDER_LANES; k++) {
+            c[k] = y[i + k] - 16;
+            d[k] = uv[(i + k) & ~1] - 128;
+            e[k] = uv[((i + k) & ~1) + 1] - 128;
+        }
+
+        c *= 298;
+        r = render_clamp_v4((c + 409 * e + 128) >> 8);
+        g = render_clamp_v4((c - 100 * d - 208 * e + 128) >> 8);
+        b = render_clamp_v4((c + 516 * d + 128) >> 8);
+
+        for (k = 0; k < RENDER_LANES; k++)
+            render_put(dst + (i + k) * pix->bytes, pix, r[k], g[k], b[k]);
+    }
+
+    for (; i < w; i++) {
+        int c = 298 * (y[i] - 16);
+        int d = uv[i & ~1] - 128;
+        int e = uv[(i & ~1) + 1] - 128;
+
+        render_put(dst + i * pix->bytes, pix,
+            render_clamp((c + 409 * e + 128) >> 8),
+            render_clamp((c - 100 * d - 208 * e + 128) >> 8),
+            render_clamp((c + 516 * d + 128) >> 8));
+    }
+}
+
+static void render_rgb24_line(unsigned char *dst, const struct render_pix *pix,
+    const unsigned char *src, int w)
+{
+    int i;
+
+    if (pix->bytes == 3 && pix->r == 0 && pix->g == 1 && pix->b == 2) {
+        memcpy(dst, src, w * 3);
+        return;
+    }
+
+    for (i = 0; i < w; i++)
+        render_put(dst + i * pix->bytes, pix, src[3 * i], src[3 * i + 1], src[3 * i + 2]);
+}
+
+static int render_rect_inside(const render_rect_t *in, const render_rect_t *out)
+{
+    return in->x >= out->x && in->y >= out->y &&
+        in->x + in->w <= out->x + out->w &&
+        in->y + in->h <= out->y + out->h;
+}
+
+static void render_clear_rect(renderer_t *r, unsigned char *page, const render_rect_t *rc)
+{
+    int bytes = r->vinfo.bits_per_pixel / 8;
+    int j;
+
+    for (j = 0; j < rc->h; j++)
+        memset(page + (rc->y + j) * r->finfo.line_length + rc->x * bytes, 0, rc->w * bytes);
+}
+
+static int renderer_setup(renderer_t *r, int buffers)
 {
-    int i, j;
-    int src_x, src_y, dst_x, dst_y, w, h;
-	int k;
-    int pos_src = 0, pos_dst = 0;
-    int bit_depth = vinfo.bits_per_pixel / 8;
+    if (buffers < 1)
+        buffers = 1;
+    if (buffers > RENDERER_MAX_BUFFERS)
+        buffers = RENDERER_MAX_BUFFERS;
+
+    r->buffers = buffers;
+    r->back = 0;
+    r->front = -1;
+    memset(r->drawn, 0, sizeof(r->drawn));
+    pthread_mutex_init(&r->lock, NULL);
+
+    return 0;
+}
+
+int renderer_open(renderer_t *r, const char *fbdev, int buffers)
+{
+    int pages;
+
+    memset(r, 0, sizeof(*r));
+
+    r->fd = open(fbdev, O_RDWR);
+    if (r->fd == -1) {
+        printf("Error: cannot open framebuffer device\n");
+        return -1;
+    }
+    MSG("The %s device was opened successfully.\n", fbdev);
+
+    if (ioctl(r->fd, FBIOGET_VSCREENINFO, &r->vinfo) == -1) {
+        printf("Error reading variable information\n");
+        goto err;
+    }
+
+    MSG("%dx%d, %dbpp\n", r->vinfo.xres, r->vinfo.yres, r->vinfo.bits_per_pixel);
+
+    r->vinfo.red.offset = 0;
+    r->vinfo.red.length = 8;
+    r->vinfo.red.msb_right = 0;
+
+    r->vinfo.green.offset = 8;
+    r->vinfo.green.length = 8;
+    r->vinfo.green.msb_right = 0;
+
+    r->vinfo.blue.offset = 16;
+    r->vinfo.blue.length = 8;
+    r->vinfo.blue.msb_right = 0;
+
+    r->vinfo.transp.offset = 0;
+    r->vinfo.transp.length = 0;
+    r->vinfo.transp.msb_right = 0;
+    r->vinfo.nonstd = 0;
+    r->vinfo.bits_per_pixel = 24;
+    r->vinfo.yres_virtual = r->vinfo.yres * buffers;
+
+    if (ioctl(r->fd, FBIOPUT_VSCREENINFO, &r->vinfo) == -1)
+        printf("Error setting variable information\n");
+
+    /* the driver may have kept a different depth or fewer pages */
+    if (ioctl(r->fd, FBIOGET_VSCREENINFO, &r->vinfo) == -1 ||
+        ioctl(r->fd, FBIOGET_FSCREENINFO, &r->finfo) == -1) {
+        printf("Error reading screen information\n");
+        goto err;
+    }
+
+    if (r->vinfo.bits_per_pixel != 24 && r->vinfo.bits_per_pixel != 32) {
+        printf("Error: %dbpp frame buffer not supported\n", r->vinfo.bits_per_pixel);
+        goto err;
+    }
+
+    pages = r->vinfo.yres ? r->vinfo.yres_virtual / r->vinfo.yres : 0;
+    if (pages < buffers)
+        buffers = pages;
+    renderer_setup(r, buffers);
+
+    r->size = (unsigned long)r->finfo.line_length * r->vinfo.yres * r->buffers;
+    r->fbp = mmap(0, r->size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, 0);
+    if (r->fbp == MAP_FAILED) {
+        printf("Error: failed to map framebuffer device to memory\n");
+        r->fbp = NULL;
+        pthread_mutex_destroy(&r->lock);
+        goto err;
+    }
+    MSG("The framebuffer device was mapped to memory successfully, %d pages.\n", r->buffers);
+
+    memset(r->fbp, 0, r->size);
+
+    return 0;
+
+err:
+    close(r->fd);
+    r->fd = -1;
+    return -1;
+}
+
+int renderer_open_headless(renderer_t *r, int xres, int yres, int bpp, int buffers)
+{
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+
+    if (xres <= 0 || yres <= 0 || (bpp != 24 && bpp != 32)) {
+        printf("Error: invalid headless frame buffer %dx%d %dbpp\n", xres, yres, bpp);
+        return -1;
+    }
+
+    r->vinfo.xres = xres;
+    r->vinfo.yres = yres;
+    r->vinfo.bits_per_pixel = bpp;
+    r->vinfo.red.offset = 0;
+    r->vinfo.red.length = 8;
+    r->vinfo.green.offset = 8;
+    r->vinfo.green.length = 8;
+    r->vinfo.blue.offset = 16;
+    r->vinfo.blue.length = 8;
+    r->finfo.line_length = xres * bpp / 8;
+
+    renderer_setup(r, buffers);
+    r->vinfo.yres_virtual = yres * r->buffers;
+
+    r->size = (unsigned long)r->finfo.line_length * yres * r->buffers;
+    r->fbp = calloc(1, r->size);
+    if (r->fbp == NULL) {
+        pthread_mutex_destroy(&r->lock);
+        return -1;
+    }
+
+    MSG("headless frame buffer %dx%d, %dbpp, %d pages\n", xres, yres, bpp, r->buffers);
+
+    return 0;
+}
+
+void renderer_close(renderer_t *r)
+{
+    if (r->fbp == NULL)
+        return;
+
+    if (r->fd >= 0) {
+        munmap(r->fbp, r->size);
+        close(r->fd);
+        r->fd = -1;
+    } else {
+        free(r->fbp);
+    }
+
+    r->fbp = NULL;
+    pthread_mutex_destroy(&r->lock);
+}
+
+int renderer_draw(renderer_t *r, image_info_t *src, render_mode_t mode)
+{
+    struct render_pix pix;
+    render_rect_t rc;
+    unsigned char *page;
+    unsigned long long start;
+    int stride, j;
+    int page_idx;
+
+    if (r->fbp == NULL || src == NULL || src->ptr == NULL)
+        return -1;
+
+    if (src->fmt == V4L2_PIX_FMT_NV12 && src->uv == NULL)
+        return -1;
+
+    if (src->fmt != V4L2_PIX_FMT_NV12 && src->fmt != V4L2_PIX_FMT_RGB24 &&
+        src->fmt != ISP_V4L2_PIX_FMT_RGB24)
+        return -1;
+
+    rc.w = src->width < (int)r->vinfo.xres ? src->width : (int)r->vinfo.xres;
+    rc.h = src->height < (int)r->vinfo.yres ? src->height : (int)r->vinfo.yres;
 
     switch (mode) {
     case AFD_RENDER_MODE_CENTER:
-        // Center is not supported yet !
+        rc.x = (r->vinfo.xres - rc.w) / 2;
+        rc.y = (r->vinfo.yres - rc.h) / 2;
+        break;
     case AFD_RENDER_MODE_LEFT_TOP:
-        src_x = 0;
-        src_y = 0;
-        dst_x = 0;
-        dst_y = 0;
-        /*
-        if (vinfo.xres > src.width) w = src.width;
-        else w = vinfo.xres;
-        if (vinfo.yres > src.height) h = src.height;
-        else h = vinfo.yres;
-        */
-        w = width;
-        h = height;
+        rc.x = 0;
+        rc.y = 0;
         break;
-
     default:
         perror("Error, invalid mode value");
-        exit(1);
-        break;
+        return -1;
     }
 
-    /*
-    if (src.fmt == ISP_V4L2_PIX_FMT_ARGB2101010) {
-        // translate YUV to RGB line by line
-        uint64_t *src_u64;
-        uint64_t *dst_u64;
-        //int32_t offset = 0;
-        uint64_t value = 0;
-
-        for (j = 0; j < h; j++) {
-            pos_src = (src_y + j) * (src.width * bit_depth) + (src_x * bit_depth);
-            pos_dst = ((dst_y + j + vinfo.yoffset) * finfo.line_length)
-                + ((dst_x + vinfo.xoffset) * bit_depth);
-
-            src_u64 = (uint64_t *)(src.ptr + pos_src);
-            dst_u64 = (uint64_t *)(dst + pos_dst);
-
-            for (i = 0; i < (w/2); i++) {
-                value = src_u64[i];
-                dst_u64[i] =  ((value>>6) & 0x00FF000000FF0000)     // Red
-                    | ((value>>4) & 0x0000FF000000FF00)     // Green
-                    | ((value>>2) & 0x000000FF000000FF);    // Blue
-            }
-        }
-    } else
-    */
-    {
-#if 0
-        for(j = 0; j < h; j++) {
-            pos_src = (src_y + j) * (w * 3);
-            pos_dst = ((dst_y + j + vinfo.yoffset) * finfo.line_length)
-                + ((dst_x + vinfo.xoffset) * bit_depth);
-            for (k = 0; k < w; k++) {
-                *(dst + pos_dst + 4 * k) = *(src + pos_src + 3 * k + 1);
-                *(dst + pos_dst + 4 * k + 1) = *(src + pos_src + 3 * k);
-                *(dst + pos_dst + 4 * k + 2) = *(src + pos_src + 3 * k + 2);
-                *(dst + pos_dst + 4 * k + 3) = 0xff;
-            }
-        }
-#else
-        memcpy(dst, src, w * h * 3);
-#endif
-
-        vinfo.activate = FB_ACTIVATE_NOW;
-        if (fb_index >= 3)
-            fb_index = 0;
-        vinfo.yoffset = 1080 * fb_index;
-        vinfo.vmode &= ~FB_VMODE_YWRAP;
-        ioctl(fb_fd, FBIOPAN_DISPLAY, &vinfo);
+    if (src->fmt == V4L2_PIX_FMT_NV12)
+        stride = src->stride ? src->stride : src->width;
+    else
+        stride = src->stride ? src->stride : src->width * 3;
+
+    render_pix_init(&pix, &r->vinfo);
+
+    pthread_mutex_lock(&r->lock);
+    start = render_now_us();
+
+    page_idx = r->back;
+    page = r->fbp + (unsigned long)r->finfo.line_length * r->vinfo.yres * page_idx;
+
+    /* the page only needs clearing where an older, larger image shows */
+    if (r->drawn[page_idx].w && !render_rect_inside(&r->drawn[page_idx], &rc))
+        render_clear_rect(r, page, &r->drawn[page_idx]);
+
+    for (j = 0; j < rc.h; j++) {
+        unsigned char *dst = page + (rc.y + j) * r->finfo.line_length + rc.x * pix.bytes;
+
+        if (src->fmt == V4L2_PIX_FMT_NV12)
+            render_nv12_line(dst, &pix, src->ptr + j * stride,
+                src->uv + (j / 2) * stride, rc.w);
+        else
+            render_rgb24_line(dst, &pix, src->ptr + j * stride, rc.w);
+    }
+    r->drawn[page_idx] = rc;
+
+    if (r->fd >= 0) {
+        r->vinfo.activate = FB_ACTIVATE_NOW;
+        r->vinfo.xoffset = 0;
+        r->vinfo.yoffset = r->vinfo.yres * page_idx;
+        r->vinfo.vmode &= ~FB_VMODE_YWRAP;
+        ioctl(r->fd, FBIOPAN_DISPLAY, &r->vinfo);
     }
+
+    r->front = page_idx;
+    r->back = (page_idx + 1) % r->buffers;
+
+    r->last_us = render_now_us() - start;
+    r->total_us += r->last_us;
+    if (r->last_us > r->max_us)
+        r->max_us = r->last_us;
+    r->frames++;
+    pthread_mutex_unlock(&r->lock);
+
     return 0;
 }
+
+unsigned char *renderer_front(renderer_t *r)
+{
+    if (r->fbp == NULL || r->front < 0)
+        return NULL;
+
+    return r->fbp + (unsigned long)r->finfo.line_length * r->vinfo.yres * r->front;
+}
+
+void renderer_print_stats(renderer_t *r, const char *tag)
+{
+    unsigned long frames;
+    unsigned long long total, max;
+
+    pthread_mutex_lock(&r->lock);
+    frames = r->frames;
+    total = r->total_us;
+    max = r->max_us;
+    r->frames = 0;
+    r->total_us = 0;
+    r->max_us = 0;
+    pthread_mutex_unlock(&r->lock);
+
+    if (frames)
+        printf("%s render: %lu frames, avg %llu us, max %llu us\n",
+            tag, frames, total / frames, max);
+}
@@ -15,6 +15,9 @@
 #ifndef _RENDERER_H_
 #define _RENDERER_H_
 
+#include <pthread.h>
+#include <linux/fb.h>
+
 /* renderer modes */
 typedef enum render_mode {
     AFD_RENDER_MODE_CENTER,
@@ -24,15 +27,58 @@ typedef enum render_mode {
 
 /* renderer image parameter */
 typedef struct image_info {
-    unsigned char *ptr;
+    unsigned char *ptr;         /* rgb24 pixels or nv12 y plane */
+    unsigned char *uv;          /* nv12 uv plane */
     int width;
     int height;
+    int stride;                 /* bytes per line of ptr and uv, 0: packed */
     int bpp;
     uint32_t fmt;
 } image_info_t;
 
-/* renderer function */
-int renderImage(unsigned char *dst, struct fb_var_screeninfo vinfo, struct fb_fix_screeninfo finfo,
-    unsigned char *src, int width, int height, render_mode_t mode, int fb_fd, int fb_index);
+typedef struct render_rect {
+    int x;
+    int y;
+    int w;
+    int h;
+} render_rect_t;
+
+#define RENDERER_MAX_BUFFERS    4
+
+/*
+ * Page flipping frame buffer renderer.
+ *
+ * Frames are converted straight from the source into the back page and the
+ * page is then panned in, only the rectangle covered by the image is written.
+ * A page is cleared only where it still holds a larger image from an earlier
+ * frame. Without a fbdev (headless) the pages live in memory and nothing is
+ * panned, which keeps the conversion and blit testable anywhere.
+ */
+typedef struct renderer {
+    int fd;                     /* fbdev, -1 when headless */
+    unsigned char *fbp;
+    unsigned long size;
+    struct fb_var_screeninfo vinfo;
+    struct fb_fix_screeninfo finfo;
+    int buffers;
+    int back;                   /* page the next frame goes to */
+    int front;                  /* page on screen, -1 before the first frame */
+    render_rect_t drawn[RENDERER_MAX_BUFFERS];
+    pthread_mutex_t lock;
+
+    /* render time, conversion and pan */
+    unsigned long frames;
+    unsigned long long total_us;
+    unsigned long long max_us;
+    unsigned long long last_us;
+} renderer_t;
+
+/* renderer functions */
+int renderer_open(renderer_t *r, const char *fbdev, int buffers);
+int renderer_open_headless(renderer_t *r, int xres, int yres, int bpp, int buffers);
+void renderer_close(renderer_t *r);
+int renderer_draw(renderer_t *r, image_info_t *src, render_mode_t mode);
+unsigned char *renderer_front(renderer_t *r);
+void renderer_print_stats(renderer_t *r, const char *tag);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,204 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * renderer_test
+ *
+ * Draw NV12 and RGB24 frames into headless frame buffers (renderer_open_headless)
+ * and check every pixel of the page against a scalar reference:
+ * - 24 and 32 bpp frame buffers, left top and center modes,
+ * - odd widths to cover the tail after the vector lanes, strides wider
+ *   than the image, images larger than the frame buffer,
+ * - a smaller frame drawn over a larger one on the same page, the part only
+ *   the larger one covered must be cleared.
+ * Returns 0 when every pixel matches.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/videodev2.h>
+
+#include "common.h"
+#include "logs.h"
+#include "renderer.h"
+
+#define FB_W 96
+#define FB_H 64
+
+static uint32_t rnd_state = 0x9e3779b9;
+static uint32_t checks, failures;
+
+static uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+static int clamp8(int v)
+{
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+/* bt.601 limited range, 8 bit fixed point, one pixel at a time */
+static void ref_nv12(const image_info_t *src, int x, int y, int *r, int *g, int *b)
+{
+    int stride = src->stride ? src->stride : src->width;
+    int c = 298 * (src->ptr[y * stride + x] - 16);
+    int d = src->uv[(y / 2) * stride + (x & ~1)] - 128;
+    int e = src->uv[(y / 2) * stride + (x & ~1) + 1] - 128;
+
+    *r = clamp8((c + 409 * e + 128) >> 8);
+    *g = clamp8((c - 100 * d - 208 * e + 128) >> 8);
+    *b = clamp8((c + 516 * d + 128) >> 8);
+}
+
+static void ref_rgb24(const image_info_t *src, int x, int y, int *r, int *g, int *b)
+{
+    int stride = src->stride ? src->stride : src->width * 3;
+    const unsigned char *p = src->ptr + y * stride + x * 3;
+
+    *r = p[0];
+    *g = p[1];
+    *b = p[2];
+}
+
+static void fail(const char *what, int bpp, const image_info_t *src, int x, int y,
+    const unsigned char *got, int r, int g, int b)
+{
+    if (failures++ < 16)
+        ERR("%s %dx%d stride %d on %dbpp, fb pixel %d,%d: %u %u %u, want %d %d %d\n",
+            what, src->width, src->height, src->stride, bpp, x, y, got[0], got[1], got[2], r, g, b);
+}
+
+/* the front page holds src at (x0, y0) and nothing else */
+static void check_page(renderer_t *r, const image_info_t *src, render_mode_t mode)
+{
+    const unsigned char *page = renderer_front(r);
+    int bytes = r->vinfo.bits_per_pixel / 8;
+    int w = src->width < FB_W ? src->width : FB_W;
+    int h = src->height < FB_H ? src->height : FB_H;
+    int x0 = (mode == AFD_RENDER_MODE_CENTER) ? (FB_W - w) / 2 : 0;
+    int y0 = (mode == AFD_RENDER_MODE_CENTER) ? (FB_H - h) / 2 : 0;
+    int x, y;
+
+    for (y = 0; y < FB_H; y++) {
+        for (x = 0; x < FB_W; x++) {
+            const unsigned char *p = page + y * r->finfo.line_length + x * bytes;
+            int red = 0, green = 0, blue = 0, spare = 0;
+
+            if (x >= x0 && x < x0 + w && y >= y0 && y < y0 + h) {
+                spare = 0xff;
+                if (src->fmt == V4L2_PIX_FMT_NV12)
+                    ref_nv12(src, x - x0, y - y0, &red, &green, &blue);
+                else
+                    ref_rgb24(src, x - x0, y - y0, &red, &green, &blue);
+            }
+
+            checks++;
+            // red, green, blue at byte 0, 1, 2, the spare byte of 32bpp is set when drawn
+            if (p[0] != red || p[1] != green || p[2] != blue || (bytes == 4 && p[3] != spare))
+                fail(src->fmt == V4L2_PIX_FMT_NV12 ? "nv12" : "rgb24",
+                    r->vinfo.bits_per_pixel, src, x, y, p, red, green, blue);
+        }
+    }
+}
+
+static void fill_image(image_info_t *img, uint32_t fmt, int width, int height, int pad)
+{
+    int stride, len, i;
+
+    memset(img, 0, sizeof(*img));
+    img->fmt = fmt;
+    img->width = width;
+    img->height = height;
+    img->bpp = 24;
+
+    if (fmt == V4L2_PIX_FMT_NV12) {
+        stride = width + pad;
+        len = stride * height;
+        img->ptr = malloc(len);
+        img->uv = malloc(stride * ((height + 1) / 2));
+        for (i = 0; i < stride * ((height + 1) / 2); i++)
+            img->uv[i] = rnd();
+    } else {
+        stride = width * 3 + pad;
+        len = stride * height;
+        img->ptr = malloc(len);
+    }
+
+    // 0 keeps the packed default
+    img->stride = pad ? stride : 0;
+    for (i = 0; i < len; i++)
+        img->ptr[i] = rnd();
+}
+
+static void free_image(image_info_t *img)
+{
+    free(img->ptr);
+    free(img->uv);
+}
+
+static void check_frame(renderer_t *r, uint32_t fmt, int width, int height, int pad, render_mode_t mode)
+{
+    image_info_t img;
+
+    fill_image(&img, fmt, width, height, pad);
+    if (renderer_draw(r, &img, mode) < 0) {
+        ERR("renderer_draw failed for %dx%d\n", width, height);
+        failures++;
+    } else {
+        check_page(r, &img, mode);
+    }
+    free_image(&img);
+}
+
+int main(int argc, char *argv[])
+{
+    static const int sizes[][2] = {
+        { 1, 1 }, { 2, 2 }, { 3, 5 }, { 5, 3 }, { 17, 9 }, { 64, 48 },
+        { 95, 63 }, { 96, 64 }, { 130, 80 }, { 7, 100 },
+    };
+    static const uint32_t fmts[] = { V4L2_PIX_FMT_NV12, V4L2_PIX_FMT_RGB24 };
+    static const int bpps[] = { 24, 32 };
+    renderer_t r;
+    int b, f, s, mode, pad;
+
+    for (b = 0; b < 2; b++) {
+        // one page, every frame is drawn over the one before it
+        if (renderer_open_headless(&r, FB_W, FB_H, bpps[b], 1) < 0)
+            return 1;
+
+        for (f = 0; f < 2; f++)
+            for (mode = AFD_RENDER_MODE_CENTER; mode <= AFD_RENDER_MODE_LEFT_TOP; mode++)
+                for (pad = 0; pad <= 16; pad += 16)
+                    for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+                        check_frame(&r, fmts[f], sizes[s][0], sizes[s][1], pad, mode);
+
+        // large then small on the same page, the old image has to go
+        check_frame(&r, V4L2_PIX_FMT_NV12, 130, 80, 0, AFD_RENDER_MODE_LEFT_TOP);
+        check_frame(&r, V4L2_PIX_FMT_NV12, 10, 6, 0, AFD_RENDER_MODE_CENTER);
+        check_frame(&r, V4L2_PIX_FMT_RGB24, 9, 7, 0, AFD_RENDER_MODE_LEFT_TOP);
+
+        renderer_close(&r);
+    }
+
+    MSG("renderer pixels checked: %u, failed: %u\n", checks, failures);
+    MSG("renderer: %s\n", failures ? "FAIL" : "PASS");
+
+    return failures ? 1 : 0;
+}
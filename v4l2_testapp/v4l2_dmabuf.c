@@ -0,0 +1,476 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * v4l2_dmabuf [-d dev] [-w width] [-h height] [-f fourcc] [-n buffers] [-c frames]
+ *             [-s heap:<name> | -s udmabuf]
+ *
+ * Capture into dmabufs allocated outside the driver: every plane comes from
+ * /dev/dma_heap/<name> (default heap:linux,cma) or from a memfd wrapped by
+ * /dev/udmabuf, is queued with V4L2_MEMORY_DMABUF and then cycled for the
+ * requested number of frames.
+ *
+ * The ISP writes one base address per plane, so the driver only imports
+ * physically contiguous dmabufs. A CMA heap passes, udmabuf and the system
+ * heap normally fail QBUF with EFAULT, which the report points out.
+ * Returns 0 when every frame came back without error.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/ioctl.h>
+#include <linux/videodev2.h>
+
+#include "logs.h"
+
+/* uapi of dma-heap.h and udmabuf.h, older toolchains do not ship them */
+struct dmabuf_heap_alloc {
+    uint64_t len;
+    uint32_t fd;
+    uint32_t fd_flags;
+    uint64_t heap_flags;
+};
+#define DMABUF_HEAP_IOCTL_ALLOC _IOWR('H', 0x0, struct dmabuf_heap_alloc)
+
+struct dmabuf_udmabuf_create {
+    uint32_t memfd;
+    uint32_t flags;
+    uint64_t offset;
+    uint64_t size;
+};
+#define DMABUF_UDMABUF_CREATE _IOW('u', 0x42, struct dmabuf_udmabuf_create)
+#define DMABUF_UDMABUF_FLAGS_CLOEXEC 0x01
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SHRINK 0x0002
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+#define MAX_BUFFERS 16
+#define MAX_PLANES 3
+#define POLL_TIMEOUT_MS 2000
+
+typedef struct _dbuf_t {
+    int fd[MAX_PLANES];
+    uint32_t length[MAX_PLANES];
+} dbuf_t;
+
+typedef struct _dmabuf_test_t {
+    const char *dev_name;
+    const char *source;
+    uint32_t width;
+    uint32_t height;
+    uint32_t fourcc;
+    uint32_t buf_num;
+    uint32_t frame_num;
+
+    int fd;
+    int src_fd;
+    int mplane;
+    uint32_t type;
+    uint32_t num_planes;
+    uint32_t sizeimage[MAX_PLANES];
+    dbuf_t buf[MAX_BUFFERS];
+
+    uint32_t frames;
+    uint32_t errors;
+    uint32_t short_frames;
+} dmabuf_test_t;
+
+static int xioctl(int fd, unsigned long req, void *arg)
+{
+    int rc;
+
+    do {
+        rc = ioctl(fd, req, arg);
+    } while (rc < 0 && errno == EINTR);
+
+    return rc;
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static int source_open(dmabuf_test_t *t)
+{
+    char path[128];
+
+    if (!strcmp(t->source, "udmabuf")) {
+        snprintf(path, sizeof(path), "/dev/udmabuf");
+    } else if (!strncmp(t->source, "heap:", 5)) {
+        snprintf(path, sizeof(path), "/dev/dma_heap/%s", t->source + 5);
+    } else {
+        ERR("unknown buffer source %s\n", t->source);
+        return -1;
+    }
+
+    t->src_fd = open(path, O_RDWR | O_CLOEXEC);
+    if (t->src_fd < 0) {
+        ERR("can't open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+/* one dmabuf of at least len bytes, returns its fd or -1 */
+static int dmabuf_alloc(dmabuf_test_t *t, uint32_t len)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    uint64_t size = (len + page - 1) & ~((uint64_t)page - 1);
+
+    if (strcmp(t->source, "udmabuf")) {
+        struct dmabuf_heap_alloc alloc = {0};
+
+        alloc.len = size;
+        alloc.fd_flags = O_RDWR | O_CLOEXEC;
+        if (xioctl(t->src_fd, DMABUF_HEAP_IOCTL_ALLOC, &alloc) < 0) {
+            ERR("heap allocation of %llu bytes failed: %s\n", (unsigned long long)size, strerror(errno));
+            return -1;
+        }
+        return alloc.fd;
+    } else {
+        struct dmabuf_udmabuf_create create = {0};
+        int memfd, fd;
+
+        memfd = syscall(SYS_memfd_create, "v4l2_dmabuf", MFD_ALLOW_SEALING);
+        if (memfd < 0) {
+            ERR("memfd_create failed: %s\n", strerror(errno));
+            return -1;
+        }
+        // udmabuf wants the memfd sealed against shrinking
+        if (ftruncate(memfd, size) < 0 || fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK) < 0) {
+            ERR("memfd setup failed: %s\n", strerror(errno));
+            close(memfd);
+            return -1;
+        }
+
+        create.memfd = memfd;
+        create.flags = DMABUF_UDMABUF_FLAGS_CLOEXEC;
+        create.size = size;
+        fd = xioctl(t->src_fd, DMABUF_UDMABUF_CREATE, &create);
+        if (fd < 0)
+            ERR("udmabuf of %llu bytes failed: %s\n", (unsigned long long)size, strerror(errno));
+        close(memfd);
+        return fd;
+    }
+}
+
+static int device_setup(dmabuf_test_t *t)
+{
+    struct v4l2_capability cap;
+    struct v4l2_format fmt;
+    uint32_t p;
+
+    t->fd = open(t->dev_name, O_RDWR | O_NONBLOCK);
+    if (t->fd < 0) {
+        ERR("can't open %s: %s\n", t->dev_name, strerror(errno));
+        return -1;
+    }
+
+    memset(&cap, 0, sizeof(cap));
+    if (xioctl(t->fd, VIDIOC_QUERYCAP, &cap) < 0) {
+        ERR("VIDIOC_QUERYCAP failed: %s\n", strerror(errno));
+        return -1;
+    }
+    if (!(cap.capabilities & V4L2_CAP_STREAMING)) {
+        ERR("%s can't stream\n", t->dev_name);
+        return -1;
+    }
+    t->mplane = !!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE);
+    t->type = t->mplane ? V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE : V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = t->type;
+    if (t->mplane) {
+        fmt.fmt.pix_mp.width = t->width;
+        fmt.fmt.pix_mp.height = t->height;
+        fmt.fmt.pix_mp.pixelformat = t->fourcc;
+        fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
+    } else {
+        fmt.fmt.pix.width = t->width;
+        fmt.fmt.pix.height = t->height;
+        fmt.fmt.pix.pixelformat = t->fourcc;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    }
+    if (xioctl(t->fd, VIDIOC_S_FMT, &fmt) < 0) {
+        ERR("VIDIOC_S_FMT failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (t->mplane) {
+        t->num_planes = fmt.fmt.pix_mp.num_planes;
+        if (t->num_planes == 0 || t->num_planes > MAX_PLANES) {
+            ERR("unexpected plane count %u\n", t->num_planes);
+            return -1;
+        }
+        for (p = 0; p < t->num_planes; p++)
+            t->sizeimage[p] = fmt.fmt.pix_mp.plane_fmt[p].sizeimage;
+        t->width = fmt.fmt.pix_mp.width;
+        t->height = fmt.fmt.pix_mp.height;
+    } else {
+        t->num_planes = 1;
+        t->sizeimage[0] = fmt.fmt.pix.sizeimage;
+        t->width = fmt.fmt.pix.width;
+        t->height = fmt.fmt.pix.height;
+    }
+
+    MSG("%s: %s, %ux%u %.4s, %u plane(s), sizeimage %u/%u/%u\n", t->dev_name,
+        t->mplane ? "multiplanar" : "single plane", t->width, t->height, (char *)&t->fourcc,
+        t->num_planes, t->sizeimage[0], t->sizeimage[1], t->sizeimage[2]);
+
+    return 0;
+}
+
+static int buffers_alloc(dmabuf_test_t *t)
+{
+    struct v4l2_requestbuffers rb;
+    uint32_t i, p;
+
+    memset(&rb, 0, sizeof(rb));
+    rb.count = t->buf_num;
+    rb.type = t->type;
+    rb.memory = V4L2_MEMORY_DMABUF;
+    if (xioctl(t->fd, VIDIOC_REQBUFS, &rb) < 0) {
+        ERR("VIDIOC_REQBUFS with V4L2_MEMORY_DMABUF failed: %s\n", strerror(errno));
+        return -1;
+    }
+    if (rb.count < t->buf_num) {
+        MSG("driver granted %u of %u buffers\n", rb.count, t->buf_num);
+        t->buf_num = rb.count;
+    }
+
+    for (i = 0; i < t->buf_num; i++) {
+        for (p = 0; p < t->num_planes; p++) {
+            t->buf[i].fd[p] = dmabuf_alloc(t, t->sizeimage[p]);
+            if (t->buf[i].fd[p] < 0)
+                return -1;
+            t->buf[i].length[p] = t->sizeimage[p];
+        }
+    }
+
+    return 0;
+}
+
+static int buffer_queue(dmabuf_test_t *t, uint32_t index)
+{
+    struct v4l2_plane planes[MAX_PLANES];
+    struct v4l2_buffer vbuf;
+    uint32_t p;
+
+    memset(&vbuf, 0, sizeof(vbuf));
+    vbuf.index = index;
+    vbuf.type = t->type;
+    vbuf.memory = V4L2_MEMORY_DMABUF;
+    if (t->mplane) {
+        memset(planes, 0, sizeof(planes));
+        for (p = 0; p < t->num_planes; p++) {
+            planes[p].m.fd = t->buf[index].fd[p];
+            planes[p].length = t->buf[index].length[p];
+        }
+        vbuf.m.planes = planes;
+        vbuf.length = t->num_planes;
+    } else {
+        vbuf.m.fd = t->buf[index].fd[0];
+        vbuf.length = t->buf[index].length[0];
+    }
+
+    if (xioctl(t->fd, VIDIOC_QBUF, &vbuf) < 0) {
+        ERR("VIDIOC_QBUF of buffer %u failed: %s\n", index, strerror(errno));
+        if (errno == EFAULT)
+            ERR("the driver refused the dmabuf, it is not one contiguous range (see the kernel log)\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int capture(dmabuf_test_t *t)
+{
+    struct v4l2_plane planes[MAX_PLANES];
+    struct v4l2_buffer vbuf;
+    struct pollfd pfd = {.fd = t->fd, .events = POLLIN};
+    uint64_t start;
+    uint32_t i, p, used;
+    int rc = 0;
+
+    for (i = 0; i < t->buf_num; i++) {
+        if (buffer_queue(t, i))
+            return -1;
+    }
+
+    if (xioctl(t->fd, VIDIOC_STREAMON, &t->type) < 0) {
+        ERR("VIDIOC_STREAMON failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    start = now_us();
+    while (t->frames < t->frame_num) {
+        rc = poll(&pfd, 1, POLL_TIMEOUT_MS);
+        if (rc <= 0) {
+            ERR("no frame within %d ms after %u frames\n", POLL_TIMEOUT_MS, t->frames);
+            rc = -1;
+            break;
+        }
+
+        memset(&vbuf, 0, sizeof(vbuf));
+        vbuf.type = t->type;
+        vbuf.memory = V4L2_MEMORY_DMABUF;
+        if (t->mplane) {
+            memset(planes, 0, sizeof(planes));
+            vbuf.m.planes = planes;
+            vbuf.length = t->num_planes;
+        }
+        if (xioctl(t->fd, VIDIOC_DQBUF, &vbuf) < 0) {
+            if (errno == EAGAIN)
+                continue;
+            ERR("VIDIOC_DQBUF failed: %s\n", strerror(errno));
+            rc = -1;
+            break;
+        }
+
+        t->frames++;
+        if (vbuf.flags & V4L2_BUF_FLAG_ERROR)
+            t->errors++;
+        for (p = 0; p < t->num_planes; p++) {
+            used = t->mplane ? planes[p].bytesused : vbuf.bytesused;
+            if (used < t->sizeimage[p]) {
+                t->short_frames++;
+                break;
+            }
+        }
+
+        if (buffer_queue(t, vbuf.index)) {
+            rc = -1;
+            break;
+        }
+    }
+
+    if (t->frames)
+        MSG("%u frames in %llu ms, %.2f fps, errors %u, short %u\n", t->frames,
+            (unsigned long long)((now_us() - start) / 1000),
+            t->frames * 1000000.0 / (now_us() - start), t->errors, t->short_frames);
+
+    xioctl(t->fd, VIDIOC_STREAMOFF, &t->type);
+
+    return rc < 0 ? -1 : 0;
+}
+
+static void cleanup(dmabuf_test_t *t)
+{
+    struct v4l2_requestbuffers rb;
+    uint32_t i, p;
+
+    if (t->fd >= 0) {
+        memset(&rb, 0, sizeof(rb));
+        rb.type = t->type;
+        rb.memory = V4L2_MEMORY_DMABUF;
+        xioctl(t->fd, VIDIOC_REQBUFS, &rb);
+    }
+
+    for (i = 0; i < MAX_BUFFERS; i++) {
+        for (p = 0; p < MAX_PLANES; p++) {
+            if (t->buf[i].fd[p] >= 0)
+                close(t->buf[i].fd[p]);
+        }
+    }
+
+    if (t->src_fd >= 0)
+        close(t->src_fd);
+    if (t->fd >= 0)
+        close(t->fd);
+}
+
+static void usage(const char *name)
+{
+    ERR("usage: %s [-d dev] [-w width] [-h height] [-f fourcc] [-n buffers] [-c frames]\n", name);
+    ERR("       [-s heap:<name> | -s udmabuf]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    dmabuf_test_t t;
+    const char *fourcc = "NV12";
+    uint32_t i, p;
+    int opt;
+    int rc;
+
+    memset(&t, 0, sizeof(t));
+    t.dev_name = "/dev/video0";
+    t.source = "heap:linux,cma";
+    t.width = 1920;
+    t.height = 1080;
+    t.buf_num = 4;
+    t.frame_num = 100;
+    t.fd = -1;
+    t.src_fd = -1;
+    for (i = 0; i < MAX_BUFFERS; i++) {
+        for (p = 0; p < MAX_PLANES; p++)
+            t.buf[i].fd[p] = -1;
+    }
+
+    while ((opt = getopt(argc, argv, "d:w:h:f:n:c:s:")) != -1) {
+        switch (opt) {
+        case 'd': t.dev_name = optarg; break;
+        case 'w': t.width = strtoul(optarg, NULL, 0); break;
+        case 'h': t.height = strtoul(optarg, NULL, 0); break;
+        case 'f': fourcc = optarg; break;
+        case 'n': t.buf_num = strtoul(optarg, NULL, 0); break;
+        case 'c': t.frame_num = strtoul(optarg, NULL, 0); break;
+        case 's': t.source = optarg; break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (strlen(fourcc) != 4 || t.buf_num == 0 || t.buf_num > MAX_BUFFERS) {
+        usage(argv[0]);
+        return 1;
+    }
+    t.fourcc = v4l2_fourcc(fourcc[0], fourcc[1], fourcc[2], fourcc[3]);
+
+    rc = source_open(&t);
+    if (!rc)
+        rc = device_setup(&t);
+    if (!rc)
+        rc = buffers_alloc(&t);
+    if (!rc)
+        rc = capture(&t);
+    if (!rc && (t.errors || t.short_frames))
+        rc = -1;
+
+    MSG("dmabuf import from %s: %s\n", t.source, rc ? "FAIL" : "PASS");
+
+    cleanup(&t);
+
+    return rc ? 1 : 0;
+}
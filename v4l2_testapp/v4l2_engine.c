@@ -0,0 +1,315 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * All streams on one epoll loop through the capture engine.
+ *
+ * ISP, one node opened once per stream (fr, ds1):
+ *   v4l2_engine -s /dev/video0:1920x1080:NV12:display -s /dev/video0:1280x720:NV12:gdc
+ * host, vivid:
+ *   v4l2_engine -E 1920x1080 -U -c cfg.bin -s /dev/video0:1280x720:NV12:gdc -s /dev/video1:640x480:RGB3:file
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+
+#include "common.h"
+#include "logs.h"
+#include "renderer.h"
+#include "gdc_api.h"
+#include "capture_engine.h"
+
+#define ENGINE_BUFFERS      4
+
+typedef struct engine_stream {
+    cap_stream_t            st;
+    char                    dev[64];
+    uint32_t                width;
+    uint32_t                height;
+    uint32_t                pixformat;
+    char                    sink[16];
+    union {
+        cap_sink_t          null;
+        cap_file_sink_t     file;
+        cap_display_sink_t  display;
+        cap_gdc_sink_t      gdc;
+    } s;
+    FILE                    *fp;
+    struct gdc_usr_ctx_s    gdc_ctx;
+    int                     has_gdc;
+} engine_stream_t;
+
+static cap_engine_t engine;
+static renderer_t display;
+static int display_open = 0;
+
+static void engine_signal(int sig)
+{
+    cap_engine_stop(&engine);
+}
+
+static int engine_parse(engine_stream_t *es, char *spec)
+{
+    char fourcc[5] = { 0 };
+    char *p;
+
+    /* dev:WxH:FOURCC:sink */
+    p = strchr(spec, ':');
+    if (p == NULL || p - spec >= (int)sizeof(es->dev))
+        return -1;
+    memcpy(es->dev, spec, p - spec);
+    es->dev[p - spec] = '\0';
+
+    if (sscanf(p + 1, "%ux%u:%4[^:]:%15s", &es->width, &es->height, fourcc, es->sink) != 4)
+        return -1;
+
+    es->pixformat = v4l2_fourcc(fourcc[0], fourcc[1], fourcc[2], fourcc[3]);
+    return 0;
+}
+
+/* nv12 context taking dmabuf input, with an input buffer for the copy path */
+static int engine_gdc_init(engine_stream_t *es, const char *cfg_file, int use_model)
+{
+    struct gdc_usr_ctx_s *ctx = &es->gdc_ctx;
+    gdc_config_t *cfg = &ctx->gs.gdc_config;
+    FILE *fp;
+    long c_len;
+
+    if (es->pixformat != V4L2_PIX_FMT_NV12) {
+        ERR("[%s] Error: gdc sink takes NV12 only\n", es->st.name);
+        return -1;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->use_model = use_model;
+
+    cfg->format = NV12;
+    cfg->input_width = cfg->output_width = es->width;
+    cfg->input_height = cfg->output_height = es->height;
+    cfg->input_y_stride = cfg->input_c_stride = es->width;
+    cfg->output_y_stride = cfg->output_c_stride = es->width;
+    ctx->gs.magic = sizeof(ctx->gs);
+
+    gdc_create_ctx(ctx);
+
+    fp = fopen(cfg_file, "rb");
+    if (fp == NULL) {
+        ERR("Error open file %s\n", cfg_file);
+        goto fail;
+    }
+    fseek(fp, 0, SEEK_END);
+    c_len = ftell(fp);
+    rewind(fp);
+
+    if (c_len <= 0 || gdc_alloc_dma_buffer(ctx, CONFIG_BUFF_TYPE, c_len) < 0 ||
+        ctx->c_buff == NULL || fread(ctx->c_buff, c_len, 1, fp) != 1) {
+        ERR("Error load gdc cfg %s\n", cfg_file);
+        fclose(fp);
+        goto fail;
+    }
+    fclose(fp);
+    cfg->config_size = c_len / 4;
+
+    if (gdc_alloc_dma_buffer(ctx, INPUT_BUFF_TYPE, es->width * es->height * 2) < 0 ||
+        gdc_alloc_dma_buffer(ctx, OUTPUT_BUFF_TYPE, es->width * es->height * 2) < 0)
+        goto fail;
+
+    return 0;
+
+fail:
+    gdc_destroy_ctx(ctx);
+    return -1;
+}
+
+static int engine_sink_init(engine_stream_t *es, int idx, const char *out,
+        const char *cfg_file, int use_model)
+{
+    char name[128];
+
+    if (!strcmp(es->sink, "null")) {
+        cap_sink_null_init(&es->s.null);
+        return cap_stream_add_sink(&es->st, &es->s.null);
+    }
+
+    if (!strcmp(es->sink, "file")) {
+        snprintf(name, sizeof(name), "%s_%d.raw", out, idx);
+        es->fp = fopen(name, "wb");
+        if (es->fp == NULL) {
+            ERR("Error open file %s\n", name);
+            return -1;
+        }
+        cap_sink_file_init(&es->s.file, es->fp, 1);
+        return cap_stream_add_sink(&es->st, &es->s.file.sink);
+    }
+
+    if (!strcmp(es->sink, "display")) {
+        cap_sink_display_init(&es->s.display, &display);
+        return cap_stream_add_sink(&es->st, &es->s.display.sink);
+    }
+
+    if (!strcmp(es->sink, "gdc")) {
+        if (engine_gdc_init(es, cfg_file, use_model) < 0)
+            return -1;
+        es->has_gdc = 1;
+        cap_sink_gdc_init(&es->s.gdc, &es->gdc_ctx, &display);
+        return cap_stream_add_sink(&es->st, &es->s.gdc.sink);
+    }
+
+    ERR("Error: unknown sink %s\n", es->sink);
+    return -1;
+}
+
+static void usage(char *prog)
+{
+    printf("usage: %s [options] -s dev:WxH:FOURCC:sink [-s ...]\n", prog);
+    printf("    s : stream, sink is null, file, display or gdc, up to %d streams\n", CAP_MAX_STREAMS);
+    printf("    n : frames per stream, default 300, 0: until ctrl-c\n");
+    printf("    B : buffers per stream, default %d\n", ENGINE_BUFFERS);
+    printf("    b : fbdev, default /dev/fb0\n");
+    printf("    E : headless, render into an in-memory frame buffer of WxH\n");
+    printf("    o : file sink prefix, default /tmp/cap\n");
+    printf("    c : gdc config file\n");
+    printf("    U : run gdc jobs on the cpu model\n");
+    printf("    p : stats period in ms, default 1000, 0: only at the end\n");
+}
+
+int main(int argc, char *argv[])
+{
+    engine_stream_t streams[CAP_MAX_STREAMS];
+    char *fbdevname = "/dev/fb0";
+    char *out = "/tmp/cap";
+    char *cfg_file = "nv12_1920_1080_cfg.bin";
+    int headless_w = 0, headless_h = 0;
+    int num_streams = 0;
+    int frames = 300;
+    int buffers = ENGINE_BUFFERS;
+    int stats_ms = 1000;
+    int use_model = 0;
+    int need_display = 0;
+    int rc = 0;
+    int c, i;
+
+    memset(streams, 0, sizeof(streams));
+    for (i = 0; i < CAP_MAX_STREAMS; i++)
+        streams[i].st.fd = -1;
+
+    while ((c = getopt(argc, argv, "s:n:B:b:E:o:c:Up:h")) != -1) {
+        switch (c) {
+        case 's':
+            if (num_streams >= CAP_MAX_STREAMS || engine_parse(&streams[num_streams], optarg) < 0) {
+                ERR("Error: bad stream %s\n", optarg);
+                return 1;
+            }
+            num_streams++;
+            break;
+        case 'n':
+            frames = atoi(optarg);
+            break;
+        case 'B':
+            buffers = atoi(optarg);
+            break;
+        case 'b':
+            fbdevname = optarg;
+            break;
+        case 'E':
+            sscanf(optarg, "%dx%d", &headless_w, &headless_h);
+            break;
+        case 'o':
+            out = optarg;
+            break;
+        case 'c':
+            cfg_file = optarg;
+            break;
+        case 'U':
+            use_model = 1;
+            break;
+        case 'p':
+            stats_ms = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (num_streams == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < num_streams; i++)
+        if (!strcmp(streams[i].sink, "display") || !strcmp(streams[i].sink, "gdc"))
+            need_display = 1;
+
+    if (need_display) {
+        if (headless_w > 0 && headless_h > 0)
+            rc = renderer_open_headless(&display, headless_w, headless_h, 24, 2);
+        else
+            rc = renderer_open(&display, fbdevname, 2);
+        if (rc < 0)
+            return 1;
+        display_open = 1;
+    }
+
+    if (cap_engine_init(&engine) < 0)
+        return 1;
+    engine.stats_period_ms = stats_ms;
+
+    /* streams open in order, the isp hands out fr, meta, ds1, ds2 by open order */
+    for (i = 0; i < num_streams; i++) {
+        engine_stream_t *es = &streams[i];
+        char name[16];
+
+        snprintf(name, sizeof(name), "S%d", i);
+        if (cap_stream_open(&es->st, name, es->dev, es->width, es->height, es->pixformat, buffers) < 0 ||
+            engine_sink_init(es, i, out, cfg_file, use_model) < 0 ||
+            cap_engine_add_stream(&engine, &es->st) < 0) {
+            rc = 1;
+            goto out;
+        }
+        es->st.max_frames = frames;
+    }
+
+    signal(SIGINT, engine_signal);
+    signal(SIGTERM, engine_signal);
+
+    if (cap_engine_run(&engine) < 0)
+        rc = 1;
+
+    for (i = 0; i < num_streams; i++)
+        cap_stream_print_stats(&streams[i].st);
+    if (display_open)
+        renderer_print_stats(&display, "display");
+
+out:
+    for (i = 0; i < num_streams; i++) {
+        cap_stream_close(&streams[i].st);
+        if (streams[i].fp)
+            fclose(streams[i].fp);
+        if (streams[i].has_gdc)
+            gdc_destroy_ctx(&streams[i].gdc_ctx);
+    }
+    cap_engine_release(&engine);
+    if (display_open)
+        renderer_close(&display);
+
+    return rc;
+}
@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------------
+//   The confidential and proprietary information contained in this file may
+//   only be used by a person authorised under and to the extent permitted
+//   by a subsisting licensing agreement from ARM Limited or its affiliates.
+//
+//          (C) COPYRIGHT [2018] ARM Limited or its affiliates.
+//              ALL RIGHTS RESERVED
+//
+//   This entire notice must be reproduced on all copies of this file
+//   and copies of this file may only be made by a person if such person is
+//   permitted to do so under the terms of a subsisting license agreement
+//   from ARM Limited or its affiliates.
+//----------------------------------------------------------------------------
+
+/*
+ * v4l2_meta_ring [-d dev] [-t seconds]
+ *
+ * Map the metadata ring of a video node read-only and follow it while
+ * another process streams (e.g. v4l2_test), without touching the streams.
+ * Every frame id published as the newest one is read back by frame id and
+ * checked: the record must carry that frame id, its payload must be the
+ * firmware_metadata_t of that frame, and the seq of the record must be even.
+ * At the end every slot is checked to hold a frame which maps to it and is
+ * one of the last ISP_META_RING_SLOTS frames.
+ *
+ * Frames newer than the last poll are counted as missed by this reader, not
+ * as errors; reads which lose the race against the writer for every retry
+ * are counted as busy. Returns 0 when no record was inconsistent.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logs.h"
+#include "isp_metadata.h"
+#include "isp_meta_ring.h"
+
+#define POLL_INTERVAL_US 2000
+
+typedef struct _ring_stats_t {
+    uint32_t frames;
+    uint32_t missed;
+    uint32_t gone;
+    uint32_t busy;
+    uint32_t errors;
+} ring_stats_t;
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void check_frame(const isp_meta_ring_t *ring, uint32_t frame_id, ring_stats_t *st)
+{
+    firmware_metadata_t meta;
+    int rc;
+
+    rc = isp_meta_ring_read(ring, frame_id, &meta, sizeof(meta));
+    if (rc < 0) {
+        st->busy++;
+        return;
+    }
+    // overwritten between the poll and the read
+    if (rc == 0) {
+        st->gone++;
+        return;
+    }
+
+    st->frames++;
+    if (rc < (int)sizeof(meta.frame_id) || meta.frame_id != frame_id) {
+        ERR("frame %u: record payload is frame %u (%d bytes)\n", frame_id, meta.frame_id, rc);
+        st->errors++;
+    }
+}
+
+/* every settled slot holds a frame which maps to it and is recent */
+static void check_slots(const isp_meta_ring_t *ring, ring_stats_t *st)
+{
+    uint32_t slots = ring->hdr->num_slots;
+    uint32_t latest = isp_meta_ring_latest(ring);
+    uint32_t i;
+
+    for (i = 0; i < slots; i++) {
+        const isp_meta_ring_record_t *rec = &ring->records[i];
+        uint32_t seq = isp_meta_ring_load(&rec->seq);
+        uint32_t frame_id = rec->frame_id;
+
+        if (seq == 0 || (seq & 1))
+            continue;
+        if (isp_meta_ring_load(&rec->seq) != seq)
+            continue;
+
+        if ((frame_id & (slots - 1)) != i) {
+            ERR("slot %u holds frame %u\n", i, frame_id);
+            st->errors++;
+        } else if (latest - frame_id >= slots && frame_id - latest >= slots) {
+            ERR("slot %u holds frame %u, the newest frame is %u\n", i, frame_id, latest);
+            st->errors++;
+        }
+    }
+}
+
+static void usage(const char *name)
+{
+    ERR("usage: %s [-d dev] [-t seconds]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *dev_name = "/dev/video0";
+    uint32_t seconds = 10;
+    isp_meta_ring_t ring;
+    ring_stats_t st;
+    uint32_t count, last_count, frame_id, last_id = 0;
+    uint64_t end;
+    int fd, opt;
+
+    while ((opt = getopt(argc, argv, "d:t:")) != -1) {
+        switch (opt) {
+        case 'd': dev_name = optarg; break;
+        case 't': seconds = strtoul(optarg, NULL, 0); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    fd = open(dev_name, O_RDWR);
+    if (fd < 0) {
+        ERR("can't open %s\n", dev_name);
+        return 1;
+    }
+
+    if (isp_meta_ring_open(&ring, fd)) {
+        ERR("%s has no metadata ring of version %d\n", dev_name, ISP_META_RING_VERSION);
+        close(fd);
+        return 1;
+    }
+
+    if (ring.hdr->payload_size < sizeof(firmware_metadata_t))
+        MSG("ring payload is %u bytes, firmware_metadata_t %zu, checking the frame id only\n",
+            ring.hdr->payload_size, sizeof(firmware_metadata_t));
+
+    memset(&st, 0, sizeof(st));
+    last_count = isp_meta_ring_count(&ring);
+    if (last_count)
+        last_id = isp_meta_ring_latest(&ring);
+
+    end = now_ms() + (uint64_t)seconds * 1000;
+    while (now_ms() < end) {
+        count = isp_meta_ring_count(&ring);
+        if (count == last_count) {
+            usleep(POLL_INTERVAL_US);
+            continue;
+        }
+
+        frame_id = isp_meta_ring_latest(&ring);
+        if (last_count && frame_id - last_id > 1)
+            st.missed += frame_id - last_id - 1;
+        check_frame(&ring, frame_id, &st);
+
+        last_count = count;
+        last_id = frame_id;
+    }
+
+    check_slots(&ring, &st);
+
+    MSG("%s: %u writes, %u frames read, %u missed by the reader, %u overwritten before the read, %u busy, %u errors\n",
+        dev_name, isp_meta_ring_count(&ring), st.frames, st.missed, st.gone, st.busy, st.errors);
+    MSG("metadata ring: %s\n", (st.errors || !st.frames) ? "FAIL" : "PASS");
+
+    isp_meta_ring_close(&ring);
+    close(fd);
+
+    return (st.errors || !st.frames) ? 1 : 0;
+}
@@ -62,11 +62,7 @@ const char *xcmd="echo 1080p60hz > /sys/class/display/mode;\
 #if DUMP_RAW
 static int dump_fd = -1;
 #endif
-unsigned char *displaybuf_fr;
-unsigned char *displaybuf_ds1;
-unsigned char *displaybuf_ds2;
-unsigned char *displaybuf_meta;
-static int fb_fd = 0;
+static renderer_t fb_renderer;
 /**********
  * thread parameters
  */
@@ -90,9 +86,19 @@ static uint32_t manual_isp_digital_gain = 0;
 
 static uint32_t stop_sensor_update = 0;
 static uint32_t max_int_time = 0;
+static int capture_direct_io = 0;
 
 #define GDC_CFG_FILE_NAME "nv12_1920_1080_cfg.bin"
 
+/* gdc input modes (-g) */
+#define GDC_INPUT_OFF       0
+#define GDC_INPUT_DMABUF    1   /* capture buffers exported with VIDIOC_EXPBUF */
+#define GDC_INPUT_COPY      2   /* capture buffers copied into the gdc input buffer */
+
+static int gdc_use_model = 0;
+/* set by the gdc stream once its output is rendered, fr stops rendering then */
+static volatile int gdc_owns_display = 0;
+
 #define LINE_SIZE 128
 #define LINE_MASK (~(LINE_SIZE - 1))
 #define LINE_ALIGN(size) ((size + LINE_SIZE - 1) & LINE_MASK)
@@ -111,11 +117,6 @@ struct thread_param {
     /* video device info */
     char                        * devname;
 
-    /* display device info */
-    char                        * fbp;
-    struct fb_var_screeninfo    vinfo;
-    struct fb_fix_screeninfo    finfo;
-
     /* format info */
     uint32_t                    width;
     uint32_t                    height;
@@ -126,6 +127,7 @@ struct thread_param {
     /* for snapshot stream (non-zsl implementation) */
     int32_t                     capture_count;
     int32_t                     gdc_ctrl;
+    int32_t                     gdc_model;
     int                         videofd;
     uint32_t  c_width;
     uint32_t  c_height;
@@ -479,6 +481,7 @@ int gdc_init_cfg(struct gdc_usr_ctx_s *ctx, struct thread_param *tparm, char *f_
     }
 
     memset(ctx, 0, sizeof(*ctx));
+    ctx->use_model = tparm->gdc_model;
 
     i_width = tparm->width;
     i_height = tparm->height;
@@ -593,6 +596,7 @@ int gdc_handle_init_cfg(struct gdc_usr_ctx_s *ctx, struct thread_param *tparm, c
     }
 
     memset(ctx, 0, sizeof(*ctx));
+    ctx->use_model = tparm->gdc_model;
 
     i_width = tparm->width;
     i_height = tparm->height;
@@ -747,11 +751,13 @@ void * video_thread(void *arg)
     int                         rc = 0;
     int                         i,j;
     __u32	v4l2_enum_type=V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
-    unsigned char *displaybuf = NULL;
     uint64_t display_count = 0;
     int64_t start, end;
     struct gdc_usr_ctx_s gdc_ctx;
     int gdc_ret = -1;
+    int gdc_done = 0;
+    uint64_t render_ns = 0;
+    image_info_t gdc_img;
     /**************************************************
      * find thread id
      *************************************************/
@@ -979,8 +985,17 @@ void * video_thread(void *arg)
     }
     DBG("[T#%d] Queue buf done.\n", stream_type);
 
-    if (stream_type == ARM_V4L2_TEST_STREAM_DS1 && tparm->gdc_ctrl == 1) {
-        gdc_ret = gdc_handle_init_cfg(&gdc_ctx, tparm, GDC_CFG_FILE_NAME);
+    if (stream_type == ARM_V4L2_TEST_STREAM_DS1 && tparm->gdc_ctrl != GDC_INPUT_OFF) {
+        /* planes which can't be exported fall back to copying */
+        if (tparm->gdc_ctrl == GDC_INPUT_DMABUF && v4l2_dma_fd[0] < 0) {
+            ERR("No dma buf for gdc input, using the copy path\n");
+            tparm->gdc_ctrl = GDC_INPUT_COPY;
+        }
+
+        if (tparm->gdc_ctrl == GDC_INPUT_DMABUF)
+            gdc_ret = gdc_handle_init_cfg(&gdc_ctx, tparm, GDC_CFG_FILE_NAME);
+        else
+            gdc_ret = gdc_init_cfg(&gdc_ctx, tparm, GDC_CFG_FILE_NAME);
         if (gdc_ret < 0)
             ERR("Failed to init gdc cfg\n");
     }
@@ -1015,25 +1030,6 @@ void * video_thread(void *arg)
         frame_t newframe;
         int idx = -1;
 
-        switch (stream_type) {
-        case ARM_V4L2_TEST_STREAM_FR:
-            memset(displaybuf_fr, 0, tparm->width * tparm->height * 3);
-            displaybuf = displaybuf_fr;
-            break;
-        case ARM_V4L2_TEST_STREAM_META:
-            memset(displaybuf_meta, 0, tparm->width * tparm->height * 3);
-            displaybuf = displaybuf_meta;
-            break;
-        case ARM_V4L2_TEST_STREAM_DS1:
-            memset(displaybuf_ds1, 0, tparm->width * tparm->height * 3);
-            displaybuf = displaybuf_ds1;
-            break;
-        case ARM_V4L2_TEST_STREAM_DS2:
-            memset(displaybuf_ds2, 0, tparm->width * tparm->height * 3);
-            displaybuf = displaybuf_ds2;
-            break;
-        }
-
         /* wait (poll) for a frame event */
         //printf ("[T#%d] Start polling (exit flag = %d, capture count = %d)\n",
         //    stream_type, v4l2_test_thread_exit, tparm->capture_count);
@@ -1111,54 +1107,84 @@ void * video_thread(void *arg)
             }
         }
 
+        /* the renderer reads the capture planes directly, before they are queued back */
         image_info_t src;
-        src.ptr = v4l2_mem[idx];
-        src.width = v4l2_fmt.fmt.pix.width;
-        src.height = v4l2_fmt.fmt.pix.height;
-        src.bpp = 32; // Todo: fixed to ARGB for now
-        src.fmt = v4l2_fmt.fmt.pix.pixelformat;
-
+        src.ptr = v4l2_mem[idx * v4l2_fmt.fmt.pix_mp.num_planes];
+        src.uv = (v4l2_fmt.fmt.pix_mp.num_planes > 1) ? v4l2_mem[idx * v4l2_fmt.fmt.pix_mp.num_planes + 1] : NULL;
+        src.width = v4l2_fmt.fmt.pix_mp.width;
+        src.height = v4l2_fmt.fmt.pix_mp.height;
+        src.stride = v4l2_fmt.fmt.pix_mp.plane_fmt[0].bytesperline;
+        src.bpp = 24;
+        src.fmt = v4l2_fmt.fmt.pix_mp.pixelformat;
+
+        gdc_done = 0;
         if (src.fmt == V4L2_PIX_FMT_NV12) {
-                if (stream_type == ARM_V4L2_TEST_STREAM_DS1 && tparm->gdc_ctrl == 1) {
+                if (stream_type == ARM_V4L2_TEST_STREAM_DS1 && tparm->gdc_ctrl != GDC_INPUT_OFF) {
                         if (gdc_ret >= 0) {
-                                //memcpy(gdc_ctx.i_buff, v4l2_mem[idx * 2], v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage);
-                                //memcpy(gdc_ctx.i_buff + v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage, v4l2_mem[idx * 2 + 1],
-                                                        //v4l2_fmt.fmt.pix_mp.plane_fmt[1].sizeimage);
-                                gdc_ctx.gs.y_base_fd = v4l2_dma_fd[idx * 2];
-                                gdc_ctx.gs.uv_base_fd = v4l2_dma_fd[idx * 2 + 1];
-
-                                gdc_handle(&gdc_ctx);
-                                save_imgae(gdc_ctx.o_buff, gdc_ctx.o_len, stream_type, tparm->capture_count);
+                                if (tparm->gdc_ctrl == GDC_INPUT_DMABUF)
+                                        rc = gdc_process_dma(&gdc_ctx, v4l2_dma_fd[idx * 2], v4l2_dma_fd[idx * 2 + 1]);
+                                else
+                                        rc = gdc_process_copy(&gdc_ctx, v4l2_mem[idx * 2], v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage,
+                                                        v4l2_mem[idx * 2 + 1], v4l2_fmt.fmt.pix_mp.plane_fmt[1].sizeimage);
+                                if (rc == 0) {
+                                        gdc_done = 1;
+                                        save_imgae(gdc_ctx.o_buff, gdc_ctx.o_len, stream_type, tparm->capture_count);
+                                }
                         }
-                } else {
-                        memcpy(displaybuf, v4l2_mem[idx * 2], v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage);
-                        memcpy(displaybuf + v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage, v4l2_mem[idx * 2 + 1],
-                                                v4l2_fmt.fmt.pix_mp.plane_fmt[1].sizeimage);
                 }
-        } else {
-                memcpy(displaybuf, src.ptr, v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage);
-        }
-
-        rc = ioctl (videofd, VIDIOC_QBUF, &v4l2_buf);
-        if (rc < 0) {
-            printf ("Error: queue buffer.\n");
-            break;
         }
 
         /***** select save file or display through different stream_type *****/
         if (stream_type == ARM_V4L2_TEST_STREAM_FR) {
-            int fb_offset = display_count % fb_buffer_cnt;
-            renderImage(tparm->fbp + (src.width * src.height * 3 * fb_offset), tparm->vinfo, tparm->finfo, displaybuf, src.width, src.height, AFD_RENDER_MODE_LEFT_TOP, fb_fd, fb_offset);
-            //save_imgae(displaybuf, v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage * 2, stream_type, tparm->capture_count);
+            if (!gdc_owns_display)
+                renderer_draw(&fb_renderer, &src, AFD_RENDER_MODE_LEFT_TOP);
         } else if (stream_type == ARM_V4L2_TEST_STREAM_META) {
         //do nothing
         } else if (stream_type == ARM_V4L2_TEST_STREAM_DS1) {
-         //save_imgae(displaybuf, v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage * 2, stream_type, tparm->capture_count);
+            if (gdc_done) {
+                /* gdc output goes to the frame buffer as is, no display copy */
+                uint64_t render_start = getTimestamp();
+
+                gdc_img = src;
+                gdc_img.ptr = (unsigned char *)gdc_ctx.o_buff;
+                gdc_img.uv = gdc_img.ptr + gdc_ctx.gs.gdc_config.output_y_stride * gdc_ctx.gs.gdc_config.output_height;
+                gdc_img.width = gdc_ctx.gs.gdc_config.output_width;
+                gdc_img.height = gdc_ctx.gs.gdc_config.output_height;
+                gdc_img.stride = gdc_ctx.gs.gdc_config.output_y_stride;
+
+                gdc_owns_display = 1;
+                renderer_draw(&fb_renderer, &gdc_img, AFD_RENDER_MODE_LEFT_TOP);
+                render_ns += getTimestamp() - render_start;
+            }
         } else if (stream_type == ARM_V4L2_TEST_STREAM_DS2) {
-        //save_imgae(displaybuf, v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage, stream_type, tparm->capture_count);
+        //save_imgae(src.ptr, v4l2_fmt.fmt.pix_mp.plane_fmt[0].sizeimage, stream_type, tparm->capture_count);
+        }
+
+        if (v4l2_test_thread_capture != V4L2_TEST_CAPTURE_NONE) {
+            /* frame_pack owns the buffer now and queues it back */
+            if (enqueue_buffer(&g_cap_mod, stream_type, &newframe, v4l2_test_thread_capture)) {
+                v4l2_test_thread_capture = V4L2_TEST_CAPTURE_NONE;
+            }
+        } else {
+            rc = ioctl (videofd, VIDIOC_QBUF, &v4l2_buf);
+            /* the plane array is only kept when handed to the capture module */
+            if(v4l2_buf.type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+                free(v4l2_buf.m.planes);
+            if (rc < 0) {
+                printf ("Error: queue buffer.\n");
+                break;
+            }
         }
 
         display_count++;
+        if (gdc_done && gdc_ctx.time.frames % 100 == 0) {
+            printf("gdc %s%s: copy %llu us, gdc %llu us, render %llu us per frame\n",
+                (tparm->gdc_ctrl == GDC_INPUT_DMABUF) ? "dmabuf" : "copy",
+                gdc_ctx.use_model ? " (cpu model)" : "",
+                gdc_ctx.time.copy_us / gdc_ctx.time.frames,
+                gdc_ctx.time.run_us / gdc_ctx.time.frames,
+                (unsigned long long)(render_ns / 1000 / gdc_ctx.time.frames));
+        }
         if ((stream_type == fps_test_port) && (display_count % 100 == 0)) {
             end = GetTimeMsec();
             end = end - start;
@@ -1168,6 +1194,7 @@ void * video_thread(void *arg)
                 ((stream_type == 2) ? "DS1":
                 ((stream_type == 3) ? "DS2": "Other"))), (100 * 1000) /end);
             start = GetTimeMsec();
+            renderer_print_stats(&fb_renderer, "fb");
         }
 
         if (tparm->capture_count > 0)
@@ -1179,7 +1206,6 @@ void * video_thread(void *arg)
      * resource clean-up
      *************************************************/
     /* release all buffers from capture_module */
-    free(displaybuf);
     release_capture_module_stream(&g_cap_mod, stream_type);
     /* stream off */
     rc = ioctl (videofd, VIDIOC_STREAMOFF, &type);
@@ -1199,8 +1225,10 @@ void * video_thread(void *arg)
     }
 
 fatal:
-    if (stream_type == ARM_V4L2_TEST_STREAM_DS1 && tparm->gdc_ctrl == 1)
+    if (stream_type == ARM_V4L2_TEST_STREAM_DS1 && tparm->gdc_ctrl != GDC_INPUT_OFF) {
+        gdc_owns_display = 0;
         gdc_destroy_ctx(&gdc_ctx);
+    }
 
     close(videofd);
 
@@ -1354,6 +1382,8 @@ int main(int argc, char *argv[])
     uint32_t wdr_mode = 0;
     uint32_t exposure = 1;
     char *fbdevname = "/dev/fb0";
+    int headless_w = 0;
+    int headless_h = 0;
     char *v4ldevname = "/dev/video0";
     int rc = 0;
     int i;
@@ -1381,12 +1411,14 @@ int main(int argc, char *argv[])
         printf("    w : wdr mode          : 0: linear 1: native 2: fs lin\n");
         printf("    e : exposure value    : min 1, max 4, default is 1\n");
         printf("    b : fbdev            : default: /dev/fb0\n");
+        printf("    E : headless, render into an in-memory frame buffer of WxH instead of fbdev\n");
         printf("    v : videodev         : default: /dev/video0\n");
         printf("    N : fr frame count \n");
         printf("    n : ds1 & ds2 frame count \n");
         printf("    t : run the port count, default is 1\n");
         printf("    x : fps print port. default: -1, no print. 0:  fr, 1: meta, 2: ds1, 3: ds2\n");
-        printf("    g : enable or disable gdc module: 0: disable, 1: enable\n");
+        printf("    g : gdc on ds1: 0: disable, 1: dmabuf input (zero copy), 2: copy input\n");
+        printf("    U : run gdc jobs on the cpu model instead of /dev/gdc, 0: disable, 1: enable\n");
         printf("    I : set sensor ir cut state, 0: close, 1: open\n");
         printf("    W : FR crop width\n");
         printf("    H : FR crop height\n");
@@ -1399,13 +1431,14 @@ int main(int argc, char *argv[])
         printf("    G : sensor digital gain\n");
         printf("    S : isp digital gain\n");
         printf("    K : stop sensor update, 0: enable sensor update, 1: stop sensor update\n");
+        printf("    O : write capture files with O_DIRECT, 0: disable, 1: enable\n");
         return -1;
     }
 
     int c;
 
     while(optind < argc){
-        if ((c = getopt (argc, argv, "c:p:F:f:D:R:r:d:N:n:w:e:b:v:t:x:g:I:W:H:Y:Z:a:M:L:A:G:S:K:m:")) != -1) {
+        if ((c = getopt (argc, argv, "c:p:F:f:D:R:r:d:N:n:w:e:b:E:v:t:x:g:I:W:H:Y:Z:a:M:L:A:G:S:K:m:O:U:")) != -1) {
             switch (c) {
             case 'c':
                 command = atoi(optarg);
@@ -1446,6 +1479,9 @@ int main(int argc, char *argv[])
             case 'b':
                 fbdevname = optarg;
                 break;
+            case 'E':
+                sscanf(optarg, "%dx%d", &headless_w, &headless_h);
+                break;
             case 'v':
                 v4ldevname = optarg;
                 break;
@@ -1496,6 +1532,12 @@ int main(int argc, char *argv[])
             case 'm':
                 max_int_time = atoi(optarg);
                 break;
+            case 'O':
+                capture_direct_io = atoi(optarg);
+                break;
+            case 'U':
+                gdc_use_model = atoi(optarg);
+                break;
             case '?':
                 usage(argv[0]);
                 exit(1);
@@ -1512,73 +1554,15 @@ int main(int argc, char *argv[])
      * Frame buffer initialize
      *************************************************/
 
-	system(xcmd);
-
-	struct fb_var_screeninfo vinfo;
-    struct fb_fix_screeninfo finfo;
-    long int screensize = 0;
-    char *fbp = 0;
-
-    /* Open the file for reading and writing */
-    fb_fd = open(fbdevname, O_RDWR);
-    if (fb_fd == -1) {
-        printf("Error: cannot open framebuffer device\n");
-        exit(1);
-    }
-    MSG("The %s device was opened successfully.\n", fbdevname);
-
-    /* Get fixed screen information */
-    if (ioctl(fb_fd, FBIOGET_FSCREENINFO, &finfo) == -1) {
-        printf("Error reading fixed information\n");
-        exit(2);
-    }
-
-    /* Get variable screen information */
-    if (ioctl(fb_fd, FBIOGET_VSCREENINFO, &vinfo) == -1) {
-        printf("Error reading variable information\n");
-        exit(3);
-    }
-
-    MSG("%dx%d, %dbpp\n", vinfo.xres, vinfo.yres, vinfo.bits_per_pixel);
-#if 1
-	vinfo.red.offset = 0;
-	vinfo.red.length = 8;
-	vinfo.red.msb_right = 0;
-
-	vinfo.green.offset = 8;
-	vinfo.green.length = 8;
-	vinfo.green.msb_right = 0;
-
-	vinfo.blue.offset = 16;
-	vinfo.blue.length = 8;
-	vinfo.blue.msb_right = 0;
-
-	vinfo.transp.offset = 0;
-	vinfo.transp.length = 0;
-	vinfo.transp.msb_right = 0;
-	vinfo.nonstd = 0;
-	vinfo.bits_per_pixel = 24;
-#else
-	vinfo.red.offset = 0;
-	vinfo.green.offset = 8;
-	vinfo.blue.offset = 16;
-#endif
-	if (ioctl(fb_fd, FBIOPUT_VSCREENINFO, &vinfo) == -1) {
-		    printf("Error reading variable information\n");
-	}
-
-
-    /* Figure out the size of the screen in bytes */
-    screensize = vinfo.xres * vinfo.yres * vinfo.bits_per_pixel * fb_buffer_cnt / 4; // 3 buffers
-
-    /* Map the device to memory */
-    fbp = (char *)mmap(0, screensize, PROT_READ | PROT_WRITE,
-        MAP_SHARED, fb_fd, 0);
-    if (fbp < 0) {
-        printf("Error: failed to map framebuffer device to memory\n");
-        exit(4);
+    if (headless_w > 0 && headless_h > 0) {
+        /* in-memory frame buffer, nothing reaches a display */
+        if (renderer_open_headless(&fb_renderer, headless_w, headless_h, 24, fb_buffer_cnt) < 0)
+            exit(1);
+    } else {
+        system(xcmd);
+        if (renderer_open(&fb_renderer, fbdevname, fb_buffer_cnt) < 0)
+            exit(1);
     }
-    MSG("The framebuffer device was mapped to memory successfully.\n");
 
     if (fr_num <= 0 && ds_num <= 0) {
         printf("can't display both fr and ds\n");
@@ -1601,10 +1585,6 @@ int main(int argc, char *argv[])
     struct thread_param tparam[STATIC_STREAM_COUNT] = {
         {
             .devname    = v4ldevname,
-            .fbp        = fbp,
-            .finfo      = finfo,
-            .vinfo      = vinfo,
-
             .width      = 1920,
             .height     = 1080,
             .pixformat  = pixel_format,
@@ -1620,10 +1600,6 @@ int main(int argc, char *argv[])
 #if ARM_V4L2_TEST_HAS_META
         {
             .devname    = v4ldevname,
-            .fbp        = fbp,
-            .finfo      = finfo,
-            .vinfo      = vinfo,
-
             .width      = 1*1024*1024,
             .height     = 1,
             .pixformat  = ISP_V4L2_PIX_FMT_META,
@@ -1636,16 +1612,13 @@ int main(int argc, char *argv[])
 #endif
         {
             .devname    = v4ldevname,
-            .fbp        = fbp,
-            .finfo      = finfo,
-            .vinfo      = vinfo,
-
             .width      = 1280,
             .height     = 720,
             .pixformat  = V4L2_PIX_FMT_RGB24,
             .wdr_mode	= 0,
             .exposure	= 1,
             .gdc_ctrl = ds_gdc_ctrl,
+            .gdc_model = gdc_use_model,
 
             .capture_count = ds_num,
             .c_width = ds_c_width,
@@ -1653,10 +1626,6 @@ int main(int argc, char *argv[])
         },
         {
             .devname    = v4ldevname,
-            .fbp        = fbp,
-            .finfo      = finfo,
-            .vinfo      = vinfo,
-
             .width      = 1280,
             .height     = 720,
             .pixformat  = V4L2_PIX_FMT_RGB24,
@@ -1672,18 +1641,9 @@ int main(int argc, char *argv[])
     parse_fmt_res(ds1_out_fmt, ds1_res, wdr_mode, exposure, &tparam[ARM_V4L2_TEST_STREAM_DS1]);
     parse_fmt_res(ds2_out_fmt, ds2_res, wdr_mode, exposure, &tparam[ARM_V4L2_TEST_STREAM_DS2]);
 
-    displaybuf_fr = (unsigned char *)malloc(tparam[0].width * tparam[0].height * 3);
-    displaybuf_meta = (unsigned char *)malloc(tparam[1].width * tparam[1].height * 3);
-    displaybuf_ds1 = (unsigned char *)malloc(tparam[2].width * tparam[2].height * 3);
-    displaybuf_ds2 = (unsigned char *)malloc(tparam[3].width * tparam[2].height * 3);
-
 #if ARM_V4L2_TEST_HAS_RAW
     struct thread_param tparam_raw = {
         .devname    = v4ldevname,
-        .fbp        = fbp,
-        .finfo      = finfo,
-        .vinfo      = vinfo,
-
         .width      = 1920,
         .height     = 1080,
         .pixformat  = V4L2_PIX_FMT_SBGGR16,
@@ -1695,6 +1655,7 @@ int main(int argc, char *argv[])
 
     /* init mutex lock for frame_pack_t */
     init_capture_module(&g_cap_mod);
+    g_cap_mod.direct_io = capture_direct_io;
 
     if(sensor_preset>=0){
         int videofd = open(v4ldevname, O_RDWR);
@@ -1841,9 +1802,11 @@ int main(int argc, char *argv[])
         pthread_join(tid[i], NULL);
     }
 
+    /* flush pending capture files */
+    release_capture_module(&g_cap_mod);
+
     MSG("terminating v4l2 test app, thank you ...\n");
 
-    munmap(fbp, screensize);
-    close(fb_fd);
+    renderer_close(&fb_renderer);
     return 0;
 }
@@ -0,0 +1,51 @@
+#!/bin/sh
+#
+# Run v4l2_engine against vivid: single plane and multiplanar capture
+# nodes, each streamed alone and several at a time with the null sink.
+# A run passes when every stream delivered all its frames without errors.
+#
+#   FRAMES=120 ENGINE=./v4l2_engine ./vivid_test.sh
+#
+# Needs root and the vivid module, the nodes are /dev/video50..53.
+
+FRAMES=${FRAMES:-120}
+ENGINE=${ENGINE:-./v4l2_engine}
+LOG=${LOG:-/tmp/vivid_test.log}
+fail=0
+
+# vivid instances 0,1 are single plane, 2,3 multiplanar
+modprobe -r vivid 2>/dev/null
+if ! modprobe vivid n_devs=4 multiplanar=1,1,2,2 node_types=0x1,0x1,0x1,0x1 vid_cap_nr=50,51,52,53; then
+    echo "vivid is not available"
+    exit 2
+fi
+sleep 1
+
+run() {
+    name=$1
+    shift
+    streams=$(echo "$@" | grep -o -- '-s' | wc -l)
+
+    $ENGINE -n $FRAMES -p 0 "$@" > $LOG 2>&1
+    rc=$?
+    # [S0] 120 frames, 30.00 fps, 0 gaps, 0 errors, ...
+    good=$(grep -E "^\[S[0-9]+\] $FRAMES frames, .* 0 errors" $LOG | wc -l)
+    if [ $rc -eq 0 ] && [ $good -eq $streams ]; then
+        echo "$name: PASS"
+    else
+        echo "$name: FAIL (rc $rc, $good of $streams streams complete)"
+        cat $LOG
+        fail=1
+    fi
+    grep -E "^\[S[0-9]+\]" $LOG
+}
+
+run "multiplanar=1, 1 stream"  -s /dev/video50:640x480:YUYV:null
+run "multiplanar=1, 2 streams" -s /dev/video50:640x480:YUYV:null -s /dev/video51:1280x720:NV12:null
+run "multiplanar=2, 1 stream"  -s /dev/video52:640x480:NM12:null
+run "multiplanar=2, 2 streams" -s /dev/video52:640x480:NM12:null -s /dev/video53:1280x720:YUYV:null
+run "mixed, 4 streams" -s /dev/video50:640x480:YUYV:null -s /dev/video51:640x480:NV12:null \
+    -s /dev/video52:640x480:NM12:null -s /dev/video53:640x480:YUYV:null
+
+modprobe -r vivid
+exit $fail